@@ -68,6 +68,17 @@ def small_value_batch(n):
     return 0
 
 
+@ray.remote
+def return_value(n):
+    return np.zeros(n, dtype=np.uint8)
+
+
+@ray.remote(num_returns="streaming")
+def small_value_generator(n):
+    for _ in range(n):
+        yield b"ok"
+
+
 @ray.remote
 def create_object_containing_ref():
     obj_refs = []
@@ -288,6 +299,108 @@ def main(results=None):
     results += timeit("n:n async-actor calls async", async_actor_multi, m * n)
     ray.shutdown()
 
+    # Fine-grained actor calls, with the actor tasks pushed in batches of up to
+    # `batch_size` tasks per RPC.
+    for batch_size in [1, 8, 32, 128]:
+        ray.init(_system_config={"actor_task_push_batch_size": batch_size})
+        a = Actor.remote()
+
+        def actor_batched_push():
+            ray.get([a.small_value.remote() for _ in range(1000)])
+
+        results += timeit(
+            f"1:1 actor calls async with push batch size {batch_size}",
+            actor_batched_push,
+            1000,
+        )
+        ray.shutdown()
+
+    # Tasks with large inlined args, which the executing worker either copies or
+    # passes to Python as slices of the received task spec.
+    for zero_copy in [False, True]:
+        ray.init(_system_config={"task_inlined_args_zero_copy": zero_copy})
+        a = Actor.remote()
+        for arg_kb in [10, 100]:
+            arg = np.zeros(arg_kb * 1024 - 1024, dtype=np.uint8)
+
+            def actor_large_inlined_arg():
+                ray.get([a.small_value_arg.remote(arg) for _ in range(100)])
+
+            results += timeit(
+                f"1:1 actor calls with {arg_kb}KB inlined arg, zero copy {zero_copy}",
+                actor_large_inlined_arg,
+                100,
+            )
+        ray.shutdown()
+
+    # Tasks returning objects near max_direct_call_object_size, which are inlined or
+    # put into plasma by the static or the adaptive threshold.
+    for adaptive in [False, True]:
+        ray.init(_system_config={"adaptive_inline_threshold_enabled": adaptive})
+        for value_kb in [50, 90, 110, 200]:
+
+            def task_return_value():
+                ray.get([return_value.remote(value_kb * 1024) for _ in range(100)])
+
+            results += timeit(
+                f"single client tasks returning {value_kb}KB, adaptive {adaptive}",
+                task_return_value,
+                100,
+            )
+        ray.shutdown()
+
+    # Streaming generators yielding small items, reported to the caller one by one
+    # or in batches.
+    for batch_size in [1, 16]:
+        ray.init(
+            _system_config={"streaming_generator_report_batch_size": batch_size}
+        )
+
+        def streaming_generator_items():
+            for ref in small_value_generator.remote(1000):
+                ray.get(ref)
+
+        results += timeit(
+            f"single client streaming generator items, report batch size {batch_size}",
+            streaming_generator_items,
+            1000,
+        )
+        ray.shutdown()
+
+    # Plasma puts and gets, with seals and releases sent on the socket or through the
+    # command ring.
+    for command_ring in [False, True]:
+        ray.init(_system_config={"plasma_command_ring_enabled": command_ring})
+        ring_value = ray.put(0)
+
+        def get_ring_value():
+            ray.get(ring_value)
+
+        results += timeit(
+            f"single client get calls (Plasma Store), command ring {command_ring}",
+            get_ring_value,
+        )
+        results += timeit(
+            f"single client put calls (Plasma Store), command ring {command_ring}",
+            put_small,
+        )
+        results += timeit(
+            f"multi client put calls (Plasma Store), command ring {command_ring}",
+            put_multi_small,
+            1000,
+        )
+        ray.shutdown()
+
+    # Plasma puts from many clients, served by 1 to 16 store threads.
+    for num_threads in [1, 2, 4, 8, 16]:
+        ray.init(_system_config={"plasma_store_num_threads": num_threads})
+        results += timeit(
+            f"multi client put calls (Plasma Store), {num_threads} store threads",
+            put_multi_small,
+            1000,
+        )
+        ray.shutdown()
+
     ############################
     # End of channel perf tests.
     ############################
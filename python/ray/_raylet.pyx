@@ -853,9 +853,8 @@ cdef prepare_args_and_increment_put_refs(
         # An error occurred during arg serialization. We must remove the
         # initial local ref for all args that were successfully put into the
         # local plasma store. These objects will then get released.
-        for put_arg_id in dereference(incremented_put_arg_ids):
-            CCoreWorkerProcess.GetCoreWorker().RemoveLocalReference(
-                put_arg_id)
+        CCoreWorkerProcess.GetCoreWorker().RemoveLocalReferences(
+            dereference(incremented_put_arg_ids))
         raise e
 
 cdef prepare_args_internal(
@@ -865,8 +864,6 @@ cdef prepare_args_internal(
         c_vector[CObjectID] *incremented_put_arg_ids):
     cdef:
         size_t size
-        int64_t put_threshold
-        int64_t rpc_inline_threshold
         int64_t total_inlined
         shared_ptr[CBuffer] arg_data
         c_vector[CObjectID] inlined_ids
@@ -874,11 +871,11 @@ cdef prepare_args_internal(
         c_vector[CObjectReference] inlined_refs
         CAddress c_owner_address
         CRayStatus op_status
+        c_string inline_arg_key
+        c_bool has_inline_arg_key = False
 
     worker = ray._private.worker.global_worker
-    put_threshold = RayConfig.instance().max_direct_call_object_size()
     total_inlined = 0
-    rpc_inline_threshold = RayConfig.instance().task_rpc_inlined_bytes_limit()
     for arg in args:
         from ray.experimental.compiled_dag_ref import CompiledDAGRef
         if isinstance(arg, CompiledDAGRef):
@@ -924,8 +921,13 @@ cdef prepare_args_internal(
             # plasma here. This is inefficient for small objects, but inlined
             # arguments aren't associated ObjectRefs right now so this is a
             # simple fix for reference counting purposes.
-            if <int64_t>size <= put_threshold and \
-                    (<int64_t>size + total_inlined <= rpc_inline_threshold):
+            if not has_inline_arg_key:
+                # Computed once for all the args of the task.
+                inline_arg_key = CCoreWorkerProcess.GetCoreWorker().GetInlineArgKey(
+                    (<FunctionDescriptor>function_descriptor).descriptor)
+                has_inline_arg_key = True
+            if CCoreWorkerProcess.GetCoreWorker().ShouldInlineArg(
+                    inline_arg_key, <int64_t>size, total_inlined):
                 arg_data = dynamic_pointer_cast[CBuffer, LocalMemoryBuffer](
                         make_shared[LocalMemoryBuffer](size))
                 if size > 0:
@@ -1218,7 +1220,8 @@ cdef class StreamingGeneratorExecutionContext:
 
         self.waiter = make_shared[CGeneratorBackpressureWaiter](
             generator_backpressure_num_objects,
-            check_signals
+            check_signals,
+            RayConfig.instance().streaming_generator_backpressure_bytes()
         )
 
         return self
@@ -1384,6 +1387,8 @@ cdef execute_streaming_generator_sync(StreamingGeneratorExecutionContext context
     # the yield'ed ObjectRef. Therefore, we must wait for all in-flight object
     # reports to complete before finishing the task.
     with nogil:
+        CCoreWorkerProcess.GetCoreWorker().FlushGeneratorItemReturns(
+            context.generator_id)
         return_status = context.waiter.get().WaitAllObjectsReported()
     check_status(return_status)
 
@@ -1481,6 +1486,8 @@ async def execute_streaming_generator_async(
     # the yield'ed ObjectRef. Therefore, we must wait for all in-flight object
     # reports to complete before finishing the task.
     with nogil:
+        CCoreWorkerProcess.GetCoreWorker().FlushGeneratorItemReturns(
+            context.generator_id)
         return_status = context.waiter.get().WaitAllObjectsReported()
     check_status(return_status)
 
@@ -3769,9 +3776,8 @@ cdef class CoreWorker:
             # ref count initially to ensure that they remain in scope until we
             # add to their submitted task ref count. Now that the task has
             # been submitted, it's safe to remove the initial local ref.
-            for put_arg_id in incremented_put_arg_ids:
-                CCoreWorkerProcess.GetCoreWorker().RemoveLocalReference(
-                    put_arg_id)
+            CCoreWorkerProcess.GetCoreWorker().RemoveLocalReferences(
+                incremented_put_arg_ids)
 
             # The initial local reference is already acquired internally when
             # adding the pending task.
@@ -3856,9 +3862,8 @@ cdef class CoreWorker:
             # ref count initially to ensure that they remain in scope until we
             # add to their submitted task ref count. Now that the task has
             # been submitted, it's safe to remove the initial local ref.
-            for put_arg_id in incremented_put_arg_ids:
-                CCoreWorkerProcess.GetCoreWorker().RemoveLocalReference(
-                    put_arg_id)
+            CCoreWorkerProcess.GetCoreWorker().RemoveLocalReferences(
+                incremented_put_arg_ids)
 
             check_status(status)
 
@@ -3999,9 +4004,8 @@ cdef class CoreWorker:
             # ref count initially to ensure that they remain in scope until we
             # add to their submitted task ref count. Now that the task has
             # been submitted, it's safe to remove the initial local ref.
-            for put_arg_id in incremented_put_arg_ids:
-                CCoreWorkerProcess.GetCoreWorker().RemoveLocalReference(
-                    put_arg_id)
+            CCoreWorkerProcess.GetCoreWorker().RemoveLocalReferences(
+                incremented_put_arg_ids)
 
             if status.ok():
                 # The initial local reference is already acquired internally
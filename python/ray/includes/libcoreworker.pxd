@@ -100,7 +100,8 @@ cdef extern from "ray/core_worker/generator_waiter.h" nogil:
     cdef cppclass CGeneratorBackpressureWaiter "ray::core::GeneratorBackpressureWaiter": # noqa
         CGeneratorBackpressureWaiter(
                 int64_t generator_backpressure_num_objects,
-                (CRayStatus() nogil) check_signals)
+                (CRayStatus() nogil) check_signals,
+                int64_t generator_backpressure_num_bytes)
         CRayStatus WaitAllObjectsReported()
 
 cdef extern from "ray/core_worker/core_worker.h" nogil:
@@ -224,9 +225,14 @@ cdef extern from "ray/core_worker/core_worker.h" nogil:
             c_bool all_namespaces)
         void AddLocalReference(const CObjectID &object_id)
         void RemoveLocalReference(const CObjectID &object_id)
+        void RemoveLocalReferences(const c_vector[CObjectID] &object_ids)
         void PutObjectIntoPlasma(const CRayObject &object,
                                  const CObjectID &object_id)
         const CAddress &GetRpcAddress() const
+        c_string GetInlineArgKey(const CFunctionDescriptor &function) const
+        c_bool ShouldInlineArg(const c_string &key,
+                               int64_t arg_size,
+                               int64_t inlined_bytes)
         CRayStatus GetOwnerAddress(const CObjectID &object_id,
                                    CAddress *owner_address) const
         c_vector[CObjectReference] GetObjectRefs(
@@ -314,6 +320,7 @@ cdef extern from "ray/core_worker/core_worker.h" nogil:
             int64_t item_index,
             uint64_t attempt_number,
             shared_ptr[CGeneratorBackpressureWaiter] waiter)
+        void FlushGeneratorItemReturns(const CObjectID &generator_id)
         c_string MemoryUsageString()
         int GetMemoryStoreSize()
 
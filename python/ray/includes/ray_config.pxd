@@ -51,6 +51,8 @@ cdef extern from "ray/common/ray_config.h" nogil:
 
         int64_t task_rpc_inlined_bytes_limit() const
 
+        int64_t streaming_generator_backpressure_bytes() const
+
         uint64_t metrics_report_interval_ms() const
 
         c_bool enable_timeline() const
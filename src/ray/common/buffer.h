@@ -172,4 +172,37 @@ class SharedMemoryBuffer : public Buffer {
   std::shared_ptr<Buffer> parent_;
 };
 
+/// Represents a byte buffer in local memory that is owned by another object, e.g., a
+/// bytes field of a protobuf message. The buffer keeps the owner alive, so the data
+/// stays valid as long as the buffer does.
+class SharedSliceBuffer : public Buffer {
+ public:
+  /// Constructor.
+  ///
+  /// \param owner The object that owns the data.
+  /// \param data The data pointer into the owner.
+  /// \param size The size of the data.
+  SharedSliceBuffer(std::shared_ptr<const void> owner, uint8_t *data, size_t size)
+      : data_(data), size_(size), owner_(std::move(owner)) {}
+
+  uint8_t *Data() const override { return data_; }
+
+  size_t Size() const override { return size_; }
+
+  bool OwnsData() const override { return true; }
+
+  bool IsPlasmaBuffer() const override { return false; }
+
+ private:
+  SharedSliceBuffer &operator=(const SharedSliceBuffer &) = delete;
+  SharedSliceBuffer(const SharedSliceBuffer &) = delete;
+
+  /// Pointer to the data.
+  uint8_t *data_;
+  /// Size of the buffer.
+  size_t size_;
+  /// Keep the owner of the data alive.
+  std::shared_ptr<const void> owner_;
+};
+
 }  // namespace ray
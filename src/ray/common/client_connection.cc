@@ -20,7 +20,9 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/bind/bind.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <sstream>
 #include <thread>
 
@@ -39,6 +41,9 @@ namespace ray {
 
 namespace {
 
+/// Size of the cookie, type and length that precede every message.
+constexpr size_t kMessageHeaderSize = 3 * sizeof(int64_t);
+
 #if defined(_WIN32)
 // Don't care what exact type is in windows... Looks like to be an asio specific type.
 template <typename NativeHandleType>
@@ -121,7 +126,8 @@ std::shared_ptr<ServerConnection> ServerConnection::Create(local_stream_socket &
 
 ServerConnection::ServerConnection(local_stream_socket &&socket)
     : socket_(std::move(socket)),
-      async_write_max_messages_(1),
+      async_write_max_messages_(
+          RayConfig::instance().client_connection_async_write_max_messages()),
       async_write_queue_(),
       async_write_in_flight_(false),
       async_write_broken_pipe_(false) {
@@ -434,7 +440,17 @@ ClientConnection::ClientConnection(
       message_handler_(message_handler),
       debug_label_(debug_label),
       message_type_enum_names_(message_type_enum_names),
-      error_message_type_(error_message_type) {}
+      error_message_type_(error_message_type) {
+#ifndef _WIN32
+  // On Windows, the plasma store reads the client PID synchronously when sending
+  // it a handle, which would miss the bytes already in the receive buffer.
+  const auto read_buffer_bytes =
+      RayConfig::instance().client_connection_read_buffer_bytes();
+  if (read_buffer_bytes > 0) {
+    read_buffer_.resize(std::max<size_t>(read_buffer_bytes, kMessageHeaderSize));
+  }
+#endif
+}
 
 void ClientConnection::Register() {
   RAY_CHECK(!registered_);
@@ -442,6 +458,10 @@ void ClientConnection::Register() {
 }
 
 void ClientConnection::ProcessMessages() {
+  if (!read_buffer_.empty()) {
+    ProcessBufferedMessages();
+    return;
+  }
   // Wait for a message header from the client. The message header includes the
   // protocol version, the message type, and the length of the message.
   std::vector<boost::asio::mutable_buffer> header{
@@ -489,6 +509,10 @@ void ClientConnection::ProcessMessageHeader(const boost::system::error_code &err
   // Resize the message buffer to match the received length.
   read_message_.resize(read_length_);
   ServerConnection::bytes_read_ += read_length_;
+  ReadMessageBody(0);
+}
+
+void ClientConnection::ReadMessageBody(size_t offset) {
   // Wait for the message to be read.
   if (RayConfig::instance().event_stats()) {
     auto this_ptr = shared_ClientConnection_from_this();
@@ -498,19 +522,112 @@ void ClientConnection::ProcessMessageHeader(const boost::system::error_code &err
         io_context.stats().RecordStart("ClientConnection.async_read.ProcessMessage");
     boost::asio::async_read(
         ServerConnection::socket_,
-        boost::asio::buffer(read_message_),
+        boost::asio::buffer(read_message_.data() + offset, read_length_ - offset),
         [this, this_ptr, stats_handle = std::move(stats_handle)](
             const boost::system::error_code &ec, size_t bytes_transferred) {
           EventTracker::RecordExecution([this, this_ptr, ec]() { ProcessMessage(ec); },
                                         std::move(stats_handle));
         });
   } else {
-    boost::asio::async_read(ServerConnection::socket_,
-                            boost::asio::buffer(read_message_),
-                            boost::bind(&ClientConnection::ProcessMessage,
-                                        shared_ClientConnection_from_this(),
-                                        boost::asio::placeholders::error));
+    boost::asio::async_read(
+        ServerConnection::socket_,
+        boost::asio::buffer(read_message_.data() + offset, read_length_ - offset),
+        boost::bind(&ClientConnection::ProcessMessage,
+                    shared_ClientConnection_from_this(),
+                    boost::asio::placeholders::error));
+  }
+}
+
+void ClientConnection::ProcessBufferedMessages() {
+  const size_t num_bytes = read_buffer_end_ - read_buffer_begin_;
+  if (num_bytes >= kMessageHeaderSize) {
+    const uint8_t *header = read_buffer_.data() + read_buffer_begin_;
+    std::memcpy(&read_cookie_, header, sizeof(read_cookie_));
+    std::memcpy(&read_type_, header + sizeof(read_cookie_), sizeof(read_type_));
+    std::memcpy(&read_length_,
+                header + sizeof(read_cookie_) + sizeof(read_type_),
+                sizeof(read_length_));
+    if (!CheckRayCookie()) {
+      ServerConnection::Close();
+      return;
+    }
+
+    const uint8_t *body = header + kMessageHeaderSize;
+    const size_t num_body_bytes = num_bytes - kMessageHeaderSize;
+    if (num_body_bytes >= read_length_) {
+      read_message_.assign(body, body + read_length_);
+      read_buffer_begin_ += kMessageHeaderSize + read_length_;
+      ServerConnection::bytes_read_ += read_length_;
+      // Process the message from the event loop like a completed read, so that the
+      // message handler doesn't recurse through ProcessMessages for every buffered
+      // message.
+      auto &io_context = static_cast<instrumented_io_context &>(
+          ServerConnection::socket_.get_executor().context());
+      io_context.post(
+          [this_ptr = shared_ClientConnection_from_this()]() {
+            this_ptr->ProcessMessage(boost::system::error_code());
+          },
+          "ClientConnection.ProcessBufferedMessage");
+      return;
+    }
+
+    if (kMessageHeaderSize + read_length_ > read_buffer_.size()) {
+      // The message doesn't fit in the buffer, so read the rest of it directly.
+      read_message_.resize(read_length_);
+      std::copy(body, body + num_body_bytes, read_message_.begin());
+      read_buffer_begin_ = 0;
+      read_buffer_end_ = 0;
+      ServerConnection::bytes_read_ += read_length_;
+      ReadMessageBody(num_body_bytes);
+      return;
+    }
+  }
+
+  // Move the partial message to the front of the buffer, which then has room for
+  // the rest of it, and read more bytes.
+  if (read_buffer_begin_ > 0) {
+    std::memmove(
+        read_buffer_.data(), read_buffer_.data() + read_buffer_begin_, num_bytes);
+    read_buffer_begin_ = 0;
+    read_buffer_end_ = num_bytes;
+  }
+  auto buffer = boost::asio::buffer(read_buffer_.data() + read_buffer_end_,
+                                    read_buffer_.size() - read_buffer_end_);
+  if (RayConfig::instance().event_stats()) {
+    auto this_ptr = shared_ClientConnection_from_this();
+    auto &io_context = static_cast<instrumented_io_context &>(
+        ServerConnection::socket_.get_executor().context());
+    const auto stats_handle = io_context.stats().RecordStart(
+        "ClientConnection.async_read.ProcessBufferedMessages");
+    ServerConnection::socket_.async_read_some(
+        buffer,
+        [this, this_ptr, stats_handle = std::move(stats_handle)](
+            const boost::system::error_code &ec, size_t bytes_transferred) {
+          EventTracker::RecordExecution(
+              [this, this_ptr, ec, bytes_transferred]() {
+                ProcessBufferedRead(ec, bytes_transferred);
+              },
+              std::move(stats_handle));
+        });
+  } else {
+    ServerConnection::socket_.async_read_some(
+        buffer,
+        boost::bind(&ClientConnection::ProcessBufferedRead,
+                    shared_ClientConnection_from_this(),
+                    boost::asio::placeholders::error,
+                    boost::asio::placeholders::bytes_transferred));
+  }
+}
+
+void ClientConnection::ProcessBufferedRead(const boost::system::error_code &error,
+                                           size_t bytes_transferred) {
+  if (error) {
+    read_length_ = 0;
+    ProcessMessage(error);
+    return;
   }
+  read_buffer_end_ += bytes_transferred;
+  ProcessBufferedMessages();
 }
 
 bool ClientConnection::CheckRayCookie() {
@@ -241,9 +241,19 @@ class ClientConnection : public ServerConnection {
   /// Process an error from the last operation, then process the  message
   /// header from the client.
   void ProcessMessageHeader(const boost::system::error_code &error);
+  /// Read the body of the current message into read_message_, starting at the
+  /// given offset, then process the message from the client.
+  void ReadMessageBody(size_t offset);
   /// Process an error from reading the message header, then process the
   /// message from the client.
   void ProcessMessage(const boost::system::error_code &error);
+  /// Process the next message in the receive buffer, or read more bytes into it
+  /// if it doesn't hold a whole message.
+  void ProcessBufferedMessages();
+  /// Process an error from reading into the receive buffer, then process the
+  /// next message in it.
+  void ProcessBufferedRead(const boost::system::error_code &error,
+                           size_t bytes_transferred);
   /// Check if the ray cookie in a received message is correct. Note, if the cookie
   /// is wrong and the remote endpoint is known, raylet process will crash. If the remote
   /// endpoint is unknown, this method will only print a warning.
@@ -272,6 +282,11 @@ class ClientConnection : public ServerConnection {
   int64_t read_type_;
   uint64_t read_length_;
   std::vector<uint8_t> read_message_;
+  /// The receive buffer, empty if messages are read one by one. The bytes in
+  /// [read_buffer_begin_, read_buffer_end_) are received but not processed yet.
+  std::vector<uint8_t> read_buffer_;
+  size_t read_buffer_begin_ = 0;
+  size_t read_buffer_end_ = 0;
 };
 
 }  // namespace ray
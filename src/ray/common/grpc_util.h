@@ -62,6 +62,9 @@ class MessageWrapper {
   /// Get reference of the protobuf message.
   Message &GetMutableMessage() { return *message_; }
 
+  /// Get the shared pointer to the protobuf message, e.g., to keep its fields alive.
+  std::shared_ptr<const Message> GetMessagePtr() const { return message_; }
+
   /// Serialize the message to a string.
   const std::string Serialize() const { return message_->SerializeAsString(); }
 
@@ -49,6 +49,17 @@ RAY_CONFIG(int64_t, ray_cookie, 0x5241590000000000)
 /// warning is logged that the handler is taking too long.
 RAY_CONFIG(int64_t, handler_warning_timeout_ms, 1000)
 
+/// If positive, client connections (e.g. from workers to the raylet and from
+/// clients to the plasma store) are read through a receive buffer of this many
+/// bytes, so that a single read returns all the queued messages that fit instead
+/// of reading the header and the body of each message separately. Messages
+/// larger than the buffer are read directly. Ignored on Windows.
+RAY_CONFIG(uint64_t, client_connection_read_buffer_bytes, 0)
+
+/// The maximum number of queued async messages written to a connection in a
+/// single write.
+RAY_CONFIG(int64_t, client_connection_async_write_max_messages, 1)
+
 /// The duration between loads pulled by GCS
 RAY_CONFIG(uint64_t, gcs_pull_resource_loads_period_milliseconds, 1000)
 
@@ -150,6 +161,21 @@ RAY_CONFIG(int64_t, reconstruct_objects_period_milliseconds, 100)
 /// inlined args.
 RAY_CONFIG(int64_t, max_lineage_bytes, 1024 * 1024 * 1024)
 
+/// Whether to store the lineage of finished tasks in a compact form. The function
+/// descriptors and runtime envs are shared by all tasks that have the same ones, and
+/// the arguments are kept serialized until the task is resubmitted.
+RAY_CONFIG(bool, task_lineage_compaction_enabled, false)
+
+/// Once the compacted lineage in memory exceeds this many bytes, the arguments of the
+/// oldest tasks are spilled to a local file, and only read back when the task is
+/// resubmitted to recover its return objects. Spilled lineage doesn't count towards
+/// max_lineage_bytes. Negative disables spilling.
+RAY_CONFIG(int64_t, task_lineage_spill_threshold_bytes, -1)
+
+/// The directory of the lineage spill files. Uses the system's temporary directory if
+/// empty.
+RAY_CONFIG(std::string, task_lineage_spill_directory, "")
+
 /// Whether to re-populate plasma memory. This avoids memory allocation failures
 /// at runtime (SIGBUS errors creating new objects), however it will use more memory
 /// upfront and can slow down Ray startup.
@@ -226,6 +252,75 @@ RAY_CONFIG(bool, grpc_enable_http_proxy, false)
 /// It likely indicates a bug in the user code.
 RAY_CONFIG(uint64_t, actor_excess_queueing_warn_threshold, 5000)
 
+/// The max number of queued actor tasks that a caller packs into one PushTaskBatch
+/// stream to the actor. The tasks are replied on the stream as they finish. While
+/// batching is enabled, at most actor_task_push_batch_max_in_flight batches are on their
+/// way to an actor at a time, and the tasks queue up meanwhile. 1 disables batching, so
+/// every task is pushed with its own PushTask RPC. It must be set for the whole
+/// cluster, since the actors only serve the streams when it's above 1.
+RAY_CONFIG(int64_t, actor_task_push_batch_size, 1)
+
+/// The max number of PushTaskBatch streams from a caller to an actor whose tasks the
+/// actor hasn't queued yet. A batch stops counting once it's queued, rather than when
+/// its tasks finish, so that a task can always wait on a later task.
+RAY_CONFIG(int64_t, actor_task_push_batch_max_in_flight, 2)
+
+/// Whether to push actor tasks to actors on the same node through a shared memory
+/// channel instead of gRPC. The channel is opened on the first task pushed to the actor,
+/// and the tasks that don't fit into it are still pushed over gRPC.
+RAY_CONFIG(bool, actor_task_shared_memory_channel_enabled, false)
+
+/// The size in bytes of each direction of a shared memory channel to an actor. Tasks
+/// whose reply doesn't fit fail with an IOError.
+RAY_CONFIG(uint64_t, actor_task_shared_memory_channel_bytes, 4 * 1024 * 1024)
+
+/// The time after which a side of a shared memory channel considers the other side
+/// dead if it hasn't seen a heartbeat of it. Each side beats about every 100ms. The
+/// actor then drops the channel, and the caller fails the pending tasks.
+RAY_CONFIG(int64_t, actor_task_shared_memory_channel_peer_timeout_ms, 30000)
+
+/// The maximum number of consecutive streaming generator returns reported to the
+/// caller in one RPC. 1 reports each return as soon as it's yielded.
+RAY_CONFIG(int64_t, streaming_generator_report_batch_size, 1)
+
+/// How long a streaming generator return may wait for more returns to be batched
+/// with, before it's reported to the caller.
+RAY_CONFIG(int64_t, streaming_generator_report_batch_timeout_us, 1000)
+
+/// The byte credit of a streaming generator: the executor pauses once the returns
+/// yielded but not consumed by the caller take this many bytes, until enough of
+/// them are consumed. This applies on top of _generator_backpressure_num_objects.
+/// -1 disables it.
+RAY_CONFIG(int64_t, streaming_generator_backpressure_bytes, -1)
+
+/// Whether the core worker learns below which size the task returns and args are
+/// inlined, per function and caller, instead of always using
+/// max_direct_call_object_size. Objects near max_direct_call_object_size are inlined
+/// if their consumer is on another node or plasma is under pressure, and put into
+/// plasma otherwise.
+RAY_CONFIG(bool, adaptive_inline_threshold_enabled, false)
+
+/// The objects of a function are near max_direct_call_object_size if their average size
+/// is within max_direct_call_object_size divided and multiplied by this factor.
+RAY_CONFIG(double, adaptive_inline_threshold_band_factor, 2.0)
+
+/// Plasma is under pressure, and objects near max_direct_call_object_size are inlined,
+/// if creating return objects in plasma takes longer than this on average.
+RAY_CONFIG(int64_t, adaptive_inline_threshold_plasma_pressure_us, 10000)
+
+/// Whether the arguments inlined in a task spec are passed to the executing language
+/// frontend as slices of the received task spec, which they keep alive, instead of
+/// being copied first.
+RAY_CONFIG(bool, task_inlined_args_zero_copy, false)
+
+/// Whether threaded actors and concurrency groups run their tasks on a work-stealing
+/// executor, with a deque per thread, instead of a thread pool with a shared queue.
+RAY_CONFIG(bool, actor_executor_work_stealing_enabled, false)
+
+/// Whether the threads of the work-stealing executors are pinned to the CPUs that the
+/// worker is allowed to run on, one each in turn.
+RAY_CONFIG(bool, actor_executor_pin_threads, false)
+
 /// When trying to resolve an object, the initial period that the raylet will
 /// wait before contacting the object's owner to check if the object is still
 /// available. This is a lower bound on the time to report the loss of an
@@ -267,6 +362,13 @@ RAY_CONFIG(bool, inline_object_status_in_refs, true)
 RAY_CONFIG(int64_t, raylet_client_num_connect_attempts, 10)
 RAY_CONFIG(int64_t, raylet_client_connect_timeout_milliseconds, 1000)
 
+/// If positive, workers hold their FetchOrReconstruct and blocked/unblocked
+/// notifications to the raylet for up to this many microseconds. Within the
+/// window, fetches are merged, transitions canceled by a later unblock are
+/// dropped, and the rest are sent to the raylet as a single message. Any other
+/// message to the raylet sends the held messages first.
+RAY_CONFIG(int64_t, raylet_client_coalesce_window_us, 0)
+
 /// The duration that the raylet will wait before reinitiating a
 /// fetch request for a missing task dependency. This time may adapt based on
 /// the number of missing task dependencies.
@@ -327,6 +429,19 @@ RAY_CONFIG(int, object_manager_timer_freq_ms, 100)
 /// ObjectManager.
 RAY_CONFIG(int, object_manager_pull_timeout_ms, 10000)
 
+/// The number of queued tasks per scheduling class whose arguments the raylet
+/// prefetches. These are the first tasks of the schedule queue, and the first
+/// waiting tasks whose argument pulls are queued behind other pulls. The prefetches
+/// run at the lowest pull priority, and are canceled once a task's argument pull is
+/// active, or it's dispatched, spilled back or canceled. 0 disables argument
+/// prefetching.
+RAY_CONFIG(int64_t, task_arg_prefetch_lookahead, 0)
+
+/// The fraction of the memory available to the pull manager that argument
+/// prefetches may use. Prefetches are deactivated first whenever any other pull
+/// needs the space.
+RAY_CONFIG(float, task_arg_prefetch_max_memory_fraction, 0.2)
+
 /// Timeout, in milliseconds, to wait until the Push request fails.
 /// Special value:
 /// Negative: waiting infinitely.
@@ -393,6 +508,67 @@ RAY_CONFIG(std::string, gcs_storage, "memory")
 /// Duration to sleep after failing to put an object in plasma because it is full.
 RAY_CONFIG(uint32_t, object_store_full_delay_ms, 10)
 
+/// Whether plasma clients seal, release and look up objects through a ring of
+/// commands in shared memory, all served by one thread of the store, instead of sending
+/// messages on the socket to the store thread. Only supported on Linux.
+RAY_CONFIG(bool, plasma_command_ring_enabled, false)
+
+/// The number of commands that a plasma client can post to its ring without waiting
+/// for the store.
+RAY_CONFIG(uint32_t, plasma_command_ring_slots, 256)
+
+/// The number of threads that serve the connections of plasma clients. Each client is
+/// served by one of them, picked round-robin when it connects. The objects, the
+/// allocator and eviction are still shared by all of them behind a single lock.
+RAY_CONFIG(uint32_t, plasma_store_num_threads, 1)
+
+/// The number of object releases that a plasma client without a command ring holds
+/// back, to send them to the store in one message. Held releases are also sent before
+/// any other request to the store, and the objects stay pinned until they are sent.
+/// 0 sends every release on its own.
+RAY_CONFIG(uint32_t, plasma_client_release_batch_size, 0)
+
+/// Plasma objects up to this size are allocated from slabs of
+/// plasma_slab_size_bytes, with one slab per size class, instead of from dlmalloc.
+/// This keeps many small objects from fragmenting the shared memory arena.
+/// 0 disables the slabs, which is the default: with objects created and evicted at
+/// random, the store is about 84% full when a create fails with the slabs, against
+/// 99% with dlmalloc alone, since chunks are rounded up to their size class and
+/// partly used slabs only fit objects of their class.
+RAY_CONFIG(uint64_t, plasma_slab_max_object_size, 0)
+
+/// The size of the slabs for small plasma objects.
+RAY_CONFIG(uint64_t, plasma_slab_size_bytes, 1024 * 1024)
+
+/// Sealed plasma objects of at least this size are hashed by the client that seals
+/// them, and an object with the same content as an existing one shares its memory
+/// instead of keeping a copy. 0 disables deduplication.
+RAY_CONFIG(uint64_t, plasma_dedup_min_object_size, 0)
+
+/// When the plasma store is full, object creation requests up to this size are
+/// served from the free memory while a larger request ahead of them in the queue
+/// waits for spilling. 0 serves the requests strictly in order.
+RAY_CONFIG(uint64_t, plasma_create_small_request_max_size, 0)
+
+/// The priority of the objects created by drivers in the plasma store's queue of
+/// creation requests. Workers create with priority 0, and requests of a higher
+/// priority are served first.
+RAY_CONFIG(int32_t, plasma_driver_create_priority, 0)
+
+/// The number of object access events (create, seal, get, release, evict, delete
+/// and spill) the plasma store keeps in a ring buffer for offline analysis with
+/// plasma_trace_analyzer. 0 disables the tracing.
+RAY_CONFIG(uint64_t, plasma_access_trace_capacity, 0)
+
+/// The file the plasma store writes its access trace to, periodically and when it
+/// stops. If empty, the trace is not written.
+RAY_CONFIG(std::string, plasma_access_trace_path, "")
+
+/// The interval, in milliseconds, at which the plasma store rewrites its access
+/// trace file with the events in the ring buffer. 0 writes it only when the store
+/// stops.
+RAY_CONFIG(uint64_t, plasma_access_trace_dump_interval_ms, 60000)
+
 /// The threshold to trigger a global gc
 RAY_CONFIG(double, high_plasma_storage_usage, 0.7)
 
@@ -520,6 +696,12 @@ RAY_CONFIG(int64_t, task_events_max_num_profile_events_per_task, 1000)
 /// side. Events will be evicted based on a FIFO order.
 RAY_CONFIG(uint64_t, task_events_max_num_profile_events_buffer_on_worker, 10 * 1000)
 
+/// Capacity of the lock-free buffer each thread stages its task events in before they
+/// are drained by the flushing thread. Events overflow to a mutex-guarded path when the
+/// staging buffer is full.
+/// Setting the value to 0 disables staging, and every event takes the buffer's mutex.
+RAY_CONFIG(uint64_t, task_events_thread_local_buffer_size, 0)
+
 /// Max number of task attempts being dropped on the worker side to report to GCS.
 /// Setting the value to -1 allows unlimited dropped task attempts in a single
 /// report to GCS.
@@ -711,6 +893,33 @@ RAY_CONFIG(int, publish_batch_size, 5000)
 /// subject to this cap.
 RAY_CONFIG(int, publisher_entity_buffer_max_bytes, 1 << 30)
 
+/// If enabled, a published message is serialized once, and the serialized bytes are
+/// copied as is into the long polling reply of each subscriber, instead of copying
+/// and serializing the message again for every subscriber.
+RAY_CONFIG(bool, publisher_serialize_messages_once, false)
+
+/// Names of the pubsub channels which carry state snapshots, where only the latest
+/// message of each key matters, e.g. "GCS_NODE_INFO_CHANNEL". For these channels, a
+/// message that hasn't been acknowledged by a subscriber yet is dropped when a newer
+/// message of the same key is published, so slow subscribers don't receive a backlog
+/// of stale states.
+RAY_CONFIG(std::vector<std::string>, publisher_coalesced_channels, {})
+
+/// If enabled, subscribers receive published messages from core worker publishers
+/// through a bidirectional gRPC stream, where messages are pushed as soon as they are
+/// published. Subscribers fall back to long polling if the publisher doesn't serve
+/// streams.
+RAY_CONFIG(bool, pubsub_use_bidi_stream, false)
+
+/// The base delay before reopening a broken pubsub stream. It doubles with each
+/// failure in a row.
+RAY_CONFIG(uint64_t, pubsub_stream_retry_base_ms, 100)
+
+/// The number of times in a row a pubsub stream is reopened before the subscriber
+/// checks whether the publisher is alive with a long polling request. The stream is
+/// reopened once the request is replied.
+RAY_CONFIG(uint64_t, pubsub_stream_max_retries, 5)
+
 /// The maximum command batch size.
 RAY_CONFIG(int64_t, max_command_batch_size, 2000)
 
@@ -863,6 +1072,13 @@ RAY_CONFIG(int64_t, health_check_period_ms, 3000)
 RAY_CONFIG(int64_t, health_check_timeout_ms, 10000)
 /// The threshold to consider a node dead.
 RAY_CONFIG(int64_t, health_check_failure_threshold, 5)
+/// Whether to treat the resource reports received through the ray syncer as proof of
+/// liveness. If enabled, a node is only probed when it has been silent for
+/// `health_check_period_ms`, so that the GCS doesn't send one RPC per node per period
+/// in large clusters.
+RAY_CONFIG(bool, health_check_traffic_based_liveness, false)
+/// The granularity of the timer wheel which schedules the traffic based health checks.
+RAY_CONFIG(int64_t, health_check_timer_wheel_tick_ms, 100)
 
 /// The pool size for grpc server call.
 RAY_CONFIG(int64_t,
@@ -0,0 +1,102 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the rate at which a ClientConnection processes small messages from
+// many concurrent writers, with and without the receive buffer and batched async
+// writes, e.g.:
+//   client_connection_bench --num_connections=200 --num_messages=1000
+
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <chrono>
+#include <iostream>
+
+#include "absl/strings/str_format.h"
+#include "gflags/gflags.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/client_connection.h"
+#include "ray/common/ray_config.h"
+
+DEFINE_int32(num_connections, 100, "The number of connections to the reader.");
+DEFINE_int32(num_messages, 1000, "The number of messages written per connection.");
+DEFINE_int32(message_size, 64, "The size in bytes of the messages.");
+
+namespace ray {
+
+double MessagesPerSecond(uint64_t read_buffer_bytes, int64_t write_max_messages) {
+  RayConfig::instance().initialize(
+      absl::StrFormat(R"({"client_connection_read_buffer_bytes": %d,
+                          "client_connection_async_write_max_messages": %d})",
+                      read_buffer_bytes,
+                      write_max_messages));
+  instrumented_io_context io_service;
+  const std::vector<uint8_t> message(FLAGS_message_size, 1);
+  int64_t num_messages_read = 0;
+
+  ClientHandler client_handler = [](ClientConnection &client) {};
+  MessageHandler noop_handler = [](std::shared_ptr<ClientConnection> client,
+                                   int64_t message_type,
+                                   const std::vector<uint8_t> &message) {};
+  MessageHandler message_handler = [&num_messages_read](
+                                       std::shared_ptr<ClientConnection> client,
+                                       int64_t message_type,
+                                       const std::vector<uint8_t> &message) {
+    if (++num_messages_read % FLAGS_num_messages != 0) {
+      client->ProcessMessages();
+    }
+  };
+
+  std::vector<std::shared_ptr<ClientConnection>> connections;
+  for (int i = 0; i < FLAGS_num_connections; i++) {
+    boost::asio::local::stream_protocol::socket input(io_service), output(io_service);
+    boost::asio::local::connect_pair(input, output);
+    connections.push_back(ClientConnection::Create(
+        client_handler, noop_handler, std::move(input), "writer", {}, 0));
+    connections.push_back(ClientConnection::Create(
+        client_handler, message_handler, std::move(output), "reader", {}, 0));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < connections.size(); i += 2) {
+    for (int j = 0; j < FLAGS_num_messages; j++) {
+      connections[i]->WriteMessageAsync(
+          1, message.size(), message.data(), [](const Status &status) {
+            RAY_CHECK_OK(status);
+          });
+    }
+    connections[i + 1]->ProcessMessages();
+  }
+  io_service.run();
+  const std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start;
+  RAY_CHECK_EQ(num_messages_read,
+               static_cast<int64_t>(FLAGS_num_connections) * FLAGS_num_messages);
+  return num_messages_read / duration.count();
+}
+
+}  // namespace ray
+
+int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  for (uint64_t read_buffer_bytes : {0, 64 * 1024}) {
+    for (int64_t write_max_messages : {1, 64}) {
+      std::cout << "read buffer bytes: " << read_buffer_bytes
+                << ", write max messages: " << write_max_messages << ", messages/s: "
+                << ray::MessagesPerSecond(read_buffer_bytes, write_max_messages)
+                << std::endl;
+    }
+  }
+  gflags::ShutDownCommandLineFlags();
+  return 0;
+}
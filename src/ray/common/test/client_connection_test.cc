@@ -22,6 +22,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/ray_config.h"
 
 namespace ray {
 namespace raylet {
@@ -146,6 +147,59 @@ TEST_F(ClientConnectionTest, SimpleAsyncWrite) {
   ASSERT_EQ(num_messages, 3);
 }
 
+TEST_F(ClientConnectionTest, BufferedRead) {
+  // Smaller than the large message below, which is read directly.
+  RayConfig::instance().initialize(
+      R"({"client_connection_read_buffer_bytes": 64,
+          "client_connection_async_write_max_messages": 16})");
+  std::vector<std::vector<uint8_t>> messages;
+  for (int i = 0; i < 10; i++) {
+    messages.emplace_back(i == 5 ? 200 : i, static_cast<uint8_t>(i));
+  }
+  size_t num_messages = 0;
+
+  ClientHandler client_handler = [](ClientConnection &client) {};
+
+  MessageHandler noop_handler = [](std::shared_ptr<ClientConnection> client,
+                                   int64_t message_type,
+                                   const std::vector<uint8_t> &message) {};
+
+  MessageHandler message_handler = [&messages, &num_messages](
+                                       std::shared_ptr<ClientConnection> client,
+                                       int64_t message_type,
+                                       const std::vector<uint8_t> &message) {
+    ASSERT_EQ(message_type, static_cast<int64_t>(num_messages));
+    ASSERT_EQ(message, messages[num_messages]);
+    num_messages += 1;
+    if (num_messages < messages.size()) {
+      client->ProcessMessages();
+    }
+  };
+
+  auto writer = ClientConnection::Create(
+      client_handler, noop_handler, std::move(in_), "writer", {}, error_message_type_);
+  auto reader = ClientConnection::Create(client_handler,
+                                         message_handler,
+                                         std::move(out_),
+                                         "reader",
+                                         {},
+                                         error_message_type_);
+
+  for (size_t i = 0; i < messages.size(); i++) {
+    writer->WriteMessageAsync(i,
+                              messages[i].size(),
+                              messages[i].data(),
+                              [](const ray::Status &status) { RAY_CHECK_OK(status); });
+  }
+  reader->ProcessMessages();
+  io_service_.run();
+  ASSERT_EQ(num_messages, messages.size());
+
+  RayConfig::instance().initialize(
+      R"({"client_connection_read_buffer_bytes": 0,
+          "client_connection_async_write_max_messages": 1})");
+}
+
 TEST_F(ClientConnectionTest, SimpleSyncReadWriteMessage) {
   auto writer = ServerConnection::Create(std::move(in_));
   auto reader = ServerConnection::Create(std::move(out_));
@@ -14,6 +14,9 @@
 
 #include "ray/core_worker/common.h"
 
+#include <cstddef>
+#include <memory>
+
 namespace ray {
 namespace core {
 
@@ -79,5 +82,32 @@ void SerializeReturnObject(const ObjectID &object_id,
   }
 }
 
+std::shared_ptr<RayObject> CreateInlinedArgForExecutor(const TaskSpecification &task,
+                                                       size_t arg_index,
+                                                       bool zero_copy,
+                                                       bool copy_data) {
+  std::shared_ptr<Buffer> data = nullptr;
+  auto *arg_data = const_cast<uint8_t *>(task.ArgData(arg_index));
+  const size_t arg_data_size = task.ArgDataSize(arg_index);
+  if (arg_data_size && zero_copy &&
+      reinterpret_cast<uintptr_t>(arg_data) % alignof(std::max_align_t) == 0) {
+    // The buffer owns the data by keeping the task spec alive, so RayObject doesn't
+    // copy it. Misaligned data is still copied, since the frontend may deserialize
+    // arrays that point into it.
+    data = std::make_shared<SharedSliceBuffer>(
+        task.GetMessagePtr(), arg_data, arg_data_size);
+  } else if (arg_data_size) {
+    data = std::make_shared<LocalMemoryBuffer>(arg_data, arg_data_size);
+  }
+  std::shared_ptr<LocalMemoryBuffer> metadata = nullptr;
+  if (task.ArgMetadataSize(arg_index)) {
+    metadata = std::make_shared<LocalMemoryBuffer>(
+        const_cast<uint8_t *>(task.ArgMetadata(arg_index)),
+        task.ArgMetadataSize(arg_index));
+  }
+  return std::make_shared<RayObject>(
+      data, metadata, task.ArgInlinedRefs(arg_index), copy_data);
+}
+
 }  // namespace core
 }  // namespace ray
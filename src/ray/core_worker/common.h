@@ -42,6 +42,20 @@ void SerializeReturnObject(const ObjectID &object_id,
                            const std::shared_ptr<RayObject> &return_object,
                            rpc::ReturnObject *return_object_proto);
 
+/// Create the value of a pass-by-value arg of a task, for the executor.
+///
+/// \param[in] task The task to execute.
+/// \param[in] arg_index The index of the arg.
+/// \param[in] zero_copy Whether the data may stay in the task spec message, which the
+/// value then keeps alive. Data that isn't aligned to max_align_t is copied anyway.
+/// \param[in] copy_data Whether the value must own its data, so that it can outlive
+/// `task`.
+/// \return The value of the arg.
+std::shared_ptr<RayObject> CreateInlinedArgForExecutor(const TaskSpecification &task,
+                                                       size_t arg_index,
+                                                       bool zero_copy,
+                                                       bool copy_data);
+
 /// Information about a remote function.
 class RayFunction {
  public:
@@ -25,6 +25,7 @@
 #include "absl/cleanup/cleanup.h"
 #include "absl/strings/str_format.h"
 #include "boost/fiber/all.hpp"
+#include "ray/common/asio/asio_util.h"
 #include "ray/common/bundle_spec.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/runtime_env_common.h"
@@ -393,6 +394,20 @@ CoreWorker::CoreWorker(CoreWorkerOptions options, const WorkerID &worker_id)
                                         assigned_port,
                                         options_.node_ip_address == "127.0.0.1");
   core_worker_server_->RegisterService(grpc_service_, false /* token_auth */);
+  if (RayConfig::instance().pubsub_use_bidi_stream()) {
+    pubsub_stream_service_ = std::make_unique<pubsub::PubsubStreamService>(io_service_);
+    core_worker_server_->RegisterService(*pubsub_stream_service_);
+  }
+  if (RayConfig::instance().actor_task_push_batch_size() > 1) {
+    push_task_batch_service_ = std::make_unique<rpc::PushTaskBatchService>(
+        io_service_,
+        [this](rpc::PushTaskRequest request,
+               rpc::PushTaskReply *reply,
+               rpc::SendReplyCallback send_reply_callback) {
+          HandlePushTask(std::move(request), reply, std::move(send_reply_callback));
+        });
+    core_worker_server_->RegisterService(*push_task_batch_service_);
+  }
   core_worker_server_->Run();
 
   // Set our own address.
@@ -460,6 +475,9 @@ CoreWorker::CoreWorker(CoreWorkerOptions options, const WorkerID &worker_id)
       /*subscriber_timeout_ms=*/RayConfig::instance().subscriber_timeout_ms(),
       /*publish_batch_size_=*/RayConfig::instance().publish_batch_size(),
       GetWorkerID());
+  if (pubsub_stream_service_ != nullptr) {
+    pubsub_stream_service_->SetPublisher(object_info_publisher_.get());
+  }
   object_info_subscriber_ = std::make_unique<pubsub::Subscriber>(
       /*subscriber_id=*/GetWorkerID(),
       /*channels=*/
@@ -525,6 +543,10 @@ CoreWorker::CoreWorker(CoreWorkerOptions options, const WorkerID &worker_id)
       (options_.worker_type != WorkerType::SPILL_WORKER &&
        options_.worker_type != WorkerType::RESTORE_WORKER),
       /*get_current_call_site=*/boost::bind(&CoreWorker::CurrentCallSite, this)));
+  if (options_.worker_type == WorkerType::DRIVER) {
+    plasma_store_provider_->store_client()->SetCreatePriority(
+        RayConfig::instance().plasma_driver_create_priority());
+  }
   memory_store_ = std::make_shared<CoreWorkerMemoryStore>(
       io_service_,
       reference_counter_,
@@ -780,6 +802,14 @@ CoreWorker::CoreWorker(CoreWorkerOptions options, const WorkerID &worker_id)
 
   // Used to detect if the object is in the plasma store.
   max_direct_call_object_size_ = RayConfig::instance().max_direct_call_object_size();
+  if (RayConfig::instance().adaptive_inline_threshold_enabled()) {
+    inline_threshold_policy_ = std::make_unique<InlineThresholdPolicy>(
+        max_direct_call_object_size_,
+        RayConfig::instance().task_rpc_inlined_bytes_limit(),
+        RayConfig::instance().adaptive_inline_threshold_band_factor(),
+        absl::Microseconds(
+            RayConfig::instance().adaptive_inline_threshold_plasma_pressure_us()));
+  }
 
   /// If periodic asio stats print is enabled, it will print it.
   const auto event_stats_print_interval_ms =
@@ -2780,7 +2810,11 @@ Status CoreWorker::CancelTask(const ObjectID &object_id,
         object_id, obj_addr, force_kill, recursive);
   }
 
-  auto task_spec = task_manager_->GetTaskSpec(object_id.TaskId());
+  // Check first whether the task is pending, since the spec of a finished task may
+  // have to be read back from disk.
+  auto task_spec = task_manager_->IsTaskPending(object_id.TaskId())
+                       ? task_manager_->GetTaskSpec(object_id.TaskId())
+                       : absl::nullopt;
   if (!task_spec.has_value()) {
     // Task is already finished.
     RAY_LOG(DEBUG).WithField(object_id)
@@ -3034,6 +3068,36 @@ void CoreWorker::RunTaskExecutionLoop() {
       << "Task execution loop was terminated without calling shutdown API.";
 }
 
+std::string CoreWorker::GetInlineArgKey(const FunctionDescriptor &function) const {
+  if (inline_threshold_policy_ == nullptr) {
+    return "";
+  }
+  return InlineThresholdPolicy::Key(function->CallString(), GetWorkerID().Hex());
+}
+
+bool CoreWorker::ShouldInlineArg(const std::string &key,
+                                 int64_t arg_size,
+                                 int64_t inlined_bytes) {
+  const bool fits_in_rpc = arg_size + inlined_bytes <=
+                           RayConfig::instance().task_rpc_inlined_bytes_limit();
+  const bool static_inline_arg = arg_size <= max_direct_call_object_size_ && fits_in_rpc;
+  if (inline_threshold_policy_ == nullptr) {
+    return static_inline_arg;
+  }
+  // The worker that will run the task isn't known yet, so the arg is only inlined
+  // beyond the static threshold if plasma is under pressure.
+  const int64_t inline_threshold = inline_threshold_policy_->ObserveAndGetThreshold(
+      key, arg_size, InlineThresholdPolicy::Consumer::kUnknown);
+  // Objects smaller than the threshold are inlined, for args like for returns.
+  const bool inline_arg = arg_size < inline_threshold && fits_in_rpc;
+  ray::stats::STATS_object_inline_decisions.Record(
+      1,
+      {{"Placement", inline_arg ? "INLINE" : "PLASMA"},
+       {"Source", "TASK_ARG"},
+       {"Adapted", inline_arg != static_inline_arg ? "true" : "false"}});
+  return inline_arg;
+}
+
 Status CoreWorker::AllocateReturnObject(const ObjectID &object_id,
                                         const size_t &data_size,
                                         const std::shared_ptr<Buffer> &metadata,
@@ -3054,23 +3118,53 @@ Status CoreWorker::AllocateReturnObject(const ObjectID &object_id,
           object_id, contained_object_ids, owner_address);
     }
 
+    int64_t inline_threshold = max_direct_call_object_size_;
+    if (inline_threshold_policy_ != nullptr && !options_.is_local_mode) {
+      const auto task_spec = worker_context_.GetCurrentTask();
+      const auto consumer =
+          caller_address.raylet_id() == rpc_address_.raylet_id()
+              ? InlineThresholdPolicy::Consumer::kLocal
+              : InlineThresholdPolicy::Consumer::kRemote;
+      inline_threshold = inline_threshold_policy_->ObserveAndGetThreshold(
+          InlineThresholdPolicy::Key(
+              task_spec ? task_spec->FunctionDescriptor()->CallString() : "",
+              WorkerID::FromBinary(caller_address.worker_id()).Hex()),
+          static_cast<int64_t>(data_size),
+          consumer);
+    }
+
     // Allocate a buffer for the return object.
-    if (options_.is_local_mode ||
-        (static_cast<int64_t>(data_size) < max_direct_call_object_size_ &&
-         // ensure we don't exceed the limit if we allocate this object inline.
-         (*task_output_inlined_bytes + static_cast<int64_t>(data_size) <=
-          RayConfig::instance().task_rpc_inlined_bytes_limit()))) {
+    const bool fits_in_rpc =
+        // ensure we don't exceed the limit if we allocate this object inline.
+        *task_output_inlined_bytes + static_cast<int64_t>(data_size) <=
+        RayConfig::instance().task_rpc_inlined_bytes_limit();
+    const bool inline_object = static_cast<int64_t>(data_size) < inline_threshold &&
+                               fits_in_rpc;
+    if (options_.is_local_mode || inline_object) {
       data_buffer = std::make_shared<LocalMemoryBuffer>(data_size);
       *task_output_inlined_bytes += static_cast<int64_t>(data_size);
     } else {
+      const auto start = absl::Now();
       RAY_RETURN_NOT_OK(CreateExisting(metadata,
                                        data_size,
                                        object_id,
                                        owner_address,
                                        &data_buffer,
                                        /*created_by_worker=*/true));
+      if (inline_threshold_policy_ != nullptr) {
+        inline_threshold_policy_->RecordPlasmaCreateLatency(absl::Now() - start);
+      }
       object_already_exists = !data_buffer;
     }
+    if (inline_threshold_policy_ != nullptr && !options_.is_local_mode) {
+      const bool static_inline_object =
+          static_cast<int64_t>(data_size) < max_direct_call_object_size_ && fits_in_rpc;
+      ray::stats::STATS_object_inline_decisions.Record(
+          1,
+          {{"Placement", inline_object ? "INLINE" : "PLASMA"},
+           {"Source", "TASK_RETURN"},
+           {"Adapted", inline_object != static_inline_object ? "true" : "false"}});
+    }
   }
   // Leave the return object as a nullptr if the object already exists.
   if (!object_already_exists) {
@@ -3437,17 +3531,22 @@ Status CoreWorker::ReportGeneratorItemReturns(
     int64_t item_index,
     uint64_t attempt_number,
     std::shared_ptr<GeneratorBackpressureWaiter> waiter) {
-  rpc::ReportGeneratorItemReturnsRequest request;
+  PendingGeneratorReport report;
+  auto &request = report.request;
   request.mutable_worker_addr()->CopyFrom(rpc_address_);
   request.set_item_index(item_index);
   request.set_generator_id(generator_id.Binary());
   request.set_attempt_number(attempt_number);
-  auto client = core_worker_client_pool_->GetOrConnect(caller_address);
+  report.caller_address = caller_address;
+  report.waiter = waiter;
+  report.generated_times.push_back(absl::Now());
 
+  int64_t object_size = 0;
   if (!dynamic_return_object.first.IsNil()) {
     auto return_object_proto = request.add_dynamic_return_objects();
     SerializeReturnObject(
         dynamic_return_object.first, dynamic_return_object.second, return_object_proto);
+    object_size = static_cast<int64_t>(dynamic_return_object.second->GetSize());
     std::vector<ObjectID> deleted;
     // When we allocate a dynamic return ID (AllocateDynamicReturnId),
     // we borrow the object. When the object value is allocatd, the
@@ -3462,14 +3561,123 @@ Status CoreWorker::ReportGeneratorItemReturns(
   RAY_LOG(DEBUG) << "Write the object ref stream, index: " << item_index
                  << ", id: " << return_id;
 
-  waiter->IncrementObjectGenerated();
+  waiter->IncrementObjectGenerated(item_index, object_size);
 
+  const int64_t batch_size =
+      RayConfig::instance().streaming_generator_report_batch_size();
+  if (batch_size <= 1 || return_id.IsNil()) {
+    FlushGeneratorItemReturns(generator_id);
+    SendGeneratorItemReport(std::move(report));
+  } else {
+    // Consecutive returns are batched into one report, which is sent once it's full,
+    // once its oldest return has waited for the batch timeout, or right away if the
+    // executor is about to block on backpressure.
+    std::optional<PendingGeneratorReport> previous_batch;
+    std::optional<PendingGeneratorReport> full_batch;
+    bool start_timer = false;
+    uint64_t batch_id = 0;
+    {
+      absl::MutexLock lock(&generator_reports_mutex_);
+      auto it = pending_generator_reports_.find(generator_id);
+      if (it != pending_generator_reports_.end() &&
+          it->second.request.item_index() +
+                  it->second.request.dynamic_return_objects_size() !=
+              item_index) {
+        previous_batch = std::move(it->second);
+        pending_generator_reports_.erase(it);
+        it = pending_generator_reports_.end();
+      }
+      if (it == pending_generator_reports_.end()) {
+        batch_id = next_generator_batch_id_++;
+        report.batch_id = batch_id;
+        it = pending_generator_reports_.emplace(generator_id, std::move(report)).first;
+        start_timer = true;
+      } else {
+        auto &batch = it->second;
+        batch.request.add_dynamic_return_objects()->Swap(
+            request.mutable_dynamic_return_objects(0));
+        batch.generated_times.push_back(report.generated_times.front());
+      }
+      if (it->second.request.dynamic_return_objects_size() >= batch_size ||
+          waiter->IsBackpressured()) {
+        full_batch = std::move(it->second);
+        pending_generator_reports_.erase(it);
+        start_timer = false;
+      }
+    }
+    if (previous_batch.has_value()) {
+      SendGeneratorItemReport(std::move(*previous_batch));
+    }
+    if (full_batch.has_value()) {
+      SendGeneratorItemReport(std::move(*full_batch));
+    }
+    if (start_timer) {
+      execute_after(
+          io_service_,
+          [this, generator_id, batch_id]() {
+            FlushExpiredGeneratorItemReturns(generator_id, batch_id);
+          },
+          std::chrono::microseconds(
+              RayConfig::instance().streaming_generator_report_batch_timeout_us()));
+    }
+  }
+
+  // Backpressure if needed. See task_manager.h and search "backpressure" for protocol
+  // details.
+  return waiter->WaitUntilObjectConsumed();
+}
+
+void CoreWorker::FlushGeneratorItemReturns(const ObjectID &generator_id) {
+  std::optional<PendingGeneratorReport> batch;
+  {
+    absl::MutexLock lock(&generator_reports_mutex_);
+    auto it = pending_generator_reports_.find(generator_id);
+    if (it == pending_generator_reports_.end()) {
+      return;
+    }
+    batch = std::move(it->second);
+    pending_generator_reports_.erase(it);
+  }
+  SendGeneratorItemReport(std::move(*batch));
+}
+
+void CoreWorker::FlushExpiredGeneratorItemReturns(const ObjectID &generator_id,
+                                                  uint64_t batch_id) {
+  std::optional<PendingGeneratorReport> batch;
+  {
+    absl::MutexLock lock(&generator_reports_mutex_);
+    auto it = pending_generator_reports_.find(generator_id);
+    if (it == pending_generator_reports_.end() || it->second.batch_id != batch_id) {
+      // The batch was already sent. A later batch has its own timer.
+      return;
+    }
+    batch = std::move(it->second);
+    pending_generator_reports_.erase(it);
+  }
+  SendGeneratorItemReport(std::move(*batch));
+}
+
+void CoreWorker::SendGeneratorItemReport(PendingGeneratorReport report) {
+  auto &request = report.request;
+  // Ask the caller to hold the reply if the executor is out of byte credit.
+  request.set_consumed_index_to_resume(report.waiter->ConsumedIndexToResume());
+  const int64_t num_objects = static_cast<int64_t>(report.generated_times.size());
+  ray::stats::STATS_streaming_generator_report_batch_size.Record(num_objects);
+
+  auto client = core_worker_client_pool_->GetOrConnect(report.caller_address);
+  const auto generator_id = ObjectID::FromBinary(request.generator_id());
+  const int64_t item_index = request.item_index();
   client->ReportGeneratorItemReturns(
       request,
-      [waiter, generator_id, return_id, item_index](
-          const Status &status, const rpc::ReportGeneratorItemReturnsReply &reply) {
+      [waiter = std::move(report.waiter),
+       generated_times = std::move(report.generated_times),
+       generator_id,
+       item_index,
+       num_objects](const Status &status,
+                    const rpc::ReportGeneratorItemReturnsReply &reply) {
         RAY_LOG(DEBUG) << "ReportGeneratorItemReturns replied. " << generator_id
-                       << "index: " << item_index << ". total_consumed_reported: "
+                       << "index: " << item_index << ". num objects: " << num_objects
+                       << ". total_consumed_reported: "
                        << reply.total_num_object_consumed();
         RAY_LOG(DEBUG) << "Total object consumed: " << waiter->TotalObjectConsumed()
                        << ". Total object generated: " << waiter->TotalObjectGenerated();
@@ -3480,17 +3688,18 @@ Status CoreWorker::ReportGeneratorItemReturns(
           // If the request fails, we should just resume until task finishes without
           // backpressure.
           num_objects_consumed = waiter->TotalObjectGenerated();
-          RAY_LOG(WARNING).WithField(return_id)
-              << "Failed to report streaming generator return "
-                 "to the caller. The yield'ed ObjectRef may not be usable. "
-              << status;
+          RAY_LOG(WARNING).WithField(generator_id)
+              << "Failed to report streaming generator returns from index "
+              << item_index
+              << " to the caller. The yield'ed ObjectRef may not be usable. " << status;
+        }
+        const auto now = absl::Now();
+        for (const auto &generated_time : generated_times) {
+          ray::stats::STATS_streaming_generator_item_report_latency_ms.Record(
+              absl::ToDoubleMilliseconds(now - generated_time));
         }
-        waiter->HandleObjectReported(num_objects_consumed);
+        waiter->HandleObjectReported(num_objects_consumed, num_objects);
       });
-
-  // Backpressure if needed. See task_manager.h and search "backpressure" for protocol
-  // details.
-  return waiter->WaitUntilObjectConsumed();
 }
 
 void CoreWorker::HandleReportGeneratorItemReturns(
@@ -3572,6 +3781,10 @@ Status CoreWorker::GetAndPinArgsForExecutor(const TaskSpecification &task,
 
   absl::flat_hash_set<ObjectID> by_ref_ids;
   absl::flat_hash_map<ObjectID, std::vector<size_t>> by_ref_indices;
+  // In local mode, the task spec is the owner's one, whose args may be released once
+  // the task finishes.
+  const bool zero_copy_args =
+      RayConfig::instance().task_inlined_args_zero_copy() && !options_.is_local_mode;
 
   for (size_t i = 0; i < task.NumArgs(); ++i) {
     if (task.ArgByRef(i)) {
@@ -3604,23 +3817,11 @@ Status CoreWorker::GetAndPinArgsForExecutor(const TaskSpecification &task,
                                       task.ArgId(i)));
       }
     } else {
-      // A pass-by-value argument.
-      std::shared_ptr<LocalMemoryBuffer> data = nullptr;
-      if (task.ArgDataSize(i)) {
-        data = std::make_shared<LocalMemoryBuffer>(const_cast<uint8_t *>(task.ArgData(i)),
-                                                   task.ArgDataSize(i));
-      }
-      std::shared_ptr<LocalMemoryBuffer> metadata = nullptr;
-      if (task.ArgMetadataSize(i)) {
-        metadata = std::make_shared<LocalMemoryBuffer>(
-            const_cast<uint8_t *>(task.ArgMetadata(i)), task.ArgMetadataSize(i));
-      }
-      // NOTE: this is a workaround to avoid an extra copy for Java workers.
-      // Python workers need this copy to pass test case
-      // test_inline_arg_memory_corruption.
-      bool copy_data = options_.language == Language::PYTHON;
-      args->at(i) =
-          std::make_shared<RayObject>(data, metadata, task.ArgInlinedRefs(i), copy_data);
+      // A pass-by-value argument. Python workers deserialize values that may
+      // outlive the task, e.g., numpy arrays that an actor keeps, so their args must
+      // own their data. Java workers copy the args on their own.
+      args->at(i) = CreateInlinedArgForExecutor(
+          task, i, zero_copy_args, options_.language == Language::PYTHON);
       arg_refs->at(i).set_object_id(ObjectID::Nil().Binary());
       // The task borrows all ObjectIDs that were serialized in the inlined
       // arguments. The task will receive references to these IDs, so it is
@@ -3717,6 +3918,55 @@ void CoreWorker::HandlePushTask(rpc::PushTaskRequest request,
   }
 }
 
+void CoreWorker::RemoveClosedSharedMemoryChannels() {
+  std::vector<std::unique_ptr<rpc::SharedMemoryChannelServer>> closed;
+  {
+    absl::MutexLock lock(&shared_memory_channels_mutex_);
+    auto it = std::partition(shared_memory_channels_.begin(),
+                             shared_memory_channels_.end(),
+                             [](const auto &channel) { return !channel->IsClosed(); });
+    std::move(it, shared_memory_channels_.end(), std::back_inserter(closed));
+    shared_memory_channels_.erase(it, shared_memory_channels_.end());
+  }
+  // The channels are destroyed outside of the lock, since that joins their threads.
+}
+
+void CoreWorker::HandleOpenSharedMemoryChannel(
+    rpc::OpenSharedMemoryChannelRequest request,
+    rpc::OpenSharedMemoryChannelReply *reply,
+    rpc::SendReplyCallback send_reply_callback) {
+  if (HandleWrongRecipient(WorkerID::FromBinary(request.intended_worker_id()),
+                           send_reply_callback)) {
+    return;
+  }
+  std::unique_ptr<rpc::SharedMemoryChannelServer> channel;
+  // The tasks are handed over from the channel's thread rather than the io service.
+  // HandlePushTask only posts actor tasks to the task execution service.
+  auto status = rpc::SharedMemoryChannelServer::Open(
+      request.channel_name(),
+      [this](rpc::PushTaskRequest request,
+             rpc::PushTaskReply *reply,
+             rpc::SendReplyCallback send_reply_callback) {
+        HandlePushTask(std::move(request), reply, std::move(send_reply_callback));
+      },
+      // A channel closes itself once its caller closed it or is gone. It's destroyed
+      // from the io service, since that joins the channel's thread.
+      [this]() {
+        io_service_.post([this]() { RemoveClosedSharedMemoryChannels(); },
+                         "CoreWorker.RemoveClosedSharedMemoryChannels");
+      },
+      &channel);
+  if (status.ok()) {
+    RemoveClosedSharedMemoryChannels();
+    absl::MutexLock lock(&shared_memory_channels_mutex_);
+    shared_memory_channels_.push_back(std::move(channel));
+  } else {
+    RAY_LOG(WARNING) << "Failed to open shared memory channel " << request.channel_name()
+                     << ": " << status;
+  }
+  send_reply_callback(status, nullptr, nullptr);
+}
+
 void CoreWorker::HandleDirectActorCallArgWaitComplete(
     rpc::DirectActorCallArgWaitCompleteRequest request,
     rpc::DirectActorCallArgWaitCompleteReply *reply,
@@ -30,6 +30,7 @@
 #include "ray/core_worker/experimental_mutable_object_provider.h"
 #include "ray/core_worker/future_resolver.h"
 #include "ray/core_worker/generator_waiter.h"
+#include "ray/core_worker/inline_threshold_policy.h"
 #include "ray/core_worker/lease_policy.h"
 #include "ray/core_worker/object_recovery_manager.h"
 #include "ray/core_worker/profile_event.h"
@@ -41,10 +42,12 @@
 #include "ray/core_worker/transport/task_receiver.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/pubsub/publisher.h"
+#include "ray/pubsub/publisher_stream.h"
 #include "ray/pubsub/subscriber.h"
 #include "ray/raylet_client/raylet_client.h"
 #include "ray/rpc/node_manager/node_manager_client.h"
 #include "ray/rpc/worker/core_worker_server.h"
+#include "ray/rpc/worker/push_task_batch_stream.h"
 #include "ray/util/process.h"
 #include "src/ray/protobuf/pubsub.pb.h"
 
@@ -347,6 +350,21 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
     }
   }
 
+  /// Decrease the reference count of each of the object IDs by one, under a single
+  /// lock acquisition of the reference counter.
+  ///
+  /// \param[in] object_ids The object IDs to decrease the reference count for.
+  void RemoveLocalReferences(const std::vector<ObjectID> &object_ids) {
+    if (object_ids.empty()) {
+      return;
+    }
+    std::vector<ObjectID> deleted;
+    reference_counter_->RemoveLocalReferences(object_ids, &deleted);
+    if (!options_.is_local_mode) {
+      memory_store_->Delete(deleted);
+    }
+  }
+
   int GetMemoryStoreSize() { return memory_store_->Size(); }
 
   /// Returns a map of all ObjectIDs currently in scope with a pair of their
@@ -782,6 +800,14 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
       uint64_t attempt_number,
       std::shared_ptr<GeneratorBackpressureWaiter> waiter);
 
+  /// Send the generator returns batched by ReportGeneratorItemReturns that haven't
+  /// been reported yet. The executor should call this before
+  /// GeneratorBackpressureWaiter::WaitAllObjectsReported at the end of the task.
+  ///
+  /// \param[in] generator_id The return object ref ID from a current generator
+  /// task.
+  void FlushGeneratorItemReturns(const ObjectID &generator_id);
+
   /// Implements gRPC server handler.
   /// If an executor can generator task return before the task is finished,
   /// it invokes this endpoint via ReportGeneratorItemReturns RPC.
@@ -1021,6 +1047,20 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   }
 
  public:
+  /// The key of the arguments of a task for the adaptive inline threshold, to compute
+  /// once per task and pass to ShouldInlineArg for each of its arguments.
+  ///
+  /// \param[in] function The function of the task.
+  /// \return The key, or an empty string if the inline threshold isn't adaptive.
+  std::string GetInlineArgKey(const FunctionDescriptor &function) const;
+
+  /// Whether to inline an argument of a task, instead of putting it into plasma.
+  ///
+  /// \param[in] key The key of the task's arguments, from GetInlineArgKey.
+  /// \param[in] arg_size The size of the argument.
+  /// \param[in] inlined_bytes The size of the arguments of the task inlined so far.
+  bool ShouldInlineArg(const std::string &key, int64_t arg_size, int64_t inlined_bytes);
+
   /// Allocate the return object for an executing task. The caller should write into the
   /// data buffer of the allocated buffer, then call SealReturnObject() to seal it.
   /// To avoid deadlock, the caller should allocate and seal a single object at a time.
@@ -1150,6 +1190,11 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
                       rpc::PushTaskReply *reply,
                       rpc::SendReplyCallback send_reply_callback) override;
 
+  /// Implements gRPC server handler.
+  void HandleOpenSharedMemoryChannel(rpc::OpenSharedMemoryChannelRequest request,
+                                     rpc::OpenSharedMemoryChannelReply *reply,
+                                     rpc::SendReplyCallback send_reply_callback) override;
+
   /// Implements gRPC server handler.
   void HandleDirectActorCallArgWaitComplete(
       rpc::DirectActorCallArgWaitCompleteRequest request,
@@ -1806,6 +1851,13 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   /// Common rpc service for all worker modules.
   rpc::CoreWorkerGrpcService grpc_service_;
 
+  /// Serves the pubsub streams of object_info_publisher_, if pubsub_use_bidi_stream is
+  /// enabled.
+  std::unique_ptr<pubsub::PubsubStreamService> pubsub_stream_service_;
+
+  /// Serves the PushTaskBatch streams, if actor_task_push_batch_size is above 1.
+  std::unique_ptr<rpc::PushTaskBatchService> push_task_batch_service_;
+
   /// Used to notify the task receiver when the arguments of a queued
   /// actor task are ready.
   std::shared_ptr<DependencyWaiterImpl> task_argument_waiter_;
@@ -1850,6 +1902,9 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
 
   int64_t max_direct_call_object_size_;
 
+  /// Decides whether to inline task returns and args, if the threshold is adaptive.
+  std::unique_ptr<InlineThresholdPolicy> inline_threshold_policy_;
+
   friend class CoreWorkerTest;
 
   TaskCounter task_counter_;
@@ -1868,6 +1923,50 @@ class CoreWorker : public rpc::CoreWorkerServiceHandler {
   uint32_t pid_;
 
   absl::flat_hash_set<ObjectID> deleted_generator_ids_;
+
+  /// The generator returns batched and not reported yet.
+  struct PendingGeneratorReport {
+    rpc::ReportGeneratorItemReturnsRequest request;
+    rpc::Address caller_address;
+    std::shared_ptr<GeneratorBackpressureWaiter> waiter;
+    /// When each of the returns was generated.
+    std::vector<absl::Time> generated_times;
+    /// Identifies this batch, so that the timer started for it doesn't flush a
+    /// later batch of the same generator.
+    uint64_t batch_id = 0;
+  };
+
+  /// Send a report of generator returns to the caller.
+  void SendGeneratorItemReport(PendingGeneratorReport report);
+
+  /// Send the batched returns of a generator once the batch timeout expires. This is
+  /// a no-op if the batch the timer was started for has already been sent.
+  ///
+  /// \param[in] generator_id The return object ref ID of the generator task.
+  /// \param[in] batch_id The ID of the batch the timer was started for.
+  void FlushExpiredGeneratorItemReturns(const ObjectID &generator_id, uint64_t batch_id)
+      ABSL_LOCKS_EXCLUDED(generator_reports_mutex_);
+
+  /// Destroy the shared memory channels that closed themselves.
+  void RemoveClosedSharedMemoryChannels()
+      ABSL_LOCKS_EXCLUDED(shared_memory_channels_mutex_);
+
+  absl::Mutex generator_reports_mutex_;
+
+  /// Generator ID -> the returns batched and not reported yet.
+  absl::flat_hash_map<ObjectID, PendingGeneratorReport> pending_generator_reports_
+      ABSL_GUARDED_BY(generator_reports_mutex_);
+
+  /// The ID to assign to the next batch of generator returns.
+  uint64_t next_generator_batch_id_ ABSL_GUARDED_BY(generator_reports_mutex_) = 0;
+
+  absl::Mutex shared_memory_channels_mutex_;
+
+  /// The shared memory channels that callers on the same node push actor tasks through.
+  /// Declared last, so that the channels stop handing tasks over before the rest of
+  /// the worker is destroyed.
+  std::vector<std::unique_ptr<rpc::SharedMemoryChannelServer>> shared_memory_channels_
+      ABSL_GUARDED_BY(shared_memory_channels_mutex_);
 };
 
 // Lease request rate-limiter based on cluster node size.
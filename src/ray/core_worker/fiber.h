@@ -14,11 +14,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/fiber/all.hpp>
 #include <chrono>
 
 #include "ray/util/logging.h"
 #include "ray/util/macros.h"
+#include "ray/util/mpsc_queue.h"
 
 namespace ray {
 namespace core {
@@ -55,40 +57,11 @@ class Event {
 using FiberEvent = Event<boost::fibers::mutex, boost::fibers::condition_variable>;
 using StdEvent = Event<std::mutex, std::condition_variable>;
 
-/// Used by async actor mode. The FiberRateLimiter is a barrier that
-/// allows at most num fibers running at once. It implements the
-/// semaphore data structure.
-class FiberRateLimiter {
- public:
-  FiberRateLimiter(int num) : num_(num) {}
-
-  // Enter the semaphore. Wait for the value to be > 0 and decrement the value.
-  void Acquire() {
-    std::unique_lock<boost::fibers::mutex> lock(mutex_);
-    cond_.wait(lock, [this]() { return num_ > 0; });
-    num_ -= 1;
-  }
-
-  // Exit the semaphore. Increment the value and notify other waiter.
-  void Release() {
-    {
-      std::unique_lock<boost::fibers::mutex> lock(mutex_);
-      num_ += 1;
-    }
-    // NOTE(simon): This not does guarantee to wake up the first queued fiber.
-    // This could be a problem for certain workloads because there is no guarantee
-    // on task ordering.
-    cond_.notify_one();
-  }
-
- private:
-  boost::fibers::condition_variable cond_;
-  boost::fibers::mutex mutex_;
-  int num_ = 1;
-};
-
-using FiberChannel = boost::fibers::unbuffered_channel<std::function<void()>>;
-
+/// Runs the tasks of an async actor in fibers, on a dedicated thread.
+///
+/// Tasks wait in a lock-free ready queue until fewer than `max_concurrency` of them are
+/// running, and only then get a fiber and its stack. Enqueuing a task never waits for
+/// the fiber thread, which is only woken up if it's idle.
 class FiberState {
  public:
   static bool NeedDefaultExecutor(int32_t max_concurrency_in_default_group) {
@@ -99,29 +72,11 @@ class FiberState {
 
   FiberState(int max_concurrency)
       : allocator_(kStackSize),
-        rate_limiter_(max_concurrency),
+        max_concurrency_(max_concurrency),
         fiber_stopped_event_(std::make_shared<StdEvent>()) {
     std::shared_ptr<StdEvent> fiber_stopped_event = fiber_stopped_event_;
     auto fiber_runner_thread = std::thread([&, fiber_stopped_event]() {
-      while (!channel_.is_closed()) {
-        std::function<void()> func;
-        auto op_status = channel_.pop(func);
-        if (op_status == boost::fibers::channel_op_status::success) {
-          boost::fibers::fiber(
-              boost::fibers::launch::dispatch, std::allocator_arg, allocator_, func)
-              .detach();
-        } else if (op_status == boost::fibers::channel_op_status::closed) {
-          // The channel was closed. We will just exit the loop and finish
-          // cleanup.
-          break;
-        } else {
-          RAY_LOG(ERROR)
-              << "Async actor fiber channel returned unexpected error code, "
-              << "shutting down the worker thread. Please submit a github issue "
-              << "at https://github.com/ray-project/ray";
-          return;
-        }
-      }
+      RunFibers();
 
       // Boost fiber thread cannot be terminated and joined
       // if there are still running detached fibers.
@@ -145,31 +100,75 @@ class FiberState {
   }
 
   void EnqueueFiber(std::function<void()> &&callback) {
-    auto op_status = channel_.push([this, callback]() {
-      rate_limiter_.Acquire();
-      callback();
-      rate_limiter_.Release();
-    });
-    RAY_CHECK(op_status == boost::fibers::channel_op_status::success);
+    RAY_CHECK(!stopped_.load()) << "Tasks can't be enqueued once the fibers stopped.";
+    ready_queue_.Push(std::move(callback));
+    // See RunFibers for why this doesn't lose wakeups.
+    if (runner_idle_.load(std::memory_order_seq_cst)) {
+      std::unique_lock<boost::fibers::mutex> lock(mutex_);
+      cond_.notify_one();
+    }
   }
 
-  void Stop() { channel_.close(); }
-
-  void Join() {
-    fiber_stopped_event_->Wait();
+  void Stop() {
+    stopped_ = true;
+    std::unique_lock<boost::fibers::mutex> lock(mutex_);
+    cond_.notify_one();
   }
 
+  void Join() { fiber_stopped_event_->Wait(); }
+
  private:
+  /// Start a fiber for each ready task while there are free slots, until stopped.
+  /// Runs on the fiber runner thread, where all the fibers run too.
+  void RunFibers() {
+    std::unique_lock<boost::fibers::mutex> lock(mutex_);
+    while (!stopped_) {
+      std::function<void()> task;
+      if (num_running_ >= max_concurrency_ || !ready_queue_.TryPop(&task)) {
+        // Announce that the runner is idle before checking the queue once more, so
+        // that either EnqueueFiber sees the announcement, or the runner sees the task.
+        // EnqueueFiber takes the mutex to notify, which can't happen between the
+        // check and the wait.
+        runner_idle_.store(true, std::memory_order_seq_cst);
+        if (num_running_ >= max_concurrency_ || ready_queue_.Empty()) {
+          cond_.wait(lock);
+        }
+        runner_idle_.store(false, std::memory_order_relaxed);
+        continue;
+      }
+      num_running_++;
+      lock.unlock();
+      boost::fibers::fiber(boost::fibers::launch::dispatch,
+                           std::allocator_arg,
+                           allocator_,
+                           [this, task = std::move(task)]() {
+                             task();
+                             std::unique_lock<boost::fibers::mutex> lock(mutex_);
+                             num_running_--;
+                             cond_.notify_one();
+                           })
+          .detach();
+      lock.lock();
+    }
+  }
+
   static constexpr size_t kStackSize = 1024 * 256;
 
   // The fiber stack allocator.
   boost::fibers::fixedsize_stack allocator_;
-  /// The fiber channel used to send task between the submitter thread
-  /// (main direct_actor_trasnport thread) and the fiber_runner_thread
-  FiberChannel channel_;
-  /// The fiber semaphore used to limit the number of concurrent fibers
-  /// running at once.
-  FiberRateLimiter rate_limiter_;
+  /// The tasks waiting for a fiber, pushed by the submitter thread (main
+  /// direct_actor_trasnport thread) and popped by the fiber_runner_thread.
+  utils::container::MpscQueue<std::function<void()>> ready_queue_;
+  /// The maximum number of fibers running at once.
+  const int max_concurrency_;
+  /// Protects `num_running_`, and wakes up the fiber runner when a task is ready, a
+  /// fiber finishes, or the fibers are stopped.
+  boost::fibers::mutex mutex_;
+  boost::fibers::condition_variable cond_;
+  int num_running_ = 0;
+  /// Whether the fiber runner is about to wait or waiting on `cond_`.
+  std::atomic<bool> runner_idle_{false};
+  std::atomic<bool> stopped_{false};
   /// The fiber event used to notify that the event loop in fiber_runner_thread
   /// have stopped running.
   /// Since we don't join the fiber threads, it's possible that the
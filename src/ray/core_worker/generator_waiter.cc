@@ -18,8 +18,11 @@ namespace ray {
 namespace core {
 
 GeneratorBackpressureWaiter::GeneratorBackpressureWaiter(
-    int64_t generator_backpressure_num_objects, std::function<Status()> check_signals)
+    int64_t generator_backpressure_num_objects,
+    std::function<Status()> check_signals,
+    int64_t generator_backpressure_num_bytes)
     : backpressure_threshold_(generator_backpressure_num_objects),
+      backpressure_num_bytes_(generator_backpressure_num_bytes),
       check_signals_(check_signals) {
   // 0 makes no sense, and it is not supported.
   RAY_CHECK_NE(generator_backpressure_num_objects, 0);
@@ -27,23 +30,23 @@ GeneratorBackpressureWaiter::GeneratorBackpressureWaiter(
 }
 
 Status GeneratorBackpressureWaiter::WaitUntilObjectConsumed() {
-  if (backpressure_threshold_ < 0) {
+  if (backpressure_threshold_ < 0 && backpressure_num_bytes_ <= 0) {
     RAY_CHECK_EQ(backpressure_threshold_, -1);
-    // Backpressure disabled if backpressure_threshold_ == -1.
+    // Backpressure disabled if backpressure_threshold_ == -1 and there's no
+    // byte credit.
     return Status::OK();
   }
 
   absl::MutexLock lock(&mutex_);
 
   auto return_status = Status::OK();
-  auto total_object_unconsumed = total_objects_generated_ - total_objects_consumed_;
-  if (total_object_unconsumed >= backpressure_threshold_) {
+  if (IsBackpressuredLocked()) {
     RAY_LOG(DEBUG) << "Generator backpressured, consumed: " << total_objects_consumed_
                    << ". generated: " << total_objects_generated_
-                   << ". threshold: " << backpressure_threshold_;
-    while (total_object_unconsumed >= backpressure_threshold_) {
+                   << ". threshold: " << backpressure_threshold_
+                   << ". unconsumed bytes: " << unconsumed_bytes_;
+    while (IsBackpressuredLocked()) {
       backpressure_cond_var_.WaitWithTimeout(&mutex_, absl::Seconds(1));
-      total_object_unconsumed = total_objects_generated_ - total_objects_consumed_;
       return_status = check_signals_();
       if (!return_status.ok()) {
         break;
@@ -72,9 +75,23 @@ void GeneratorBackpressureWaiter::IncrementObjectGenerated() {
   num_object_reports_in_flight_++;
 }
 
-void GeneratorBackpressureWaiter::HandleObjectReported(int64_t total_objects_consumed) {
+void GeneratorBackpressureWaiter::IncrementObjectGenerated(int64_t item_index,
+                                                           int64_t object_size) {
   absl::MutexLock lock(&mutex_);
-  num_object_reports_in_flight_--;
+  total_objects_generated_ += 1;
+  num_object_reports_in_flight_++;
+  if (backpressure_num_bytes_ > 0 && item_index >= total_objects_consumed_) {
+    auto inserted = unconsumed_object_sizes_.emplace(item_index, object_size);
+    if (inserted.second) {
+      unconsumed_bytes_ += object_size;
+    }
+  }
+}
+
+void GeneratorBackpressureWaiter::HandleObjectReported(int64_t total_objects_consumed,
+                                                       int64_t num_objects) {
+  absl::MutexLock lock(&mutex_);
+  num_object_reports_in_flight_ -= num_objects;
   if (num_object_reports_in_flight_ < 0) {
     RAY_LOG(INFO)
         << "Streaming generator executor received more object report acks than sent. If "
@@ -86,12 +103,47 @@ void GeneratorBackpressureWaiter::HandleObjectReported(int64_t total_objects_con
   }
 
   total_objects_consumed_ = std::max(total_objects_consumed, total_objects_consumed_);
-  auto total_object_unconsumed = total_objects_generated_ - total_objects_consumed_;
-  if (total_object_unconsumed < backpressure_threshold_) {
+  while (!unconsumed_object_sizes_.empty() &&
+         unconsumed_object_sizes_.begin()->first < total_objects_consumed_) {
+    unconsumed_bytes_ -= unconsumed_object_sizes_.begin()->second;
+    unconsumed_object_sizes_.erase(unconsumed_object_sizes_.begin());
+  }
+  if (!IsBackpressuredLocked()) {
     backpressure_cond_var_.SignalAll();
   }
 }
 
+bool GeneratorBackpressureWaiter::IsBackpressured() const {
+  absl::MutexLock lock(&mutex_);
+  return IsBackpressuredLocked();
+}
+
+bool GeneratorBackpressureWaiter::IsBackpressuredLocked() const {
+  if (backpressure_threshold_ > 0 &&
+      total_objects_generated_ - total_objects_consumed_ >= backpressure_threshold_) {
+    return true;
+  }
+  return backpressure_num_bytes_ > 0 && !unconsumed_object_sizes_.empty() &&
+         unconsumed_bytes_ >= backpressure_num_bytes_;
+}
+
+int64_t GeneratorBackpressureWaiter::ConsumedIndexToResume() const {
+  absl::MutexLock lock(&mutex_);
+  if (backpressure_num_bytes_ <= 0 || unconsumed_bytes_ < backpressure_num_bytes_) {
+    return 0;
+  }
+  // Find the lowest index such that the objects after it fit in the credit.
+  int64_t bytes = 0;
+  for (auto it = unconsumed_object_sizes_.rbegin(); it != unconsumed_object_sizes_.rend();
+       it++) {
+    bytes += it->second;
+    if (bytes >= backpressure_num_bytes_) {
+      return it->first + 1;
+    }
+  }
+  return 0;
+}
+
 int64_t GeneratorBackpressureWaiter::TotalObjectConsumed() const {
   absl::MutexLock lock(&mutex_);
   return total_objects_consumed_;
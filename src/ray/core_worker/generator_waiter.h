@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <map>
+
 #include "absl/synchronization/mutex.h"
 #include "ray/core_worker/common.h"
 
@@ -34,8 +36,13 @@ class GeneratorBackpressureWaiter {
   /// \param[in] check_signals A callback to check Python signals while we are
   /// blocked in C++ code. If check_signals returns non-ok status, it finishes
   /// blocking and returns the non-ok status to the caller.
+  /// \param[in] generator_backpressure_num_bytes The credit, in bytes, of the
+  /// objects generated but not consumed yet. Generation pauses once the
+  /// unconsumed objects reach it, until enough of them are consumed. Set to -1
+  /// to disable.
   GeneratorBackpressureWaiter(int64_t generator_backpressure_num_objects,
-                              std::function<Status()> check_signals);
+                              std::function<Status()> check_signals,
+                              int64_t generator_backpressure_num_bytes = -1);
 
   /// Block and wait until enough objects are consumed from the consumer, so
   /// that we are under the backpressure threshold. Returns OK status if
@@ -65,6 +72,10 @@ class GeneratorBackpressureWaiter {
   /// before sending an object report to the caller.
   void IncrementObjectGenerated();
 
+  /// Same as above, and record the size of the object of the given index against
+  /// the byte credit.
+  void IncrementObjectGenerated(int64_t item_index, int64_t object_size);
+
   /// Handle a completed object report. The executor should call this after
   /// receiving an ack from the caller for an object report.
   ///
@@ -77,7 +88,15 @@ class GeneratorBackpressureWaiter {
   /// value. Unblocks execution if the updated number of objects consumed puts
   /// us under the backpressure threshold. Setting this to the total objects
   /// generated will always unblock execution.
-  void HandleObjectReported(int64_t total_objects_consumed);
+  /// \param[in] num_objects The number of objects of the acked report.
+  void HandleObjectReported(int64_t total_objects_consumed, int64_t num_objects = 1);
+
+  /// Whether the executor would block in WaitUntilObjectConsumed right now.
+  bool IsBackpressured() const;
+
+  /// The index before which the objects must be consumed for the unconsumed
+  /// objects to fit in the byte credit again. 0 if they already fit.
+  int64_t ConsumedIndexToResume() const;
 
   /// Get the total number of objects consumed by the caller so far.
   int64_t TotalObjectConsumed() const;
@@ -86,6 +105,8 @@ class GeneratorBackpressureWaiter {
   int64_t TotalObjectGenerated() const;
 
  private:
+  bool IsBackpressuredLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   mutable absl::Mutex mutex_;
   // Used to signal when backpressure is released and
   // execution may continue. Only used if
@@ -100,6 +121,8 @@ class GeneratorBackpressureWaiter {
   // If total_objects_generated_ - total_objects_consumed_ < this
   // the task will stop.
   const int64_t backpressure_threshold_;
+  // If the unconsumed objects take this many bytes or more, the task will stop.
+  const int64_t backpressure_num_bytes_;
   const std::function<Status()> check_signals_;
   // Total number of objects generated from a generator.
   int64_t total_objects_generated_ = 0;
@@ -107,6 +130,11 @@ class GeneratorBackpressureWaiter {
   int64_t num_object_reports_in_flight_ = 0;
   // Total number of objects consumed from a generator.
   int64_t total_objects_consumed_ = 0;
+  // Index -> size of the objects generated but not consumed yet, if the byte
+  // credit is enabled.
+  std::map<int64_t, int64_t> unconsumed_object_sizes_;
+  // Total size of unconsumed_object_sizes_.
+  int64_t unconsumed_bytes_ = 0;
 };
 
 }  // namespace core
@@ -0,0 +1,86 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/inline_threshold_policy.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+InlineThresholdPolicy::InlineThresholdPolicy(int64_t static_threshold,
+                                             int64_t max_threshold,
+                                             double band_factor,
+                                             absl::Duration pressure_latency,
+                                             size_t max_keys)
+    : static_threshold_(static_threshold),
+      max_threshold_(max_threshold),
+      band_lower_(static_cast<int64_t>(static_threshold / band_factor)),
+      band_upper_(std::min(static_cast<int64_t>(static_threshold * band_factor),
+                           max_threshold)),
+      pressure_latency_(pressure_latency),
+      average_sizes_(max_keys) {
+  RAY_CHECK(band_factor >= 1);
+}
+
+int64_t InlineThresholdPolicy::ObserveAndGetThreshold(const std::string &key,
+                                                      int64_t object_size,
+                                                      Consumer consumer) {
+  absl::MutexLock lock(&mutex_);
+  auto average = average_sizes_.Get(key);
+  if (average == nullptr) {
+    average = std::make_shared<double>(object_size);
+    average_sizes_.Put(key, average);
+  } else {
+    *average = kAlpha * object_size + (1 - kAlpha) * *average;
+  }
+
+  const double average_size = *average;
+  if (average_size < band_lower_ || average_size > band_upper_) {
+    return std::min(static_threshold_, max_threshold_);
+  }
+  const bool pressure =
+      average_create_latency_us_ > absl::ToDoubleMicroseconds(pressure_latency_);
+  if (consumer == Consumer::kRemote || pressure) {
+    // Objects at the upper edge are inlined too.
+    return std::min(band_upper_ + 1, max_threshold_);
+  }
+  if (consumer == Consumer::kLocal) {
+    return band_lower_;
+  }
+  return std::min(static_threshold_, max_threshold_);
+}
+
+void InlineThresholdPolicy::RecordPlasmaCreateLatency(absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  average_create_latency_us_ = kAlpha * absl::ToDoubleMicroseconds(latency) +
+                               (1 - kAlpha) * average_create_latency_us_;
+}
+
+bool InlineThresholdPolicy::PlasmaUnderPressure() const {
+  absl::MutexLock lock(&mutex_);
+  return average_create_latency_us_ > absl::ToDoubleMicroseconds(pressure_latency_);
+}
+
+std::string InlineThresholdPolicy::Key(const std::string &function,
+                                       const std::string &caller) {
+  return absl::StrCat(function, "|", caller);
+}
+
+}  // namespace core
+}  // namespace ray
@@ -0,0 +1,98 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ray/util/shared_lru.h"
+
+namespace ray {
+namespace core {
+
+/// Learns below which size the objects of a function, returned to or passed by a
+/// given caller, are inlined in task RPCs rather than put into plasma.
+///
+/// The static threshold is a good fit for objects much smaller or much larger than it.
+/// For the objects near it, neither choice is free: plasma costs a create, a seal and
+/// a pin RPC, plus a pull if the consumer is on another node, and inlining bloats the
+/// RPCs. So once the average size of the objects of a key falls within a band around
+/// the static threshold, the threshold of the key moves to one edge of the band:
+///
+/// - To the upper edge, inlining them, if the consumer is on another node or plasma is
+///   under pressure, i.e., creating objects takes long.
+/// - To the lower edge, putting them into plasma, if the consumer is on this node and
+///   can read them from shared memory.
+///
+/// All the objects of a key are then treated alike, instead of being split by small
+/// variations of their size. This class is thread-safe.
+class InlineThresholdPolicy {
+ public:
+  /// Where the object is consumed, relative to this node.
+  enum class Consumer { kLocal, kRemote, kUnknown };
+
+  /// \param static_threshold The threshold used for keys whose objects aren't near it.
+  /// \param max_threshold The maximum threshold, e.g., the limit of inlined bytes of
+  /// a task RPC.
+  /// \param band_factor The band spans from the static threshold divided by this
+  /// factor, to the static threshold multiplied by it.
+  /// \param pressure_latency Plasma is under pressure when creating objects takes
+  /// longer than this on average.
+  /// \param max_keys The maximum number of keys tracked. Beyond that, the least
+  /// recently seen key is forgotten.
+  InlineThresholdPolicy(int64_t static_threshold,
+                        int64_t max_threshold,
+                        double band_factor,
+                        absl::Duration pressure_latency,
+                        size_t max_keys = 10000);
+
+  /// Record an object of the key, and get the threshold to decide whether to inline
+  /// it: objects smaller than the threshold are inlined.
+  int64_t ObserveAndGetThreshold(const std::string &key,
+                                 int64_t object_size,
+                                 Consumer consumer);
+
+  /// Record how long it took to create an object in plasma.
+  void RecordPlasmaCreateLatency(absl::Duration latency);
+
+  bool PlasmaUnderPressure() const;
+
+  int64_t StaticThreshold() const { return static_threshold_; }
+
+  /// The key of the objects of a function and a caller.
+  static std::string Key(const std::string &function, const std::string &caller);
+
+ private:
+  /// The weight of a new observation in the moving averages.
+  static constexpr double kAlpha = 0.2;
+
+  const int64_t static_threshold_;
+  const int64_t max_threshold_;
+  const int64_t band_lower_;
+  const int64_t band_upper_;
+  const absl::Duration pressure_latency_;
+
+  mutable absl::Mutex mutex_;
+  /// The moving average of the object sizes of each key.
+  utils::container::SharedLruCache<std::string, double> average_sizes_
+      ABSL_GUARDED_BY(mutex_);
+  /// The moving average of the plasma create latency, in microseconds.
+  double average_create_latency_us_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace core
+}  // namespace ray
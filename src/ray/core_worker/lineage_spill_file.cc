@@ -0,0 +1,107 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/lineage_spill_file.h"
+
+#include <cstdio>
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+LineageSpillFile::~LineageSpillFile() {
+  absl::MutexLock lock(&mu_);
+  if (file_.is_open()) {
+    file_.close();
+    std::remove(path_.c_str());
+  }
+}
+
+Status LineageSpillFile::Open() {
+  file_.close();
+  file_.clear();
+  file_.open(path_, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!file_.is_open()) {
+    return Status::IOError("Failed to open the lineage spill file " + path_);
+  }
+  file_bytes_ = 0;
+  generation_++;
+  return Status::OK();
+}
+
+Status LineageSpillFile::Append(const std::string &data, Record *record) {
+  absl::MutexLock lock(&mu_);
+  if (!file_.is_open()) {
+    RAY_RETURN_NOT_OK(Open());
+  }
+  file_.seekp(file_bytes_);
+  file_.write(data.data(), data.size());
+  file_.flush();
+  if (!file_) {
+    file_.clear();
+    return Status::IOError("Failed to write to the lineage spill file " + path_);
+  }
+  record->offset = file_bytes_;
+  record->size = data.size();
+  record->generation = generation_;
+  file_bytes_ += record->size;
+  live_bytes_ += record->size;
+  return Status::OK();
+}
+
+Status LineageSpillFile::Read(const Record &record, std::string *data) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (record.generation != generation_) {
+      return Status::NotFound("The lineage spill record was released.");
+    }
+    RAY_CHECK(file_.is_open());
+    RAY_CHECK_LE(record.offset + record.size, file_bytes_);
+    // Records are never rewritten, and the file isn't truncated until the read is
+    // done, so the record can be read without the lock.
+    num_reads_++;
+  }
+  data->resize(record.size);
+  std::ifstream file(path_, std::ios::in | std::ios::binary);
+  file.seekg(record.offset);
+  file.read(data->data(), record.size);
+  const bool ok = static_cast<bool>(file);
+  {
+    absl::MutexLock lock(&mu_);
+    num_reads_--;
+    TruncateIfUnused();
+  }
+  if (!ok) {
+    return Status::IOError("Failed to read from the lineage spill file " + path_);
+  }
+  return Status::OK();
+}
+
+void LineageSpillFile::Release(const Record &record) {
+  absl::MutexLock lock(&mu_);
+  live_bytes_ -= record.size;
+  RAY_CHECK_GE(live_bytes_, 0);
+  TruncateIfUnused();
+}
+
+void LineageSpillFile::TruncateIfUnused() {
+  if (live_bytes_ == 0 && file_bytes_ > 0 && num_reads_ == 0) {
+    // Reclaim the space of all the released records.
+    RAY_UNUSED(Open());
+  }
+}
+
+}  // namespace core
+}  // namespace ray
@@ -0,0 +1,107 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/status.h"
+
+namespace ray {
+namespace core {
+
+/// A local file that holds the lineage spilled from the memory of the task manager.
+///
+/// Records are appended and never rewritten. The space of the released records is
+/// only reclaimed once all of them are released, by truncating the file. Lineage is
+/// mostly released in the order it was spilled, so this keeps the file small without
+/// having to compact it. The file is created on the first append, and removed when
+/// this object is destroyed.
+///
+/// This class is thread-safe. Reads don't block the other calls, so that the caller
+/// doesn't have to hold its own lock during the disk read.
+class LineageSpillFile {
+ public:
+  /// Where a record is in the file.
+  struct Record {
+    int64_t offset = 0;
+    int64_t size = 0;
+    /// How many times the file was truncated before the record was appended.
+    int64_t generation = 0;
+  };
+
+  explicit LineageSpillFile(std::string path) : path_(std::move(path)) {}
+
+  ~LineageSpillFile();
+
+  LineageSpillFile(const LineageSpillFile &) = delete;
+  LineageSpillFile &operator=(const LineageSpillFile &) = delete;
+
+  /// Append `data` to the file.
+  ///
+  /// \param[in] data The data to spill.
+  /// \param[out] record Where the data was written.
+  /// \return Error if the data couldn't be written.
+  Status Append(const std::string &data, Record *record);
+
+  /// Read a record back. The record stays in the file until it's released.
+  ///
+  /// \param[in] record A record that was appended. If it was released concurrently,
+  /// it's still read unless the file was truncated since.
+  /// \param[out] data The data of the record.
+  /// \return Error if the record couldn't be read, or its space was reclaimed.
+  Status Read(const Record &record, std::string *data);
+
+  /// Release a record that is no longer needed.
+  void Release(const Record &record);
+
+  /// Total size of the records that are not released.
+  int64_t LiveBytes() const {
+    absl::MutexLock lock(&mu_);
+    return live_bytes_;
+  }
+
+  /// Size of the file, including the released records.
+  int64_t FileBytes() const {
+    absl::MutexLock lock(&mu_);
+    return file_bytes_;
+  }
+
+  const std::string &Path() const { return path_; }
+
+ private:
+  /// Open the file, truncating it.
+  Status Open() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Truncate the file once all the records are released, unless a read is in
+  /// progress.
+  void TruncateIfUnused() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string path_;
+  mutable absl::Mutex mu_;
+  std::fstream file_ ABSL_GUARDED_BY(mu_);
+  int64_t file_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t live_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  /// The number of times the file was truncated.
+  int64_t generation_ ABSL_GUARDED_BY(mu_) = 0;
+  /// The reads in progress. They use their own stream and don't hold the lock.
+  int64_t num_reads_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace core
+}  // namespace ray
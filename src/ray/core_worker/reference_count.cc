@@ -94,7 +94,7 @@ bool ReferenceCounter::AddBorrowedObjectInternal(const ObjectID &object_id,
   }
 
   RAY_LOG(DEBUG) << "Adding borrowed object " << object_id;
-  it->second.owner_address = owner_address;
+  it->second.owner_address = InternAddress(owner_address);
   it->second.foreign_owner_already_monitoring |= foreign_owner_already_monitoring;
 
   if (!outer_id.IsNil()) {
@@ -135,7 +135,7 @@ void ReferenceCounter::AddObjectRefStats(
 
     auto ref_proto = stats->add_object_refs();
     ref_proto->set_object_id(ref.first.Binary());
-    ref_proto->set_call_site(ref.second.call_site);
+    ref_proto->set_call_site(ref.second.CallSite());
     ref_proto->set_object_size(ref.second.object_size);
     ref_proto->set_local_ref_count(ref.second.local_ref_count);
     ref_proto->set_submitted_task_ref_count(ref.second.submitted_task_ref_count);
@@ -146,7 +146,7 @@ void ReferenceCounter::AddObjectRefStats(
       if (ref.second.object_size <= 0) {
         ref_proto->set_object_size(it->second.first);
       }
-      if (ref.second.call_site.empty()) {
+      if (ref.second.CallSite().empty()) {
         ref_proto->set_call_site(it->second.second);
       }
     }
@@ -216,12 +216,12 @@ void ReferenceCounter::AddDynamicReturn(const ObjectID &object_id,
   RAY_LOG(DEBUG) << "Adding dynamic return " << object_id
                  << " contained in generator object " << generator_id;
   RAY_CHECK(outer_it->second.owned_by_us);
-  RAY_CHECK(outer_it->second.owner_address.has_value());
-  rpc::Address owner_address(outer_it->second.owner_address.value());
+  RAY_CHECK(outer_it->second.owner_address != nullptr);
+  rpc::Address owner_address(*outer_it->second.owner_address);
   RAY_UNUSED(AddOwnedObjectInternal(object_id,
                                     {},
                                     owner_address,
-                                    outer_it->second.call_site,
+                                    outer_it->second.CallSite(),
                                     /*object_size=*/-1,
                                     outer_it->second.is_reconstructable,
                                     /*add_local_ref=*/false,
@@ -249,14 +249,14 @@ void ReferenceCounter::OwnDynamicStreamingTaskReturnRef(const ObjectID &object_i
   RAY_LOG(DEBUG) << "Adding dynamic return " << object_id
                  << " contained in generator object " << generator_id;
   RAY_CHECK(outer_it->second.owned_by_us);
-  RAY_CHECK(outer_it->second.owner_address.has_value());
-  rpc::Address owner_address(outer_it->second.owner_address.value());
+  RAY_CHECK(outer_it->second.owner_address != nullptr);
+  rpc::Address owner_address(*outer_it->second.owner_address);
   // We add a local reference here. The ref removal will be handled
   // by the ObjectRefStream.
   RAY_UNUSED(AddOwnedObjectInternal(object_id,
                                     {},
                                     owner_address,
-                                    outer_it->second.call_site,
+                                    outer_it->second.CallSite(),
                                     /*object_size=*/-1,
                                     outer_it->second.is_reconstructable,
                                     /*add_local_ref=*/true,
@@ -417,6 +417,16 @@ void ReferenceCounter::RemoveLocalReference(const ObjectID &object_id,
   RemoveLocalReferenceInternal(object_id, deleted);
 }
 
+void ReferenceCounter::RemoveLocalReferences(const std::vector<ObjectID> &object_ids,
+                                             std::vector<ObjectID> *deleted) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto &object_id : object_ids) {
+    if (!object_id.IsNil()) {
+      RemoveLocalReferenceInternal(object_id, deleted);
+    }
+  }
+}
+
 void ReferenceCounter::RemoveLocalReferenceInternal(const ObjectID &object_id,
                                                     std::vector<ObjectID> *deleted) {
   RAY_CHECK(!object_id.IsNil());
@@ -451,7 +461,41 @@ void ReferenceCounter::UpdateSubmittedTaskReferences(
   for (const auto &return_id : return_ids) {
     UpdateObjectPendingCreationInternal(return_id, true);
   }
-  for (const ObjectID &argument_id : argument_ids_to_add) {
+  AddSubmittedTaskReferencesInternal(argument_ids_to_add);
+  // Release the submitted task ref and the lineage ref for any argument IDs
+  // whose values were inlined.
+  RemoveSubmittedTaskReferences(
+      argument_ids_to_remove, /*release_lineage=*/true, deleted);
+}
+
+void ReferenceCounter::AddSubmittedTaskReferences(
+    const std::vector<ObjectID> &owned_return_ids,
+    const rpc::Address &owner_address,
+    const std::string &call_site,
+    bool is_reconstructable,
+    const std::vector<ObjectID> &return_ids,
+    const std::vector<ObjectID> &argument_ids) {
+  absl::MutexLock lock(&mutex_);
+  for (const auto &return_id : owned_return_ids) {
+    RAY_CHECK(AddOwnedObjectInternal(return_id,
+                                     /*inner_ids=*/{},
+                                     owner_address,
+                                     call_site,
+                                     /*object_size=*/-1,
+                                     is_reconstructable,
+                                     /*add_local_ref=*/true,
+                                     absl::optional<NodeID>()))
+        << "Tried to create an owned object that already exists: " << return_id;
+  }
+  for (const auto &return_id : return_ids) {
+    UpdateObjectPendingCreationInternal(return_id, true);
+  }
+  AddSubmittedTaskReferencesInternal(argument_ids);
+}
+
+void ReferenceCounter::AddSubmittedTaskReferencesInternal(
+    const std::vector<ObjectID> &argument_ids) {
+  for (const ObjectID &argument_id : argument_ids) {
     RAY_LOG(DEBUG) << "Increment ref count for submitted task argument " << argument_id;
     auto it = object_id_refs_.find(argument_id);
     if (it == object_id_refs_.end()) {
@@ -468,10 +512,6 @@ void ReferenceCounter::UpdateSubmittedTaskReferences(
       SetNestedRefInUseRecursive(it);
     }
   }
-  // Release the submitted task ref and the lineage ref for any argument IDs
-  // whose values were inlined.
-  RemoveSubmittedTaskReferences(
-      argument_ids_to_remove, /*release_lineage=*/true, deleted);
 }
 
 void ReferenceCounter::UpdateResubmittedTaskReferences(
@@ -546,7 +586,7 @@ int64_t ReferenceCounter::ReleaseLineageReferences(ReferenceTable::iterator ref)
       OnObjectOutOfScopeOrFreed(arg_it);
     }
     if (arg_it->second.ShouldDelete(lineage_pinning_enabled_)) {
-      RAY_CHECK(arg_it->second.on_ref_removed == nullptr);
+      RAY_CHECK(arg_it->second.callbacks().on_ref_removed == nullptr);
       lineage_bytes_evicted += ReleaseLineageReferences(arg_it);
       EraseReference(arg_it);
     }
@@ -671,10 +711,11 @@ void ReferenceCounter::DeleteReferenceInternal(ReferenceTable::iterator it,
                                                std::vector<ObjectID> *deleted) {
   const ObjectID id = it->first;
   RAY_LOG(DEBUG) << "Attempting to delete object " << id;
-  if (it->second.RefCount() == 0 && it->second.on_ref_removed) {
+  if (it->second.RefCount() == 0 && it->second.callbacks().on_ref_removed) {
     RAY_LOG(DEBUG) << "Calling on_ref_removed for object " << id;
-    it->second.on_ref_removed(id);
-    it->second.on_ref_removed = nullptr;
+    auto *callbacks = it->second.mutable_callbacks();
+    callbacks->on_ref_removed(id);
+    callbacks->on_ref_removed = nullptr;
   }
 
   PRINT_REF_COUNT(it);
@@ -740,8 +781,8 @@ void ReferenceCounter::EraseReference(ReferenceTable::iterator it) {
       num_objects_owned_by_us_--;
     }
   }
-  if (it->second.on_object_ref_delete) {
-    it->second.on_object_ref_delete(it->first);
+  if (it->second.callbacks().on_object_ref_delete) {
+    it->second.callbacks().on_object_ref_delete(it->first);
   }
   object_id_refs_.erase(it);
   ShutdownIfNeeded();
@@ -766,11 +807,17 @@ int64_t ReferenceCounter::EvictLineage(int64_t min_bytes_to_evict) {
 void ReferenceCounter::OnObjectOutOfScopeOrFreed(ReferenceTable::iterator it) {
   RAY_LOG(DEBUG) << "Calling on_object_out_of_scope_or_freed_callbacks for object "
                  << it->first << " num callbacks: "
-                 << it->second.on_object_out_of_scope_or_freed_callbacks.size();
-  for (const auto &callback : it->second.on_object_out_of_scope_or_freed_callbacks) {
-    callback(it->first);
+                 << it->second.callbacks()
+                        .on_object_out_of_scope_or_freed_callbacks.size();
+  // Don't allocate the callbacks of the references that have none.
+  if (it->second.reference_callbacks != nullptr) {
+    auto &callbacks =
+        it->second.reference_callbacks->on_object_out_of_scope_or_freed_callbacks;
+    for (const auto &callback : callbacks) {
+      callback(it->first);
+    }
+    callbacks.clear();
   }
-  it->second.on_object_out_of_scope_or_freed_callbacks.clear();
   UnsetObjectPrimaryCopy(it);
 }
 
@@ -790,7 +837,7 @@ bool ReferenceCounter::SetObjectRefDeletedCallback(
   if (it == object_id_refs_.end()) {
     return false;
   }
-  it->second.on_object_ref_delete = callback;
+  it->second.mutable_callbacks()->on_object_ref_delete = callback;
   return true;
 }
 
@@ -811,7 +858,8 @@ bool ReferenceCounter::AddObjectOutOfScopeOrFreedCallback(
     return false;
   }
 
-  it->second.on_object_out_of_scope_or_freed_callbacks.emplace_back(callback);
+  it->second.mutable_callbacks()->on_object_out_of_scope_or_freed_callbacks.emplace_back(
+      callback);
   return true;
 }
 
@@ -1300,7 +1348,7 @@ void ReferenceCounter::SetRefRemovedCallback(
   } else {
     // We are still borrowing the object ID. Respond to the owner once we have
     // stopped borrowing it.
-    if (it->second.on_ref_removed != nullptr) {
+    if (it->second.callbacks().on_ref_removed != nullptr) {
       // TODO(swang): If the owner of an object dies and and is re-executed, it
       // is possible that we will receive a duplicate request to set
       // on_ref_removed. If messages are delayed and we overwrite the
@@ -1311,7 +1359,7 @@ void ReferenceCounter::SetRefRemovedCallback(
           << "on_ref_removed already set for object. The owner task must have died and "
              "been re-executed.";
     }
-    it->second.on_ref_removed = ref_removed_callback;
+    it->second.mutable_callbacks()->on_ref_removed = ref_removed_callback;
   }
 }
 
@@ -1393,7 +1441,8 @@ absl::optional<absl::flat_hash_set<NodeID>> ReferenceCounter::GetObjectLocations
            "reference table";
     return absl::nullopt;
   }
-  return it->second.locations;
+  return absl::flat_hash_set<NodeID>(it->second.locations.begin(),
+                                     it->second.locations.end());
 }
 
 bool ReferenceCounter::HandleObjectSpilled(const ObjectID &object_id,
@@ -1452,7 +1501,7 @@ absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
   if (object_size < 0) {
     // We don't know the object size so we can't returned valid locality data.
     RAY_LOG(DEBUG).WithField(object_id)
-        << "Reference [" << it->second.call_site
+        << "Reference [" << it->second.CallSite()
         << "] for object has an unknown object size, locality data not available";
     return absl::nullopt;
   }
@@ -1462,7 +1511,8 @@ absl::optional<LocalityData> ReferenceCounter::GetLocalityData(
   //   locations.
   // - If we don't own this object, this will contain a snapshot of the object locations
   //   at future resolution time.
-  auto node_ids = it->second.locations;
+  absl::flat_hash_set<NodeID> node_ids(it->second.locations.begin(),
+                                       it->second.locations.end());
   // Add location of the primary copy since the object must be there: either in memory or
   // spilled.
   if (it->second.pinned_at_raylet_id.has_value()) {
@@ -1640,6 +1690,19 @@ std::string ReferenceCounter::DebugString() const {
   return ss.str();
 }
 
+ReferenceCounter::Interned<std::string> ReferenceCounter::InternCallSite(
+    const std::string &call_site) {
+  // Shared by all the threads that create references, so it's sharded.
+  static auto *pool = new InternPool<std::string>(/*num_shards=*/16);
+  return pool->Intern(call_site);
+}
+
+ReferenceCounter::Interned<rpc::Address> ReferenceCounter::InternAddress(
+    const rpc::Address &address) {
+  static auto *pool = new InternPool<rpc::Address>(/*num_shards=*/16);
+  return pool->Intern(address);
+}
+
 std::string ReferenceCounter::Reference::DebugString() const {
   std::stringstream ss;
   ss << "Reference{borrowers: " << borrow().borrowers.size()
@@ -1656,7 +1719,7 @@ std::string ReferenceCounter::Reference::DebugString() const {
 ReferenceCounter::Reference ReferenceCounter::Reference::FromProto(
     const rpc::ObjectReferenceCount &ref_count) {
   Reference ref;
-  ref.owner_address = ref_count.reference().owner_address();
+  ref.owner_address = InternAddress(ref_count.reference().owner_address());
   ref.local_ref_count = ref_count.has_local_ref() ? 1 : 0;
 
   for (const auto &borrower : ref_count.borrowers()) {
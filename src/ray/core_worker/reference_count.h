@@ -25,7 +25,9 @@
 #include "ray/rpc/grpc_server.h"
 #include "ray/rpc/worker/core_worker_client.h"
 #include "ray/rpc/worker/core_worker_client_pool.h"
+#include "ray/util/intern_pool.h"
 #include "ray/util/logging.h"
+#include "ray/util/small_set.h"
 #include "src/ray/protobuf/common.pb.h"
 
 namespace ray {
@@ -111,6 +113,15 @@ class ReferenceCounter : public ReferenceCounterInterface,
   void RemoveLocalReference(const ObjectID &object_id, std::vector<ObjectID> *deleted)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Decrease the local reference count of each of the ObjectIDs by one, under a
+  /// single lock acquisition. Nil IDs are skipped.
+  ///
+  /// \param[in] object_ids The objects to decrement the count for. An object that
+  /// appears several times is decremented several times.
+  /// \param[out] deleted List to store objects that hit zero ref count.
+  void RemoveLocalReferences(const std::vector<ObjectID> &object_ids,
+                             std::vector<ObjectID> *deleted) ABSL_LOCKS_EXCLUDED(mutex_);
+
   /// Add references for the provided object IDs that correspond to them being
   /// dependencies to a submitted task. If lineage pinning is enabled, then
   /// this will also pin the Reference entry for each new argument until the
@@ -128,6 +139,26 @@ class ReferenceCounter : public ReferenceCounterInterface,
       const std::vector<ObjectID> &argument_ids_to_remove = std::vector<ObjectID>(),
       std::vector<ObjectID> *deleted = nullptr) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Add the return objects of a submitted task, and the references of its arguments,
+  /// under a single lock acquisition per task. This is the same as calling
+  /// `AddOwnedObject` with a local ref for each of `owned_return_ids`, followed by
+  /// `UpdateSubmittedTaskReferences(return_ids, argument_ids)`.
+  ///
+  /// \param[in] owned_return_ids The return objects to add as owned by us.
+  /// \param[in] owner_address The address of this worker.
+  /// \param[in] call_site The call site of the task submission.
+  /// \param[in] is_reconstructable Whether the return objects can be reconstructed.
+  /// \param[in] return_ids All the return objects of the task, which become pending
+  /// creation.
+  /// \param[in] argument_ids The arguments of the task to add references for.
+  void AddSubmittedTaskReferences(const std::vector<ObjectID> &owned_return_ids,
+                                  const rpc::Address &owner_address,
+                                  const std::string &call_site,
+                                  bool is_reconstructable,
+                                  const std::vector<ObjectID> &return_ids,
+                                  const std::vector<ObjectID> &argument_ids)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   /// Add references for the object dependencies of a resubmitted task. This
   /// does not increment the arguments' lineage ref counts because we should
   /// have already incremented them when the task was first submitted.
@@ -138,7 +169,9 @@ class ReferenceCounter : public ReferenceCounterInterface,
 
   /// Update object references that were given to a submitted task. The task
   /// may still be borrowing any object IDs that were contained in its
-  /// arguments. This should be called when the task finishes.
+  /// arguments. This should be called when the task finishes. The lock is taken once
+  /// per task; tasks that finish together, e.g. the queued tasks of a dead actor, still
+  /// take it once each.
   ///
   /// \param[in] object_ids The object IDs to remove references for.
   /// \param[in] release_lineage Whether to decrement the arguments' lineage
@@ -625,25 +658,57 @@ class ReferenceCounter : public ReferenceCounterInterface,
     absl::flat_hash_set<rpc::Address> borrowers;
   };
 
+  /// Callbacks registered for a reference, which only a few references have.
+  struct ReferenceCallbacks {
+    /// Callback that will be called when this object
+    /// is out of scope or manually freed.
+    /// Note: when an object is out of scope, it can still
+    /// have lineage ref count and on_object_ref_delete
+    /// will be called when lineage ref count is also 0.
+    std::vector<std::function<void(const ObjectID &)>>
+        on_object_out_of_scope_or_freed_callbacks;
+    /// Callback that will be called when the object ref is deleted
+    /// from the reference table (all refs including lineage ref count go to 0).
+    std::function<void(const ObjectID &)> on_object_ref_delete;
+    /// Callback that is called when this process is no longer a borrower
+    /// (RefCount() == 0).
+    std::function<void(const ObjectID &)> on_ref_removed;
+  };
+
+  /// A shared, immutable copy of a value that many references hold the same, e.g. the
+  /// call site or the owner's address. See `InternCallSite` and `InternAddress`.
+  template <typename T>
+  using Interned = std::shared_ptr<const T>;
+
+  /// Returns the shared copy of a call site. Thread-safe.
+  static Interned<std::string> InternCallSite(const std::string &call_site);
+
+  /// Returns the shared copy of an address. Thread-safe.
+  static Interned<rpc::Address> InternAddress(const rpc::Address &address);
+
+  /// The state of a reference. An owner may track millions of them, so the struct is
+  /// kept compact: the counters that change on every update come first, the values
+  /// that most references share are interned, and the metadata that most references
+  /// don't have lives in sidecars that are only allocated when needed.
   struct Reference {
     /// Constructor for a reference whose origin is unknown.
     Reference() {}
-    Reference(std::string call_site, const int64_t object_size)
-        : call_site(call_site), object_size(object_size) {}
+    Reference(const std::string &call_site, const int64_t object_size)
+        : object_size(object_size), call_site(InternCallSite(call_site)) {}
     /// Constructor for a reference that we created.
     Reference(const rpc::Address &owner_address,
-              std::string call_site,
+              const std::string &call_site,
               const int64_t object_size,
               bool is_reconstructable,
               const absl::optional<NodeID> &pinned_at_raylet_id)
-        : call_site(call_site),
-          object_size(object_size),
-          owner_address(owner_address),
-          pinned_at_raylet_id(pinned_at_raylet_id),
+        : object_size(object_size),
           owned_by_us(true),
           is_reconstructable(is_reconstructable),
           foreign_owner_already_monitoring(false),
-          pending_creation(!pinned_at_raylet_id.has_value()) {}
+          pending_creation(!pinned_at_raylet_id.has_value()),
+          call_site(InternCallSite(call_site)),
+          owner_address(InternAddress(owner_address)),
+          pinned_at_raylet_id(pinned_at_raylet_id) {}
 
     /// Constructor from a protobuf. This is assumed to be a message from
     /// another process, so the object defaults to not being owned by us.
@@ -735,24 +800,47 @@ class ReferenceCounter : public ReferenceCounterInterface,
       return nested_reference_count.get();
     }
 
-    std::string DebugString() const;
+    /// Access the callbacks without modifications.
+    /// Returns the default value of the struct if it is not set.
+    const ReferenceCallbacks &callbacks() const {
+      if (reference_callbacks == nullptr) {
+        static auto *default_callbacks = new ReferenceCallbacks();
+        return *default_callbacks;
+      }
+      return *reference_callbacks;
+    }
+
+    /// Returns the callbacks for updates.
+    /// Creates the underlying field if it is not set.
+    ReferenceCallbacks *mutable_callbacks() {
+      if (reference_callbacks == nullptr) {
+        reference_callbacks = std::make_unique<ReferenceCallbacks>();
+      }
+      return reference_callbacks.get();
+    }
 
     /// Description of the call site where the reference was created.
-    std::string call_site = "<unknown>";
+    const std::string &CallSite() const {
+      if (call_site == nullptr) {
+        static auto *unknown_call_site = new std::string("<unknown>");
+        return *unknown_call_site;
+      }
+      return *call_site;
+    }
+
+    std::string DebugString() const;
+
+    /// The number of tasks that depend on this object that may be retried in
+    /// the future (pending execution or finished but retryable). If the object
+    /// is inlined (not stored in plasma), then its lineage ref count is 0
+    /// because any dependent task will already have the value of the object.
+    uint32_t lineage_ref_count = 0;
+    /// The local ref count for the ObjectID in the language frontend.
+    uint32_t local_ref_count = 0;
+    /// The ref count for submitted tasks that depend on the ObjectID.
+    uint32_t submitted_task_ref_count = 0;
     /// Object size if known, otherwise -1;
     int64_t object_size = -1;
-    /// If this object is owned by us and stored in plasma, this contains all
-    /// object locations.
-    absl::flat_hash_set<NodeID> locations;
-    /// The object's owner's address, if we know it. If this process is the
-    /// owner, then this is added during creation of the Reference. If this is
-    /// process is a borrower, the borrower must add the owner's address before
-    /// using the ObjectID.
-    absl::optional<rpc::Address> owner_address;
-    /// If this object is owned by us and stored in plasma, and reference
-    /// counting is enabled, then some raylet must be pinning the object value.
-    /// This is the address of that raylet.
-    absl::optional<NodeID> pinned_at_raylet_id;
     /// Whether we own the object. If we own the object, then we are
     /// responsible for tracking the state of the task that creates the object
     /// (see task_manager.h).
@@ -765,66 +853,56 @@ class ReferenceCounter : public ReferenceCounterInterface,
     bool is_reconstructable = false;
     /// Whether the lineage of this object was evicted due to memory pressure.
     bool lineage_evicted = false;
-    /// The number of tasks that depend on this object that may be retried in
-    /// the future (pending execution or finished but retryable). If the object
-    /// is inlined (not stored in plasma), then its lineage ref count is 0
-    /// because any dependent task will already have the value of the object.
-    size_t lineage_ref_count = 0;
-
-    /// The local ref count for the ObjectID in the language frontend.
-    size_t local_ref_count = 0;
-    /// The ref count for submitted tasks that depend on the ObjectID.
-    size_t submitted_task_ref_count = 0;
-
-    /// Metadata related to nesting, including references that contain this
-    /// reference, and references contained by this reference.
-    std::unique_ptr<NestedReferenceCount> nested_reference_count;
-
-    /// Metadata related to borrowing.
-    std::unique_ptr<BorrowInfo> borrow_info;
-
-    /// Callback that will be called when this object
-    /// is out of scope or manually freed.
-    /// Note: when an object is out of scope, it can still
-    /// have lineage ref count and on_object_ref_delete
-    /// will be called when lineage ref count is also 0.
-    std::vector<std::function<void(const ObjectID &)>>
-        on_object_out_of_scope_or_freed_callbacks;
-    /// Callback that will be called when the object ref is deleted
-    /// from the reference table (all refs including lineage ref count go to 0).
-    std::function<void(const ObjectID &)> on_object_ref_delete;
-    /// Callback that is called when this process is no longer a borrower
-    /// (RefCount() == 0).
-    std::function<void(const ObjectID &)> on_ref_removed;
-
-    /// For objects that have been spilled to external storage, the URL from which
-    /// they can be retrieved.
-    std::string spilled_url = "";
-    /// The ID of the node that spilled the object.
-    /// This will be Nil if the object has not been spilled or if it is spilled
-    /// distributed external storage.
-    NodeID spilled_node_id = NodeID::Nil();
     /// Whether this object has been spilled to external storage.
     bool spilled = false;
-
     /// Whether the object was created with a foreign owner (i.e., _owner set).
     /// In this case, the owner is already monitoring this reference with a
     /// WaitForRefRemoved() call, and it is an error to return borrower
     /// metadata to the parent of the current task.
     /// See https://github.com/ray-project/ray/pull/19910 for more context.
     bool foreign_owner_already_monitoring = false;
-
     /// ObjectRefs nested in this object that are or were in use. These objects
     /// are not owned by us, and we need to report that we are borrowing them
     /// to their owner. Nesting is transitive, so this flag is set as long as
     /// any child object is in scope.
     bool has_nested_refs_to_report = false;
-
     /// Whether the task that creates this object is scheduled/executing.
     bool pending_creation = false;
-
     /// Whether or not this object was spilled.
     bool did_spill = false;
+
+    /// Metadata related to nesting, including references that contain this
+    /// reference, and references contained by this reference.
+    std::unique_ptr<NestedReferenceCount> nested_reference_count;
+    /// Metadata related to borrowing.
+    std::unique_ptr<BorrowInfo> borrow_info;
+    /// Callbacks registered for this reference.
+    std::unique_ptr<ReferenceCallbacks> reference_callbacks;
+
+    /// Below fields are cold: they are set once, or only for objects in plasma.
+    ///
+    /// Description of the call site where the reference was created. Read it through
+    /// `CallSite()`, since it's not set for references whose origin is unknown.
+    Interned<std::string> call_site;
+    /// The object's owner's address, if we know it. If this process is the
+    /// owner, then this is added during creation of the Reference. If this is
+    /// process is a borrower, the borrower must add the owner's address before
+    /// using the ObjectID.
+    Interned<rpc::Address> owner_address;
+    /// If this object is owned by us and stored in plasma, this contains all
+    /// object locations. Objects rarely have more than one copy.
+    SmallSet<NodeID> locations;
+    /// If this object is owned by us and stored in plasma, and reference
+    /// counting is enabled, then some raylet must be pinning the object value.
+    /// This is the address of that raylet.
+    absl::optional<NodeID> pinned_at_raylet_id;
+    /// For objects that have been spilled to external storage, the URL from which
+    /// they can be retrieved.
+    std::string spilled_url = "";
+    /// The ID of the node that spilled the object.
+    /// This will be Nil if the object has not been spilled or if it is spilled
+    /// distributed external storage.
+    NodeID spilled_node_id = NodeID::Nil();
   };
 
   using ReferenceTable = absl::flat_hash_map<ObjectID, Reference>;
@@ -1013,6 +1091,10 @@ class ReferenceCounter : public ReferenceCounterInterface,
                                     const ObjectID &object_id,
                                     const rpc::Address &borrower_addr);
 
+  /// Add the submitted task refs, and the lineage refs, of a task's arguments.
+  void AddSubmittedTaskReferencesInternal(const std::vector<ObjectID> &argument_ids)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Decrease the local reference count for the ObjectID by one.
   /// This method is internal and not thread-safe. mutex_ lock must be held before
   /// calling this method.
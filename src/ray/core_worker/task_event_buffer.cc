@@ -22,6 +22,13 @@ namespace core {
 
 namespace worker {
 
+namespace {
+
+/// Source of TaskEventBufferImpl::staging_id_.
+std::atomic<uint64_t> next_staging_id{0};
+
+}  // namespace
+
 TaskEvent::TaskEvent(TaskID task_id, JobID job_id, int32_t attempt_number)
     : task_id_(task_id), job_id_(job_id), attempt_number_(attempt_number) {}
 
@@ -54,14 +61,32 @@ TaskProfileEvent::TaskProfileEvent(TaskID task_id,
       event_name_(event_name),
       start_time_(start_time) {}
 
+void TaskStatusEvent::MergeFrom(std::shared_ptr<TaskStatusEvent> other) {
+  RAY_CHECK(other->GetTaskAttempt() == GetTaskAttempt())
+      << "Only status events of the same task attempt could be merged.";
+  auto other_merged_events = std::move(other->merged_events_);
+  merged_events_.push_back(std::move(other));
+  merged_events_.insert(merged_events_.end(),
+                        std::make_move_iterator(other_merged_events.begin()),
+                        std::make_move_iterator(other_merged_events.end()));
+}
+
 void TaskStatusEvent::ToRpcTaskEvents(rpc::TaskEvents *rpc_task_events) {
+  FillStatusUpdate(rpc_task_events);
+  for (const auto &merged_event : merged_events_) {
+    merged_event->FillStatusUpdate(rpc_task_events);
+  }
+}
+
+void TaskStatusEvent::FillStatusUpdate(rpc::TaskEvents *rpc_task_events) {
   // Base fields
   rpc_task_events->set_task_id(task_id_.Binary());
   rpc_task_events->set_job_id(job_id_.Binary());
   rpc_task_events->set_attempt_number(attempt_number_);
 
-  // Task info.
-  if (task_spec_) {
+  // Task info. It's static for a task attempt, so it's only filled once even if
+  // multiple events of the attempt carry the task spec.
+  if (task_spec_ && !rpc_task_events->has_task_info()) {
     gcs::FillTaskInfo(rpc_task_events->mutable_task_info(), *task_spec_);
   }
 
@@ -111,13 +136,21 @@ void TaskStatusEvent::ToRpcTaskEvents(rpc::TaskEvents *rpc_task_events) {
 
 void TaskStatusEvent::ToRpcTaskExportEvents(
     std::shared_ptr<rpc::ExportTaskEventData> rpc_task_export_event_data) {
+  FillExportStatusUpdate(rpc_task_export_event_data.get());
+  for (const auto &merged_event : merged_events_) {
+    merged_event->FillExportStatusUpdate(rpc_task_export_event_data.get());
+  }
+}
+
+void TaskStatusEvent::FillExportStatusUpdate(
+    rpc::ExportTaskEventData *rpc_task_export_event_data) {
   // Base fields
   rpc_task_export_event_data->set_task_id(task_id_.Binary());
   rpc_task_export_event_data->set_job_id(job_id_.Binary());
   rpc_task_export_event_data->set_attempt_number(attempt_number_);
 
   // Task info.
-  if (task_spec_) {
+  if (task_spec_ && !rpc_task_export_event_data->has_task_info()) {
     gcs::FillExportTaskInfo(rpc_task_export_event_data->mutable_task_info(), *task_spec_);
   }
 
@@ -234,7 +267,8 @@ TaskEventBufferImpl::TaskEventBufferImpl(std::shared_ptr<gcs::GcsClient> gcs_cli
     : work_guard_(boost::asio::make_work_guard(io_service_)),
       periodical_runner_(PeriodicalRunner::Create(io_service_)),
       gcs_client_(std::move(gcs_client)),
-      status_events_() {}
+      status_events_(),
+      staging_id_(next_staging_id.fetch_add(1)) {}
 
 TaskEventBufferImpl::~TaskEventBufferImpl() { Stop(); }
 
@@ -249,6 +283,8 @@ Status TaskEventBufferImpl::Start(bool auto_flush) {
       RayConfig::instance().task_events_max_num_status_events_buffer_on_worker());
   status_events_for_export_.set_capacity(
       RayConfig::instance().task_events_max_num_export_status_events_buffer_on_worker());
+  staging_buffer_capacity_ =
+      RayConfig::instance().task_events_thread_local_buffer_size();
 
   io_thread_ = std::thread([this]() {
 #ifndef _WIN32
@@ -498,6 +534,10 @@ void TaskEventBufferImpl::FlushEvents(bool forced) {
     return;
   }
 
+  // Drain the staging buffers even if the flush is skipped below, so that producers
+  // don't overflow to the locked path while GCS is slow.
+  DrainStagingBuffers();
+
   // Skip if GCS hasn't finished processing the previous message.
   if (grpc_in_progress_ && !forced) {
     RAY_LOG_EVERY_N_OR_DEBUG(WARNING, 100)
@@ -594,7 +634,101 @@ void TaskEventBufferImpl::ResetCountersForFlush() {
                            num_status_events_dropped_since_last_flush);
 }
 
+TaskEventBufferImpl::StagingBuffer &TaskEventBufferImpl::GetThreadStagingBuffer() {
+  // Staging buffers of the calling thread, keyed by the staging id of the
+  // TaskEventBufferImpl that drains them. Entries of destroyed TaskEventBufferImpl are
+  // only released on thread exit, which is fine since there is normally a single
+  // TaskEventBufferImpl per process.
+  thread_local absl::flat_hash_map<uint64_t, std::shared_ptr<StagingBuffer>>
+      thread_staging_buffers;
+
+  auto itr = thread_staging_buffers.find(staging_id_);
+  if (itr != thread_staging_buffers.end()) {
+    return *itr->second;
+  }
+
+  auto staging_buffer = std::make_shared<StagingBuffer>(staging_buffer_capacity_);
+  {
+    absl::MutexLock lock(&staging_mutex_);
+    staging_buffers_.push_back(staging_buffer);
+  }
+  thread_staging_buffers.emplace(staging_id_, staging_buffer);
+  return *staging_buffer;
+}
+
+void TaskEventBufferImpl::DrainStagingBuffers() {
+  std::vector<std::shared_ptr<TaskEvent>> status_events;
+  std::vector<std::shared_ptr<TaskEvent>> profile_events;
+  size_t num_status_events_merged = 0;
+  {
+    absl::MutexLock lock(&staging_mutex_);
+    if (staging_buffers_.empty()) {
+      return;
+    }
+
+    // Status events of a task attempt drained in this round are merged into the first
+    // one of the attempt, so they take a single slot in the buffer.
+    absl::flat_hash_map<TaskAttempt, std::shared_ptr<TaskStatusEvent>>
+        first_status_events;
+    std::unique_ptr<TaskEvent> event;
+    for (const auto &staging_buffer : staging_buffers_) {
+      while (staging_buffer->TryPop(&event)) {
+        if (event->IsProfileEvent()) {
+          profile_events.push_back(std::move(event));
+          continue;
+        }
+        std::shared_ptr<TaskStatusEvent> status_event(
+            static_cast<TaskStatusEvent *>(event.release()));
+        auto [itr, inserted] =
+            first_status_events.try_emplace(status_event->GetTaskAttempt(), status_event);
+        if (inserted) {
+          status_events.push_back(std::move(status_event));
+        } else {
+          itr->second->MergeFrom(std::move(status_event));
+          num_status_events_merged++;
+        }
+      }
+    }
+
+    // Remove the staging buffers of exited threads, which will not get new events.
+    staging_buffers_.erase(
+        std::remove_if(staging_buffers_.begin(),
+                       staging_buffers_.end(),
+                       [](const std::shared_ptr<StagingBuffer> &staging_buffer) {
+                         return staging_buffer.use_count() == 1 &&
+                                staging_buffer->Empty();
+                       }),
+        staging_buffers_.end());
+  }
+
+  stats_counter_.Increment(TaskEventBufferCounter::kTotalNumTaskStatusEventsMerged,
+                           num_status_events_merged);
+
+  if (!status_events.empty()) {
+    absl::MutexLock lock(&mutex_);
+    for (auto &status_event : status_events) {
+      AddTaskStatusEventLocked(std::move(status_event));
+    }
+  }
+
+  if (!profile_events.empty()) {
+    absl::MutexLock lock(&profile_mutex_);
+    for (auto &profile_event : profile_events) {
+      AddTaskProfileEventLocked(std::move(profile_event));
+    }
+  }
+}
+
 void TaskEventBufferImpl::AddTaskEvent(std::unique_ptr<TaskEvent> task_event) {
+  if (enabled_ && staging_buffer_capacity_ > 0) {
+    if (GetThreadStagingBuffer().TryPush(std::move(task_event))) {
+      return;
+    }
+    // The staging buffer is full since it's not drained fast enough, fall back to
+    // adding the event under lock.
+    stats_counter_.Increment(TaskEventBufferCounter::kTotalNumTaskEventsStagingOverflow);
+  }
+
   if (task_event->IsProfileEvent()) {
     AddTaskProfileEvent(std::move(task_event));
   } else {
@@ -607,8 +741,11 @@ void TaskEventBufferImpl::AddTaskStatusEvent(std::unique_ptr<TaskEvent> status_e
   if (!enabled_) {
     return;
   }
-  std::shared_ptr<TaskEvent> status_event_shared_ptr = std::move(status_event);
+  AddTaskStatusEventLocked(std::move(status_event));
+}
 
+void TaskEventBufferImpl::AddTaskStatusEventLocked(
+    std::shared_ptr<TaskEvent> status_event_shared_ptr) {
   if (export_event_write_enabled_) {
     // If status_events_for_export_ is full, the oldest event will be
     // dropped in the circular buffer and replaced with the current event.
@@ -654,7 +791,11 @@ void TaskEventBufferImpl::AddTaskProfileEvent(std::unique_ptr<TaskEvent> profile
   if (!enabled_) {
     return;
   }
-  std::shared_ptr<TaskEvent> profile_event_shared_ptr = std::move(profile_event);
+  AddTaskProfileEventLocked(std::move(profile_event));
+}
+
+void TaskEventBufferImpl::AddTaskProfileEventLocked(
+    std::shared_ptr<TaskEvent> profile_event_shared_ptr) {
   auto profile_events_itr =
       profile_events_.find(profile_event_shared_ptr->GetTaskAttempt());
   if (profile_events_itr == profile_events_.end()) {
@@ -727,7 +868,11 @@ const std::string TaskEventBufferImpl::DebugString() {
      << "\n\tnum status task events dropped: "
      << stats[TaskEventBufferCounter::kTotalNumTaskStatusEventDropped]
      << "\n\tnum profile task events dropped: "
-     << stats[TaskEventBufferCounter::kTotalNumTaskProfileEventDropped] << "\n";
+     << stats[TaskEventBufferCounter::kTotalNumTaskProfileEventDropped]
+     << "\n\tnum status task events merged: "
+     << stats[TaskEventBufferCounter::kTotalNumTaskStatusEventsMerged]
+     << "\n\tnum task events overflowed from staging buffers: "
+     << stats[TaskEventBufferCounter::kTotalNumTaskEventsStagingOverflow] << "\n";
 
   return ss.str();
 }
@@ -27,6 +27,7 @@
 #include "ray/common/task/task_spec.h"
 #include "ray/gcs/gcs_client/gcs_client.h"
 #include "ray/util/counter_map.h"
+#include "ray/util/spsc_ring_buffer.h"
 #include "src/ray/protobuf/export_api/export_task_event.pb.h"
 #include "src/ray/protobuf/gcs.pb.h"
 
@@ -138,7 +139,24 @@ class TaskStatusEvent : public TaskEvent {
 
   bool IsProfileEvent() const override { return false; }
 
+  /// Merge a later status change of the same task attempt into this event, so that
+  /// both changes occupy a single slot in the buffer and are converted together.
+  ///
+  /// Static task info is only filled once per task attempt, so a merged event
+  /// carrying another copy of the task spec will not be serialized twice.
+  ///
+  /// \param other Status event of the same task attempt to be merged.
+  void MergeFrom(std::shared_ptr<TaskStatusEvent> other);
+
  private:
+  /// Fill the status change of this event (excluding the merged ones) to the rpc
+  /// task events.
+  void FillStatusUpdate(rpc::TaskEvents *rpc_task_events);
+
+  /// Fill the status change of this event (excluding the merged ones) to the rpc
+  /// export task event data.
+  void FillExportStatusUpdate(rpc::ExportTaskEventData *rpc_task_export_event_data);
+
   /// The task status change if it's a status change event.
   const rpc::TaskStatus task_status_ = rpc::TaskStatus::NIL;
   /// The time when the task status change happens.
@@ -147,6 +165,8 @@ class TaskStatusEvent : public TaskEvent {
   const std::shared_ptr<const TaskSpecification> task_spec_ = nullptr;
   /// Optional task state update
   const std::optional<const TaskStateUpdate> state_update_ = std::nullopt;
+  /// Later status changes of the same task attempt merged into this event.
+  std::vector<std::shared_ptr<TaskStatusEvent>> merged_events_;
 };
 
 /// TaskProfileEvent is generated when `RAY_enable_timeline` is on.
@@ -197,6 +217,8 @@ enum TaskEventBufferCounter {
   kTotalNumLostTaskAttemptsReported,
   kTotalTaskEventsBytesReported,
   kTotalNumFailedToReport,
+  kTotalNumTaskStatusEventsMerged,
+  kTotalNumTaskEventsStagingOverflow,
 };
 
 /// An interface for a buffer that stores task status changes and profiling events,
@@ -292,6 +314,15 @@ class TaskEventBuffer {
 /// The buffer has its own io_context and io_thread, that's isolated from other
 /// components.
 ///
+/// Per-thread staging
+/// ==================
+/// When `RAY_task_events_thread_local_buffer_size` > 0, each thread that adds task
+/// events gets its own lock-free single-producer single-consumer ring, and events are
+/// pushed there without taking `mutex_`. The rings are drained by the flushing thread
+/// at the beginning of each flush, when status events of the same task attempt are
+/// merged before being moved into the shared buffers under a single lock. If a ring
+/// is full, the event falls back to the locked path.
+///
 /// This class is thread-safe.
 class TaskEventBufferImpl : public TaskEventBuffer {
  public:
@@ -316,6 +347,28 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   const std::string DebugString() override;
 
  private:
+  using StagingBuffer = utils::container::SpscRingBuffer<std::unique_ptr<TaskEvent>>;
+
+  /// Get the staging buffer of the calling thread, creating and registering one if
+  /// the thread has not added any task event to this buffer before.
+  StagingBuffer &GetThreadStagingBuffer() ABSL_LOCKS_EXCLUDED(staging_mutex_);
+
+  /// Move task events from all per-thread staging buffers into the buffers to be
+  /// sent, merging status events of the same task attempt.
+  void DrainStagingBuffers() ABSL_LOCKS_EXCLUDED(staging_mutex_, mutex_, profile_mutex_);
+
+  /// Add a task status event to the buffer.
+  ///
+  /// \param status_event Task status event.
+  void AddTaskStatusEventLocked(std::shared_ptr<TaskEvent> status_event)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Add a task profile event to the buffer.
+  ///
+  /// \param profile_event Task profile event.
+  void AddTaskProfileEventLocked(std::shared_ptr<TaskEvent> profile_event)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(profile_mutex_);
+
   /// Add a task status event to be reported.
   ///
   /// \param status_event Task status event.
@@ -409,6 +462,11 @@ class TaskEventBufferImpl : public TaskEventBuffer {
     return stats_counter_.Get(TaskEventBufferCounter::kTotalNumFailedToReport);
   }
 
+  /// Test only functions.
+  size_t GetTotalNumStatusTaskEventsMerged() {
+    return stats_counter_.Get(TaskEventBufferCounter::kTotalNumTaskStatusEventsMerged);
+  }
+
   /// Test only functions.
   gcs::GcsClient *GetGcsClient() {
     absl::MutexLock lock(&mutex_);
@@ -459,6 +517,23 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   /// Stats counter map.
   CounterMapThreadSafe<TaskEventBufferCounter> stats_counter_;
 
+  /// Unique id of this buffer, used to look up the per-thread staging buffers. A
+  /// pointer to this buffer is not used since it could be reused by a later instance.
+  const uint64_t staging_id_;
+
+  /// Capacity of each per-thread staging buffer. 0 if staging is disabled.
+  size_t staging_buffer_capacity_ = 0;
+
+  /// Mutex guarding staging_buffers_. It also serializes draining of the staging
+  /// buffers, since each of them only supports a single consumer. Producers only
+  /// take it once per thread when registering their staging buffer.
+  absl::Mutex staging_mutex_;
+
+  /// Staging buffers of all threads that have added task events. Once its thread has
+  /// exited, a buffer is only referenced here, and it is removed after being drained.
+  std::vector<std::shared_ptr<StagingBuffer>> staging_buffers_
+      ABSL_GUARDED_BY(staging_mutex_);
+
   /// True if there's a pending gRPC call. It's a simple way to prevent overloading
   /// GCS with too many calls. There is no point sending more events if GCS could not
   /// process them quick enough.
@@ -478,6 +553,11 @@ class TaskEventBufferImpl : public TaskEventBuffer {
   FRIEND_TEST(TaskEventBufferTestLimitProfileEvents, TestBufferSizeLimitProfileEvents);
   FRIEND_TEST(TaskEventBufferTestLimitProfileEvents, TestLimitProfileEventsPerTask);
   FRIEND_TEST(TaskEventTestWriteExport, TestWriteTaskExportEvents);
+  FRIEND_TEST(TaskEventBufferTestStaging, TestAddEventStaged);
+  FRIEND_TEST(TaskEventBufferTestStaging, TestMergeStatusEventsOfSameAttempt);
+  FRIEND_TEST(TaskEventBufferTestStaging, TestStagingOverflowFallback);
+  FRIEND_TEST(TaskEventBufferTestStaging, TestStagingFromExitedThread);
+  FRIEND_TEST(TaskEventBufferTestStaging, DISABLED_TestAddEventThroughputPerThread);
 };
 
 }  // namespace worker
@@ -14,6 +14,9 @@
 
 #include "ray/core_worker/task_manager.h"
 
+#include <algorithm>
+#include <filesystem>
+
 #include "ray/common/buffer.h"
 #include "ray/common/common_protocol.h"
 #include "ray/core_worker/actor_manager.h"
@@ -30,6 +33,32 @@ constexpr int64_t kTaskFailureThrottlingThreshold = 50;
 // Throttle task failure logs to once this interval.
 constexpr int64_t kTaskFailureLoggingFrequencyMillis = 5000;
 
+namespace {
+
+/// Appends the objects whose lineage the task pins to `dependencies`.
+void GetLineageDependencies(const TaskSpecification &spec,
+                            std::vector<ObjectID> *dependencies) {
+  for (size_t i = 0; i < spec.NumArgs(); i++) {
+    if (spec.ArgByRef(i)) {
+      dependencies->push_back(spec.ArgId(i));
+    } else {
+      const auto &inlined_refs = spec.ArgInlinedRefs(i);
+      for (const auto &inlined_ref : inlined_refs) {
+        dependencies->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
+      }
+    }
+  }
+
+  if (spec.IsActorTask()) {
+    // We need to decrement the actor lineage ref count here
+    // since it's incremented during TaskManager::AddPendingTask.
+    const auto actor_creation_return_id = spec.ActorCreationDummyObjectId();
+    dependencies->push_back(actor_creation_return_id);
+  }
+}
+
+}  // namespace
+
 absl::flat_hash_set<ObjectID> ObjectRefStream::GetItemsUnconsumed() const {
   absl::flat_hash_set<ObjectID> result;
   for (int64_t index = 0; index <= max_index_seen_; index++) {
@@ -241,26 +270,6 @@ std::vector<rpc::ObjectReference> TaskManager::AddPendingTask(
   return_ids.reserve(num_returns);
   for (size_t i = 0; i < num_returns; i++) {
     auto return_id = spec.ReturnId(i);
-    if (!spec.IsActorCreationTask()) {
-      bool is_reconstructable = max_retries != 0;
-      // We pass an empty vector for inner IDs because we do not know the return
-      // value of the task yet. If the task returns an ID(s), the worker will
-      // publish the WaitForRefRemoved message that we are now a borrower for
-      // the inner IDs. Note that this message can be received *before* the
-      // PushTaskReply.
-      // NOTE(swang): We increment the local ref count to ensure that the
-      // object is considered in scope before we return the ObjectRef to the
-      // language frontend. Note that the language bindings should set
-      // skip_adding_local_ref=True to avoid double referencing the object.
-      reference_counter_->AddOwnedObject(return_id,
-                                         /*contained_ids=*/{},
-                                         caller_address,
-                                         call_site,
-                                         -1,
-                                         is_reconstructable,
-                                         /*add_local_ref=*/true);
-    }
-
     return_ids.push_back(return_id);
     rpc::ObjectReference ref;
     ref.set_object_id(spec.ReturnId(i).Binary());
@@ -269,7 +278,25 @@ std::vector<rpc::ObjectReference> TaskManager::AddPendingTask(
     returned_refs.push_back(std::move(ref));
   }
 
-  reference_counter_->UpdateSubmittedTaskReferences(return_ids, task_deps);
+  // The returns are added without inner IDs because we do not know the return
+  // value of the task yet. If the task returns an ID(s), the worker will
+  // publish the WaitForRefRemoved message that we are now a borrower for
+  // the inner IDs. Note that this message can be received *before* the
+  // PushTaskReply.
+  // NOTE(swang): We increment the local ref count to ensure that the
+  // object is considered in scope before we return the ObjectRef to the
+  // language frontend. Note that the language bindings should set
+  // skip_adding_local_ref=True to avoid double referencing the object.
+  // The owned returns and the argument refs are added under a single lock
+  // acquisition of the reference counter, which is contended on the submit path.
+  reference_counter_->AddSubmittedTaskReferences(
+      /*owned_return_ids=*/spec.IsActorCreationTask() ? std::vector<ObjectID>()
+                                                       : return_ids,
+      caller_address,
+      call_site,
+      /*is_reconstructable=*/max_retries != 0,
+      return_ids,
+      task_deps);
 
   // If it is a generator task, create an object ref stream.
   // The language frontend is responsible for calling DeleteObjectRefStream.
@@ -279,8 +306,8 @@ std::vector<rpc::ObjectReference> TaskManager::AddPendingTask(
     absl::MutexLock lock(&object_ref_stream_ops_mu_);
     auto inserted =
         object_ref_streams_.emplace(generator_id, ObjectRefStream(generator_id));
-    ref_stream_execution_signal_callbacks_.emplace(
-        generator_id, std::vector<ExecutionSignalCallback>());
+    ref_stream_execution_signal_callbacks_.emplace(generator_id,
+                                                   std::vector<HeldExecutionSignal>());
     RAY_CHECK(inserted.second);
   }
 
@@ -316,6 +343,17 @@ bool TaskManager::ResubmitTask(const TaskID &task_id, std::vector<ObjectID> *tas
     }
 
     if (!it->second.IsPending()) {
+      if (it->second.compacted_lineage != nullptr) {
+        TaskSpecification full_spec;
+        auto status = GetLineageSpec(it->second, /*with_args=*/true, &full_spec);
+        if (!status.ok()) {
+          RAY_LOG(ERROR) << "Failed to restore the lineage of task " << task_id
+                         << ", it can't be resubmitted: " << status;
+          return false;
+        }
+        ReleaseCompactedLineage(it->second);
+        it->second.spec = std::move(full_spec);
+      }
       resubmit = true;
       MarkTaskRetryOnResubmit(it->second);
       num_pending_tasks_++;
@@ -530,17 +568,30 @@ Status TaskManager::TryReadObjectRefStream(const ObjectID &generator_id,
     auto total_generated = stream_it->second.TotalNumObjectWritten();
     auto total_consumed = stream_it->second.TotalNumObjectConsumed();
     auto total_unconsumed = total_generated - total_consumed;
-    if (backpressure_threshold != -1 && total_unconsumed < backpressure_threshold) {
+    // Signals held for the byte credit of the executor may be released even if
+    // there's no threshold on the number of objects.
+    if (backpressure_threshold == -1 || total_unconsumed < backpressure_threshold) {
       auto it = ref_stream_execution_signal_callbacks_.find(generator_id);
       if (it != ref_stream_execution_signal_callbacks_.end()) {
-        for (const auto &execution_signal : it->second) {
-          RAY_LOG(DEBUG) << "The task for a stream " << generator_id
-                         << " should resume. total_generated: " << total_generated
-                         << ". total_consumed: " << total_consumed
-                         << ". threshold: " << backpressure_threshold;
-          execution_signal(Status::OK(), total_consumed);
-        }
-        it->second.clear();
+        const auto consumed_index = stream_it->second.LastConsumedIndex() + 1;
+        auto &held_signals = it->second;
+        held_signals.erase(
+            std::remove_if(
+                held_signals.begin(),
+                held_signals.end(),
+                [&](const HeldExecutionSignal &execution_signal) {
+                  if (consumed_index < execution_signal.consumed_index_to_resume) {
+                    return false;
+                  }
+                  RAY_LOG(DEBUG) << "The task for a stream " << generator_id
+                                 << " should resume. total_generated: "
+                                 << total_generated
+                                 << ". total_consumed: " << total_consumed
+                                 << ". threshold: " << backpressure_threshold;
+                  execution_signal.callback(Status::OK(), total_consumed);
+                  return true;
+                }),
+            held_signals.end());
       }
     }
   }
@@ -566,7 +617,7 @@ bool TaskManager::TryDelObjectRefStreamInternal(const ObjectID &generator_id) {
     RAY_LOG(DEBUG) << "Deleting execution signal callbacks for generator "
                    << generator_id;
     for (const auto &execution_signal : signal_it->second) {
-      execution_signal(Status::NotFound("Stream is deleted."), -1);
+      execution_signal.callback(Status::NotFound("Stream is deleted."), -1);
     }
     // We may still receive more generator return reports in the future, if the
     // generator task is still running or is retried. They will get the
@@ -652,6 +703,9 @@ bool TaskManager::HandleReportGeneratorItemReturns(
   const auto &generator_id = ObjectID::FromBinary(request.generator_id());
   const auto &task_id = generator_id.TaskId();
   int64_t item_index = request.item_index();
+  // The index of the last object of the report, which may contain a batch of them.
+  const int64_t last_item_index =
+      item_index + std::max(request.dynamic_return_objects_size(), 1) - 1;
   uint64_t attempt_number = request.attempt_number();
   // Every generated object has the same task id.
   RAY_LOG(DEBUG) << "Received an intermediate result of index " << item_index
@@ -689,12 +743,14 @@ bool TaskManager::HandleReportGeneratorItemReturns(
 
   // TODO(sang): Support the regular return values as well.
   size_t num_objects_written = 0;
+  int64_t object_index = item_index;
   for (const auto &return_object : request.dynamic_return_objects()) {
     const auto object_id = ObjectID::FromBinary(return_object.object_id());
 
     RAY_LOG(DEBUG) << "Write an object " << object_id
                    << " to the object ref stream of id " << generator_id;
-    auto index_not_used_yet = stream_it->second.InsertToStream(object_id, item_index);
+    auto index_not_used_yet =
+        stream_it->second.InsertToStream(object_id, object_index++);
 
     // If the ref was written to a stream, we should also
     // own the dynamically generated task return.
@@ -715,7 +771,7 @@ bool TaskManager::HandleReportGeneratorItemReturns(
   auto total_generated = stream_it->second.TotalNumObjectWritten();
   auto total_consumed = stream_it->second.TotalNumObjectConsumed();
 
-  if (stream_it->second.IsObjectConsumed(item_index)) {
+  if (stream_it->second.IsObjectConsumed(last_item_index)) {
     execution_signal_callback(Status::OK(), total_consumed);
     return false;
   }
@@ -724,17 +780,26 @@ bool TaskManager::HandleReportGeneratorItemReturns(
   // NOTE, here we check `item_index - last_consumed_index >= backpressure_threshold`,
   // instead of the number of unconsumed items, because we may receive the
   // `HandleReportGeneratorItemReturns` requests out of order.
-  if (backpressure_threshold != -1 &&
-      (item_index - stream_it->second.LastConsumedIndex()) >= backpressure_threshold) {
+  const bool over_num_objects =
+      backpressure_threshold != -1 &&
+      (last_item_index - stream_it->second.LastConsumedIndex()) >= backpressure_threshold;
+  // The executor is out of byte credit until the objects before this index are
+  // consumed.
+  const auto consumed_index_to_resume = request.consumed_index_to_resume();
+  const bool over_num_bytes =
+      stream_it->second.LastConsumedIndex() + 1 < consumed_index_to_resume;
+  if (over_num_objects || over_num_bytes) {
     RAY_LOG(DEBUG) << "Stream " << generator_id
                    << " is backpressured. total_generated: " << total_generated
                    << ". total_consumed: " << total_consumed
-                   << ". threshold: " << backpressure_threshold;
+                   << ". threshold: " << backpressure_threshold
+                   << ". consumed_index_to_resume: " << consumed_index_to_resume;
     auto signal_it = ref_stream_execution_signal_callbacks_.find(generator_id);
     if (signal_it == ref_stream_execution_signal_callbacks_.end()) {
       execution_signal_callback(Status::NotFound("Stream is deleted."), -1);
     } else {
-      signal_it->second.push_back(execution_signal_callback);
+      signal_it->second.push_back(
+          HeldExecutionSignal{consumed_index_to_resume, execution_signal_callback});
     }
   } else {
     // No need to backpressure.
@@ -894,8 +959,13 @@ void TaskManager::CompletePendingTask(const TaskID &task_id,
     if (task_retryable) {
       // Pin the task spec if it may be retried again.
       release_lineage = false;
-      it->second.lineage_footprint_bytes = it->second.spec.GetMessage().ByteSizeLong();
+      if (RayConfig::instance().task_lineage_compaction_enabled()) {
+        CompactLineage(it->second);
+      } else {
+        it->second.lineage_footprint_bytes = it->second.spec.GetMessage().ByteSizeLong();
+      }
       total_lineage_footprint_bytes_ += it->second.lineage_footprint_bytes;
+      SpillLineageIfNeeded();
       if (total_lineage_footprint_bytes_ > max_lineage_bytes_) {
         RAY_LOG(INFO) << "Total lineage size is " << total_lineage_footprint_bytes_ / 1e6
                       << "MB, which exceeds the limit of " << max_lineage_bytes_ / 1e6
@@ -1204,6 +1274,130 @@ void TaskManager::RemoveFinishedTaskReferences(
   in_memory_store_->Delete(deleted);
 }
 
+void TaskManager::CompactLineage(TaskEntry &task_entry) {
+  RAY_CHECK(task_entry.compacted_lineage == nullptr);
+  auto lineage = std::make_unique<CompactedLineage>();
+  GetLineageDependencies(task_entry.spec, &lineage->lineage_dependencies);
+  // The spec may still be shared with the submitters, so it's copied rather than
+  // modified in place.
+  auto message = std::make_shared<rpc::TaskSpec>(task_entry.spec.GetMessage());
+  rpc::TaskSpec fragment;
+  fragment.mutable_args()->Swap(message->mutable_args());
+  lineage->args = fragment.SerializeAsString();
+  fragment.Clear();
+  fragment.mutable_function_descriptor()->Swap(message->mutable_function_descriptor());
+  message->clear_function_descriptor();
+  lineage->function_descriptor = lineage_fragments_.Intern(fragment.SerializeAsString());
+  fragment.Clear();
+  fragment.mutable_runtime_env_info()->Swap(message->mutable_runtime_env_info());
+  message->clear_runtime_env_info();
+  lineage->runtime_env_info = lineage_fragments_.Intern(fragment.SerializeAsString());
+
+  // The interned fragments are shared, so they aren't counted.
+  task_entry.lineage_footprint_bytes = message->ByteSizeLong() + lineage->args.size();
+  task_entry.spec = TaskSpecification(std::move(message));
+  task_entry.compacted_lineage = std::move(lineage);
+  if (RayConfig::instance().task_lineage_spill_threshold_bytes() >= 0) {
+    lineage_to_spill_.push_back(task_entry.spec.TaskId());
+    num_lineage_to_spill_++;
+  }
+}
+
+std::shared_ptr<rpc::TaskSpec> TaskManager::GetLineageMessage(
+    const TaskEntry &task_entry) const {
+  const auto &lineage = *task_entry.compacted_lineage;
+  auto message = std::make_shared<rpc::TaskSpec>(task_entry.spec.GetMessage());
+  RAY_CHECK(message->MergeFromString(*lineage.function_descriptor));
+  RAY_CHECK(message->MergeFromString(*lineage.runtime_env_info));
+  return message;
+}
+
+Status TaskManager::GetLineageSpec(const TaskEntry &task_entry,
+                                   bool with_args,
+                                   TaskSpecification *spec) const {
+  const auto &lineage = *task_entry.compacted_lineage;
+  auto message = GetLineageMessage(task_entry);
+  if (with_args) {
+    if (lineage.spilled_args.has_value()) {
+      std::string args;
+      RAY_RETURN_NOT_OK(lineage_spill_file_->Read(*lineage.spilled_args, &args));
+      RAY_CHECK(message->MergeFromString(args));
+    } else {
+      RAY_CHECK(message->MergeFromString(lineage.args));
+    }
+  }
+  *spec = TaskSpecification(std::move(message));
+  return Status::OK();
+}
+
+void TaskManager::ReleaseCompactedLineage(TaskEntry &task_entry) {
+  auto &lineage = *task_entry.compacted_lineage;
+  if (lineage.spilled_args.has_value()) {
+    lineage_spill_file_->Release(*lineage.spilled_args);
+  } else if (RayConfig::instance().task_lineage_spill_threshold_bytes() >= 0) {
+    num_lineage_to_spill_--;
+  }
+  task_entry.compacted_lineage.reset();
+
+  // Drop the skipped tasks once they are the majority, so that the queue doesn't grow
+  // when the lineage is released before it needs to be spilled.
+  if (lineage_to_spill_.size() > 2 * num_lineage_to_spill_ + 64) {
+    std::deque<TaskID> lineage_to_spill;
+    for (const auto &task_id : lineage_to_spill_) {
+      auto it = submissible_tasks_.find(task_id);
+      if (it != submissible_tasks_.end() && it->second.compacted_lineage != nullptr &&
+          !it->second.compacted_lineage->spilled_args.has_value()) {
+        lineage_to_spill.push_back(task_id);
+      }
+    }
+    lineage_to_spill_.swap(lineage_to_spill);
+  }
+}
+
+void TaskManager::SpillLineageIfNeeded() {
+  const int64_t threshold = RayConfig::instance().task_lineage_spill_threshold_bytes();
+  if (threshold < 0) {
+    return;
+  }
+  while (total_lineage_footprint_bytes_ > threshold && !lineage_to_spill_.empty()) {
+    const auto task_id = lineage_to_spill_.front();
+    auto it = submissible_tasks_.find(task_id);
+    if (it == submissible_tasks_.end() || it->second.compacted_lineage == nullptr ||
+        it->second.compacted_lineage->spilled_args.has_value()) {
+      lineage_to_spill_.pop_front();
+      continue;
+    }
+
+    if (lineage_spill_file_ == nullptr) {
+      std::filesystem::path directory =
+          RayConfig::instance().task_lineage_spill_directory();
+      if (directory.empty()) {
+        std::error_code ec;
+        directory = std::filesystem::temp_directory_path(ec);
+      }
+      lineage_spill_file_ = std::make_unique<LineageSpillFile>(
+          (directory / ("ray_lineage_" + UniqueID::FromRandom().Hex())).string());
+    }
+    auto &lineage = *it->second.compacted_lineage;
+    LineageSpillFile::Record record;
+    auto status = lineage_spill_file_->Append(lineage.args, &record);
+    if (!status.ok()) {
+      RAY_LOG_EVERY_MS(WARNING, 10000)
+          << "Failed to spill task lineage, keeping it in memory: " << status;
+      return;
+    }
+    lineage_to_spill_.pop_front();
+    num_lineage_to_spill_--;
+    const int64_t spilled_bytes = lineage.args.size();
+    lineage.spilled_args = record;
+    std::string().swap(lineage.args);
+    it->second.lineage_footprint_bytes -= spilled_bytes;
+    total_lineage_footprint_bytes_ -= spilled_bytes;
+    RAY_LOG(DEBUG) << "Spilled " << spilled_bytes << " bytes of lineage of task "
+                   << task_id << " to " << lineage_spill_file_->Path();
+  }
+}
+
 int64_t TaskManager::RemoveLineageReference(const ObjectID &object_id,
                                             std::vector<ObjectID> *released_objects) {
   absl::MutexLock lock(&mu_);
@@ -1228,22 +1422,13 @@ int64_t TaskManager::RemoveLineageReference(const ObjectID &object_id,
   if (it->second.reconstructable_return_ids.empty() && !it->second.IsPending()) {
     // If the task can no longer be retried, decrement the lineage ref count
     // for each of the task's args.
-    for (size_t i = 0; i < it->second.spec.NumArgs(); i++) {
-      if (it->second.spec.ArgByRef(i)) {
-        released_objects->push_back(it->second.spec.ArgId(i));
-      } else {
-        const auto &inlined_refs = it->second.spec.ArgInlinedRefs(i);
-        for (const auto &inlined_ref : inlined_refs) {
-          released_objects->push_back(ObjectID::FromBinary(inlined_ref.object_id()));
-        }
-      }
-    }
-
-    if (it->second.spec.IsActorTask()) {
-      // We need to decrement the actor lineage ref count here
-      // since it's incremented during TaskManager::AddPendingTask.
-      const auto actor_creation_return_id = it->second.spec.ActorCreationDummyObjectId();
-      released_objects->push_back(actor_creation_return_id);
+    if (it->second.compacted_lineage != nullptr) {
+      const auto &dependencies = it->second.compacted_lineage->lineage_dependencies;
+      released_objects->insert(
+          released_objects->end(), dependencies.begin(), dependencies.end());
+      ReleaseCompactedLineage(it->second);
+    } else {
+      GetLineageDependencies(it->second.spec, released_objects);
     }
 
     total_lineage_footprint_bytes_ -= it->second.lineage_footprint_bytes;
@@ -1352,12 +1537,39 @@ void TaskManager::MarkTaskReturnObjectsFailed(
 }
 
 absl::optional<TaskSpecification> TaskManager::GetTaskSpec(const TaskID &task_id) const {
-  absl::MutexLock lock(&mu_);
-  auto it = submissible_tasks_.find(task_id);
-  if (it == submissible_tasks_.end()) {
-    return absl::optional<TaskSpecification>();
+  std::shared_ptr<rpc::TaskSpec> message;
+  LineageSpillFile::Record spilled_args;
+  LineageSpillFile *spill_file = nullptr;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = submissible_tasks_.find(task_id);
+    if (it == submissible_tasks_.end()) {
+      return absl::optional<TaskSpecification>();
+    }
+    if (it->second.compacted_lineage == nullptr) {
+      return it->second.spec;
+    }
+    if (!it->second.compacted_lineage->spilled_args.has_value()) {
+      TaskSpecification spec;
+      RAY_CHECK_OK(GetLineageSpec(it->second, /*with_args=*/true, &spec));
+      return spec;
+    }
+    message = GetLineageMessage(it->second);
+    spilled_args = *it->second.compacted_lineage->spilled_args;
+    spill_file = lineage_spill_file_.get();
   }
-  return it->second.spec;
+
+  // Read the spilled arguments without the lock, so that the disk read doesn't block
+  // the other calls.
+  std::string args;
+  auto status = spill_file->Read(spilled_args, &args);
+  if (status.ok()) {
+    RAY_CHECK(message->MergeFromString(args));
+  } else {
+    RAY_LOG(WARNING) << "Failed to restore the arguments of task " << task_id << ": "
+                     << status;
+  }
+  return TaskSpecification(std::move(message));
 }
 
 std::vector<TaskID> TaskManager::GetPendingChildrenTasks(
@@ -1527,7 +1739,11 @@ void TaskManager::FillTaskInfo(rpc::GetCoreWorkerStatsReply *reply,
 
     const auto &task_entry = task_it.second;
     auto entry = reply->add_owned_task_info_entries();
-    const auto &task_spec = task_entry.spec;
+    TaskSpecification task_spec = task_entry.spec;
+    if (task_entry.compacted_lineage != nullptr) {
+      // The arguments aren't needed, so they aren't read back if they were spilled.
+      RAY_CHECK_OK(GetLineageSpec(task_entry, /*with_args=*/false, &task_spec));
+    }
     const auto &task_state = task_entry.GetStatus();
     const auto &node_id = task_entry.GetNodeId();
     rpc::TaskType type;
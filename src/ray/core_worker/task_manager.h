@@ -14,15 +14,20 @@
 
 #pragma once
 
+#include <deque>
+#include <optional>
+
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/id.h"
 #include "ray/common/task/task.h"
+#include "ray/core_worker/lineage_spill_file.h"
 #include "ray/core_worker/store_provider/memory_store/memory_store.h"
 #include "ray/core_worker/task_event_buffer.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/counter_map.h"
+#include "ray/util/intern_pool.h"
 #include "src/ray/protobuf/common.pb.h"
 #include "src/ray/protobuf/core_worker.pb.h"
 #include "src/ray/protobuf/gcs.pb.h"
@@ -325,12 +330,18 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
    *   and the execution resumes.
    * - If a gRPC request fails, the executor assumes all the objects are
    *   consumed and resume execution. (alternatively, we can fail execution).
+   * - Objects may be reported in batches of consecutive indexes. If the
+   *   unconsumed objects exceed the byte credit of the executor, the request
+   *   contains `consumed_index_to_resume`, and the executor blocks until the
+   *   objects before it are consumed.
    *
    * Client Side:
    * - If object_generated - object_consumed < threshold, it sends a reply that
    *   contains `object_consumed` to an executor immediately.
    * - If object_generated - object_consumed > threshold, it doesn't reply
    *   until objects are consumed via TryReadObjectRefStream.
+   * - Likewise, it doesn't reply until the objects before
+   *   `consumed_index_to_resume` are consumed.
    * - If objects are not going to be consumed (e.g., generator is deleted
    *   or objects are already consumed), it replies immediately.
    *
@@ -539,7 +550,9 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   /// \return Whether the task was pending and was marked for cancellation.
   bool MarkTaskCanceled(const TaskID &task_id) override;
 
-  /// Return the spec for a pending task.
+  /// Return the spec for a pending task, or for a finished one whose lineage is kept.
+  /// The arguments of compacted lineage may be read back from disk, so callers that
+  /// only need to know whether a task is pending should use `IsTaskPending`.
   absl::optional<TaskSpecification> GetTaskSpec(const TaskID &task_id) const override;
 
   /// Return specs for pending children tasks of the given parent task.
@@ -615,6 +628,24 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   void RecordMetrics();
 
  private:
+  /// The parts of a task spec that are taken out of it when its lineage is compacted.
+  /// See `CompactLineage`.
+  ///
+  /// The parts are kept serialized as a TaskSpec that only has the given fields set,
+  /// so merging them back into the compacted spec restores the original one.
+  struct CompactedLineage {
+    /// The function descriptor, shared with all the tasks of the same function.
+    std::shared_ptr<const std::string> function_descriptor;
+    /// The runtime env info, shared with all the tasks of the same runtime env.
+    std::shared_ptr<const std::string> runtime_env_info;
+    /// The arguments, unless they were spilled.
+    std::string args;
+    /// Where the arguments were spilled, if they were.
+    std::optional<LineageSpillFile::Record> spilled_args;
+    /// The objects whose lineage to release once the task can't be retried anymore.
+    std::vector<ObjectID> lineage_dependencies;
+  };
+
   struct TaskEntry {
     TaskEntry(const TaskSpecification &spec_arg,
               int num_retries_left_arg,
@@ -676,7 +707,11 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
     /// the worker fails. We could avoid this by either not caching the full
     /// TaskSpec for tasks that cannot be retried (e.g., actor tasks), or by
     /// storing a shared_ptr to a PushTaskRequest protobuf for all tasks.
-    const TaskSpecification spec;
+    /// If `compacted_lineage` is set, some fields of the spec were taken out, and
+    /// `GetLineageSpec` must be used to get the full spec.
+    TaskSpecification spec;
+    /// Set if the task finished and its lineage was compacted.
+    std::unique_ptr<CompactedLineage> compacted_lineage;
     // Number of times this task may be resubmitted. If this reaches 0, then
     // the task entry may be erased.
     int32_t num_retries_left;
@@ -722,6 +757,35 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
                         const NodeID &worker_raylet_id,
                         bool store_in_plasma) ABSL_LOCKS_EXCLUDED(mu_);
 
+  /// Compact the lineage of a finished task that may be retried: the function
+  /// descriptor and the runtime env are interned, and the arguments are serialized so
+  /// they can be spilled. Updates the lineage footprint of the task.
+  void CompactLineage(TaskEntry &task_entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Get the full spec of a task whose lineage was compacted.
+  ///
+  /// \param[in] task_entry The task, whose lineage must be compacted.
+  /// \param[in] with_args Whether to restore the arguments, which may read them back
+  /// from the spill file. If false, the spec has no arguments.
+  /// \param[out] spec The spec of the task.
+  /// \return Error if the spilled arguments couldn't be read.
+  Status GetLineageSpec(const TaskEntry &task_entry,
+                        bool with_args,
+                        TaskSpecification *spec) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Restore the spec message of a task whose lineage is compacted, without the
+  /// arguments.
+  std::shared_ptr<rpc::TaskSpec> GetLineageMessage(const TaskEntry &task_entry) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Drop the compacted lineage of a task, releasing its spilled arguments.
+  void ReleaseCompactedLineage(TaskEntry &task_entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Spill the arguments of the oldest compacted lineage until the lineage in memory
+  /// is below task_lineage_spill_threshold_bytes.
+  void SpillLineageIfNeeded() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Remove a lineage reference to this object ID. This should be called
   /// whenever a task that depended on this object ID can no longer be retried.
   ///
@@ -828,10 +892,18 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
   absl::flat_hash_map<ObjectID, ObjectRefStream> object_ref_streams_
       ABSL_GUARDED_BY(object_ref_stream_ops_mu_);
 
+  /// A signal callback held until the executor may resume.
+  struct HeldExecutionSignal {
+    /// The objects of index lower than this must be consumed before the executor
+    /// resumes, on top of the backpressure threshold of the task. 0 if none.
+    int64_t consumed_index_to_resume;
+    ExecutionSignalCallback callback;
+  };
+
   /// The consumer side of object ref stream should signal the executor
   /// to resume execution via signal callbacks (i.e., RPC reply).
   /// This data structure maintains the mapping of ObjectRefStreamID -> signal_callbacks
-  absl::flat_hash_map<ObjectID, std::vector<ExecutionSignalCallback>>
+  absl::flat_hash_map<ObjectID, std::vector<HeldExecutionSignal>>
       ref_stream_execution_signal_callbacks_ ABSL_GUARDED_BY(object_ref_stream_ops_mu_);
 
   /// Callback to store objects in plasma. This is used for objects that were
@@ -877,6 +949,21 @@ class TaskManager : public TaskFinisherInterface, public TaskResubmissionInterfa
 
   int64_t total_lineage_footprint_bytes_ ABSL_GUARDED_BY(mu_) = 0;
 
+  /// Shares the function descriptors and runtime envs of the compacted lineage.
+  InternPool<std::string> lineage_fragments_;
+
+  /// The file that the compacted lineage is spilled to, created on the first spill.
+  /// Once created, it lives as long as the task manager, so it can be read without
+  /// holding `mu_`.
+  std::unique_ptr<LineageSpillFile> lineage_spill_file_ ABSL_GUARDED_BY(mu_);
+
+  /// The tasks whose compacted lineage may be spilled, oldest first. Tasks whose
+  /// lineage was released or restored since are skipped.
+  std::deque<TaskID> lineage_to_spill_ ABSL_GUARDED_BY(mu_);
+
+  /// Number of tasks in `lineage_to_spill_` whose lineage is still in memory.
+  size_t num_lineage_to_spill_ ABSL_GUARDED_BY(mu_) = 0;
+
   /// Optional shutdown hook to call when pending tasks all finish.
   std::function<void()> shutdown_hook_ ABSL_GUARDED_BY(mu_) = nullptr;
 
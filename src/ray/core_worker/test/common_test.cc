@@ -0,0 +1,68 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/common.h"
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+const std::string kArgData(10 * 1024, 'x');
+
+std::string DataOf(const RayObject &object) {
+  return std::string(reinterpret_cast<const char *>(object.GetData()->Data()),
+                     object.GetData()->Size());
+}
+
+}  // namespace
+
+TEST(CoreWorkerCommonTest, TestZeroCopyArgOutlivesTaskSpec) {
+  rpc::TaskSpec message;
+  message.add_args()->set_data(kArgData);
+  std::shared_ptr<RayObject> arg;
+  {
+    TaskSpecification task(std::move(message));
+    arg = CreateInlinedArgForExecutor(
+        task, /*arg_index=*/0, /*zero_copy=*/true, /*copy_data=*/true);
+    // The arg points into the task spec, unless the data happens to be misaligned.
+    if (reinterpret_cast<uintptr_t>(task.ArgData(0)) % alignof(std::max_align_t) == 0) {
+      ASSERT_EQ(arg->GetData()->Data(), task.ArgData(0));
+    }
+  }
+  // The task spec is still alive, held by the arg.
+  ASSERT_EQ(DataOf(*arg), kArgData);
+}
+
+TEST(CoreWorkerCommonTest, TestCopiedArgOutlivesTaskSpec) {
+  rpc::TaskSpec message;
+  message.add_args()->set_data(kArgData);
+  message.mutable_args(0)->set_metadata("meta");
+  std::shared_ptr<RayObject> arg;
+  {
+    TaskSpecification task(std::move(message));
+    arg = CreateInlinedArgForExecutor(
+        task, /*arg_index=*/0, /*zero_copy=*/false, /*copy_data=*/true);
+    ASSERT_NE(arg->GetData()->Data(), task.ArgData(0));
+  }
+  ASSERT_EQ(DataOf(*arg), kArgData);
+  ASSERT_EQ(std::string(reinterpret_cast<const char *>(arg->GetMetadata()->Data()),
+                        arg->GetMetadata()->Size()),
+            "meta");
+}
+
+}  // namespace core
+}  // namespace ray
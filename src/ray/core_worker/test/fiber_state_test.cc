@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <boost/fiber/all.hpp>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "ray/core_worker/fiber.h"
@@ -95,6 +96,28 @@ TEST(FiberStateTest, RespectsConcurrencyLimit) {
   fiber_state.Join();
 }
 
+TEST(FiberStateTest, StartsTasksInOrder) {
+  FiberState fiber_state(1);
+  TotalCounter total_counter;
+  std::vector<int> order;
+
+  for (int i = 0; i < 100; ++i) {
+    fiber_state.EnqueueFiber([&, i]() {
+      order.push_back(i);
+      boost::this_fiber::yield();
+      total_counter.increment();
+    });
+  }
+
+  total_counter.wait_for(100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+
+  fiber_state.Stop();
+  fiber_state.Join();
+}
+
 TEST(FiberStateTest, DoubleStopJoin) {
   FiberState fiber_state(2);
   fiber_state.Stop();
@@ -121,6 +121,58 @@ TEST(GeneratorWaiterTest, TestLargerThreshold) {
   t3.join();
 }
 
+TEST(GeneratorWaiterTest, TestByteCredit) {
+  std::shared_ptr<GeneratorBackpressureWaiter> waiter =
+      std::make_shared<GeneratorBackpressureWaiter>(
+          -1,
+          /*check_signals*/ []() { return Status::OK(); },
+          /*generator_backpressure_num_bytes*/ 100);
+
+  auto wait = [waiter]() {
+    auto status = waiter->WaitUntilObjectConsumed();
+    ASSERT_TRUE(status.ok());
+  };
+
+  // 60 bytes unconsumed, under the credit.
+  waiter->IncrementObjectGenerated(0, 60);
+  ASSERT_FALSE(waiter->IsBackpressured());
+  ASSERT_EQ(waiter->ConsumedIndexToResume(), 0);
+  std::thread t1(wait);
+  t1.join();
+
+  // 120 bytes unconsumed. Consuming the first object is enough to resume.
+  waiter->IncrementObjectGenerated(1, 60);
+  ASSERT_TRUE(waiter->IsBackpressured());
+  ASSERT_EQ(waiter->ConsumedIndexToResume(), 1);
+  std::thread t2(wait);
+  waiter->HandleObjectReported(1);
+  ASSERT_FALSE(waiter->IsBackpressured());
+  t2.join();
+
+  // A single object larger than the credit must be consumed to resume.
+  waiter->IncrementObjectGenerated(2, 200);
+  ASSERT_EQ(waiter->ConsumedIndexToResume(), 3);
+  std::thread t3(wait);
+  waiter->HandleObjectReported(2);
+  ASSERT_TRUE(waiter->IsBackpressured());
+  waiter->HandleObjectReported(3);
+  t3.join();
+}
+
+TEST(GeneratorWaiterTest, TestBatchReported) {
+  std::shared_ptr<GeneratorBackpressureWaiter> waiter =
+      std::make_shared<GeneratorBackpressureWaiter>(
+          -1,
+          /*check_signals*/ []() { return Status::OK(); });
+
+  // Three objects reported in one batch are acked at once.
+  waiter->IncrementObjectGenerated(0, 1);
+  waiter->IncrementObjectGenerated(1, 1);
+  waiter->IncrementObjectGenerated(2, 1);
+  waiter->HandleObjectReported(0, /*num_objects*/ 3);
+  ASSERT_TRUE(waiter->WaitAllObjectsReported().ok());
+}
+
 TEST(GeneratorWaiterTest, TestSignalFailure) {
   std::shared_ptr<std::atomic<bool>> signal_failed =
       std::make_shared<std::atomic<bool>>(false);
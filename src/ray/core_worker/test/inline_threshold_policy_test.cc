@@ -0,0 +1,115 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/inline_threshold_policy.h"
+
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace core {
+
+using Consumer = InlineThresholdPolicy::Consumer;
+
+constexpr int64_t kStaticThreshold = 100 * 1024;
+constexpr int64_t kMaxThreshold = 10 * 1024 * 1024;
+
+TEST(InlineThresholdPolicyTest, TestStaticThresholdOutsideBand) {
+  InlineThresholdPolicy policy(
+      kStaticThreshold, kMaxThreshold, /*band_factor=*/2, absl::Milliseconds(10));
+  // Much smaller or much larger objects aren't affected by their consumer.
+  for (auto consumer : {Consumer::kLocal, Consumer::kRemote, Consumer::kUnknown}) {
+    ASSERT_EQ(policy.ObserveAndGetThreshold("small", 1024, consumer), kStaticThreshold);
+    ASSERT_EQ(policy.ObserveAndGetThreshold("large", 1024 * 1024, consumer),
+              kStaticThreshold);
+  }
+}
+
+TEST(InlineThresholdPolicyTest, TestConsumerInsideBand) {
+  InlineThresholdPolicy policy(
+      kStaticThreshold, kMaxThreshold, /*band_factor=*/2, absl::Milliseconds(10));
+  // Objects slightly larger than the static threshold are inlined for remote
+  // consumers, and objects slightly smaller are put into plasma for local ones.
+  const int64_t size = kStaticThreshold + 1024;
+  ASSERT_GT(policy.ObserveAndGetThreshold("f|remote", size, Consumer::kRemote), size);
+  ASSERT_LE(policy.ObserveAndGetThreshold("f|local", size - 2048, Consumer::kLocal),
+            size - 2048);
+  ASSERT_EQ(policy.ObserveAndGetThreshold("f|unknown", size, Consumer::kUnknown),
+            kStaticThreshold);
+}
+
+TEST(InlineThresholdPolicyTest, TestMovingAverage) {
+  InlineThresholdPolicy policy(
+      kStaticThreshold, kMaxThreshold, /*band_factor=*/2, absl::Milliseconds(10));
+  // A single small object doesn't move the key out of the band.
+  for (int i = 0; i < 10; i++) {
+    policy.ObserveAndGetThreshold("f", kStaticThreshold, Consumer::kRemote);
+  }
+  ASSERT_GT(policy.ObserveAndGetThreshold("f", 1024, Consumer::kRemote),
+            kStaticThreshold);
+  // But many of them do.
+  for (int i = 0; i < 20; i++) {
+    policy.ObserveAndGetThreshold("f", 1024, Consumer::kRemote);
+  }
+  ASSERT_EQ(policy.ObserveAndGetThreshold("f", 1024, Consumer::kRemote),
+            kStaticThreshold);
+}
+
+TEST(InlineThresholdPolicyTest, TestPlasmaPressure) {
+  InlineThresholdPolicy policy(
+      kStaticThreshold, kMaxThreshold, /*band_factor=*/2, absl::Milliseconds(10));
+  const int64_t size = kStaticThreshold + 1024;
+  ASSERT_FALSE(policy.PlasmaUnderPressure());
+  ASSERT_EQ(policy.ObserveAndGetThreshold("f", size, Consumer::kUnknown),
+            kStaticThreshold);
+  for (int i = 0; i < 20; i++) {
+    policy.RecordPlasmaCreateLatency(absl::Milliseconds(50));
+  }
+  ASSERT_TRUE(policy.PlasmaUnderPressure());
+  // Under pressure, objects near the threshold are inlined even for local consumers.
+  ASSERT_GT(policy.ObserveAndGetThreshold("f", size, Consumer::kUnknown), size);
+  ASSERT_GT(policy.ObserveAndGetThreshold("g", size, Consumer::kLocal), size);
+  for (int i = 0; i < 50; i++) {
+    policy.RecordPlasmaCreateLatency(absl::Microseconds(100));
+  }
+  ASSERT_FALSE(policy.PlasmaUnderPressure());
+}
+
+TEST(InlineThresholdPolicyTest, TestMaxThreshold) {
+  InlineThresholdPolicy policy(kStaticThreshold,
+                               /*max_threshold=*/kStaticThreshold + 1024,
+                               /*band_factor=*/2,
+                               absl::Milliseconds(10));
+  // The threshold never exceeds the limit of inlined bytes.
+  ASSERT_EQ(policy.ObserveAndGetThreshold("f", kStaticThreshold, Consumer::kRemote),
+            kStaticThreshold + 1024);
+}
+
+TEST(InlineThresholdPolicyTest, TestMaxKeys) {
+  InlineThresholdPolicy policy(kStaticThreshold,
+                               kMaxThreshold,
+                               /*band_factor=*/2,
+                               absl::Milliseconds(10),
+                               /*max_keys=*/1);
+  const int64_t size = kStaticThreshold + 1024;
+  const int64_t large_size = kStaticThreshold * 4;
+  ASSERT_EQ(policy.ObserveAndGetThreshold("f", large_size, Consumer::kRemote),
+            kStaticThreshold);
+  // A new key evicts the least recently seen one.
+  ASSERT_GT(policy.ObserveAndGetThreshold("g", size, Consumer::kRemote), size);
+  // "f" starts over from this object, instead of averaging it with the large one.
+  ASSERT_GT(policy.ObserveAndGetThreshold("f", size, Consumer::kRemote), size);
+}
+
+}  // namespace core
+}  // namespace ray
@@ -562,6 +562,49 @@ TEST_F(ReferenceCountTest, TestBasic) {
   out.clear();
 }
 
+// Tests that the batched updates of the submit path have the same effect as the
+// per-object ones.
+TEST_F(ReferenceCountTest, TestBatchedSubmitUpdates) {
+  std::vector<ObjectID> out;
+  rpc::Address address;
+  address.set_ip_address("1234");
+  ObjectID id1 = ObjectID::FromRandom();
+  ObjectID id2 = ObjectID::FromRandom();
+  ObjectID return_id1 = ObjectID::FromRandom();
+  ObjectID return_id2 = ObjectID::FromRandom();
+
+  // The arguments were put with an initial local ref.
+  rc->AddOwnedObject(id1, {}, address, "", 0, false, /*add_local_ref=*/true);
+  rc->AddOwnedObject(id2, {}, address, "", 0, false, /*add_local_ref=*/true);
+  rc->AddSubmittedTaskReferences({return_id1, return_id2},
+                                 address,
+                                 "call_site",
+                                 /*is_reconstructable=*/true,
+                                 {return_id1, return_id2},
+                                 {id1, id2, id1});
+  ASSERT_EQ(rc->NumObjectIDsInScope(), 4);
+  ASSERT_TRUE(rc->OwnedByUs(return_id1));
+  ASSERT_TRUE(rc->IsObjectPendingCreation(return_id1));
+  ASSERT_TRUE(rc->IsObjectPendingCreation(return_id2));
+
+  // The initial local refs of the arguments are released once submitted. Nil IDs are
+  // skipped.
+  rc->RemoveLocalReferences({id1, ObjectID::Nil(), id2}, &out);
+  ASSERT_EQ(rc->NumObjectIDsInScope(), 4);
+  ASSERT_TRUE(out.empty());
+
+  rc->UpdateFinishedTaskReferences(
+      {return_id1, return_id2}, {id1, id2, id1}, true, empty_borrower, empty_refs, &out);
+  ASSERT_FALSE(rc->IsObjectPendingCreation(return_id1));
+  ASSERT_EQ(rc->NumObjectIDsInScope(), 2);
+  ASSERT_EQ(out.size(), 2);
+
+  // The local refs of the returns were added for the language frontend.
+  rc->RemoveLocalReferences({return_id1, return_id2}, &out);
+  ASSERT_EQ(rc->NumObjectIDsInScope(), 0);
+  ASSERT_EQ(out.size(), 4);
+}
+
 TEST_F(ReferenceCountTest, TestUnreconstructableObjectOutOfScope) {
   ObjectID id = ObjectID::FromRandom();
   rpc::Address address;
@@ -18,6 +18,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
@@ -178,6 +179,21 @@ class TaskEventBufferTestLimitProfileEvents : public TaskEventBufferTest {
   }
 };
 
+class TaskEventBufferTestStaging : public TaskEventBufferTest {
+ public:
+  TaskEventBufferTestStaging() : TaskEventBufferTest() {
+    RayConfig::instance().initialize(
+        R"(
+{
+  "task_events_report_interval_ms": 1000,
+  "task_events_max_num_status_events_buffer_on_worker": 100,
+  "task_events_send_batch_size": 100,
+  "task_events_thread_local_buffer_size": 4
+}
+  )");
+  }
+};
+
 void ReadContentFromFile(std::vector<std::string> &vc,
                          std::string log_file,
                          std::string filter = "") {
@@ -559,6 +575,105 @@ TEST_F(TaskEventBufferTest, TestGracefulDestruction) {
   delete task_event_buffer_.release();
 }
 
+TEST_F(TaskEventBufferTestStaging, TestAddEventStaged) {
+  auto task_id = RandomTaskId();
+  task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(task_id, 0));
+  task_event_buffer_->AddTaskEvent(GenProfileTaskEvent(task_id, 0));
+
+  // Events are only moved to the buffer when staging buffers are drained.
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 0);
+  task_event_buffer_->DrainStagingBuffers();
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 2);
+}
+
+TEST_F(TaskEventBufferTestStaging, TestMergeStatusEventsOfSameAttempt) {
+  auto task_id = RandomTaskId();
+  auto node_id = NodeID::FromRandom();
+  auto worker_id = WorkerID::FromRandom();
+  std::vector<std::unique_ptr<TaskEvent>> status_events;
+  status_events.push_back(std::make_unique<TaskStatusEvent>(
+      task_id, JobID::FromInt(0), 0, rpc::TaskStatus::PENDING_ARGS_AVAIL, 1));
+  status_events.push_back(std::make_unique<TaskStatusEvent>(
+      task_id,
+      JobID::FromInt(0),
+      0,
+      rpc::TaskStatus::SUBMITTED_TO_WORKER,
+      2,
+      nullptr,
+      TaskStatusEvent::TaskStateUpdate(node_id, worker_id)));
+  status_events.push_back(std::make_unique<TaskStatusEvent>(
+      task_id, JobID::FromInt(0), 0, rpc::TaskStatus::RUNNING, 3));
+
+  // The expected data is the same as converting all events without merging.
+  rpc::TaskEventData expected_data;
+  expected_data.set_num_profile_events_dropped(0);
+  auto expected_events = expected_data.add_events_by_task();
+  for (const auto &event_ptr : status_events) {
+    auto event = std::make_unique<TaskStatusEvent>(
+        *static_cast<TaskStatusEvent *>(event_ptr.get()));
+    event->ToRpcTaskEvents(expected_events);
+  }
+
+  for (auto &event : status_events) {
+    task_event_buffer_->AddTaskEvent(std::move(event));
+  }
+  task_event_buffer_->DrainStagingBuffers();
+
+  // All status events of the attempt take a single slot.
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 1);
+  ASSERT_EQ(task_event_buffer_->GetTotalNumStatusTaskEventsMerged(), 2);
+
+  auto task_gcs_accessor =
+      static_cast<ray::gcs::MockGcsClient *>(task_event_buffer_->GetGcsClient())
+          ->mock_task_accessor;
+  EXPECT_CALL(*task_gcs_accessor, AsyncAddTaskEventData(_, _))
+      .WillOnce([&](std::unique_ptr<rpc::TaskEventData> actual_data,
+                    ray::gcs::StatusCallback callback) {
+        CompareTaskEventData(*actual_data, expected_data);
+        return Status::OK();
+      });
+
+  task_event_buffer_->FlushEvents(false);
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 0);
+}
+
+TEST_F(TaskEventBufferTestStaging, TestStagingOverflowFallback) {
+  size_t num_events = 10;
+  size_t staging_buffer_capacity = 4;  // sync with setup
+  for (size_t i = 0; i < num_events; ++i) {
+    task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(RandomTaskId(), 0));
+  }
+
+  // Events that don't fit in the staging buffer are added to the buffer directly.
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(),
+            num_events - staging_buffer_capacity);
+  task_event_buffer_->DrainStagingBuffers();
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), num_events);
+  ASSERT_EQ(task_event_buffer_->GetTotalNumStatusTaskEventsDropped(), 0);
+}
+
+TEST_F(TaskEventBufferTestStaging, TestStagingFromExitedThread) {
+  std::thread producer([this]() {
+    task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(RandomTaskId(), 0));
+    task_event_buffer_->AddTaskEvent(GenStatusTaskEvent(RandomTaskId(), 0));
+  });
+  producer.join();
+
+  {
+    absl::MutexLock lock(&task_event_buffer_->staging_mutex_);
+    ASSERT_EQ(task_event_buffer_->staging_buffers_.size(), 1);
+  }
+
+  // Events staged by the exited thread are not lost, and its staging buffer is
+  // released after being drained.
+  task_event_buffer_->DrainStagingBuffers();
+  ASSERT_EQ(task_event_buffer_->GetNumTaskEventsStored(), 2);
+  {
+    absl::MutexLock lock(&task_event_buffer_->staging_mutex_);
+    ASSERT_TRUE(task_event_buffer_->staging_buffers_.empty());
+  }
+}
+
 }  // namespace worker
 
 }  // namespace core
@@ -14,6 +14,8 @@
 
 #include "ray/core_worker/task_manager.h"
 
+#include <filesystem>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mock/ray/gcs/gcs_client/gcs_client.h"
@@ -156,6 +158,15 @@ class TaskManagerTest : public ::testing::Test {
     ASSERT_EQ(manager_.total_lineage_footprint_bytes_, 0);
   }
 
+  /// Live bytes of the lineage spill file, or -1 if nothing was spilled yet.
+  int64_t LineageSpillFileLiveBytes() {
+    absl::MutexLock lock(&manager_.mu_);
+    if (manager_.lineage_spill_file_ == nullptr) {
+      return -1;
+    }
+    return manager_.lineage_spill_file_->LiveBytes();
+  }
+
   void CompletePendingStreamingTask(const TaskSpecification &spec,
                                     const rpc::Address &caller_address,
                                     int64_t num_streaming_generator_returns,
@@ -1009,6 +1020,87 @@ TEST_F(TaskManagerLineageTest, TestResubmitTask) {
   ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
 }
 
+// Test that the lineage of a finished task is compacted and spilled, and that the
+// full spec is restored when the task is resubmitted.
+TEST_F(TaskManagerLineageTest, TestResubmitCompactedLineage) {
+  RayConfig::instance().initialize(
+      R"({"task_lineage_compaction_enabled": true,
+          "task_lineage_spill_threshold_bytes": 0})");
+  rpc::Address caller_address;
+  ObjectID dep1 = ObjectID::FromRandom();
+  ObjectID dep2 = ObjectID::FromRandom();
+  auto spec = CreateTaskHelper(1, {dep1, dep2});
+  spec.GetMutableMessage()
+      .mutable_function_descriptor()
+      ->mutable_python_function_descriptor()
+      ->set_function_name("f");
+  auto return_id = spec.ReturnId(0);
+  manager_.AddPendingTask(caller_address, spec, "", /*max_retries=*/3);
+  manager_.MarkDependenciesResolved(spec.TaskId());
+  manager_.MarkTaskWaitingForExecution(
+      spec.TaskId(), NodeID::FromRandom(), WorkerID::FromRandom());
+  rpc::PushTaskReply reply;
+  auto return_object = reply.add_return_objects();
+  return_object->set_object_id(return_id.Binary());
+  auto data = GenerateRandomBuffer();
+  return_object->set_data(data->Data(), data->Size());
+  return_object->set_in_plasma(true);
+  manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+
+  // The arguments were spilled, and the rest of the lineage is smaller than the spec.
+  ASSERT_GT(manager_.TotalLineageFootprintBytes(), 0);
+  ASSERT_LT(manager_.TotalLineageFootprintBytes(),
+            static_cast<int64_t>(spec.GetMessage().ByteSizeLong()));
+  ASSERT_GT(LineageSpillFileLiveBytes(), 0);
+  ASSERT_TRUE(*manager_.GetTaskSpec(spec.TaskId()) == spec);
+
+  std::vector<ObjectID> resubmitted_task_deps;
+  ASSERT_TRUE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
+  ASSERT_EQ(resubmitted_task_deps, spec.GetDependencyIds());
+  ASSERT_EQ(num_retries_, 1);
+  ASSERT_TRUE(*manager_.GetTaskSpec(spec.TaskId()) == spec);
+  ASSERT_EQ(LineageSpillFileLiveBytes(), 0);
+
+  // The resubmitted task finishes, and its lineage is released once the return ID
+  // goes out of scope.
+  manager_.CompletePendingTask(spec.TaskId(), reply, rpc::Address(), false);
+  reference_counter_->RemoveLocalReference(return_id, nullptr);
+  ASSERT_FALSE(manager_.ResubmitTask(spec.TaskId(), &resubmitted_task_deps));
+  ASSERT_EQ(reference_counter_->NumObjectIDsInScope(), 0);
+  ASSERT_EQ(LineageSpillFileLiveBytes(), 0);
+  RayConfig::instance().initialize(
+      R"({"task_lineage_compaction_enabled": false,
+          "task_lineage_spill_threshold_bytes": -1})");
+}
+
+// Test that a spilled record can be read after it's released, until the file is
+// truncated.
+TEST(LineageSpillFileTest, TestReadReleasedRecord) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    ("ray_lineage_" + UniqueID::FromRandom().Hex());
+  LineageSpillFile file(path.string());
+  LineageSpillFile::Record first;
+  LineageSpillFile::Record second;
+  ASSERT_TRUE(file.Append("first", &first).ok());
+  ASSERT_TRUE(file.Append("second", &second).ok());
+  file.Release(first);
+  std::string data;
+  ASSERT_TRUE(file.Read(first, &data).ok());
+  ASSERT_EQ(data, "first");
+
+  // Once all the records are released, the file is truncated, and the space of the
+  // released records is reused.
+  file.Release(second);
+  ASSERT_EQ(file.FileBytes(), 0);
+  LineageSpillFile::Record third;
+  ASSERT_TRUE(file.Append("third", &third).ok());
+  ASSERT_EQ(third.offset, first.offset);
+  ASSERT_TRUE(file.Read(first, &data).IsNotFound());
+  ASSERT_TRUE(file.Read(third, &data).ok());
+  ASSERT_EQ(data, "third");
+  file.Release(third);
+}
+
 // Test resubmission for a task that was successfully executed once and stored
 // its return values in plasma. On re-execution, the task's return values
 // should be stored in plasma again, even if the worker returns its values
@@ -2351,6 +2443,63 @@ TEST_F(TaskManagerTest, TestObjectRefStreamBackpressure) {
   /// No need to test out of order case. It won't be different.
 }
 
+TEST_F(TaskManagerTest, TestObjectRefStreamBatchedReport) {
+  /**
+   * Test a report of a batch of objects writes them at consecutive indexes.
+   * Test the RPC is not replied until the objects before
+   * consumed_index_to_resume are consumed.
+   */
+  auto spec =
+      CreateTaskHelper(1, {}, /*dynamic_returns=*/true, /*is_streaming_generator=*/true);
+  auto generator_id = spec.ReturnId(0);
+  rpc::Address caller_address;
+  manager_.AddPendingTask(caller_address, spec, "", 0);
+
+  std::vector<ObjectID> dynamic_return_ids;
+  for (int i = 0; i < 3; i++) {
+    dynamic_return_ids.push_back(ObjectID::FromIndex(spec.TaskId(), i + 2));
+  }
+  auto req = GetIntermediateTaskReturn(
+      /*idx*/ 0,
+      /*finished*/ false,
+      generator_id,
+      /*dynamic_return_id*/ dynamic_return_ids[0],
+      /*data*/ GenerateRandomBuffer(),
+      /*set_in_plasma*/ false);
+  for (int i = 1; i < 3; i++) {
+    auto data = GenerateRandomBuffer();
+    auto dynamic_return_object = req.add_dynamic_return_objects();
+    dynamic_return_object->set_object_id(dynamic_return_ids[i].Binary());
+    dynamic_return_object->set_data(data->Data(), data->Size());
+  }
+  // The executor is out of byte credit until the first 2 objects are consumed.
+  req.set_consumed_index_to_resume(2);
+  bool signal_called = false;
+  ASSERT_TRUE(manager_.HandleReportGeneratorItemReturns(
+      req,
+      /*execution_signal_callback*/ [&signal_called](Status status,
+                                                     int64_t num_objects_consumed) {
+        signal_called = true;
+        ASSERT_TRUE(status.ok());
+        ASSERT_EQ(num_objects_consumed, 2);
+      }));
+  ASSERT_FALSE(signal_called);
+
+  for (int i = 0; i < 2; i++) {
+    ObjectID obj_id;
+    ASSERT_TRUE(manager_.TryReadObjectRefStream(generator_id, &obj_id).ok());
+    ASSERT_EQ(obj_id, dynamic_return_ids[i]);
+    // Only the second read consumes enough objects.
+    ASSERT_EQ(signal_called, i == 1);
+  }
+  ObjectID obj_id;
+  ASSERT_TRUE(manager_.TryReadObjectRefStream(generator_id, &obj_id).ok());
+  ASSERT_EQ(obj_id, dynamic_return_ids[2]);
+
+  CompletePendingStreamingTask(spec, caller_address, 3);
+  manager_.TryDelObjectRefStream(generator_id);
+}
+
 TEST_F(TaskManagerTest, TestBackpressureAfterReconstruction) {
   // Consumed objects should be signaled immediately.
   // Unconsumed objects should not be.
@@ -0,0 +1,148 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/work_stealing_executor.h"
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "gtest/gtest.h"
+
+namespace ray {
+namespace core {
+
+TEST(WorkStealingExecutorTest, TestRunsAllTasks) {
+  WorkStealingExecutor executor(4);
+  const int num_tasks = 10000;
+  std::atomic<int> num_run{0};
+  absl::BlockingCounter done(num_tasks);
+  for (int i = 0; i < num_tasks; i++) {
+    executor.Post([&num_run, &done]() {
+      num_run++;
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  ASSERT_EQ(num_run, num_tasks);
+}
+
+TEST(WorkStealingExecutorTest, TestSingleThreadOrder) {
+  WorkStealingExecutor executor(1);
+  std::vector<int> order;
+  std::promise<void> done;
+  // Tasks posted from outside run in order, and tasks posted by a task run first.
+  executor.Post([&]() {
+    order.push_back(0);
+    executor.Post([&]() { order.push_back(2); });
+    executor.Post([&]() { order.push_back(1); });
+  });
+  executor.Post([&]() { order.push_back(3); });
+  executor.Post([&]() {
+    order.push_back(4);
+    done.set_value();
+  });
+  done.get_future().get();
+  ASSERT_EQ(order, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST(WorkStealingExecutorTest, TestStealing) {
+  WorkStealingExecutor executor(2);
+  // A task posted by a thread is stolen by the other one while the first is blocked.
+  std::promise<void> stolen;
+  std::promise<void> done;
+  executor.Post([&]() {
+    executor.Post([&]() { stolen.set_value(); });
+    stolen.get_future().wait();
+    done.set_value();
+  });
+  ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+}
+
+TEST(WorkStealingExecutorTest, TestStolenTasksRunInOrder) {
+  WorkStealingExecutor executor(2);
+  // Block both threads, so that the posted tasks are queued on both deques.
+  std::promise<void> release_first;
+  std::promise<void> release_second;
+  std::promise<void> first_running;
+  std::promise<void> second_running;
+  executor.Post([&]() {
+    first_running.set_value();
+    release_first.get_future().wait();
+  });
+  executor.Post([&]() {
+    second_running.set_value();
+    release_second.get_future().wait();
+  });
+  first_running.get_future().wait();
+  second_running.get_future().wait();
+
+  const int num_tasks = 10;
+  std::vector<int> order;
+  std::promise<void> done;
+  for (int i = 0; i < num_tasks; i++) {
+    executor.Post([&, i]() {
+      order.push_back(i);
+      if (static_cast<int>(order.size()) == num_tasks) {
+        done.set_value();
+      }
+    });
+  }
+  // The released thread runs the tasks of its own deque, then steals the others.
+  release_first.set_value();
+  done.get_future().wait();
+  release_second.set_value();
+  // The tasks of each deque ran in the order they were posted.
+  for (int parity : {0, 1}) {
+    std::vector<int> deque_order;
+    for (int i : order) {
+      if (i % 2 == parity) {
+        deque_order.push_back(i);
+      }
+    }
+    ASSERT_TRUE(std::is_sorted(deque_order.begin(), deque_order.end()));
+  }
+}
+
+TEST(WorkStealingExecutorTest, TestJoinRunsQueuedTasks) {
+  std::atomic<int> num_run{0};
+  WorkStealingExecutor executor(2, /*pin_threads=*/true);
+  for (int i = 0; i < 1000; i++) {
+    executor.Post([&num_run]() { num_run++; });
+  }
+  executor.Join();
+  ASSERT_EQ(num_run, 1000);
+}
+
+TEST(WorkStealingExecutorTest, TestStopDropsQueuedTasks) {
+  WorkStealingExecutor executor(1);
+  std::promise<void> running;
+  std::promise<void> release;
+  std::atomic<int> num_run{0};
+  executor.Post([&]() {
+    running.set_value();
+    release.get_future().wait();
+  });
+  running.get_future().wait();
+  executor.Post([&num_run]() { num_run++; });
+  executor.Stop();
+  release.set_value();
+  executor.Join();
+  ASSERT_EQ(num_run, 0);
+}
+
+}  // namespace core
+}  // namespace ray
@@ -957,7 +957,7 @@ Status ActorTaskSubmitter::CancelTask(TaskSpecification task_spec, bool recursiv
 
                          // Keep retrying every 2 seconds until a task is officially
                          // finished.
-                         if (!GetTaskFinisherWithoutMu().GetTaskSpec(task_id)) {
+                         if (!GetTaskFinisherWithoutMu().IsTaskPending(task_id)) {
                            // Task is already finished.
                            RAY_LOG(DEBUG).WithField(task_spec.TaskId())
                                << "Task is finished. Stop a cancel request.";
@@ -16,6 +16,7 @@
 
 #include "ray/core_worker/fiber.h"
 #include "ray/core_worker/transport/thread_pool.h"
+#include "ray/core_worker/transport/work_stealing_executor.h"
 
 namespace ray {
 namespace core {
@@ -104,6 +105,7 @@ void ConcurrencyGroupManager<ExecutorType>::Stop() {
 
 template class ConcurrencyGroupManager<FiberState>;
 template class ConcurrencyGroupManager<BoundedExecutor>;
+template class ConcurrencyGroupManager<WorkStealingExecutor>;
 
 }  // namespace core
 }  // namespace ray
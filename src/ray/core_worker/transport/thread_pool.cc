@@ -16,16 +16,37 @@
 
 #include <boost/asio/post.hpp>
 
+#include "ray/common/ray_config.h"
+
 namespace ray {
 namespace core {
 
-BoundedExecutor::BoundedExecutor(int max_concurrency) : pool_(max_concurrency){};
+BoundedExecutor::BoundedExecutor(int max_concurrency) {
+  if (RayConfig::instance().actor_executor_work_stealing_enabled()) {
+    work_stealing_executor_ = std::make_unique<WorkStealingExecutor>(
+        max_concurrency, RayConfig::instance().actor_executor_pin_threads());
+  } else {
+    pool_ = std::make_unique<boost::asio::thread_pool>(max_concurrency);
+  }
+};
 
 /// Stop the thread pool.
-void BoundedExecutor::Stop() { pool_.stop(); }
+void BoundedExecutor::Stop() {
+  if (work_stealing_executor_) {
+    work_stealing_executor_->Stop();
+  } else {
+    pool_->stop();
+  }
+}
 
 /// Join the thread pool.
-void BoundedExecutor::Join() { pool_.join(); }
+void BoundedExecutor::Join() {
+  if (work_stealing_executor_) {
+    work_stealing_executor_->Join();
+  } else {
+    pool_->join();
+  }
+}
 
 }  // namespace core
 }  // namespace ray
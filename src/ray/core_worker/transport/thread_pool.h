@@ -18,6 +18,7 @@
 #include <boost/asio/thread_pool.hpp>
 #include <boost/thread.hpp>
 #include <list>
+#include <memory>
 #include <queue>
 #include <set>
 #include <utility>
@@ -27,12 +28,16 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/task/task_spec.h"
+#include "ray/core_worker/transport/work_stealing_executor.h"
 
 namespace ray {
 namespace core {
 
 /// Wraps a thread-pool to block posts until the pool has free slots. This is used
 /// by the SchedulingQueue to provide backpressure to clients.
+///
+/// The pool is a `WorkStealingExecutor` if `actor_executor_work_stealing_enabled` is
+/// set, and a `boost::asio::thread_pool` otherwise.
 class BoundedExecutor {
  public:
   static bool NeedDefaultExecutor(int32_t max_concurrency_in_default_group) {
@@ -43,7 +48,13 @@ class BoundedExecutor {
   explicit BoundedExecutor(int max_concurrency);
 
   /// Posts work to the pool
-  void Post(std::function<void()> fn) { boost::asio::post(pool_, std::move(fn)); }
+  void Post(std::function<void()> fn) {
+    if (work_stealing_executor_) {
+      work_stealing_executor_->Post(std::move(fn));
+    } else {
+      boost::asio::post(*pool_, std::move(fn));
+    }
+  }
 
   /// Stop the thread pool.
   void Stop();
@@ -52,8 +63,9 @@ class BoundedExecutor {
   void Join();
 
  private:
-  /// The underlying thread pool for running tasks.
-  boost::asio::thread_pool pool_;
+  /// The underlying thread pool for running tasks. Only one of them is set.
+  std::unique_ptr<boost::asio::thread_pool> pool_;
+  std::unique_ptr<WorkStealingExecutor> work_stealing_executor_;
 };
 
 }  // namespace core
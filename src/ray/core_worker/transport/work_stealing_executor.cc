@@ -0,0 +1,190 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/core_worker/transport/work_stealing_executor.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace core {
+
+namespace {
+
+/// How many times an idle thread looks for a task before it parks.
+constexpr int kSpinIterations = 128;
+
+/// The executor and the index of the calling thread, if it's a thread of an executor.
+thread_local const WorkStealingExecutor *current_executor = nullptr;
+thread_local size_t current_worker_index = 0;
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads, bool pin_threads) {
+  RAY_CHECK(num_threads > 0);
+  for (int i = 0; i < num_threads; i++) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this, i, pin_threads]() {
+      if (pin_threads) {
+        PinCurrentThread(i);
+      }
+      Run(i);
+    });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  Stop();
+  Join();
+}
+
+void WorkStealingExecutor::Post(std::function<void()> fn) {
+  if (current_executor == this) {
+    auto &worker = *workers_[current_worker_index];
+    absl::MutexLock lock(&worker.mutex);
+    worker.tasks.push_back(std::move(fn));
+  } else {
+    auto &worker = *workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                             workers_.size()];
+    absl::MutexLock lock(&worker.mutex);
+    worker.tasks.push_front(std::move(fn));
+  }
+  num_queued_.fetch_add(1, std::memory_order_seq_cst);
+  Unpark();
+}
+
+void WorkStealingExecutor::Stop() {
+  stopped_ = true;
+  absl::MutexLock lock(&park_mutex_);
+  park_cond_var_.SignalAll();
+}
+
+void WorkStealingExecutor::Join() {
+  {
+    absl::MutexLock lock(&park_mutex_);
+    joining_ = true;
+    park_cond_var_.SignalAll();
+  }
+  for (auto &thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+void WorkStealingExecutor::Run(size_t index) {
+  current_executor = this;
+  current_worker_index = index;
+  std::function<void()> task;
+  while (!stopped_) {
+    bool found = false;
+    for (int i = 0; i < kSpinIterations && !stopped_; i++) {
+      if (HasTasks() && NextTask(index, &task)) {
+        found = true;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    if (found) {
+      task();
+      task = nullptr;
+    } else if (joining_) {
+      if (!HasTasks()) {
+        break;
+      }
+    } else {
+      Park();
+    }
+  }
+  current_executor = nullptr;
+}
+
+bool WorkStealingExecutor::NextTask(size_t index, std::function<void()> *task) {
+  for (size_t i = 0; i < workers_.size(); i++) {
+    auto &worker = *workers_[(index + i) % workers_.size()];
+    absl::MutexLock lock(&worker.mutex);
+    if (worker.tasks.empty()) {
+      continue;
+    }
+    // Steal from the back too, where the oldest of the tasks posted from other threads
+    // are, rather than from the front, where the newest are.
+    *task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    num_queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+bool WorkStealingExecutor::HasTasks() const {
+  return num_queued_.load(std::memory_order_seq_cst) > 0;
+}
+
+void WorkStealingExecutor::Park() {
+  absl::MutexLock lock(&park_mutex_);
+  // Announce the thread before looking for tasks one last time, so that either a
+  // concurrent `Post` sees it parked, or the thread sees the posted task.
+  num_parked_.fetch_add(1, std::memory_order_seq_cst);
+  while (!stopped_ && !joining_ && !HasTasks()) {
+    park_cond_var_.Wait(&park_mutex_);
+  }
+  num_parked_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void WorkStealingExecutor::Unpark() {
+  if (num_parked_.load(std::memory_order_seq_cst) > 0) {
+    absl::MutexLock lock(&park_mutex_);
+    park_cond_var_.Signal();
+  }
+}
+
+void WorkStealingExecutor::PinCurrentThread(size_t index) {
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+    RAY_LOG(WARNING) << "Failed to get the CPU affinity of the worker, threads of the "
+                        "executor are not pinned.";
+    return;
+  }
+  // Pick the index-th allowed CPU, wrapping around.
+  size_t target = index % CPU_COUNT(&allowed);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &allowed)) {
+      continue;
+    }
+    if (target-- > 0) {
+      continue;
+    }
+    cpu_set_t pinned;
+    CPU_ZERO(&pinned);
+    CPU_SET(cpu, &pinned);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) != 0) {
+      RAY_LOG(WARNING) << "Failed to pin a thread of the executor to CPU " << cpu;
+    }
+    return;
+  }
+#else
+  RAY_LOG(DEBUG) << "Pinning threads is only supported on Linux.";
+#endif
+}
+
+}  // namespace core
+}  // namespace ray
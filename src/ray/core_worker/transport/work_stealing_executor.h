@@ -0,0 +1,106 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ray {
+namespace core {
+
+/// A thread pool where each thread has its own deque of tasks, and steals from the
+/// others when it runs out. Posting a task only locks the deque it goes to, so threads
+/// don't contend on a shared queue when there are many of them and tasks are short.
+///
+/// The back of a deque is where its thread pushes and pops the tasks that it posts
+/// itself, so these run LIFO while their data is still in cache. Tasks posted from
+/// other threads are spread round-robin over the fronts of the deques. Since threads
+/// that steal take from the back as well, the tasks of a deque that were posted from
+/// other threads start in the order they were posted, whichever thread runs them. Idle
+/// threads spin for a while before they park.
+class WorkStealingExecutor {
+ public:
+  static bool NeedDefaultExecutor(int32_t max_concurrency_in_default_group) {
+    return max_concurrency_in_default_group > 1;
+  }
+
+  /// \param num_threads The number of threads.
+  /// \param pin_threads Whether to pin the threads to the CPUs that the process may run
+  /// on, one each in turn. Only supported on Linux.
+  explicit WorkStealingExecutor(int num_threads, bool pin_threads = false);
+
+  ~WorkStealingExecutor();
+
+  WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+  WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+  /// Posts work to the pool.
+  void Post(std::function<void()> fn);
+
+  /// Stop the threads once they finish the tasks they are running. The tasks that are
+  /// still queued are dropped.
+  void Stop();
+
+  /// Wait for the threads to exit. Unless the executor is stopped, they exit once all
+  /// the queued tasks have run.
+  void Join();
+
+ private:
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  void Run(size_t index);
+
+  /// Pop a task of the given worker from the back, or steal one from the back of
+  /// another worker.
+  bool NextTask(size_t index, std::function<void()> *task);
+
+  /// Whether any task is queued.
+  bool HasTasks() const;
+
+  /// Park the calling thread until a task is posted or the executor is joined.
+  void Park();
+
+  /// Wake up a parked thread, if any.
+  void Unpark();
+
+  static void PinCurrentThread(size_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_worker_{0};
+  /// The number of queued tasks, so that idle threads don't have to lock every deque
+  /// to find out there are none.
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<bool> stopped_{false};
+  /// Set by `Join`, after which threads exit instead of parking.
+  std::atomic<bool> joining_{false};
+
+  absl::Mutex park_mutex_;
+  absl::CondVar park_cond_var_;
+  std::atomic<int> num_parked_{0};
+};
+
+}  // namespace core
+}  // namespace ray
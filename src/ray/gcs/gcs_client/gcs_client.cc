@@ -15,9 +15,11 @@
 #include "ray/gcs/gcs_client/gcs_client.h"
 
 #include <chrono>
+#include <string>
 #include <thread>
 #include <utility>
 
+#include "google/protobuf/unknown_field_set.h"
 #include "ray/common/asio/asio_util.h"
 #include "ray/common/ray_config.h"
 #include "ray/gcs/gcs_client/accessor.h"
@@ -58,6 +60,14 @@ void GcsSubscriberClient::PubsubLongPolling(
       req, [callback](const Status &status, rpc::GcsSubscriberPollReply &&poll_reply) {
         rpc::PubsubLongPollingReply reply;
         reply.mutable_pub_messages()->Swap(poll_reply.mutable_pub_messages());
+        // Messages serialized once by the publisher are parsed into `pub_messages` when
+        // the reply is received. Any that are still unknown fields, because the reply
+        // was passed in process, are parsed here.
+        if (!poll_reply.unknown_fields().empty()) {
+          std::string unknown_fields;
+          poll_reply.unknown_fields().SerializeToString(&unknown_fields);
+          reply.MergeFromString(unknown_fields);
+        }
         *reply.mutable_publisher_id() = std::move(*poll_reply.mutable_publisher_id());
         callback(status, std::move(reply));
       });
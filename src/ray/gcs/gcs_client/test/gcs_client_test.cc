@@ -30,17 +30,21 @@ namespace ray {
 
 class GcsClientTest : public ::testing::TestWithParam<bool> {
  public:
-  GcsClientTest() : no_redis_(GetParam()) {
+  /// \param extra_config Additional config entries, each followed by a comma.
+  explicit GcsClientTest(const std::string &extra_config = "")
+      : no_redis_(GetParam()) {
     RayConfig::instance().initialize(
         absl::Substitute(R"(
 {
   "gcs_rpc_server_reconnect_timeout_s": 60,
   "maximum_gcs_destroyed_actor_cached_count": 10,
   "maximum_gcs_dead_node_cached_count": 10,
+  $1
   "gcs_storage": $0
 }
   )",
-                         no_redis_ ? "\"memory\"" : "\"redis\""));
+                         no_redis_ ? "\"memory\"" : "\"redis\"",
+                         extra_config));
     if (!no_redis_) {
       TestSetupUtil::StartUpRedisServers(std::vector<int>());
     }
@@ -442,6 +446,18 @@ class GcsClientTest : public ::testing::TestWithParam<bool> {
 
 INSTANTIATE_TEST_SUITE_P(RedisMigration, GcsClientTest, testing::Bool());
 
+/// Runs the GCS pubsub with the published messages serialized once for all the
+/// subscribers.
+class GcsClientSerializeMessagesOnceTest : public GcsClientTest {
+ public:
+  GcsClientSerializeMessagesOnceTest()
+      : GcsClientTest(R"("publisher_serialize_messages_once": true,)") {}
+};
+
+INSTANTIATE_TEST_SUITE_P(RedisMigration,
+                         GcsClientSerializeMessagesOnceTest,
+                         testing::Values(true));
+
 TEST_P(GcsClientTest, TestCheckAlive) {
   auto node_info1 = Mocker::GenNodeInfo();
   node_info1->set_node_manager_address("172.1.2.3");
@@ -526,6 +542,26 @@ TEST_P(GcsClientTest, TestJobInfo) {
   WaitForExpectedCount(job_updates, 2);
 }
 
+TEST_P(GcsClientSerializeMessagesOnceTest, TestJobInfo) {
+  JobID add_job_id = JobID::FromInt(1);
+  auto job_table_data = Mocker::GenJobTableData(add_job_id);
+
+  // The subscriber receives the messages that the GCS serialized once.
+  std::atomic<int> job_updates(0);
+  std::atomic<bool> is_dead(false);
+  auto on_subscribe = [&](const JobID &job_id, const gcs::JobTableData &data) {
+    EXPECT_EQ(job_id, add_job_id);
+    is_dead = data.is_dead();
+    job_updates++;
+  };
+  ASSERT_TRUE(SubscribeToAllJobs(on_subscribe));
+
+  ASSERT_TRUE(AddJob(job_table_data));
+  ASSERT_TRUE(MarkJobFinished(add_job_id));
+  WaitForExpectedCount(job_updates, 2);
+  ASSERT_TRUE(is_dead);
+}
+
 TEST_P(GcsClientTest, TestGetNextJobID) {
   JobID job_id1 = GetNextJobID();
   JobID job_id2 = GetNextJobID();
@@ -17,6 +17,7 @@
 #include <string_view>
 
 #include "ray/stats/metric.h"
+#include "ray/util/util.h"
 
 DEFINE_stats(health_check_rpc_latency_ms,
              "Latency of rpc request for health check.",
@@ -32,18 +33,30 @@ GcsHealthCheckManager::GcsHealthCheckManager(
     int64_t initial_delay_ms,
     int64_t timeout_ms,
     int64_t period_ms,
-    int64_t failure_threshold)
+    int64_t failure_threshold,
+    bool traffic_based_liveness,
+    int64_t timer_wheel_tick_ms)
     : io_service_(io_service),
       on_node_death_callback_(on_node_death_callback),
       initial_delay_ms_(initial_delay_ms),
       timeout_ms_(timeout_ms),
       period_ms_(period_ms),
-      failure_threshold_(failure_threshold) {
+      failure_threshold_(failure_threshold),
+      traffic_based_liveness_(traffic_based_liveness),
+      timer_wheel_tick_ms_(timer_wheel_tick_ms),
+      timer_wheel_start_ms_(current_time_ms()) {
   RAY_CHECK(on_node_death_callback != nullptr);
   RAY_CHECK_GE(initial_delay_ms, 0);
   RAY_CHECK_GE(timeout_ms, 0);
   RAY_CHECK_GE(period_ms, 0);
   RAY_CHECK_GE(failure_threshold, 0);
+  if (traffic_based_liveness_) {
+    RAY_CHECK_GT(timer_wheel_tick_ms, 0);
+    periodical_runner_ = PeriodicalRunner::Create(io_service_);
+    periodical_runner_->RunFnPeriodically([this]() { OnTimerWheelTick(); },
+                                          timer_wheel_tick_ms_,
+                                          "GcsHealthCheckManager.OnTimerWheelTick");
+  }
 }
 
 GcsHealthCheckManager::~GcsHealthCheckManager() = default;
@@ -56,6 +69,19 @@ void GcsHealthCheckManager::RemoveNode(const NodeID &node_id) {
         if (iter == health_check_contexts_.end()) {
           return;
         }
+        if (traffic_based_liveness_) {
+          {
+            absl::MutexLock lock(&activity_mutex_);
+            last_activity_ms_.erase(node_id);
+          }
+          // Without a request in flight, nothing refers to the context anymore: the
+          // stale timer wheel entry is skipped based on the context id.
+          if (!iter->second->probe_in_flight_) {
+            delete iter->second;
+            health_check_contexts_.erase(iter);
+            return;
+          }
+        }
         iter->second->Stop();
         health_check_contexts_.erase(iter);
       },
@@ -69,6 +95,10 @@ void GcsHealthCheckManager::FailNode(const NodeID &node_id) {
   if (iter != health_check_contexts_.end()) {
     on_node_death_callback_(node_id);
     health_check_contexts_.erase(iter);
+    if (traffic_based_liveness_) {
+      absl::MutexLock lock(&activity_mutex_);
+      last_activity_ms_.erase(node_id);
+    }
   }
 }
 
@@ -82,6 +112,60 @@ std::vector<NodeID> GcsHealthCheckManager::GetAllNodes() const {
   return nodes;
 }
 
+void GcsHealthCheckManager::MarkNodeHealthy(const NodeID &node_id) {
+  if (!traffic_based_liveness_) {
+    return;
+  }
+  const int64_t now_ms = current_time_ms();
+  absl::MutexLock lock(&activity_mutex_);
+  auto iter = last_activity_ms_.find(node_id);
+  if (iter != last_activity_ms_.end()) {
+    iter->second = now_ms;
+  }
+}
+
+int64_t GcsHealthCheckManager::GetLastActivityMs(const NodeID &node_id) const {
+  absl::MutexLock lock(&activity_mutex_);
+  auto iter = last_activity_ms_.find(node_id);
+  return iter == last_activity_ms_.end() ? 0 : iter->second;
+}
+
+void GcsHealthCheckManager::ScheduleCheck(HealthCheckContext *context,
+                                          int64_t delay_ms) {
+  // The wheel might lag behind the clock if the io context is busy, so the deadline
+  // is computed from the clock rather than from the current tick of the wheel.
+  const int64_t deadline_ms = current_time_ms() - timer_wheel_start_ms_ + delay_ms;
+  const uint64_t deadline_tick =
+      (deadline_ms + timer_wheel_tick_ms_ - 1) / timer_wheel_tick_ms_;
+  timer_wheel_.Schedule(PendingCheck{context->node_id_, context->id_},
+                        deadline_tick - timer_wheel_.CurrentTick());
+}
+
+void GcsHealthCheckManager::OnTimerWheelTick() {
+  thread_checker_.IsOnSameThread();
+  const int64_t now_ms = current_time_ms();
+  std::vector<PendingCheck> expired;
+  timer_wheel_.Advance((now_ms - timer_wheel_start_ms_) / timer_wheel_tick_ms_,
+                       &expired);
+  for (const auto &check : expired) {
+    auto iter = health_check_contexts_.find(check.node_id);
+    if (iter == health_check_contexts_.end() ||
+        iter->second->id_ != check.context_id) {
+      // The node has been removed or failed since the check was scheduled.
+      continue;
+    }
+    auto *context = iter->second;
+    const int64_t last_activity_ms = GetLastActivityMs(check.node_id);
+    if (last_activity_ms > 0 && now_ms - last_activity_ms < period_ms_) {
+      // The node has been heard from recently, no need to probe it.
+      context->health_check_remaining_ = failure_threshold_;
+      ScheduleCheck(context, last_activity_ms + period_ms_ - now_ms);
+    } else {
+      context->StartHealthCheck();
+    }
+  }
+}
+
 void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
   using ::grpc::health::v1::HealthCheckResponse;
 
@@ -93,6 +177,7 @@ void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
   const auto now = absl::Now();
   const auto deadline = now + absl::Milliseconds(manager_->timeout_ms_);
   context_.set_deadline(absl::ToChronoTime(deadline));
+  probe_in_flight_ = true;
   stub_->async()->Check(
       &context_, &request_, &response_, [this, start = now](::grpc::Status status) {
         // This callback is done in gRPC's thread pool.
@@ -100,6 +185,7 @@ void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
             absl::ToInt64Milliseconds(absl::Now() - start));
         manager_->io_service_.post(
             [this, status]() {
+              probe_in_flight_ = false;
               if (stopped_) {
                 delete this;
                 return;
@@ -108,7 +194,17 @@ void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
                              << HealthCheckResponse_ServingStatus_Name(
                                     response_.status());
 
-              if (status.ok() && response_.status() == HealthCheckResponse::SERVING) {
+              // Any message received from the node while the request was in flight
+              // proves it's alive as well.
+              const int64_t last_activity_ms =
+                  manager_->traffic_based_liveness_
+                      ? manager_->GetLastActivityMs(node_id_)
+                      : 0;
+              const bool heard_from_node =
+                  last_activity_ms > 0 &&
+                  current_time_ms() - last_activity_ms < manager_->period_ms_;
+              if ((status.ok() && response_.status() == HealthCheckResponse::SERVING) ||
+                  heard_from_node) {
                 // Health check passed.
                 health_check_remaining_ = manager_->failure_threshold_;
               } else {
@@ -124,11 +220,10 @@ void GcsHealthCheckManager::HealthCheckContext::StartHealthCheck() {
               if (health_check_remaining_ == 0) {
                 manager_->FailNode(node_id_);
                 delete this;
+              } else if (manager_->traffic_based_liveness_) {
+                manager_->ScheduleCheck(this, manager_->period_ms_);
               } else {
                 // Do another health check.
-                //
-                // TODO(hjiang): Able to reduce a few health check based on know resource
-                // usage communication between GCS and raylet.
                 timer_.expires_from_now(
                     boost::posix_time::milliseconds(manager_->period_ms_));
                 timer_.async_wait([this](auto) { StartHealthCheck(); });
@@ -145,6 +240,10 @@ void GcsHealthCheckManager::AddNode(const NodeID &node_id,
   io_service_.dispatch(
       [this, channel = std::move(channel), node_id]() {
         thread_checker_.IsOnSameThread();
+        if (traffic_based_liveness_) {
+          absl::MutexLock lock(&activity_mutex_);
+          last_activity_ms_[node_id] = 0;
+        }
         auto context = new HealthCheckContext(this, channel, node_id);
         auto [_, is_new] = health_check_contexts_.emplace(node_id, context);
         RAY_CHECK(is_new);
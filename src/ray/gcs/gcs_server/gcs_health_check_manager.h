@@ -22,10 +22,13 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/asio/periodical_runner.h"
 #include "ray/common/id.h"
 #include "ray/common/ray_config.h"
 #include "ray/util/thread_checker.h"
+#include "ray/util/timer_wheel.h"
 #include "src/proto/grpc/health/v1/health.grpc.pb.h"
 
 namespace ray::gcs {
@@ -41,6 +44,12 @@ namespace ray::gcs {
 ///
 /// All IO operations happens on the same thread, which is managed by the pass-ed in
 /// [io_service].
+///
+/// When traffic based liveness is enabled, any message received from a node (see
+/// `MarkNodeHealthy`) counts as a passed health check, and the node is only probed
+/// once it has been silent for `period_ms`. Instead of a timer per node, all the
+/// pending checks are kept in a single timer wheel driven by one periodic tick, so
+/// the cost of the idle nodes doesn't grow with the cluster size.
 /// TODO (iycheng): Move the GcsHealthCheckManager to ray/common.
 class GcsHealthCheckManager {
  public:
@@ -53,13 +62,20 @@ class GcsHealthCheckManager {
   /// \param period_ms The interval between two health checks for the same node.
   /// \param failure_threshold The threshold before a node will be marked as dead due to
   /// health check failure.
+  /// \param traffic_based_liveness Whether to only probe the nodes which haven't been
+  /// marked healthy within `period_ms`.
+  /// \param timer_wheel_tick_ms The granularity of the traffic based health checks.
   GcsHealthCheckManager(
       instrumented_io_context &io_service,
       std::function<void(const NodeID &)> on_node_death_callback,
       int64_t initial_delay_ms = RayConfig::instance().health_check_initial_delay_ms(),
       int64_t timeout_ms = RayConfig::instance().health_check_timeout_ms(),
       int64_t period_ms = RayConfig::instance().health_check_period_ms(),
-      int64_t failure_threshold = RayConfig::instance().health_check_failure_threshold());
+      int64_t failure_threshold = RayConfig::instance().health_check_failure_threshold(),
+      bool traffic_based_liveness =
+          RayConfig::instance().health_check_traffic_based_liveness(),
+      int64_t timer_wheel_tick_ms =
+          RayConfig::instance().health_check_timer_wheel_tick_ms());
 
   ~GcsHealthCheckManager();
 
@@ -82,6 +98,13 @@ class GcsHealthCheckManager {
   /// \return A list of node id which are being monitored by this class.
   std::vector<NodeID> GetAllNodes() const;
 
+  /// Record that a message was just received from the node, which proves it's alive.
+  /// No-op unless traffic based liveness is enabled, or if the node isn't tracked.
+  /// Safe to call from non-io-context threads.
+  ///
+  /// \param node_id The id of the node.
+  void MarkNodeHealthy(const NodeID &node_id);
+
  private:
   /// Fail a node when health check failed. It'll stop the health checking and
   /// call `on_node_death_callback_`.
@@ -89,6 +112,19 @@ class GcsHealthCheckManager {
   /// \param node_id The id of the node.
   void FailNode(const NodeID &node_id);
 
+  class HealthCheckContext;
+
+  /// Schedule the next check of the context on the timer wheel.
+  /// Only used with traffic based liveness.
+  void ScheduleCheck(HealthCheckContext *context, int64_t delay_ms);
+
+  /// Expire the due checks on the timer wheel. For each of them, either postpone the
+  /// check if the node was heard from recently, or probe the node.
+  void OnTimerWheelTick();
+
+  /// The last time the node was marked healthy, or 0 if it never was.
+  int64_t GetLastActivityMs(const NodeID &node_id) const;
+
   using Timer = boost::asio::deadline_timer;
 
   /// The context for the health check. It's to support unary call.
@@ -100,10 +136,15 @@ class GcsHealthCheckManager {
                        NodeID node_id)
         : manager_(manager),
           node_id_(node_id),
+          id_(manager->next_context_id_++),
           timer_(manager->io_service_),
           health_check_remaining_(manager->failure_threshold_) {
       request_.set_service(node_id.Hex());
       stub_ = grpc::health::v1::Health::NewStub(channel);
+      if (manager_->traffic_based_liveness_) {
+        manager_->ScheduleCheck(this, manager_->initial_delay_ms_);
+        return;
+      }
       timer_.expires_from_now(
           boost::posix_time::milliseconds(manager_->initial_delay_ms_));
       timer_.async_wait([this](auto) { StartHealthCheck(); });
@@ -112,15 +153,25 @@ class GcsHealthCheckManager {
     void Stop();
 
    private:
+    friend class GcsHealthCheckManager;
+
     void StartHealthCheck();
 
     GcsHealthCheckManager *manager_;
 
     NodeID node_id_;
 
+    /// Unique id of the context, used to tell whether an expired timer wheel entry
+    /// still refers to the living context of the node.
+    const uint64_t id_;
+
     // Whether the health check has stopped.
     bool stopped_ = false;
 
+    // Whether a health check request has been sent and not replied yet. If not, the
+    // context can be deleted right away when the node is removed.
+    bool probe_in_flight_ = false;
+
     /// gRPC related fields
     std::unique_ptr<::grpc::health::v1::Health::Stub> stub_;
 
@@ -156,6 +207,32 @@ class GcsHealthCheckManager {
   const int64_t period_ms_;
   /// The number of failures before the node is considered as dead.
   const int64_t failure_threshold_;
+  /// Whether a message received from a node counts as a passed health check.
+  const bool traffic_based_liveness_;
+  /// The duration of a timer wheel tick.
+  const int64_t timer_wheel_tick_ms_;
+
+  /// The id to assign to the next health check context.
+  uint64_t next_context_id_ = 0;
+
+  /// An entry of the timer wheel. The context id makes the entries of a removed node
+  /// stale, even if the same node id is added back later.
+  struct PendingCheck {
+    NodeID node_id;
+    uint64_t context_id;
+  };
+
+  /// The pending checks of all the nodes. Only used with traffic based liveness.
+  TimerWheel<PendingCheck> timer_wheel_;
+  /// The time the timer wheel started ticking.
+  const int64_t timer_wheel_start_ms_;
+  /// Drives the timer wheel.
+  std::shared_ptr<PeriodicalRunner> periodical_runner_;
+
+  mutable absl::Mutex activity_mutex_;
+  /// The last time each tracked node was marked healthy. Written by the threads
+  /// receiving the messages from the nodes, so it's kept out of the contexts.
+  absl::flat_hash_map<NodeID, int64_t> last_activity_ms_ ABSL_GUARDED_BY(activity_mutex_);
 };
 
 }  // namespace ray::gcs
@@ -39,6 +39,9 @@ void GcsResourceManager::ConsumeSyncMessage(
   // delegate the work to the main thread for thread safety.
   // Ideally, all public api in GcsResourceManager need to be put into this
   // io context for thread safety.
+  if (sync_message_received_listener_) {
+    sync_message_received_listener_(NodeID::FromBinary(message->node_id()));
+  }
   io_context_.dispatch(
       [this, message]() {
         if (message->message_type() == syncer::MessageType::COMMANDS) {
@@ -348,6 +351,11 @@ void GcsResourceManager::AddResourcesChangedListener(std::function<void()> &&lis
   resources_changed_listeners_.emplace_back(std::move(listener));
 }
 
+void GcsResourceManager::SetSyncMessageReceivedListener(
+    std::function<void(const NodeID &)> &&listener) {
+  sync_message_received_listener_ = std::move(listener);
+}
+
 void GcsResourceManager::UpdateNodeNormalTaskResources(
     const NodeID &node_id, const rpc::ResourcesData &heartbeat) {
   if (cluster_resource_manager_.UpdateNodeNormalTaskResources(
@@ -119,6 +119,11 @@ class GcsResourceManager : public rpc::NodeResourceInfoHandler,
   /// Add resources changed listener.
   void AddResourcesChangedListener(std::function<void()> &&listener);
 
+  /// Set the listener called with the node id of every sync message received. Unlike
+  /// the other methods, the listener runs on the ray syncer thread, before the message
+  /// is handed over to the io context. Must be set before the syncer starts.
+  void SetSyncMessageReceivedListener(std::function<void(const NodeID &)> &&listener);
+
   // Update node normal task resources.
   void UpdateNodeNormalTaskResources(const NodeID &node_id,
                                      const rpc::ResourcesData &heartbeat);
@@ -184,6 +189,8 @@ class GcsResourceManager : public rpc::NodeResourceInfoHandler,
   absl::optional<std::shared_ptr<rpc::PlacementGroupLoad>> placement_group_load_;
   /// The resources changed listeners.
   std::vector<std::function<void()>> resources_changed_listeners_;
+  /// The listener of the received sync messages.
+  std::function<void(const NodeID &)> sync_message_received_listener_;
 
   /// Debug info.
   enum CountType {
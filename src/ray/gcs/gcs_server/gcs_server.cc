@@ -295,6 +295,14 @@ void GcsServer::InitGcsHealthCheckManager(const GcsInitData &gcs_init_data) {
 
   gcs_healthcheck_manager_ = std::make_unique<GcsHealthCheckManager>(
       io_context_provider_.GetDefaultIOContext(), node_death_callback);
+  if (RayConfig::instance().health_check_traffic_based_liveness()) {
+    // Resource reports from the raylets prove they are alive, which saves most of
+    // the health check requests in large clusters.
+    gcs_resource_manager_->SetSyncMessageReceivedListener(
+        [this](const NodeID &node_id) {
+          gcs_healthcheck_manager_->MarkNodeHealthy(node_id);
+        });
+  }
   for (const auto &item : gcs_init_data.Nodes()) {
     if (item.second.state() == rpc::GcsNodeInfo::ALIVE) {
       rpc::Address remote_address;
@@ -53,6 +53,10 @@ void InternalPubSubHandler::HandleGcsSubscriberPoll(
                                                std::function<void()> success_cb,
                                                std::function<void()> failure_cb) {
         reply->mutable_pub_messages()->Swap(pubsub_reply->mutable_pub_messages());
+        // Messages serialized once for all subscribers are added to the reply as
+        // unknown fields. `pub_messages` has the same field number in both replies, so
+        // they're forwarded as is.
+        reply->mutable_unknown_fields()->Swap(pubsub_reply->mutable_unknown_fields());
         reply->set_publisher_id(std::move(*pubsub_reply->mutable_publisher_id()));
         reply_cb(std::move(status), std::move(success_cb), std::move(failure_cb));
       });
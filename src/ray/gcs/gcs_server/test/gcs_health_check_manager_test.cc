@@ -19,6 +19,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread.hpp>
 #include <cstdlib>
+#include <ctime>
 #include <unordered_map>
 
 using namespace boost;
@@ -271,3 +272,144 @@ TEST_F(GcsHealthCheckManagerTest, StressTest) {
   io_service.stop();
   t->join();
 }
+
+class GcsHealthCheckManagerTrafficTest : public GcsHealthCheckManagerTest {
+ protected:
+  void SetUp() override {
+    grpc::EnableDefaultHealthCheckService(true);
+
+    health_check = std::make_unique<gcs::GcsHealthCheckManager>(
+        io_service,
+        [this](const NodeID &id) { dead_nodes.insert(id); },
+        initial_delay_ms,
+        timeout_ms,
+        period_ms,
+        failure_threshold,
+        /*traffic_based_liveness=*/true,
+        timer_wheel_tick_ms);
+  }
+
+  /// Run the io context on this thread for `duration`, marking the nodes in
+  /// `active_nodes` healthy every tick to simulate their resource reports.
+  void RunFor(std::chrono::milliseconds duration,
+              const std::vector<NodeID> &active_nodes = {}) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+      for (const auto &node_id : active_nodes) {
+        health_check->MarkNodeHealthy(node_id);
+      }
+      io_service.run_for(std::chrono::milliseconds(timer_wheel_tick_ms));
+      io_service.restart();
+    }
+  }
+
+  /// Run the io context until `node_id` is dead or `timeout` expires.
+  bool WaitForDeath(const NodeID &node_id, std::chrono::milliseconds timeout = 5s) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!dead_nodes.count(node_id) && std::chrono::steady_clock::now() < deadline) {
+      RunFor(std::chrono::milliseconds(timer_wheel_tick_ms));
+    }
+    return dead_nodes.count(node_id) > 0;
+  }
+
+  const int64_t timer_wheel_tick_ms = 5;
+};
+
+TEST_F(GcsHealthCheckManagerTrafficTest, TrafficKeepsNodeAlive) {
+  // The node never answers the health check, but it keeps sending messages.
+  auto node_id = AddServer(false);
+  RunFor(1s, {node_id});
+  ASSERT_TRUE(dead_nodes.empty());
+  ASSERT_EQ(1, health_check->GetAllNodes().size());
+
+  // Once the node becomes silent, it's probed and fails.
+  ASSERT_TRUE(WaitForDeath(node_id));
+  ASSERT_EQ(1, dead_nodes.size());
+  ASSERT_EQ(0, health_check->GetAllNodes().size());
+}
+
+TEST_F(GcsHealthCheckManagerTrafficTest, SilentNodeIsProbed) {
+  auto node_id = AddServer();
+  // Without any traffic, the node stays alive as long as it answers the probes.
+  RunFor(1s);
+  ASSERT_TRUE(dead_nodes.empty());
+
+  StopServing(node_id);
+  ASSERT_TRUE(WaitForDeath(node_id));
+  ASSERT_EQ(1, dead_nodes.size());
+}
+
+TEST_F(GcsHealthCheckManagerTrafficTest, NodeRemoved) {
+  auto active_node = AddServer(false);
+  auto silent_node = AddServer();
+  RunFor(200ms, {active_node});
+  ASSERT_EQ(2, health_check->GetAllNodes().size());
+
+  health_check->RemoveNode(active_node);
+  health_check->RemoveNode(silent_node);
+  DeleteServer(silent_node);
+  // Marking a removed node healthy is a no-op.
+  RunFor(500ms, {active_node});
+  ASSERT_EQ(0, dead_nodes.size());
+  ASSERT_EQ(0, health_check->GetAllNodes().size());
+
+  // The same node can be added back, and is tracked from scratch.
+  DeleteServer(active_node);
+  auto node_id = AddServer(false);
+  ASSERT_TRUE(WaitForDeath(node_id));
+}
+
+// Compare the CPU time spent on health checking by the GCS process with and without
+// traffic based liveness, for different cluster sizes. All the nodes are served by the
+// same gRPC server so the cost of the raylets is negligible, and every node reports its
+// resources once per tick in the traffic based mode.
+TEST_F(GcsHealthCheckManagerTrafficTest, DISABLED_SimulateHealthCheckCpuUsage) {
+  auto port = GetFreePort();
+  auto server = std::make_shared<rpc::GrpcServer>("health_check_sim", port, true);
+  server->Run();
+  auto channel = grpc::CreateChannel("localhost:" + std::to_string(port),
+                                     grpc::InsecureChannelCredentials());
+  constexpr int64_t kPeriodMs = 1000;
+  constexpr auto kDuration = 5s;
+
+  for (size_t num_nodes : {100, 1000, 10000}) {
+    std::vector<NodeID> node_ids;
+    for (size_t i = 0; i < num_nodes; ++i) {
+      node_ids.emplace_back(NodeID::FromRandom());
+      server->GetServer().GetHealthCheckService()->SetServingStatus(
+          node_ids.back().Hex(), true);
+    }
+    for (bool traffic_based_liveness : {false, true}) {
+      health_check = std::make_unique<gcs::GcsHealthCheckManager>(
+          io_service,
+          [this](const NodeID &id) { dead_nodes.insert(id); },
+          /*initial_delay_ms=*/0,
+          /*timeout_ms=*/kPeriodMs,
+          kPeriodMs,
+          failure_threshold,
+          traffic_based_liveness,
+          timer_wheel_tick_ms);
+      for (const auto &node_id : node_ids) {
+        health_check->AddNode(node_id, channel);
+      }
+      // Let the initial checks go out before measuring.
+      RunFor(std::chrono::milliseconds(kPeriodMs),
+             traffic_based_liveness ? node_ids : std::vector<NodeID>{});
+
+      const auto cpu_start = std::clock();
+      RunFor(kDuration, traffic_based_liveness ? node_ids : std::vector<NodeID>{});
+      const double cpu_ms = 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+      RAY_LOG(INFO) << "num_nodes=" << num_nodes
+                    << ", traffic_based_liveness=" << traffic_based_liveness
+                    << ", cpu time per second: " << cpu_ms / kDuration.count() << "ms";
+      ASSERT_TRUE(dead_nodes.empty());
+
+      for (const auto &node_id : node_ids) {
+        health_check->RemoveNode(node_id);
+      }
+      // Drain the requests in flight before the manager goes away.
+      RunFor(std::chrono::milliseconds(3 * kPeriodMs));
+    }
+  }
+  server->Shutdown();
+}
@@ -171,6 +171,10 @@ bool ObjectManager::IsPlasmaObjectSpillable(const ObjectID &object_id) {
   return plasma::plasma_store_runner->IsPlasmaObjectSpillable(object_id);
 }
 
+void ObjectManager::RecordPlasmaObjectSpilled(const ObjectID &object_id) {
+  plasma::plasma_store_runner->RecordObjectSpilled(object_id);
+}
+
 void ObjectManager::RunRpcService(int index) {
   SetThreadName("rpc.obj.mgr." + std::to_string(index));
   rpc_service_.run();
@@ -196,6 +196,9 @@ class ObjectManager : public ObjectManagerInterface,
   /// local object manager. False otherwise.
   bool IsPlasmaObjectSpillable(const ObjectID &object_id);
 
+  /// Record in the plasma store's access trace that an object was spilled.
+  void RecordPlasmaObjectSpilled(const ObjectID &object_id);
+
   /// Consider pushing an object to a remote object manager. This object manager
   /// may choose to ignore the Push call (e.g., if Push is called twice in a row
   /// on the same object, the second one might be ignored).
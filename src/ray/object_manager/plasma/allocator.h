@@ -16,12 +16,30 @@
 // under the License.
 #pragma once
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/compat.h"
 
 namespace plasma {
 
+/// Occupancy of one size class of an allocator that serves small allocations
+/// from per-size-class slabs.
+struct SizeClassStats {
+  /// Size of the chunks in this class.
+  int64_t chunk_size;
+  /// Number of slabs of this class.
+  int64_t num_slabs;
+  /// Number of chunks in all slabs of this class.
+  int64_t num_chunks;
+  /// Number of chunks that are allocated.
+  int64_t num_chunks_in_use;
+  /// Bytes requested by the allocations in this class. The rest of the slab bytes
+  /// are either rounding waste or free chunks.
+  int64_t bytes_in_use;
+};
+
 // IAllocator is responsible for allocating/deallocating memories.
 // This class is not thread safe.
 class IAllocator {
@@ -59,6 +77,9 @@ class IAllocator {
 
   /// Get the number of bytes fallback allocated so far.
   virtual int64_t FallbackAllocated() const = 0;
+
+  /// Get the occupancy of each size class, for allocators that have them.
+  virtual std::vector<SizeClassStats> GetSizeClassStats() const { return {}; }
 };
 
 }  // namespace plasma
@@ -19,6 +19,10 @@
 
 #include "ray/object_manager/plasma/client.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include <algorithm>
 #include <boost/asio.hpp>
 #include <cstring>
@@ -30,9 +34,11 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/ray_config.h"
 #include "ray/object_manager/common.h"
+#include "ray/object_manager/plasma/command_ring.h"
 #include "ray/object_manager/plasma/connection.h"
 #include "ray/object_manager/plasma/plasma.h"
 #include "ray/object_manager/plasma/protocol.h"
@@ -137,6 +143,14 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
                               fb::ObjectSource source,
                               int device_num);
 
+  Status CreateMany(const std::vector<ObjectID> &object_ids,
+                    const ray::rpc::Address &owner_address,
+                    const std::vector<int64_t> &data_sizes,
+                    const std::vector<const uint8_t *> &metadata,
+                    const std::vector<int64_t> &metadata_sizes,
+                    std::vector<std::shared_ptr<Buffer>> *data,
+                    fb::ObjectSource source);
+
   Status Get(const std::vector<ObjectID> &object_ids,
              int64_t timeout_ms,
              std::vector<ObjectBuffer> *object_buffers,
@@ -161,6 +175,12 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
 
   Status Seal(const ObjectID &object_id);
 
+  Status SealMany(const std::vector<ObjectID> &object_ids);
+
+  Status FlushReleases();
+
+  void SetCreatePriority(int32_t priority);
+
   Status Delete(const std::vector<ObjectID> &object_ids);
 
   Status Evict(int64_t num_bytes, int64_t &num_bytes_evicted);
@@ -181,6 +201,15 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
                            uint64_t *retry_with_request_id,
                            std::shared_ptr<Buffer> *data);
 
+  /// Map the buffer of an object that this client created, and mark the object as in
+  /// use.
+  std::shared_ptr<Buffer> MapCreatedObject(const ObjectID &object_id,
+                                           bool is_experimental_mutable_object,
+                                           const uint8_t *metadata,
+                                           std::unique_ptr<PlasmaObject> object,
+                                           MEMFD_TYPE store_fd,
+                                           int64_t mmap_size);
+
   /// Check if store_fd has already been received from the store. If yes,
   /// return it. Otherwise, receive it from the store (see analogous logic
   /// in store.cc).
@@ -206,6 +235,12 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
 
   uint8_t *LookupMmappedFile(MEMFD_TYPE store_fd_val) const;
 
+  /// Hash the content of an object this client created, to send with its seal so
+  /// that the store deduplicates it without hashing it under its lock.
+  ///
+  /// \return The hash, or kNoContentHash if the store doesn't deduplicate the object.
+  uint64_t ComputeContentHash(const PlasmaObject &object) const;
+
   ray::PlasmaObjectHeader *GetPlasmaObjectHeader(const PlasmaObject &object) const {
     auto base_ptr = LookupMmappedFile(object.store_fd);
     auto header_ptr = base_ptr + object.header_offset;
@@ -218,10 +253,23 @@ class PlasmaClient::Impl : public std::enable_shared_from_this<PlasmaClient::Imp
 
   void IncrementObjectCount(const ObjectID &object_id);
 
+  /// Wait until the store has run the commands posted to the command ring, if any, and
+  /// send the releases held back to be batched. Must be called before sending a
+  /// request on the socket.
+  Status FlushPendingCommands();
+
   /// The boost::asio IO context for the client.
   instrumented_io_context main_service_;
   /// The connection to the store service.
   std::shared_ptr<StoreConn> store_conn_;
+  /// The ring through which objects are sealed, released and looked up, if the store
+  /// created one for this client.
+  std::unique_ptr<PlasmaCommandRing> command_ring_;
+  /// The objects whose releases are held back, to send them in one message once there
+  /// are plasma_client_release_batch_size of them.
+  std::vector<ObjectID> pending_releases_;
+  /// The priority of the create requests of this client in the store's queue.
+  int32_t create_priority_ = 0;
   /// Table of dlmalloc buffer files that have been memory mapped so far. This
   /// is a hash table mapping a file descriptor to a struct containing the
   /// address of the corresponding memory-mapped file.
@@ -280,6 +328,16 @@ uint8_t *PlasmaClient::Impl::LookupMmappedFile(MEMFD_TYPE store_fd_val) const {
   return entry->second->pointer();
 }
 
+uint64_t PlasmaClient::Impl::ComputeContentHash(const PlasmaObject &object) const {
+  const uint64_t min_size = RayConfig::instance().plasma_dedup_min_object_size();
+  const uint64_t size = object.data_size + object.metadata_size;
+  if (min_size == 0 || size < min_size || object.device_num != 0 ||
+      object.is_experimental_mutable_object) {
+    return kNoContentHash;
+  }
+  return ObjectContentHash(LookupMmappedFile(object.store_fd) + object.data_offset, size);
+}
+
 bool PlasmaClient::Impl::IsInUse(const ObjectID &object_id) {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
 
@@ -344,14 +402,31 @@ Status PlasmaClient::Impl::HandleCreateReply(const ObjectID &object_id,
     RAY_CHECK(unused == 0);
   }
 
+  *data = MapCreatedObject(object_id,
+                           is_experimental_mutable_object,
+                           metadata,
+                           std::move(object),
+                           store_fd,
+                           mmap_size);
+  return Status::OK();
+}
+
+std::shared_ptr<Buffer> PlasmaClient::Impl::MapCreatedObject(
+    const ObjectID &object_id,
+    bool is_experimental_mutable_object,
+    const uint8_t *metadata,
+    std::unique_ptr<PlasmaObject> object,
+    MEMFD_TYPE store_fd,
+    int64_t mmap_size) {
+  std::shared_ptr<Buffer> data;
   // If the CreateReply included an error, then the store will not send a file
   // descriptor.
   if (object->device_num == 0) {
     // The metadata should come right after the data.
     RAY_CHECK(object->metadata_offset == object->data_offset + object->data_size);
     RAY_LOG(DEBUG) << "GetStoreFdAndMmap " << store_fd.first << ", " << store_fd.second
-                   << ", size " << mmap_size << " for object id " << id;
-    *data = std::make_shared<PlasmaMutableBuffer>(
+                   << ", size " << mmap_size << " for object id " << object_id;
+    data = std::make_shared<PlasmaMutableBuffer>(
         shared_from_this(),
         GetStoreFdAndMmap(store_fd, mmap_size) + object->data_offset,
         object->data_size);
@@ -360,7 +435,7 @@ Status PlasmaClient::Impl::HandleCreateReply(const ObjectID &object_id,
     // from the transfer.
     if (metadata != NULL) {
       // Copy the metadata to the buffer.
-      memcpy((*data)->Data() + object->data_size, metadata, object->metadata_size);
+      memcpy(data->Data() + object->data_size, metadata, object->metadata_size);
     }
   } else {
     RAY_LOG(FATAL) << "GPU is not enabled.";
@@ -392,7 +467,7 @@ Status PlasmaClient::Impl::HandleCreateReply(const ObjectID &object_id,
   auto &entry = object_entry->second;
   RAY_CHECK(!entry->is_sealed);
 
-  return Status::OK();
+  return data;
 }
 
 Status PlasmaClient::Impl::CreateAndSpillIfNeeded(const ObjectID &object_id,
@@ -409,6 +484,7 @@ Status PlasmaClient::Impl::CreateAndSpillIfNeeded(const ObjectID &object_id,
 
   RAY_LOG(DEBUG) << "called plasma_create on conn " << store_conn_ << " with size "
                  << data_size << " and metadata size " << metadata_size;
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendCreateRequest(store_conn_,
                                       object_id,
                                       owner_address,
@@ -417,7 +493,8 @@ Status PlasmaClient::Impl::CreateAndSpillIfNeeded(const ObjectID &object_id,
                                       metadata_size,
                                       source,
                                       device_num,
-                                      /*try_immediately=*/false));
+                                      /*try_immediately=*/false,
+                                      create_priority_));
   Status status = HandleCreateReply(
       object_id, is_experimental_mutable_object, metadata, &retry_with_request_id, data);
 
@@ -447,6 +524,7 @@ Status PlasmaClient::Impl::RetryCreate(const ObjectID &object_id,
                                        uint64_t *retry_with_request_id,
                                        std::shared_ptr<Buffer> *data) {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendCreateRetryRequest(store_conn_, object_id, request_id));
   return HandleCreateReply(
       object_id, is_experimental_mutable_object, metadata, retry_with_request_id, data);
@@ -464,6 +542,7 @@ Status PlasmaClient::Impl::TryCreateImmediately(const ObjectID &object_id,
 
   RAY_LOG(DEBUG) << "called plasma_create on conn " << store_conn_ << " with size "
                  << data_size << " and metadata size " << metadata_size;
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendCreateRequest(store_conn_,
                                       object_id,
                                       owner_address,
@@ -472,11 +551,54 @@ Status PlasmaClient::Impl::TryCreateImmediately(const ObjectID &object_id,
                                       metadata_size,
                                       source,
                                       device_num,
-                                      /*try_immediately=*/true));
+                                      /*try_immediately=*/true,
+                                      create_priority_));
   return HandleCreateReply(
       object_id, /*is_experimental_mutable_object=*/false, metadata, nullptr, data);
 }
 
+Status PlasmaClient::Impl::CreateMany(const std::vector<ObjectID> &object_ids,
+                                      const ray::rpc::Address &owner_address,
+                                      const std::vector<int64_t> &data_sizes,
+                                      const std::vector<const uint8_t *> &metadata,
+                                      const std::vector<int64_t> &metadata_sizes,
+                                      std::vector<std::shared_ptr<Buffer>> *data,
+                                      fb::ObjectSource source) {
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  data->assign(object_ids.size(), nullptr);
+  if (object_ids.empty()) {
+    return Status::OK();
+  }
+
+  RAY_LOG(DEBUG) << "called plasma_create_many on conn " << store_conn_ << " with "
+                 << object_ids.size() << " objects";
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
+  RAY_RETURN_NOT_OK(SendCreateManyRequest(
+      store_conn_, object_ids, owner_address, data_sizes, metadata_sizes, source));
+  std::vector<uint8_t> buffer;
+  RAY_RETURN_NOT_OK(
+      PlasmaReceive(store_conn_, MessageType::PlasmaCreateManyReply, &buffer));
+  std::vector<PlasmaObject> objects;
+  std::vector<MEMFD_TYPE> store_fds;
+  std::vector<int64_t> mmap_sizes;
+  std::vector<PlasmaError> errors;
+  RAY_RETURN_NOT_OK(ReadCreateManyReply(
+      buffer.data(), buffer.size(), &objects, &store_fds, &mmap_sizes, &errors));
+  RAY_CHECK(objects.size() == object_ids.size());
+  // The fds of the created objects follow in order, so the objects are mapped in order.
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    if (errors[i] == PlasmaError::OK) {
+      (*data)[i] = MapCreatedObject(object_ids[i],
+                                    /*is_experimental_mutable_object=*/false,
+                                    metadata[i],
+                                    std::make_unique<PlasmaObject>(objects[i]),
+                                    store_fds[i],
+                                    mmap_sizes[i]);
+    }
+  }
+  return Status::OK();
+}
+
 Status PlasmaClient::Impl::GetBuffers(
     const ObjectID *object_ids,
     int64_t num_objects,
@@ -537,6 +659,7 @@ Status PlasmaClient::Impl::GetBuffers(
   for (int64_t i = 0; i < num_objects; i++) {
     RAY_LOG(DEBUG) << "Sending get request " << object_ids[i];
   }
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendGetRequest(
       store_conn_, &object_ids[0], num_objects, timeout_ms, is_from_worker));
   std::vector<uint8_t> buffer;
@@ -727,7 +850,23 @@ Status PlasmaClient::Impl::Release(const ObjectID &object_id) {
     bool may_unmap = object_entry->second->object.fallback_allocated;
     // Tell the store that the client no longer needs the object.
     RAY_RETURN_NOT_OK(MarkObjectUnused(object_id));
-    RAY_RETURN_NOT_OK(SendReleaseRequest(store_conn_, object_id, may_unmap));
+    const auto release_batch_size =
+        RayConfig::instance().plasma_client_release_batch_size();
+    if (command_ring_ != nullptr && !may_unmap) {
+      // No reply is needed, so the release is posted without waiting for the store.
+      if (!command_ring_->Post(RingCommandType::kRelease, object_id)) {
+        return Status::IOError("The plasma store closed the command ring.");
+      }
+    } else if (release_batch_size > 0 && !may_unmap) {
+      // No reply is needed either, so the release is sent later with others.
+      pending_releases_.push_back(object_id);
+      if (pending_releases_.size() >= release_batch_size) {
+        RAY_RETURN_NOT_OK(FlushPendingCommands());
+      }
+    } else {
+      RAY_RETURN_NOT_OK(FlushPendingCommands());
+      RAY_RETURN_NOT_OK(SendReleaseRequest(store_conn_, object_id, may_unmap));
+    }
     if (may_unmap) {
       // Now, since the object release may unmap the mmap, we wait for a reply.
       std::vector<uint8_t> buffer;
@@ -757,6 +896,32 @@ Status PlasmaClient::Impl::Release(const ObjectID &object_id) {
   return Status::OK();
 }
 
+Status PlasmaClient::Impl::FlushPendingCommands() {
+  if (command_ring_ != nullptr && !command_ring_->Drain()) {
+    return Status::IOError("The plasma store closed the command ring.");
+  }
+  if (!pending_releases_.empty()) {
+    std::vector<ObjectID> object_ids;
+    object_ids.swap(pending_releases_);
+    RAY_RETURN_NOT_OK(SendReleaseManyRequest(store_conn_, object_ids));
+  }
+  return Status::OK();
+}
+
+void PlasmaClient::Impl::SetCreatePriority(int32_t priority) {
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  create_priority_ = priority;
+}
+
+Status PlasmaClient::Impl::FlushReleases() {
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  // If the client is already disconnected, the store has released the objects.
+  if (!store_conn_) {
+    return Status::OK();
+  }
+  return FlushPendingCommands();
+}
+
 // This method is used to query whether the plasma store contains an object.
 Status PlasmaClient::Impl::Contains(const ObjectID &object_id, bool *has_object) {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
@@ -764,6 +929,15 @@ Status PlasmaClient::Impl::Contains(const ObjectID &object_id, bool *has_object)
   // Check if we already have a reference to the object.
   if (objects_in_use_.count(object_id) > 0) {
     *has_object = 1;
+  } else if (command_ring_ != nullptr) {
+    int32_t result;
+    if (!command_ring_->Call(RingCommandType::kContains, object_id, &result)) {
+      return Status::IOError("The plasma store closed the command ring.");
+    }
+    if (result < 0) {
+      return Status::IOError("The plasma store disconnected the client.");
+    }
+    *has_object = result == 1;
   } else {
     // If we don't already have a reference to the object, check with the store
     // to see if we have the object.
@@ -795,14 +969,27 @@ Status PlasmaClient::Impl::Seal(const ObjectID &object_id) {
   }
 
   object_entry->second->is_sealed = true;
+  const uint64_t content_hash = ComputeContentHash(object_entry->second->object);
   // Send the seal request to Plasma. This is the normal Seal path, used for
   // immutable objects and the initial Create call for mutable objects.
-  RAY_RETURN_NOT_OK(SendSealRequest(store_conn_, object_id));
-  std::vector<uint8_t> buffer;
-  RAY_RETURN_NOT_OK(PlasmaReceive(store_conn_, MessageType::PlasmaSealReply, &buffer));
-  ObjectID sealed_id;
-  RAY_RETURN_NOT_OK(ReadSealReply(buffer.data(), buffer.size(), &sealed_id));
-  RAY_CHECK(sealed_id == object_id);
+  if (command_ring_ != nullptr) {
+    int32_t result;
+    if (!command_ring_->Call(RingCommandType::kSeal, object_id, &result, content_hash)) {
+      return Status::IOError("The plasma store closed the command ring.");
+    }
+    // The store returns -1 for a client it already disconnected.
+    if (result < 0) {
+      return Status::IOError("The plasma store disconnected the client.");
+    }
+    RAY_RETURN_NOT_OK(PlasmaErrorStatus(static_cast<PlasmaError>(result)));
+  } else {
+    RAY_RETURN_NOT_OK(SendSealRequest(store_conn_, object_id, content_hash));
+    std::vector<uint8_t> buffer;
+    RAY_RETURN_NOT_OK(PlasmaReceive(store_conn_, MessageType::PlasmaSealReply, &buffer));
+    ObjectID sealed_id;
+    RAY_RETURN_NOT_OK(ReadSealReply(buffer.data(), buffer.size(), &sealed_id));
+    RAY_CHECK(sealed_id == object_id);
+  }
   // We call PlasmaClient::Release to decrement the number of instances of this
   // object
   // that are currently being used by this client. The corresponding increment
@@ -813,6 +1000,49 @@ Status PlasmaClient::Impl::Seal(const ObjectID &object_id) {
   return Status::OK();
 }
 
+Status PlasmaClient::Impl::SealMany(const std::vector<ObjectID> &object_ids) {
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  RAY_LOG(DEBUG) << "SealMany " << object_ids.size() << " objects";
+
+  // Check all the objects before sealing any of them.
+  absl::flat_hash_set<ObjectID> unique_ids;
+  for (const auto &object_id : object_ids) {
+    auto object_entry = objects_in_use_.find(object_id);
+    if (object_entry == objects_in_use_.end()) {
+      return Status::ObjectNotFound(
+          "SealMany() called on an object without a reference to it");
+    }
+    if (object_entry->second->is_sealed || !unique_ids.insert(object_id).second) {
+      return Status::ObjectAlreadySealed("SealMany() called on an already sealed object");
+    }
+  }
+  if (object_ids.empty()) {
+    return Status::OK();
+  }
+
+  std::vector<uint64_t> content_hashes;
+  content_hashes.reserve(object_ids.size());
+  for (const auto &object_id : object_ids) {
+    auto &object_entry = objects_in_use_[object_id];
+    object_entry->is_sealed = true;
+    content_hashes.push_back(ComputeContentHash(object_entry->object));
+  }
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
+  RAY_RETURN_NOT_OK(SendSealManyRequest(store_conn_, object_ids, content_hashes));
+  std::vector<uint8_t> buffer;
+  RAY_RETURN_NOT_OK(
+      PlasmaReceive(store_conn_, MessageType::PlasmaSealManyReply, &buffer));
+  std::vector<ObjectID> sealed_ids;
+  RAY_RETURN_NOT_OK(ReadSealManyReply(buffer.data(), buffer.size(), &sealed_ids));
+  RAY_CHECK(sealed_ids == object_ids);
+  // Release the references taken at creation to keep the objects until they're sealed,
+  // as Seal does.
+  for (const auto &object_id : object_ids) {
+    RAY_RETURN_NOT_OK(Release(object_id));
+  }
+  return Status::OK();
+}
+
 Status PlasmaClient::Impl::Abort(const ObjectID &object_id) {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
   auto object_entry = objects_in_use_.find(object_id);
@@ -829,6 +1059,7 @@ Status PlasmaClient::Impl::Abort(const ObjectID &object_id) {
   }
 
   // Send the abort request.
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendAbortRequest(store_conn_, object_id));
   // Decrease the reference count to zero, then remove the object.
   object_entry->second->count--;
@@ -853,6 +1084,7 @@ Status PlasmaClient::Impl::Delete(const std::vector<ObjectID> &object_ids) {
     }
   }
   if (not_in_use_ids.size() > 0) {
+    RAY_RETURN_NOT_OK(FlushPendingCommands());
     RAY_RETURN_NOT_OK(SendDeleteRequest(store_conn_, not_in_use_ids));
     std::vector<uint8_t> buffer;
     RAY_RETURN_NOT_OK(
@@ -870,6 +1102,7 @@ Status PlasmaClient::Impl::Evict(int64_t num_bytes, int64_t &num_bytes_evicted)
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
 
   // Send a request to the store to evict objects.
+  RAY_RETURN_NOT_OK(FlushPendingCommands());
   RAY_RETURN_NOT_OK(SendEvictRequest(store_conn_, num_bytes));
   // Wait for a response with the number of bytes actually evicted.
   std::vector<uint8_t> buffer;
@@ -887,11 +1120,28 @@ Status PlasmaClient::Impl::Connect(const std::string &store_socket_name,
   ray::local_stream_socket socket(main_service_);
   RAY_RETURN_NOT_OK(ray::ConnectSocketRetry(socket, store_socket_name));
   store_conn_.reset(new StoreConn(std::move(socket)));
-  // Send a ConnectRequest to the store to get its memory capacity.
-  RAY_RETURN_NOT_OK(SendConnectRequest(store_conn_));
+  // Send a ConnectRequest to the store to get its memory capacity, and a command ring
+  // if enabled.
+  RAY_RETURN_NOT_OK(SendConnectRequest(
+      store_conn_, RayConfig::instance().plasma_command_ring_enabled()));
   std::vector<uint8_t> buffer;
   RAY_RETURN_NOT_OK(PlasmaReceive(store_conn_, MessageType::PlasmaConnectReply, &buffer));
-  RAY_RETURN_NOT_OK(ReadConnectReply(buffer.data(), buffer.size(), &store_capacity_));
+  bool command_ring;
+  RAY_RETURN_NOT_OK(
+      ReadConnectReply(buffer.data(), buffer.size(), &store_capacity_, &command_ring));
+#ifndef _WIN32
+  if (command_ring) {
+    int fd;
+    RAY_RETURN_NOT_OK(store_conn_->RecvFd(&fd));
+    int doorbell_fd;
+    auto status = store_conn_->RecvFd(&doorbell_fd);
+    if (!status.ok()) {
+      close(fd);
+      return status;
+    }
+    RAY_RETURN_NOT_OK(PlasmaCommandRing::Map(fd, doorbell_fd, &command_ring_));
+  }
+#endif
 
   return Status::OK();
 }
@@ -905,13 +1155,14 @@ Status PlasmaClient::Impl::Disconnect() {
 
   // Close the connections to Plasma. The Plasma store will release the objects
   // that were in use by us when handling the SIGPIPE.
+  command_ring_.reset();
   store_conn_.reset();
   return Status::OK();
 }
 
 std::string PlasmaClient::Impl::DebugString() {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
-  if (!SendGetDebugStringRequest(store_conn_).ok()) {
+  if (!FlushPendingCommands().ok() || !SendGetDebugStringRequest(store_conn_).ok()) {
     return "error sending request";
   }
   std::vector<uint8_t> buffer;
@@ -978,6 +1229,17 @@ Status PlasmaClient::TryCreateImmediately(const ObjectID &object_id,
                                      device_num);
 }
 
+Status PlasmaClient::CreateMany(const std::vector<ObjectID> &object_ids,
+                                const ray::rpc::Address &owner_address,
+                                const std::vector<int64_t> &data_sizes,
+                                const std::vector<const uint8_t *> &metadata,
+                                const std::vector<int64_t> &metadata_sizes,
+                                std::vector<std::shared_ptr<Buffer>> *data,
+                                fb::ObjectSource source) {
+  return impl_->CreateMany(
+      object_ids, owner_address, data_sizes, metadata, metadata_sizes, data, source);
+}
+
 Status PlasmaClient::Get(const std::vector<ObjectID> &object_ids,
                          int64_t timeout_ms,
                          std::vector<ObjectBuffer> *object_buffers,
@@ -1019,6 +1281,16 @@ Status PlasmaClient::Abort(const ObjectID &object_id) { return impl_->Abort(obje
 
 Status PlasmaClient::Seal(const ObjectID &object_id) { return impl_->Seal(object_id); }
 
+Status PlasmaClient::SealMany(const std::vector<ObjectID> &object_ids) {
+  return impl_->SealMany(object_ids);
+}
+
+Status PlasmaClient::FlushReleases() { return impl_->FlushReleases(); }
+
+void PlasmaClient::SetCreatePriority(int32_t priority) {
+  impl_->SetCreatePriority(priority);
+}
+
 Status PlasmaClient::Delete(const ObjectID &object_id) {
   return impl_->Delete(std::vector<ObjectID>{object_id});
 }
@@ -256,6 +256,30 @@ class PlasmaClient : public PlasmaClientInterface {
                               plasma::flatbuf::ObjectSource source,
                               int device_num = 0);
 
+  /// Create objects in host memory in a single request to the store. An object is only
+  /// created if the store has the memory for it right away, as with
+  /// TryCreateImmediately but without falling back to the filesystem. The objects
+  /// that aren't created can then be created one by one with CreateAndSpillIfNeeded.
+  ///
+  /// \param object_ids The IDs to use for the newly created objects.
+  /// \param owner_address The address of the owner of all the objects.
+  /// \param data_sizes The size in bytes of the data of each object.
+  /// \param metadata The metadata of each object, or NULL if it has none.
+  /// \param metadata_sizes The size in bytes of the metadata of each object.
+  /// \param[out] data The buffer of each object, or nullptr if it wasn't created.
+  /// \param source The source of the objects.
+  /// \return The return status.
+  ///
+  /// The created objects must be released once they are done with. They must also
+  /// be either sealed or aborted.
+  Status CreateMany(const std::vector<ObjectID> &object_ids,
+                    const ray::rpc::Address &owner_address,
+                    const std::vector<int64_t> &data_sizes,
+                    const std::vector<const uint8_t *> &metadata,
+                    const std::vector<int64_t> &metadata_sizes,
+                    std::vector<std::shared_ptr<Buffer>> *data,
+                    plasma::flatbuf::ObjectSource source);
+
   /// Get some objects from the Plasma Store. This function will block until the
   /// objects have all been created and sealed in the Plasma Store or the
   /// timeout expires.
@@ -330,6 +354,26 @@ class PlasmaClient : public PlasmaClientInterface {
   /// \return The return status.
   Status Seal(const ObjectID &object_id);
 
+  /// Seal objects in the object store with a single request, as if each was sealed
+  /// with Seal.
+  ///
+  /// \param object_ids The IDs of the objects to seal.
+  /// \return The return status.
+  Status SealMany(const std::vector<ObjectID> &object_ids);
+
+  /// Send the releases that this client holds back to batch them, see
+  /// plasma_client_release_batch_size.
+  ///
+  /// \return The return status.
+  Status FlushReleases();
+
+  /// Set the priority of the objects this client creates. When the store is full
+  /// and create requests queue up, the requests of higher priority are served
+  /// first. Requests of the same priority are served in order.
+  ///
+  /// \param priority The priority, 0 by default.
+  void SetCreatePriority(int32_t priority);
+
   /// Delete an object from the object store. This currently assumes that the
   /// object is present, has been sealed and not used by another client. Otherwise,
   /// it is a no operation.
@@ -0,0 +1,207 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/id.h"
+#include "ray/common/status.h"
+
+namespace plasma {
+
+using ray::ObjectID;
+using ray::Status;
+
+/// The operations that a client runs through its command ring instead of the socket.
+enum class RingCommandType : uint32_t {
+  /// Seal an object created by the client. The argument is the content hash of the
+  /// object, or kNoContentHash. The result is a PlasmaError.
+  kSeal = 1,
+  /// Release an object that isn't fallback-allocated. There is no result.
+  kRelease = 2,
+  /// Check whether the store has a sealed object. The result is 1 if it does.
+  kContains = 3,
+};
+
+/// A queue of commands in shared memory between a plasma client and the store, with
+/// fixed-size slots, so the hot operations on objects don't go through a flatbuffer
+/// and a syscall on the socket each.
+///
+/// The client posts the commands, and the store runs them in order and writes their
+/// results back into their slots. Neither side makes a syscall while the other keeps
+/// up: the client spins for a while before it sleeps on a futex, and the store polls
+/// the rings of all its clients from one thread, which sleeps on a doorbell that the
+/// clients ring only when it's sleeping.
+///
+/// The client side must be used by one thread at a time, and so must the store side.
+class PlasmaCommandRing {
+ public:
+  /// Create a ring in a new anonymous shared memory file, whose fd is sent to the
+  /// client.
+  ///
+  /// \param[in] num_slots The number of commands that can be pending at once.
+  /// \param[out] ring The ring.
+  static Status Create(uint32_t num_slots, std::unique_ptr<PlasmaCommandRing> *ring);
+
+  /// Map the ring created by the store, and keep the doorbell of the poller serving
+  /// it. Both fds are closed, or owned by the ring.
+  static Status Map(int fd, int doorbell_fd, std::unique_ptr<PlasmaCommandRing> *ring);
+
+  ~PlasmaCommandRing();
+
+  PlasmaCommandRing(const PlasmaCommandRing &) = delete;
+  PlasmaCommandRing &operator=(const PlasmaCommandRing &) = delete;
+
+  /// The fd of the shared memory file, or -1 if the ring was mapped from one.
+  int GetFd() const { return fd_; }
+
+  /// Post a command without waiting for it to run. Waits for a free slot if the ring is
+  /// full.
+  ///
+  /// \param arg An argument of the command, see RingCommandType.
+  /// \return False if the ring is closed.
+  bool Post(RingCommandType type, const ObjectID &object_id, uint64_t arg = 0);
+
+  /// Post a command and wait for its result.
+  ///
+  /// \param arg An argument of the command, see RingCommandType.
+  /// \return False if the ring is closed.
+  bool Call(RingCommandType type,
+            const ObjectID &object_id,
+            int32_t *result,
+            uint64_t arg = 0);
+
+  /// Wait until all the posted commands have run. The client must drain the ring
+  /// before it sends a request on the socket, so that the store sees the requests in
+  /// the order the client made them.
+  ///
+  /// \return False if the ring is closed.
+  bool Drain();
+
+  /// Run the commands posted so far with `handler`, without waiting for more. Called
+  /// by the store.
+  ///
+  /// \return The number of commands run.
+  size_t ServePending(
+      const std::function<int32_t(RingCommandType, const ObjectID &, uint64_t)> &handler);
+
+  /// Whether the client posted commands that haven't run yet.
+  bool HasPending() const;
+
+  /// Set whether the store is sleeping, in which case the client rings the doorbell
+  /// when it posts a command. Called by the store.
+  void SetStoreSleeping(bool sleeping);
+
+  /// Close the ring, and wake up both sides. Commands are no longer posted or run.
+  void Close();
+
+  bool IsClosed() const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  PlasmaCommandRing(int fd, int doorbell_fd, void *mapping, uint64_t mapping_size);
+
+  /// The size of the shared memory file of a ring.
+  static uint64_t MappingSize(uint32_t num_slots);
+
+  /// Wait until the store has run the first `num_commands` commands.
+  bool WaitForCompleted(uint64_t num_commands);
+
+  /// Wake up the poller of the store.
+  void RingDoorbell();
+
+  const int fd_;
+  /// The eventfd that the poller of the store sleeps on, or -1 on the store side.
+  const int doorbell_fd_;
+  void *mapping_;
+  const uint64_t mapping_size_;
+  Header *header_;
+  /// Read once, since the header can be written by the other side.
+  const uint32_t num_slots_;
+  Slot *slots_;
+};
+
+/// Runs the commands of the rings of all the clients of the store on a single thread,
+/// so that only one thread contends for the store lock, and clients that don't post
+/// anything cost nothing. The thread polls the rings while any of them is busy, and
+/// otherwise sleeps on an eventfd, the doorbell, that is sent to the clients with
+/// their rings.
+class PlasmaCommandRingPoller {
+ public:
+  using Handler = std::function<int32_t(RingCommandType, const ObjectID &, uint64_t)>;
+
+  /// Create the doorbell and start the thread.
+  static Status Create(std::unique_ptr<PlasmaCommandRingPoller> *poller);
+
+  /// Stop and join the thread. Must not be called with locks that the handlers take.
+  ~PlasmaCommandRingPoller();
+
+  PlasmaCommandRingPoller(const PlasmaCommandRingPoller &) = delete;
+  PlasmaCommandRingPoller &operator=(const PlasmaCommandRingPoller &) = delete;
+
+  /// The fd of the doorbell, to send to the clients.
+  int GetDoorbellFd() const { return doorbell_fd_; }
+
+  /// Start running the commands of `ring` with `handler`.
+  ///
+  /// \param key The key to remove the ring with, e.g., the client.
+  void Add(const void *key, std::unique_ptr<PlasmaCommandRing> ring, Handler handler);
+
+  /// Stop running the commands of the ring added with `key`, and close it so that the
+  /// client doesn't wait for them. Doesn't wait for the thread, so it may be called with
+  /// locks that the handler takes, as long as the handler then checks whether it should
+  /// still run.
+  void Remove(const void *key);
+
+  /// The number of rings being served.
+  size_t NumRings() const;
+
+ private:
+  struct Entry {
+    std::unique_ptr<PlasmaCommandRing> ring;
+    Handler handler;
+  };
+
+  explicit PlasmaCommandRingPoller(int doorbell_fd);
+
+  /// The loop of the thread.
+  void Run();
+
+  /// Wake up the thread.
+  void RingDoorbell();
+
+  /// Sleep on the doorbell until a client rings it or the timeout passes.
+  void WaitForDoorbell(int64_t timeout_ms);
+
+  const int doorbell_fd_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<const void *, std::shared_ptr<Entry>> rings_
+      ABSL_GUARDED_BY(mutex_);
+  /// Bumped whenever a ring is added or removed, so that the thread only copies
+  /// `rings_` when it changed.
+  std::atomic<uint64_t> version_{0};
+  std::atomic<bool> stopped_{false};
+  std::thread thread_;
+};
+
+}  // namespace plasma
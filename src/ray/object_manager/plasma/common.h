@@ -96,9 +96,12 @@ struct Allocation {
         fallback_allocated(false) {}
 
   friend class PlasmaAllocator;
+  friend class SlabAllocator;
+  friend class ObjectStore;
   friend class DummyAllocator;
   friend struct ObjectLifecycleManagerTest;
   FRIEND_TEST(ObjectStoreTest, PassThroughTest);
+  FRIEND_TEST(ObjectStoreTest, DeduplicationTest);
   FRIEND_TEST(EvictionPolicyTest, Test);
   friend struct GetRequestQueueTest;
 };
@@ -158,6 +161,7 @@ class LocalObject {
   friend class ObjectStore;
   friend class ObjectLifecycleManager;
   FRIEND_TEST(ObjectStoreTest, PassThroughTest);
+  FRIEND_TEST(ObjectStoreTest, DeduplicationTest);
   friend struct ObjectLifecycleManagerTest;
   FRIEND_TEST(ObjectLifecycleManagerTest, RemoveReferenceOneRefNotSealed);
   friend struct ObjectStatsCollectorTest;
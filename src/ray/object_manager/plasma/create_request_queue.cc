@@ -16,22 +16,53 @@
 
 #include <stdlib.h>
 
+#include <iterator>
 #include <memory>
+#include <string>
 
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/object_manager/plasma/common.h"
+#include "ray/stats/metric_defs.h"
 #include "ray/util/util.h"
 
 namespace plasma {
 
+namespace {
+
+/// The size bucket of a request in the wait time metric.
+std::string SizeBucket(size_t object_size) {
+  if (object_size < 1024 * 1024) {
+    return "<1MiB";
+  } else if (object_size < 100 * 1024 * 1024) {
+    return "1MiB-100MiB";
+  } else if (object_size < 1024 * 1024 * 1024) {
+    return "100MiB-1GiB";
+  }
+  return ">=1GiB";
+}
+
+}  // namespace
+
 uint64_t CreateRequestQueue::AddRequest(const ObjectID &object_id,
                                         const std::shared_ptr<ClientInterface> &client,
                                         const CreateObjectCallback &create_callback,
-                                        size_t object_size) {
+                                        size_t object_size,
+                                        int32_t priority) {
   auto req_id = next_req_id_++;
   fulfilled_requests_[req_id] = nullptr;
-  queue_.emplace_back(
-      new CreateRequest(object_id, req_id, client, create_callback, object_size));
+  // Queue behind the requests of the same or a higher priority.
+  auto it = queue_.end();
+  while (it != queue_.begin() && (*std::prev(it))->priority < priority) {
+    it--;
+  }
+  queue_.emplace(it,
+                 new CreateRequest(object_id,
+                                   req_id,
+                                   client,
+                                   create_callback,
+                                   object_size,
+                                   priority,
+                                   get_time_()));
   num_bytes_pending_ += object_size;
   return req_id;
 }
@@ -86,6 +117,13 @@ Status CreateRequestQueue::ProcessRequests() {
   bool logged_oom = false;
   while (!queue_.empty()) {
     auto request_it = queue_.begin();
+    if ((*request_it)->request_id != head_request_id_) {
+      // Another request took the head, e.g. one of a higher priority, so it gets its
+      // own grace period and small requests may go ahead of it again.
+      head_request_id_ = (*request_it)->request_id;
+      oom_start_time_ns_ = -1;
+      small_request_bytes_ahead_of_head_ = 0;
+    }
     auto status = ProcessRequest(/*fallback_allocator=*/false, *request_it);
 
     // if allocation failed due to OOM, and fs_monitor_ indicates the local disk is full,
@@ -111,6 +149,7 @@ Status CreateRequestQueue::ProcessRequests() {
       if (oom_start_time_ns_ == -1) {
         oom_start_time_ns_ = now;
       }
+      ProcessSmallRequests();
       auto grace_period_ns = oom_grace_period_ns_;
       auto spill_pending = spill_objects_callback_();
       if (spill_pending) {
@@ -141,6 +180,12 @@ Status CreateRequestQueue::ProcessRequests() {
                         << dump;
         }
         FinishRequest(request_it);
+        if (!queue_.empty()) {
+          // The store is still full, so the next request goes to the fallback
+          // allocator without another grace period.
+          head_request_id_ = queue_.front()->request_id;
+          small_request_bytes_ahead_of_head_ = 0;
+        }
       }
     }
   }
@@ -148,10 +193,37 @@ Status CreateRequestQueue::ProcessRequests() {
   return Status::OK();
 }
 
+void CreateRequestQueue::ProcessSmallRequests() {
+  if (small_request_max_size_ == 0 || queue_.empty()) {
+    return;
+  }
+  const size_t head_size = queue_.front()->object_size;
+  for (auto it = std::next(queue_.begin()); it != queue_.end();) {
+    if ((*it)->object_size > small_request_max_size_) {
+      it++;
+      continue;
+    }
+    if (small_request_bytes_ahead_of_head_ + (*it)->object_size > head_size) {
+      return;
+    }
+    if (!ProcessRequest(/*fallback_allocator=*/false, *it).ok()) {
+      return;
+    }
+    RAY_LOG(DEBUG) << "Created object " << (*it)->object_id << " of size "
+                   << (*it)->object_size << " ahead of "
+                   << queue_.front()->object_id;
+    small_request_bytes_ahead_of_head_ += (*it)->object_size;
+    FinishRequest(it++);
+  }
+}
+
 void CreateRequestQueue::FinishRequest(
     std::list<std::unique_ptr<CreateRequest>>::iterator request_it) {
   // Fulfill the request.
   auto &request = *request_it;
+  ray::stats::STATS_object_store_create_request_wait_time_ms.Record(
+      (get_time_() - request->queued_time_ns) / 1e6,
+      {{"SizeBucket", SizeBucket(request->object_size)}});
   auto it = fulfilled_requests_.find(request->request_id);
   RAY_CHECK(it != fulfilled_requests_.end());
   RAY_CHECK(it->second == nullptr);
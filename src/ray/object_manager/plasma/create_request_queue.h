@@ -39,30 +39,34 @@ class CreateRequestQueue {
                      ray::SpillObjectsCallback spill_objects_callback,
                      std::function<void()> trigger_global_gc,
                      std::function<int64_t()> get_time,
-                     std::function<std::string()> dump_debug_info_callback = nullptr)
+                     std::function<std::string()> dump_debug_info_callback = nullptr,
+                     size_t small_request_max_size = 0)
       : fs_monitor_(fs_monitor),
         oom_grace_period_ns_(oom_grace_period_s * 1e9),
         spill_objects_callback_(spill_objects_callback),
         trigger_global_gc_(trigger_global_gc),
         get_time_(get_time),
-        dump_debug_info_callback_(dump_debug_info_callback) {}
+        dump_debug_info_callback_(dump_debug_info_callback),
+        small_request_max_size_(small_request_max_size) {}
 
   /// Add a request to the queue. The caller should use the returned request ID
   /// to later get the result of the request.
   ///
   /// The request may not get tried immediately if the head of the queue is not
-  /// serviceable.
+  /// serviceable. It is queued behind the requests of the same or a higher priority.
   ///
   /// \param object_id The ID of the object to create.
   /// \param client The client that sent the request. This is used as a key to
   /// drop this request if the client disconnects.
   /// \param create_callback A callback to attempt to create the object.
   /// \param object_size Object size in bytes.
+  /// \param priority Priority of the request, higher is served first.
   /// \return A request ID that can be used to get the result.
   uint64_t AddRequest(const ObjectID &object_id,
                       const std::shared_ptr<ClientInterface> &client,
                       const CreateObjectCallback &create_callback,
-                      const size_t object_size);
+                      const size_t object_size,
+                      int32_t priority = 0);
 
   /// Get the result of a request.
   ///
@@ -101,8 +105,11 @@ class CreateRequestQueue {
   /// Process requests in the queue.
   ///
   /// This will try to process as many requests in the queue as possible, in
-  /// FIFO order. If the first request is not serviceable, this will break and
-  /// the caller should try again later.
+  /// priority and then FIFO order. If the first request is not serviceable, this
+  /// will break and the caller should try again later. Before that, the queued
+  /// requests of at most small_request_max_size bytes are tried, so that they can
+  /// be served from the free space while the first one waits for spilling. They
+  /// may take up to the size of the first request in total.
   ///
   /// \return Bad status for the first request in the queue if it failed to be
   /// serviced, or OK if all requests were fulfilled.
@@ -123,12 +130,16 @@ class CreateRequestQueue {
                   uint64_t request_id,
                   const std::shared_ptr<ClientInterface> &client,
                   CreateObjectCallback create_callback,
-                  size_t object_size)
+                  size_t object_size,
+                  int32_t priority,
+                  int64_t queued_time_ns)
         : object_id(object_id),
           request_id(request_id),
           client(client),
           create_callback(create_callback),
-          object_size(object_size) {}
+          object_size(object_size),
+          priority(priority),
+          queued_time_ns(queued_time_ns) {}
 
     // The ObjectID to create.
     const ObjectID object_id;
@@ -146,6 +157,11 @@ class CreateRequestQueue {
 
     const size_t object_size;
 
+    const int32_t priority;
+
+    // When the request was queued, used to measure its wait time.
+    const int64_t queued_time_ns;
+
     // The results of the creation call. These should be sent back to the
     // client once ready.
     PlasmaError error = PlasmaError::OK;
@@ -157,6 +173,11 @@ class CreateRequestQueue {
   /// finished.
   Status ProcessRequest(bool fallback_allocator, std::unique_ptr<CreateRequest> &request);
 
+  /// Try the small requests behind the first one in the queue, with the primary
+  /// allocator only. Stops at the first one that doesn't fit, or once the small
+  /// requests served ahead of the first one add up to its size.
+  void ProcessSmallRequests();
+
   /// Finish a queued request and remove it from the queue.
   void FinishRequest(std::list<std::unique_ptr<CreateRequest>>::iterator request_it);
 
@@ -186,6 +207,10 @@ class CreateRequestQueue {
   /// Sink for debug info.
   const std::function<std::string()> dump_debug_info_callback_;
 
+  /// Requests up to this size may be served ahead of a first request that doesn't
+  /// fit. 0 keeps the queue strictly in order.
+  const size_t small_request_max_size_;
+
   /// Queue of object creation requests to respond to. Requests will be placed
   /// on this queue if the object store does not have enough room at the time
   /// that the client made the creation request, but space may be made through
@@ -207,9 +232,18 @@ class CreateRequestQueue {
   /// Last time global gc was invoked in ms.
   uint64_t last_global_gc_ms_;
 
-  /// The time OOM timer first starts. It becomes -1 upon every creation success.
+  /// The time OOM timer first starts. It becomes -1 upon every creation success, and
+  /// when another request takes the head of the queue.
   int64_t oom_start_time_ns_ = -1;
 
+  /// The ID of the request at the head of the queue, or 0 if none was processed yet.
+  uint64_t head_request_id_ = 0;
+
+  /// Bytes of the small requests served ahead of the current head. They may take at
+  /// most as many bytes as the head needs, so that they delay it by at most as much
+  /// spilling again.
+  size_t small_request_bytes_ahead_of_head_ = 0;
+
   size_t num_bytes_pending_ = 0;
 
   friend class CreateRequestQueueTest;
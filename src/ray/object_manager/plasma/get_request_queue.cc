@@ -94,8 +94,14 @@ void GetRequestQueue::AddRequest(const std::shared_ptr<ClientInterface> &client,
     // that a timeout of -1 is used to indicate that no timer should be set.
     get_request->AsyncWait(timeout_ms,
                            [this, get_request](const boost::system::error_code &ec) {
-                             if (ec != boost::asio::error::operation_aborted) {
-                               // Timer was not cancelled, take necessary action.
+                             if (ec == boost::asio::error::operation_aborted) {
+                               return;
+                             }
+                             // Timer was not cancelled, take necessary action.
+                             if (timeout_mutex_ != nullptr) {
+                               absl::MutexLock lock(timeout_mutex_);
+                               OnGetRequestCompleted(get_request);
+                             } else {
                                OnGetRequestCompleted(get_request);
                              }
                            });
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/id.h"
 #include "ray/object_manager/plasma/connection.h"
@@ -75,11 +76,13 @@ class GetRequestQueue {
   GetRequestQueue(instrumented_io_context &io_context,
                   IObjectLifecycleManager &object_lifecycle_mgr,
                   ObjectReadyCallback object_callback,
-                  AllObjectReadyCallback all_objects_callback)
+                  AllObjectReadyCallback all_objects_callback,
+                  absl::Mutex *timeout_mutex = nullptr)
       : io_context_(io_context),
         object_lifecycle_mgr_(object_lifecycle_mgr),
         object_satisfied_callback_(object_callback),
-        all_objects_satisfied_callback_(all_objects_callback) {}
+        all_objects_satisfied_callback_(all_objects_callback),
+        timeout_mutex_(timeout_mutex) {}
 
   /// Add a get request to get request queue. Note this will call callback functions
   /// directly if all objects has been satisfied, otherwise store the request
@@ -133,6 +136,10 @@ class GetRequestQueue {
   ObjectReadyCallback object_satisfied_callback_;
   AllObjectReadyCallback all_objects_satisfied_callback_;
 
+  /// The lock that guards the queue, if any. It's taken when a get request times out,
+  /// since the timer fires outside of the callers' lock.
+  absl::Mutex *timeout_mutex_;
+
   friend struct GetRequestQueueTest;
 };
 
@@ -0,0 +1,281 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/object_access_trace_analyzer.h"
+
+#include <limits>
+#include <list>
+#include <sstream>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace plasma {
+
+namespace {
+
+/// Upper bounds of the lifetime histogram buckets, in milliseconds.
+const std::vector<int64_t> kLifetimeBucketsMs = {1, 10, 100, 1000, 10000, 60000};
+
+/// A Fenwick tree over the positions of the gets, counting the gets that are the
+/// latest one of their object.
+class FenwickTree {
+ public:
+  explicit FenwickTree(size_t size) : tree_(size + 1, 0) {}
+
+  void Add(size_t pos, int64_t delta) {
+    for (pos++; pos < tree_.size(); pos += pos & (~pos + 1)) {
+      tree_[pos] += delta;
+    }
+  }
+
+  /// Sum of positions [0, pos).
+  int64_t PrefixSum(size_t pos) const {
+    int64_t sum = 0;
+    for (; pos > 0; pos -= pos & (~pos + 1)) {
+      sum += tree_[pos];
+    }
+    return sum;
+  }
+
+ private:
+  std::vector<int64_t> tree_;
+};
+
+int64_t ReuseDistanceBucket(int64_t distance) {
+  int64_t bucket = 0;
+  if (distance > 0) {
+    bucket = 1;
+    while (bucket < distance) {
+      bucket <<= 1;
+    }
+  }
+  return bucket;
+}
+
+}  // namespace
+
+ObjectAccessTraceAnalyzer::ObjectAccessTraceAnalyzer(
+    std::vector<ObjectAccessEvent> events)
+    : events_(std::move(events)) {}
+
+std::map<int64_t, int64_t> ObjectAccessTraceAnalyzer::GetReuseDistanceHistogram(
+    int64_t *num_cold_gets) const {
+  size_t num_gets = 0;
+  for (const auto &event : events_) {
+    if (event.type == ObjectAccessEventType::GET) {
+      num_gets++;
+    }
+  }
+
+  std::map<int64_t, int64_t> histogram;
+  *num_cold_gets = 0;
+  FenwickTree latest_gets(num_gets);
+  absl::flat_hash_map<ObjectID, size_t> last_get_pos;
+  size_t pos = 0;
+  for (const auto &event : events_) {
+    if (event.type != ObjectAccessEventType::GET) {
+      continue;
+    }
+    auto it = last_get_pos.find(event.object_id);
+    if (it == last_get_pos.end()) {
+      (*num_cold_gets)++;
+      last_get_pos.emplace(event.object_id, pos);
+    } else {
+      // Every object got since the previous get of this object has exactly one
+      // latest get in between.
+      const int64_t distance =
+          latest_gets.PrefixSum(pos) - latest_gets.PrefixSum(it->second + 1);
+      histogram[ReuseDistanceBucket(distance)]++;
+      latest_gets.Add(it->second, -1);
+      it->second = pos;
+    }
+    latest_gets.Add(pos, 1);
+    pos++;
+  }
+  return histogram;
+}
+
+std::map<int64_t, int64_t> ObjectAccessTraceAnalyzer::GetLifetimeHistogram() const {
+  std::map<int64_t, int64_t> histogram;
+  absl::flat_hash_map<ObjectID, int64_t> create_time_us;
+  for (const auto &event : events_) {
+    if (event.type == ObjectAccessEventType::CREATE) {
+      create_time_us[event.object_id] = event.timestamp_us;
+    } else if (event.type == ObjectAccessEventType::EVICT ||
+               event.type == ObjectAccessEventType::DELETE) {
+      auto it = create_time_us.find(event.object_id);
+      if (it == create_time_us.end()) {
+        continue;
+      }
+      const int64_t lifetime_ms = (event.timestamp_us - it->second) / 1000;
+      create_time_us.erase(it);
+      int64_t bucket = std::numeric_limits<int64_t>::max();
+      for (int64_t bound : kLifetimeBucketsMs) {
+        if (lifetime_ms <= bound) {
+          bucket = bound;
+          break;
+        }
+      }
+      histogram[bucket]++;
+    }
+  }
+  return histogram;
+}
+
+ObjectAccessTraceReplayResult ObjectAccessTraceAnalyzer::Replay(int64_t capacity) const {
+  struct ResidentObject {
+    int64_t size;
+    int64_t ref_count;
+    /// Position in the LRU list, only valid while ref_count is 0.
+    std::list<ObjectID>::iterator lru_it;
+  };
+
+  ObjectAccessTraceReplayResult result;
+  result.capacity = capacity;
+  absl::flat_hash_map<ObjectID, ResidentObject> resident;
+  // Objects evicted by the replayed store that weren't deleted since.
+  absl::flat_hash_set<ObjectID> evicted;
+  // Unreferenced resident objects, least recently used first.
+  std::list<ObjectID> lru;
+  int64_t bytes_used = 0;
+
+  auto make_room = [&](int64_t size) {
+    while (bytes_used + size > capacity && !lru.empty()) {
+      auto it = resident.find(lru.front());
+      bytes_used -= it->second.size;
+      result.num_evictions++;
+      result.bytes_evicted += it->second.size;
+      evicted.insert(it->first);
+      resident.erase(it);
+      lru.pop_front();
+    }
+  };
+  auto insert = [&](const ObjectAccessEvent &event, int64_t ref_count) {
+    make_room(event.object_size);
+    auto &object = resident[event.object_id];
+    object.size = event.object_size;
+    object.ref_count = ref_count;
+    if (ref_count == 0) {
+      object.lru_it = lru.insert(lru.end(), event.object_id);
+    }
+    bytes_used += event.object_size;
+  };
+
+  for (const auto &event : events_) {
+    auto it = resident.find(event.object_id);
+    switch (event.type) {
+    case ObjectAccessEventType::CREATE:
+      // Objects are created again when the original store restores them. If the
+      // replayed store kept the object, the restore is saved.
+      if (it == resident.end()) {
+        if (evicted.erase(event.object_id) > 0) {
+          result.num_misses++;
+          result.bytes_missed += event.object_size;
+        }
+        insert(event, /*ref_count=*/0);
+      }
+      break;
+    case ObjectAccessEventType::GET:
+      result.num_gets++;
+      if (it == resident.end()) {
+        if (evicted.erase(event.object_id) > 0) {
+          result.num_misses++;
+          result.bytes_missed += event.object_size;
+        }
+        insert(event, /*ref_count=*/1);
+      } else {
+        result.num_hits++;
+        if (it->second.ref_count++ == 0) {
+          lru.erase(it->second.lru_it);
+        }
+      }
+      break;
+    case ObjectAccessEventType::RELEASE:
+      if (it != resident.end() && it->second.ref_count > 0 &&
+          --it->second.ref_count == 0) {
+        it->second.lru_it = lru.insert(lru.end(), event.object_id);
+      }
+      break;
+    case ObjectAccessEventType::DELETE:
+      evicted.erase(event.object_id);
+      if (it != resident.end()) {
+        if (it->second.ref_count == 0) {
+          lru.erase(it->second.lru_it);
+        }
+        bytes_used -= it->second.size;
+        resident.erase(it);
+      }
+      break;
+    case ObjectAccessEventType::SEAL:
+    case ObjectAccessEventType::EVICT:
+    case ObjectAccessEventType::SPILL:
+      // Evictions and spilling are decided by the replayed store itself.
+      break;
+    }
+  }
+  return result;
+}
+
+std::string ObjectAccessTraceAnalyzer::Report(
+    const std::vector<int64_t> &capacities) const {
+  std::stringstream result;
+  result << "Plasma access trace:";
+  result << "\n- num events: " << events_.size();
+  if (!events_.empty()) {
+    result << "\n- duration ms: "
+           << (events_.back().timestamp_us - events_.front().timestamp_us) / 1000;
+  }
+  absl::flat_hash_map<ObjectAccessEventType, int64_t> num_events_by_type;
+  for (const auto &event : events_) {
+    num_events_by_type[event.type]++;
+  }
+  for (int type = 0; type <= static_cast<int>(ObjectAccessEventType::SPILL); type++) {
+    const auto event_type = static_cast<ObjectAccessEventType>(type);
+    result << "\n- num " << ObjectAccessEventTypeName(event_type)
+           << " events: " << num_events_by_type[event_type];
+  }
+
+  int64_t num_cold_gets = 0;
+  const auto reuse_distances = GetReuseDistanceHistogram(&num_cold_gets);
+  result << "\nReuse distance (distinct objects between gets):";
+  result << "\n- first get: " << num_cold_gets;
+  for (const auto &[bucket, count] : reuse_distances) {
+    result << "\n- <= " << bucket << ": " << count;
+  }
+
+  result << "\nLifetime (create to evict or delete):";
+  for (const auto &[bucket, count] : GetLifetimeHistogram()) {
+    if (bucket == std::numeric_limits<int64_t>::max()) {
+      result << "\n- > " << kLifetimeBucketsMs.back() << " ms: " << count;
+    } else {
+      result << "\n- <= " << bucket << " ms: " << count;
+    }
+  }
+
+  for (int64_t capacity : capacities) {
+    const auto replay = Replay(capacity);
+    result << "\nReplay with capacity " << capacity << " bytes:";
+    result << "\n- num gets: " << replay.num_gets;
+    result << "\n- num hits: " << replay.num_hits;
+    result << "\n- num misses: " << replay.num_misses << " (" << replay.bytes_missed
+           << " bytes)";
+    result << "\n- num evictions: " << replay.num_evictions << " ("
+           << replay.bytes_evicted << " bytes)";
+  }
+  return result.str();
+}
+
+}  // namespace plasma
@@ -0,0 +1,74 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ray/object_manager/plasma/object_access_tracer.h"
+
+namespace plasma {
+
+/// The outcome of replaying a trace against a store of a given capacity.
+struct ObjectAccessTraceReplayResult {
+  int64_t capacity = 0;
+  int64_t num_gets = 0;
+  /// Gets of objects that were still in the store.
+  int64_t num_hits = 0;
+  /// Times an object evicted by the replayed store had to be restored, either to
+  /// serve a get or because the original store restored it too.
+  int64_t num_misses = 0;
+  int64_t bytes_missed = 0;
+  int64_t num_evictions = 0;
+  int64_t bytes_evicted = 0;
+};
+
+// ObjectAccessTraceAnalyzer computes offline statistics of a plasma access trace
+// written by ObjectAccessTracer.
+class ObjectAccessTraceAnalyzer {
+ public:
+  explicit ObjectAccessTraceAnalyzer(std::vector<ObjectAccessEvent> events);
+
+  /// Histogram of the reuse distance of the gets, i.e. the number of distinct
+  /// objects that were got since the previous get of the same object. The keys
+  /// are the inclusive upper bounds of the buckets (0, 1, 2, 4, 8, ...).
+  ///
+  /// \param[out] num_cold_gets The number of gets of objects not got before.
+  std::map<int64_t, int64_t> GetReuseDistanceHistogram(int64_t *num_cold_gets) const;
+
+  /// Histogram of the time in milliseconds from the creation of the objects to
+  /// their eviction or deletion. The keys are the inclusive upper bounds of the
+  /// buckets, and objects that lived longer than the last bound are counted
+  /// under INT64_MAX. Objects created before the trace started or still alive at
+  /// its end are not counted.
+  std::map<int64_t, int64_t> GetLifetimeHistogram() const;
+
+  /// Replay the trace against a store of the given capacity that evicts the
+  /// least recently used objects that aren't referenced. The evictions of the
+  /// original store are ignored, and its restores of objects the replayed store
+  /// still holds are skipped.
+  ObjectAccessTraceReplayResult Replay(int64_t capacity) const;
+
+  /// A human-readable report of all the statistics above, with a replay per
+  /// capacity.
+  std::string Report(const std::vector<int64_t> &capacities) const;
+
+ private:
+  const std::vector<ObjectAccessEvent> events_;
+};
+
+}  // namespace plasma
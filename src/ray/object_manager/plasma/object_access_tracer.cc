@@ -0,0 +1,234 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/object_access_tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/clock.h"
+#include "ray/util/logging.h"
+
+namespace plasma {
+
+namespace {
+
+constexpr char kTraceMagic[4] = {'P', 'L', 'T', 'R'};
+constexpr uint64_t kTraceVersion = 1;
+
+void WriteVarint(std::ostream &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.put(static_cast<char>(value));
+}
+
+bool ReadVarint(std::istream &in, uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const int byte = in.get();
+    if (byte == std::char_traits<char>::eof()) {
+      return false;
+    }
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}  // namespace
+
+const char *ObjectAccessEventTypeName(ObjectAccessEventType type) {
+  switch (type) {
+  case ObjectAccessEventType::CREATE:
+    return "create";
+  case ObjectAccessEventType::SEAL:
+    return "seal";
+  case ObjectAccessEventType::GET:
+    return "get";
+  case ObjectAccessEventType::RELEASE:
+    return "release";
+  case ObjectAccessEventType::EVICT:
+    return "evict";
+  case ObjectAccessEventType::DELETE:
+    return "delete";
+  case ObjectAccessEventType::SPILL:
+    return "spill";
+  }
+  return "unknown";
+}
+
+ObjectAccessTracer::ObjectAccessTracer(size_t capacity) : capacity_(capacity) {
+  RAY_CHECK_GT(capacity_, 0u);
+  events_.reserve(capacity_);
+}
+
+void ObjectAccessTracer::Record(ObjectAccessEventType type,
+                                const ObjectID &object_id,
+                                int64_t size) {
+  ObjectAccessEvent event{absl::GetCurrentTimeNanos() / 1000, object_id, size, type};
+  if (events_.size() < capacity_) {
+    events_.push_back(event);
+  } else {
+    events_[next_] = event;
+  }
+  next_ = (next_ + 1) % capacity_;
+  num_events_total_++;
+}
+
+std::vector<ObjectAccessEvent> ObjectAccessTracer::GetEvents() const {
+  if (events_.size() < capacity_) {
+    return events_;
+  }
+  std::vector<ObjectAccessEvent> events;
+  events.reserve(events_.size());
+  events.insert(events.end(), events_.begin() + next_, events_.end());
+  events.insert(events.end(), events_.begin(), events_.begin() + next_);
+  return events;
+}
+
+void ObjectAccessTracer::Dump(std::ostream &out) const {
+  WriteObjectAccessTrace(out, GetEvents());
+}
+
+ray::Status ObjectAccessTracer::DumpToFile(const std::string &path) const {
+  return WriteObjectAccessTraceFile(path, GetEvents());
+}
+
+void WriteObjectAccessTrace(std::ostream &out,
+                            const std::vector<ObjectAccessEvent> &events) {
+  std::vector<const ObjectAccessEvent *> objects;
+  absl::flat_hash_map<ObjectID, uint64_t> object_indices;
+  for (const auto &event : events) {
+    if (object_indices.emplace(event.object_id, objects.size()).second) {
+      objects.push_back(&event);
+    }
+  }
+
+  out.write(kTraceMagic, sizeof(kTraceMagic));
+  WriteVarint(out, kTraceVersion);
+  WriteVarint(out, objects.size());
+  for (const auto *object : objects) {
+    out.write(reinterpret_cast<const char *>(object->object_id.Data()),
+              ObjectID::Size());
+    WriteVarint(out, object->object_size);
+  }
+  WriteVarint(out, events.size());
+  int64_t last_timestamp_us = 0;
+  for (const auto &event : events) {
+    out.put(static_cast<char>(event.type));
+    WriteVarint(out, object_indices[event.object_id]);
+    WriteVarint(out, ZigZagEncode(event.timestamp_us - last_timestamp_us));
+    last_timestamp_us = event.timestamp_us;
+  }
+}
+
+ray::Status WriteObjectAccessTraceFile(const std::string &path,
+                                       const std::vector<ObjectAccessEvent> &events) {
+  // Write to a temporary file first, so that the trace at `path` is always complete,
+  // even if the process dies while writing.
+  const std::string tmp_path = path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return ray::Status::IOError("Failed to open " + tmp_path);
+  }
+  WriteObjectAccessTrace(out, events);
+  out.close();
+  if (!out) {
+    return ray::Status::IOError("Failed to write " + tmp_path);
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    return ray::Status::IOError("Failed to rename " + tmp_path + " to " + path);
+  }
+  return ray::Status::OK();
+}
+
+ray::Status ReadObjectAccessTrace(std::istream &in,
+                                  std::vector<ObjectAccessEvent> *events) {
+  char magic[sizeof(kTraceMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), kTraceMagic)) {
+    return ray::Status::Invalid("Not a plasma access trace.");
+  }
+  uint64_t version;
+  if (!ReadVarint(in, &version) || version != kTraceVersion) {
+    return ray::Status::Invalid("Unsupported plasma access trace version.");
+  }
+
+  uint64_t num_objects;
+  if (!ReadVarint(in, &num_objects)) {
+    return ray::Status::Invalid("Truncated plasma access trace.");
+  }
+  std::vector<std::pair<ObjectID, int64_t>> objects;
+  objects.reserve(num_objects);
+  std::string id_binary(ObjectID::Size(), '\0');
+  for (uint64_t i = 0; i < num_objects; i++) {
+    uint64_t size;
+    if (!in.read(id_binary.data(), id_binary.size()) || !ReadVarint(in, &size)) {
+      return ray::Status::Invalid("Truncated plasma access trace.");
+    }
+    objects.emplace_back(ObjectID::FromBinary(id_binary), size);
+  }
+
+  uint64_t num_events;
+  if (!ReadVarint(in, &num_events)) {
+    return ray::Status::Invalid("Truncated plasma access trace.");
+  }
+  events->clear();
+  events->reserve(num_events);
+  int64_t timestamp_us = 0;
+  for (uint64_t i = 0; i < num_events; i++) {
+    const int type = in.get();
+    uint64_t index;
+    uint64_t delta;
+    if (type == std::char_traits<char>::eof() || !ReadVarint(in, &index) ||
+        !ReadVarint(in, &delta)) {
+      return ray::Status::Invalid("Truncated plasma access trace.");
+    }
+    if (type > static_cast<int>(ObjectAccessEventType::SPILL) ||
+        index >= objects.size()) {
+      return ray::Status::Invalid("Corrupted plasma access trace.");
+    }
+    timestamp_us += ZigZagDecode(delta);
+    events->push_back({timestamp_us,
+                       objects[index].first,
+                       objects[index].second,
+                       static_cast<ObjectAccessEventType>(type)});
+  }
+  return ray::Status::OK();
+}
+
+ray::Status ReadObjectAccessTraceFile(const std::string &path,
+                                      std::vector<ObjectAccessEvent> *events) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return ray::Status::IOError("Failed to open " + path);
+  }
+  return ReadObjectAccessTrace(in, events);
+}
+
+}  // namespace plasma
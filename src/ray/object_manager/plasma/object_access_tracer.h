@@ -0,0 +1,108 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ray/common/id.h"
+#include "ray/common/status.h"
+
+namespace plasma {
+
+using ray::ObjectID;
+
+enum class ObjectAccessEventType : uint8_t {
+  CREATE = 0,
+  SEAL = 1,
+  /// A client (or the raylet) took a reference to the object.
+  GET = 2,
+  /// A client (or the raylet) released a reference to the object.
+  RELEASE = 3,
+  /// The store evicted the object to make room for other objects.
+  EVICT = 4,
+  /// The object was deleted or aborted.
+  DELETE = 5,
+  /// The raylet spilled the object to external storage.
+  SPILL = 6,
+};
+
+const char *ObjectAccessEventTypeName(ObjectAccessEventType type);
+
+struct ObjectAccessEvent {
+  int64_t timestamp_us;
+  ObjectID object_id;
+  /// Data plus metadata size of the object.
+  int64_t object_size;
+  ObjectAccessEventType type;
+};
+
+// ObjectAccessTracer keeps the latest object access events of the plasma store
+// in a fixed-size ring buffer, so that tracing can be left on with a bounded
+// memory cost. The events can be dumped to a compact binary trace and read back
+// by plasma_trace_analyzer.
+//
+// The trace starts with the magic "PLTR" and a version, followed by the table of
+// the traced objects and the events, which refer to the objects by their index
+// in the table. Integers other than the header are LEB128 varints and event
+// timestamps are deltas from the previous event.
+//
+// Like the rest of the store state, it's not thread safe.
+class ObjectAccessTracer {
+ public:
+  /// \param capacity The maximum number of events kept. Must be positive.
+  explicit ObjectAccessTracer(size_t capacity);
+
+  void Record(ObjectAccessEventType type, const ObjectID &object_id, int64_t size);
+
+  /// The events still in the buffer, oldest first.
+  std::vector<ObjectAccessEvent> GetEvents() const;
+
+  /// Number of events recorded so far, including those overwritten.
+  int64_t GetNumEventsTotal() const { return num_events_total_; }
+
+  /// Write the events still in the buffer as a binary trace.
+  void Dump(std::ostream &out) const;
+
+  ray::Status DumpToFile(const std::string &path) const;
+
+ private:
+  const size_t capacity_;
+  std::vector<ObjectAccessEvent> events_;
+  /// Index of the slot the next event is written to.
+  size_t next_ = 0;
+  int64_t num_events_total_ = 0;
+};
+
+/// Write the events as a binary trace.
+void WriteObjectAccessTrace(std::ostream &out,
+                            const std::vector<ObjectAccessEvent> &events);
+
+/// Write the events as a binary trace file. The file is replaced at once, so it
+/// always holds a complete trace.
+ray::Status WriteObjectAccessTraceFile(const std::string &path,
+                                       const std::vector<ObjectAccessEvent> &events);
+
+/// Read a binary trace written by WriteObjectAccessTrace.
+ray::Status ReadObjectAccessTrace(std::istream &in,
+                                  std::vector<ObjectAccessEvent> *events);
+
+ray::Status ReadObjectAccessTraceFile(const std::string &path,
+                                      std::vector<ObjectAccessEvent> *events);
+
+}  // namespace plasma
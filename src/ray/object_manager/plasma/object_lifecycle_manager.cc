@@ -29,7 +29,12 @@ ObjectLifecycleManager::ObjectLifecycleManager(
       eviction_policy_(std::make_unique<EvictionPolicy>(*object_store_, allocator)),
       delete_object_callback_(delete_object_callback),
       earger_deletion_objects_(),
-      stats_collector_(std::make_unique<ObjectStatsCollector>()) {}
+      stats_collector_(std::make_unique<ObjectStatsCollector>(&allocator)) {
+  if (RayConfig::instance().plasma_access_trace_capacity() > 0) {
+    access_tracer_ = std::make_unique<ObjectAccessTracer>(
+        RayConfig::instance().plasma_access_trace_capacity());
+  }
+}
 
 std::pair<const LocalObject *, flatbuf::PlasmaError> ObjectLifecycleManager::CreateObject(
     const ray::ObjectInfo &object_info,
@@ -47,6 +52,7 @@ std::pair<const LocalObject *, flatbuf::PlasmaError> ObjectLifecycleManager::Cre
   }
   eviction_policy_->ObjectCreated(object_info.object_id);
   stats_collector_->OnObjectCreated(*entry);
+  RecordAccess(ObjectAccessEventType::CREATE, *entry);
   return {entry, PlasmaError::OK};
 }
 
@@ -59,6 +65,7 @@ const LocalObject *ObjectLifecycleManager::SealObject(const ObjectID &object_id)
   auto entry = object_store_->SealObject(object_id);
   if (entry != nullptr) {
     stats_collector_->OnObjectSealed(*entry);
+    RecordAccess(ObjectAccessEventType::SEAL, *entry);
   }
   return entry;
 }
@@ -75,6 +82,7 @@ flatbuf::PlasmaError ObjectLifecycleManager::AbortObject(const ObjectID &object_
   }
 
   bool abort_while_using = entry->ref_count > 0;
+  RecordAccess(ObjectAccessEventType::DELETE, *entry);
   DeleteObjectInternal(object_id);
 
   if (abort_while_using) {
@@ -106,6 +114,7 @@ PlasmaError ObjectLifecycleManager::DeleteObject(const ObjectID &object_id) {
     return PlasmaError::ObjectInUse;
   }
 
+  RecordAccess(ObjectAccessEventType::DELETE, *entry);
   DeleteObjectInternal(object_id);
   return PlasmaError::OK;
 }
@@ -133,6 +142,7 @@ bool ObjectLifecycleManager::AddReference(const ObjectID &object_id) {
   // Increase reference count.
   entry->ref_count++;
   stats_collector_->OnObjectRefIncreased(*entry);
+  RecordAccess(ObjectAccessEventType::GET, *entry);
   RAY_LOG(DEBUG) << "Object " << object_id << " reference has incremented"
                  << ", num bytes in use is now " << GetNumBytesInUse();
   return true;
@@ -149,6 +159,7 @@ bool ObjectLifecycleManager::RemoveReference(const ObjectID &object_id) {
 
   entry->ref_count--;
   stats_collector_->OnObjectRefDecreased(*entry);
+  RecordAccess(ObjectAccessEventType::RELEASE, *entry);
 
   if (entry->ref_count > 0) {
     return true;
@@ -162,11 +173,28 @@ bool ObjectLifecycleManager::RemoveReference(const ObjectID &object_id) {
   // TODO(scv119): handle this anomaly in upper layer.
   RAY_CHECK(entry->Sealed()) << object_id << " is not sealed while ref count becomes 0.";
   if (earger_deletion_objects_.count(object_id) > 0) {
+    RecordAccess(ObjectAccessEventType::DELETE, *entry);
     DeleteObjectInternal(object_id);
   }
   return true;
 }
 
+bool ObjectLifecycleManager::DeduplicateObject(const ObjectID &object_id,
+                                               uint64_t content_hash,
+                                               bool keep_allocation) {
+  auto entry = object_store_->GetObject(object_id);
+  uint64_t min_size = RayConfig::instance().plasma_dedup_min_object_size();
+  if (entry == nullptr || min_size == 0 || content_hash == kNoContentHash ||
+      static_cast<uint64_t>(entry->GetObjectSize()) < min_size) {
+    return false;
+  }
+  return object_store_->DeduplicateObject(object_id, content_hash, keep_allocation);
+}
+
+void ObjectLifecycleManager::FreeRetiredAllocation(const ObjectID &object_id) {
+  object_store_->FreeRetiredAllocation(object_id);
+}
+
 std::string ObjectLifecycleManager::EvictionPolicyDebugString() const {
   return eviction_policy_->DebugString();
 }
@@ -229,6 +257,7 @@ void ObjectLifecycleManager::EvictObjects(const std::vector<ObjectID> &object_id
     RAY_CHECK(entry->ref_count == 0)
         << "To evict an object, there must be no clients currently using it.";
 
+    RecordAccess(ObjectAccessEventType::EVICT, *entry);
     DeleteObjectInternal(object_id);
   }
 }
@@ -278,7 +307,32 @@ int64_t ObjectLifecycleManager::GetNumObjectsUnsealed() const {
 void ObjectLifecycleManager::RecordMetrics() const { stats_collector_->RecordMetrics(); }
 
 void ObjectLifecycleManager::GetDebugDump(std::stringstream &buffer) const {
-  return stats_collector_->GetDebugDump(buffer);
+  stats_collector_->GetDebugDump(buffer);
+  if (RayConfig::instance().plasma_dedup_min_object_size() > 0) {
+    buffer << "- bytes deduplicated: " << object_store_->GetNumBytesDeduplicated()
+           << "\n";
+  }
+}
+
+void ObjectLifecycleManager::RecordObjectSpilled(const ObjectID &object_id) {
+  auto entry = object_store_->GetObject(object_id);
+  if (entry != nullptr) {
+    RecordAccess(ObjectAccessEventType::SPILL, *entry);
+  }
+}
+
+std::vector<ObjectAccessEvent> ObjectLifecycleManager::GetAccessTraceEvents() const {
+  if (access_tracer_ == nullptr) {
+    return {};
+  }
+  return access_tracer_->GetEvents();
+}
+
+void ObjectLifecycleManager::RecordAccess(ObjectAccessEventType type,
+                                          const LocalObject &entry) {
+  if (access_tracer_ != nullptr) {
+    access_tracer_->Record(type, entry.GetObjectInfo().object_id, entry.GetObjectSize());
+  }
 }
 
 // For test only.
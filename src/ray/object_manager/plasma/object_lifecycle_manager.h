@@ -21,6 +21,7 @@
 #include "gtest/gtest.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/eviction_policy.h"
+#include "ray/object_manager/plasma/object_access_tracer.h"
 #include "ray/object_manager/plasma/object_store.h"
 #include "ray/object_manager/plasma/plasma_allocator.h"
 #include "ray/object_manager/plasma/stats_collector.h"
@@ -120,6 +121,23 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
 
   bool RemoveReference(const ObjectID &object_id) override;
 
+  /// Share the memory of a sealed object with the objects of identical content, if
+  /// the object is at least plasma_dedup_min_object_size bytes and the client hashed
+  /// it.
+  ///
+  /// \param object_id Object ID of the sealed object.
+  /// \param content_hash Hash of the object's content, or kNoContentHash.
+  /// \param keep_allocation Whether a client still maps the object's own allocation,
+  /// which is then kept until FreeRetiredAllocation.
+  /// \return true if the object now shares the memory of another object.
+  bool DeduplicateObject(const ObjectID &object_id,
+                         uint64_t content_hash,
+                         bool keep_allocation);
+
+  /// Free the own allocation of a deduplicated object, once the client that mapped
+  /// it released the object.
+  void FreeRetiredAllocation(const ObjectID &object_id);
+
   /// Ask it to evict objects until we have at least size of capacity
   /// available.
   /// TEST ONLY
@@ -145,6 +163,13 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
 
   void GetDebugDump(std::stringstream &buffer) const;
 
+  /// Record in the access trace that the raylet spilled the object, if tracing
+  /// is enabled.
+  void RecordObjectSpilled(const ObjectID &object_id);
+
+  /// The events in the access trace, oldest first. Empty if tracing is disabled.
+  std::vector<ObjectAccessEvent> GetAccessTraceEvents() const;
+
  private:
   // Test only
   ObjectLifecycleManager(std::unique_ptr<IObjectStore> store,
@@ -169,6 +194,9 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
   void EvictObjects(const std::vector<ObjectID> &object_ids);
 
   void DeleteObjectInternal(const ObjectID &object_id);
+
+  void RecordAccess(ObjectAccessEventType type, const LocalObject &entry);
+
   std::unique_ptr<IObjectStore> object_store_;
   std::unique_ptr<IEvictionPolicy> eviction_policy_;
   const ray::DeleteObjectCallback delete_object_callback_;
@@ -178,5 +206,8 @@ class ObjectLifecycleManager : public IObjectLifecycleManager {
   absl::flat_hash_set<ObjectID> earger_deletion_objects_;
 
   std::unique_ptr<ObjectStatsCollector> stats_collector_;
+
+  /// Null unless plasma_access_trace_capacity is set.
+  std::unique_ptr<ObjectAccessTracer> access_tracer_;
 };
 }  // namespace plasma
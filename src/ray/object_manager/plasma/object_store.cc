@@ -17,6 +17,11 @@
 
 #include "ray/object_manager/plasma/object_store.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "absl/strings/string_view.h"
+
 namespace plasma {
 
 ObjectStore::ObjectStore(IAllocator &allocator)
@@ -82,11 +87,99 @@ bool ObjectStore::DeleteObject(const ObjectID &object_id) {
     return false;
   }
 
-  allocator_.Free(std::move(entry->allocation));
+  FreeRetiredAllocation(object_id);
+  auto buffer_it = object_buffers_.find(object_id);
+  if (buffer_it == object_buffers_.end()) {
+    allocator_.Free(std::move(entry->allocation));
+  } else {
+    // The allocation of a deduplicated object is an alias, the memory belongs to
+    // the buffer.
+    ContentBuffer *buffer = buffer_it->second;
+    object_buffers_.erase(buffer_it);
+    buffer->num_objects--;
+    if (buffer->num_objects > 0) {
+      num_bytes_deduplicated_ -= buffer->data_size + buffer->metadata_size;
+    } else {
+      uint64_t content_hash = buffer->content_hash;
+      auto &buffers = content_buffers_[content_hash];
+      auto it = std::find_if(buffers.begin(), buffers.end(), [buffer](const auto &b) {
+        return b.get() == buffer;
+      });
+      RAY_CHECK(it != buffers.end());
+      allocator_.Free(std::move(buffer->allocation));
+      buffers.erase(it);
+      if (buffers.empty()) {
+        content_buffers_.erase(content_hash);
+      }
+    }
+  }
   object_table_.erase(object_id);
   return true;
 }
 
+bool ObjectStore::DeduplicateObject(const ObjectID &object_id,
+                                    uint64_t content_hash,
+                                    bool keep_allocation) {
+  auto entry = GetMutableObject(object_id);
+  if (entry == nullptr || !entry->Sealed() || entry->object_info.is_mutable ||
+      object_buffers_.contains(object_id)) {
+    return false;
+  }
+  const auto &info = entry->object_info;
+  absl::string_view content(static_cast<const char *>(entry->allocation.address),
+                            info.data_size + info.metadata_size);
+  auto &buffers = content_buffers_[content_hash];
+  for (const auto &buffer : buffers) {
+    // Hash collisions are possible, and the hash comes from the client, so the contents
+    // are compared too. This only reads the object when it's likely a copy.
+    if (buffer->data_size != info.data_size ||
+        buffer->metadata_size != info.metadata_size ||
+        std::memcmp(buffer->allocation.address, content.data(), content.size()) != 0) {
+      continue;
+    }
+    Allocation own_allocation = std::move(entry->allocation);
+    entry->allocation = AliasAllocation(buffer->allocation);
+    buffer->num_objects++;
+    object_buffers_.emplace(object_id, buffer.get());
+    num_bytes_deduplicated_ += content.size();
+    if (keep_allocation) {
+      retired_allocations_.emplace(object_id, std::move(own_allocation));
+    } else {
+      allocator_.Free(std::move(own_allocation));
+    }
+    RAY_LOG(DEBUG) << "object " << object_id << " shares " << content.size()
+                   << " bytes with an identical object";
+    return true;
+  }
+  // This is the first object with this content, its allocation becomes the buffer.
+  buffers.push_back(std::make_unique<ContentBuffer>(ContentBuffer{
+      std::move(entry->allocation), content_hash, info.data_size, info.metadata_size, 1}));
+  entry->allocation = AliasAllocation(buffers.back()->allocation);
+  object_buffers_.emplace(object_id, buffers.back().get());
+  return false;
+}
+
+void ObjectStore::FreeRetiredAllocation(const ObjectID &object_id) {
+  auto it = retired_allocations_.find(object_id);
+  if (it == retired_allocations_.end()) {
+    return;
+  }
+  allocator_.Free(std::move(it->second));
+  retired_allocations_.erase(it);
+}
+
+int64_t ObjectStore::GetNumBytesDeduplicated() const { return num_bytes_deduplicated_; }
+
+Allocation ObjectStore::AliasAllocation(const Allocation &allocation) {
+  return Allocation(allocation.address,
+                    allocation.size,
+                    allocation.fd,
+                    allocation.offset,
+                    allocation.device_num,
+                    allocation.mmap_size,
+                    allocation.fallback_allocated);
+}
+
 LocalObject *ObjectStore::GetMutableObject(const ObjectID &object_id) {
   auto it = object_table_.find(object_id);
   if (it == object_table_.end()) {
@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "ray/object_manager/plasma/allocator.h"
 #include "ray/object_manager/plasma/common.h"
@@ -67,6 +70,30 @@ class IObjectStore {
   ///   - false if such object doesn't exist.
   ///   - true if deleted.
   virtual bool DeleteObject(const ObjectID &object_id) = 0;
+
+  /// Share the memory of a sealed object with the objects of identical content.
+  /// The first object with a given content keeps its buffer. Later ones are
+  /// switched to that buffer and their own allocation is freed, or kept until
+  /// FreeRetiredAllocation if a client still maps it. The object isn't hashed here,
+  /// only compared with the objects of the same hash.
+  ///
+  /// \param object_id Object ID of the sealed object.
+  /// \param content_hash ObjectContentHash of the object's data and metadata.
+  /// \param keep_allocation Whether to keep the object's own allocation.
+  /// \return
+  ///   - true if the object now shares the buffer of another object.
+  ///   - false otherwise.
+  virtual bool DeduplicateObject(const ObjectID &object_id,
+                                 uint64_t content_hash,
+                                 bool keep_allocation) = 0;
+
+  /// Free the allocation kept by DeduplicateObject.
+  ///
+  /// \param object_id Object ID of the deduplicated object.
+  virtual void FreeRetiredAllocation(const ObjectID &object_id) = 0;
+
+  /// \return The number of bytes saved by sharing buffers between objects.
+  virtual int64_t GetNumBytesDeduplicated() const = 0;
 };
 
 // ObjectStore implements IObjectStore. It uses IAllocator
@@ -85,15 +112,53 @@ class ObjectStore : public IObjectStore {
 
   bool DeleteObject(const ObjectID &object_id) override;
 
+  bool DeduplicateObject(const ObjectID &object_id,
+                         uint64_t content_hash,
+                         bool keep_allocation) override;
+
+  void FreeRetiredAllocation(const ObjectID &object_id) override;
+
+  int64_t GetNumBytesDeduplicated() const override;
+
  private:
   friend struct ObjectStatsCollectorTest;
 
+  /// The memory shared by the deduplicated objects of one content.
+  struct ContentBuffer {
+    /// The allocation of the first object with this content.
+    Allocation allocation;
+    /// Hash of the data and metadata.
+    uint64_t content_hash;
+    int64_t data_size;
+    int64_t metadata_size;
+    /// Number of objects pointing to this buffer.
+    int64_t num_objects;
+  };
+
   LocalObject *GetMutableObject(const ObjectID &object_id);
 
+  /// Return an allocation that points to the same memory as the given one. The
+  /// returned allocation must not be freed.
+  static Allocation AliasAllocation(const Allocation &allocation);
+
   /// Allocator that allocates memory.
   IAllocator &allocator_;
 
   /// Mapping from ObjectIDs to information about the object.
   absl::flat_hash_map<ObjectID, std::unique_ptr<LocalObject>> object_table_;
+
+  /// Buffers of the deduplicated objects, by content hash.
+  absl::flat_hash_map<uint64_t, std::vector<std::unique_ptr<ContentBuffer>>>
+      content_buffers_;
+
+  /// The buffer that each deduplicated object points to.
+  absl::flat_hash_map<ObjectID, ContentBuffer *> object_buffers_;
+
+  /// Own allocations of deduplicated objects that are still mapped by the client
+  /// that created them.
+  absl::flat_hash_map<ObjectID, Allocation> retired_allocations_;
+
+  /// Bytes of objects that point to the buffer of another object.
+  int64_t num_bytes_deduplicated_ = 0;
 };
 }  // namespace plasma
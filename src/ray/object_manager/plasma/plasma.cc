@@ -17,10 +17,29 @@
 
 #include "ray/object_manager/plasma/plasma.h"
 
+#include <algorithm>
+
+#include "ray/common/id.h"
 #include "ray/object_manager/plasma/common.h"
 
 namespace plasma {
 
 LocalObject::LocalObject(Allocation allocation)
     : allocation(std::move(allocation)), ref_count(0) {}
+
+uint64_t ObjectContentHash(const uint8_t *content, uint64_t size) {
+  // MurmurHash64A takes an int length, so larger objects are hashed in chunks, each
+  // seeded with the hash of the ones before it.
+  constexpr uint64_t kChunkSize = 1 << 30;
+  uint64_t hash = size;
+  do {
+    const uint64_t chunk_size = std::min(size, kChunkSize);
+    hash = ray::MurmurHash64A(content,
+                              static_cast<int>(chunk_size),
+                              static_cast<unsigned int>(hash ^ (hash >> 32)));
+    content += chunk_size;
+    size -= chunk_size;
+  } while (size > 0);
+  return hash == kNoContentHash ? 1 : hash;
+}
 }  // namespace plasma
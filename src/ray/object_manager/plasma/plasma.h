@@ -20,6 +20,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -66,6 +67,14 @@ struct PlasmaObject {
   }
 };
 
+/// The content hash sent with the seal of an object that the client didn't hash.
+constexpr uint64_t kNoContentHash = 0;
+
+/// Hash the data and metadata of an object for deduplication. The clients hash the
+/// objects they seal, so unlike absl::Hash, the hash is the same in every process.
+/// Never returns kNoContentHash.
+uint64_t ObjectContentHash(const uint8_t *content, uint64_t size);
+
 enum class ObjectStatus : int {
   /// The object was not found.
   OBJECT_NOT_FOUND = 0,
@@ -205,7 +205,8 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                          int64_t metadata_size,
                          flatbuf::ObjectSource source,
                          int device_num,
-                         bool try_immediately) {
+                         bool try_immediately,
+                         int32_t priority) {
   flatbuffers::FlatBufferBuilder fbb;
   auto message =
       fb::CreatePlasmaCreateRequest(fbb,
@@ -219,18 +220,18 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                                     metadata_size,
                                     source,
                                     device_num,
-                                    try_immediately);
+                                    try_immediately,
+                                    priority);
   return PlasmaSend(store_conn, MessageType::PlasmaCreateRequest, &fbb, message);
 }
 
-void ReadCreateRequest(uint8_t *data,
-                       size_t size,
-                       ray::ObjectInfo *object_info,
-                       flatbuf::ObjectSource *source,
-                       int *device_num) {
-  RAY_DCHECK(data);
-  auto message = flatbuffers::GetRoot<fb::PlasmaCreateRequest>(data);
-  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+namespace {
+
+/// Read a create request, sent on its own or in a batch.
+void ReadCreateRequestFields(const fb::PlasmaCreateRequest *message,
+                             ray::ObjectInfo *object_info,
+                             flatbuf::ObjectSource *source,
+                             int *device_num) {
   object_info->is_mutable = message->is_mutable();
   object_info->data_size = message->data_size();
   object_info->metadata_size = message->metadata_size();
@@ -241,26 +242,14 @@ void ReadCreateRequest(uint8_t *data,
   object_info->owner_worker_id = WorkerID::FromBinary(message->owner_worker_id()->str());
   *source = message->source();
   *device_num = message->device_num();
-  return;
 }
 
-Status SendUnfinishedCreateReply(const std::shared_ptr<Client> &client,
-                                 ObjectID object_id,
-                                 uint64_t retry_with_request_id) {
-  flatbuffers::FlatBufferBuilder fbb;
-  auto object_string = fbb.CreateString(object_id.Binary());
-  fb::PlasmaCreateReplyBuilder crb(fbb);
-  crb.add_object_id(object_string);
-  crb.add_retry_with_request_id(retry_with_request_id);
-  auto message = crb.Finish();
-  return PlasmaSend(client, MessageType::PlasmaCreateReply, &fbb, message);
-}
-
-Status SendCreateReply(const std::shared_ptr<Client> &client,
-                       ObjectID object_id,
-                       const PlasmaObject &object,
-                       PlasmaError error_code) {
-  flatbuffers::FlatBufferBuilder fbb;
+/// Build a create reply, sent on its own or in a batch.
+flatbuffers::Offset<fb::PlasmaCreateReply> MakeCreateReply(
+    flatbuffers::FlatBufferBuilder *fbb,
+    const ObjectID &object_id,
+    const PlasmaObject &object,
+    PlasmaError error_code) {
   PlasmaObjectSpec plasma_object(FD2INT(object.store_fd.first),
                                  object.store_fd.second,
                                  object.header_offset,
@@ -272,8 +261,8 @@ Status SendCreateReply(const std::shared_ptr<Client> &client,
                                  object.fallback_allocated,
                                  object.device_num,
                                  object.is_experimental_mutable_object);
-  auto object_string = fbb.CreateString(object_id.Binary());
-  fb::PlasmaCreateReplyBuilder crb(fbb);
+  auto object_string = fbb->CreateString(object_id.Binary());
+  fb::PlasmaCreateReplyBuilder crb(*fbb);
   crb.add_error(static_cast<PlasmaError>(error_code));
   crb.add_plasma_object(&plasma_object);
   crb.add_object_id(object_string);
@@ -284,10 +273,76 @@ Status SendCreateReply(const std::shared_ptr<Client> &client,
   if (object.device_num != 0) {
     RAY_LOG(FATAL) << "This should be unreachable.";
   }
+  return crb.Finish();
+}
+
+/// Read a finished create reply, sent on its own or in a batch.
+void ReadCreateReplyFields(const fb::PlasmaCreateReply *message,
+                           PlasmaObject *object,
+                           MEMFD_TYPE *store_fd,
+                           int64_t *mmap_size) {
+  object->store_fd.first = INT2FD(message->plasma_object()->segment_index());
+  object->store_fd.second = message->plasma_object()->unique_fd_id();
+  object->header_offset = message->plasma_object()->header_offset();
+  object->data_offset = message->plasma_object()->data_offset();
+  object->data_size = message->plasma_object()->data_size();
+  object->metadata_offset = message->plasma_object()->metadata_offset();
+  object->metadata_size = message->plasma_object()->metadata_size();
+  object->allocated_size = message->plasma_object()->allocated_size();
+  object->fallback_allocated = message->plasma_object()->fallback_allocated();
+  object->is_experimental_mutable_object =
+      message->plasma_object()->is_experimental_mutable_object();
+
+  store_fd->first = INT2FD(message->store_fd());
+  store_fd->second = message->unique_fd_id();
+  *mmap_size = message->mmap_size();
+
+  object->device_num = message->plasma_object()->device_num();
+}
+
+/// Read a list of object IDs.
+void ReadObjectIds(
+    const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *fbvector,
+    std::vector<ObjectID> *object_ids) {
+  ConvertToVector(fbvector, object_ids, [](const flatbuffers::String &object_id) {
+    return ObjectID::FromBinary(object_id.str());
+  });
+}
+
+}  // namespace
+
+void ReadCreateRequest(uint8_t *data,
+                       size_t size,
+                       ray::ObjectInfo *object_info,
+                       flatbuf::ObjectSource *source,
+                       int *device_num) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaCreateRequest>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  ReadCreateRequestFields(message, object_info, source, device_num);
+}
+
+Status SendUnfinishedCreateReply(const std::shared_ptr<Client> &client,
+                                 ObjectID object_id,
+                                 uint64_t retry_with_request_id) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto object_string = fbb.CreateString(object_id.Binary());
+  fb::PlasmaCreateReplyBuilder crb(fbb);
+  crb.add_object_id(object_string);
+  crb.add_retry_with_request_id(retry_with_request_id);
   auto message = crb.Finish();
   return PlasmaSend(client, MessageType::PlasmaCreateReply, &fbb, message);
 }
 
+Status SendCreateReply(const std::shared_ptr<Client> &client,
+                       ObjectID object_id,
+                       const PlasmaObject &object,
+                       PlasmaError error_code) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = MakeCreateReply(&fbb, object_id, object, error_code);
+  return PlasmaSend(client, MessageType::PlasmaCreateReply, &fbb, message);
+}
+
 Status ReadCreateReply(uint8_t *data,
                        size_t size,
                        ObjectID *object_id,
@@ -304,25 +359,99 @@ Status ReadCreateReply(uint8_t *data,
     // The client should retry the request.
     return Status::OK();
   }
+  ReadCreateReplyFields(message, object, store_fd, mmap_size);
+  return PlasmaErrorStatus(message->error());
+}
 
-  object->store_fd.first = INT2FD(message->plasma_object()->segment_index());
-  object->store_fd.second = message->plasma_object()->unique_fd_id();
-  object->header_offset = message->plasma_object()->header_offset();
-  object->data_offset = message->plasma_object()->data_offset();
-  object->data_size = message->plasma_object()->data_size();
-  object->metadata_offset = message->plasma_object()->metadata_offset();
-  object->metadata_size = message->plasma_object()->metadata_size();
-  object->allocated_size = message->plasma_object()->allocated_size();
-  object->fallback_allocated = message->plasma_object()->fallback_allocated();
-  object->is_experimental_mutable_object =
-      message->plasma_object()->is_experimental_mutable_object();
+Status SendCreateManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                             const std::vector<ObjectID> &object_ids,
+                             const ray::rpc::Address &owner_address,
+                             const std::vector<int64_t> &data_sizes,
+                             const std::vector<int64_t> &metadata_sizes,
+                             flatbuf::ObjectSource source) {
+  RAY_DCHECK(object_ids.size() == data_sizes.size());
+  RAY_DCHECK(object_ids.size() == metadata_sizes.size());
+  flatbuffers::FlatBufferBuilder fbb;
+  // The owner is the same for all the objects, so its fields are shared.
+  auto owner_raylet_id = fbb.CreateString(owner_address.raylet_id());
+  auto owner_ip_address = fbb.CreateString(owner_address.ip_address());
+  auto owner_worker_id = fbb.CreateString(owner_address.worker_id());
+  std::vector<flatbuffers::Offset<fb::PlasmaCreateRequest>> requests;
+  requests.reserve(object_ids.size());
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    requests.push_back(
+        fb::CreatePlasmaCreateRequest(fbb,
+                                      fbb.CreateString(object_ids[i].Binary()),
+                                      owner_raylet_id,
+                                      owner_ip_address,
+                                      owner_address.port(),
+                                      owner_worker_id,
+                                      /*is_mutable=*/false,
+                                      data_sizes[i],
+                                      metadata_sizes[i],
+                                      source,
+                                      /*device_num=*/0,
+                                      /*try_immediately=*/true));
+  }
+  auto message = fb::CreatePlasmaCreateManyRequest(
+      fbb, fbb.CreateVector(MakeNonNull(requests.data()), requests.size()));
+  return PlasmaSend(store_conn, MessageType::PlasmaCreateManyRequest, &fbb, message);
+}
 
-  store_fd->first = INT2FD(message->store_fd());
-  store_fd->second = message->unique_fd_id();
-  *mmap_size = message->mmap_size();
+void ReadCreateManyRequest(uint8_t *data,
+                           size_t size,
+                           std::vector<ray::ObjectInfo> *object_infos,
+                           std::vector<flatbuf::ObjectSource> *sources) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaCreateManyRequest>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  const auto num_requests = message->requests()->size();
+  object_infos->resize(num_requests);
+  sources->resize(num_requests);
+  for (uoffset_t i = 0; i < num_requests; i++) {
+    int device_num;
+    ReadCreateRequestFields(
+        message->requests()->Get(i), &(*object_infos)[i], &(*sources)[i], &device_num);
+  }
+}
 
-  object->device_num = message->plasma_object()->device_num();
-  return PlasmaErrorStatus(message->error());
+Status SendCreateManyReply(const std::shared_ptr<Client> &client,
+                           const std::vector<ObjectID> &object_ids,
+                           const std::vector<PlasmaObject> &objects,
+                           const std::vector<PlasmaError> &errors) {
+  RAY_DCHECK(object_ids.size() == objects.size());
+  RAY_DCHECK(object_ids.size() == errors.size());
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<fb::PlasmaCreateReply>> replies;
+  replies.reserve(object_ids.size());
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    replies.push_back(MakeCreateReply(&fbb, object_ids[i], objects[i], errors[i]));
+  }
+  auto message = fb::CreatePlasmaCreateManyReply(
+      fbb, fbb.CreateVector(MakeNonNull(replies.data()), replies.size()));
+  return PlasmaSend(client, MessageType::PlasmaCreateManyReply, &fbb, message);
+}
+
+Status ReadCreateManyReply(uint8_t *data,
+                           size_t size,
+                           std::vector<PlasmaObject> *objects,
+                           std::vector<MEMFD_TYPE> *store_fds,
+                           std::vector<int64_t> *mmap_sizes,
+                           std::vector<PlasmaError> *errors) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaCreateManyReply>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  const auto num_replies = message->replies()->size();
+  objects->resize(num_replies);
+  store_fds->resize(num_replies);
+  mmap_sizes->resize(num_replies);
+  errors->resize(num_replies);
+  for (uoffset_t i = 0; i < num_replies; i++) {
+    const auto *reply = message->replies()->Get(i);
+    ReadCreateReplyFields(reply, &(*objects)[i], &(*store_fds)[i], &(*mmap_sizes)[i]);
+    (*errors)[i] = reply->error();
+  }
+  return Status::OK();
 }
 
 Status SendAbortRequest(const std::shared_ptr<StoreConn> &store_conn,
@@ -356,17 +485,24 @@ Status ReadAbortReply(uint8_t *data, size_t size, ObjectID *object_id) {
 
 // Seal messages.
 
-Status SendSealRequest(const std::shared_ptr<StoreConn> &store_conn, ObjectID object_id) {
+Status SendSealRequest(const std::shared_ptr<StoreConn> &store_conn,
+                       ObjectID object_id,
+                       uint64_t content_hash) {
   flatbuffers::FlatBufferBuilder fbb;
-  auto message = fb::CreatePlasmaSealRequest(fbb, fbb.CreateString(object_id.Binary()));
+  auto message = fb::CreatePlasmaSealRequest(
+      fbb, fbb.CreateString(object_id.Binary()), content_hash);
   return PlasmaSend(store_conn, MessageType::PlasmaSealRequest, &fbb, message);
 }
 
-Status ReadSealRequest(uint8_t *data, size_t size, ObjectID *object_id) {
+Status ReadSealRequest(uint8_t *data,
+                       size_t size,
+                       ObjectID *object_id,
+                       uint64_t *content_hash) {
   RAY_DCHECK(data);
   auto message = flatbuffers::GetRoot<fb::PlasmaSealRequest>(data);
   RAY_DCHECK(VerifyFlatbuffer(message, data, size));
   *object_id = ObjectID::FromBinary(message->object_id()->str());
+  *content_hash = message->content_hash();
   return Status::OK();
 }
 
@@ -387,6 +523,53 @@ Status ReadSealReply(uint8_t *data, size_t size, ObjectID *object_id) {
   return PlasmaErrorStatus(message->error());
 }
 
+Status SendSealManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                           const std::vector<ObjectID> &object_ids,
+                           const std::vector<uint64_t> &content_hashes) {
+  RAY_DCHECK(object_ids.size() == content_hashes.size());
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = fb::CreatePlasmaSealManyRequest(
+      fbb,
+      ToFlatbuffer(&fbb, object_ids.data(), object_ids.size()),
+      fbb.CreateVector(MakeNonNull(content_hashes.data()), content_hashes.size()));
+  return PlasmaSend(store_conn, MessageType::PlasmaSealManyRequest, &fbb, message);
+}
+
+Status ReadSealManyRequest(uint8_t *data,
+                           size_t size,
+                           std::vector<ObjectID> *object_ids,
+                           std::vector<uint64_t> *content_hashes) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaSealManyRequest>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  ReadObjectIds(message->object_ids(), object_ids);
+  content_hashes->assign(object_ids->size(), kNoContentHash);
+  if (message->content_hashes() != nullptr) {
+    for (uoffset_t i = 0;
+         i < message->content_hashes()->size() && i < content_hashes->size();
+         ++i) {
+      (*content_hashes)[i] = message->content_hashes()->Get(i);
+    }
+  }
+  return Status::OK();
+}
+
+Status SendSealManyReply(const std::shared_ptr<Client> &client,
+                         const std::vector<ObjectID> &object_ids) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = fb::CreatePlasmaSealManyReply(
+      fbb, ToFlatbuffer(&fbb, object_ids.data(), object_ids.size()));
+  return PlasmaSend(client, MessageType::PlasmaSealManyReply, &fbb, message);
+}
+
+Status ReadSealManyReply(uint8_t *data, size_t size, std::vector<ObjectID> *object_ids) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaSealManyReply>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  ReadObjectIds(message->object_ids(), object_ids);
+  return Status::OK();
+}
+
 // Release messages.
 
 Status SendReleaseRequest(const std::shared_ptr<StoreConn> &store_conn,
@@ -432,6 +615,24 @@ Status ReadReleaseReply(uint8_t *data,
   return PlasmaErrorStatus(message->error());
 }
 
+Status SendReleaseManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                              const std::vector<ObjectID> &object_ids) {
+  flatbuffers::FlatBufferBuilder fbb;
+  auto message = fb::CreatePlasmaReleaseManyRequest(
+      fbb, ToFlatbuffer(&fbb, object_ids.data(), object_ids.size()));
+  return PlasmaSend(store_conn, MessageType::PlasmaReleaseManyRequest, &fbb, message);
+}
+
+Status ReadReleaseManyRequest(uint8_t *data,
+                              size_t size,
+                              std::vector<ObjectID> *object_ids) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaReleaseManyRequest>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  ReadObjectIds(message->object_ids(), object_ids);
+  return Status::OK();
+}
+
 // Delete objects messages.
 
 Status SendDeleteRequest(const std::shared_ptr<StoreConn> &store_conn,
@@ -532,25 +733,38 @@ Status ReadContainsReply(uint8_t *data,
 
 // Connect messages.
 
-Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn) {
+Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn,
+                          bool command_ring) {
   flatbuffers::FlatBufferBuilder fbb;
-  auto message = fb::CreatePlasmaConnectRequest(fbb);
+  auto message = fb::CreatePlasmaConnectRequest(fbb, command_ring);
   return PlasmaSend(store_conn, MessageType::PlasmaConnectRequest, &fbb, message);
 }
 
-Status ReadConnectRequest(uint8_t *data) { return Status::OK(); }
+Status ReadConnectRequest(uint8_t *data, size_t size, bool *command_ring) {
+  RAY_DCHECK(data);
+  auto message = flatbuffers::GetRoot<fb::PlasmaConnectRequest>(data);
+  RAY_DCHECK(VerifyFlatbuffer(message, data, size));
+  *command_ring = message->command_ring();
+  return Status::OK();
+}
 
-Status SendConnectReply(const std::shared_ptr<Client> &client, int64_t memory_capacity) {
+Status SendConnectReply(const std::shared_ptr<Client> &client,
+                        int64_t memory_capacity,
+                        bool command_ring) {
   flatbuffers::FlatBufferBuilder fbb;
-  auto message = fb::CreatePlasmaConnectReply(fbb, memory_capacity);
+  auto message = fb::CreatePlasmaConnectReply(fbb, memory_capacity, command_ring);
   return PlasmaSend(client, MessageType::PlasmaConnectReply, &fbb, message);
 }
 
-Status ReadConnectReply(uint8_t *data, size_t size, int64_t *memory_capacity) {
+Status ReadConnectReply(uint8_t *data,
+                        size_t size,
+                        int64_t *memory_capacity,
+                        bool *command_ring) {
   RAY_DCHECK(data);
   auto message = flatbuffers::GetRoot<fb::PlasmaConnectReply>(data);
   RAY_DCHECK(VerifyFlatbuffer(message, data, size));
   *memory_capacity = message->memory_capacity();
+  *command_ring = message->command_ring();
   return Status::OK();
 }
 
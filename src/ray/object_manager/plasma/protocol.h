@@ -90,7 +90,8 @@ Status SendCreateRequest(const std::shared_ptr<StoreConn> &store_conn,
                          int64_t metadata_size,
                          flatbuf::ObjectSource source,
                          int device_num,
-                         bool try_immediately);
+                         bool try_immediately,
+                         int32_t priority);
 
 void ReadCreateRequest(uint8_t *data,
                        size_t size,
@@ -115,6 +116,30 @@ Status ReadCreateReply(uint8_t *data,
                        MEMFD_TYPE *store_fd,
                        int64_t *mmap_size);
 
+Status SendCreateManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                             const std::vector<ObjectID> &object_ids,
+                             const ray::rpc::Address &owner_address,
+                             const std::vector<int64_t> &data_sizes,
+                             const std::vector<int64_t> &metadata_sizes,
+                             flatbuf::ObjectSource source);
+
+void ReadCreateManyRequest(uint8_t *data,
+                           size_t size,
+                           std::vector<ray::ObjectInfo> *object_infos,
+                           std::vector<flatbuf::ObjectSource> *sources);
+
+Status SendCreateManyReply(const std::shared_ptr<Client> &client,
+                           const std::vector<ObjectID> &object_ids,
+                           const std::vector<PlasmaObject> &objects,
+                           const std::vector<PlasmaError> &errors);
+
+Status ReadCreateManyReply(uint8_t *data,
+                           size_t size,
+                           std::vector<PlasmaObject> *objects,
+                           std::vector<MEMFD_TYPE> *store_fds,
+                           std::vector<int64_t> *mmap_sizes,
+                           std::vector<PlasmaError> *errors);
+
 Status SendAbortRequest(const std::shared_ptr<StoreConn> &store_conn, ObjectID object_id);
 
 Status ReadAbortRequest(uint8_t *data, size_t size, ObjectID *object_id);
@@ -125,9 +150,14 @@ Status ReadAbortReply(uint8_t *data, size_t size, ObjectID *object_id);
 
 /* Plasma Seal message functions. */
 
-Status SendSealRequest(const std::shared_ptr<StoreConn> &store_conn, ObjectID object_id);
+Status SendSealRequest(const std::shared_ptr<StoreConn> &store_conn,
+                       ObjectID object_id,
+                       uint64_t content_hash);
 
-Status ReadSealRequest(uint8_t *data, size_t size, ObjectID *object_id);
+Status ReadSealRequest(uint8_t *data,
+                       size_t size,
+                       ObjectID *object_id,
+                       uint64_t *content_hash);
 
 Status SendSealReply(const std::shared_ptr<Client> &client,
                      ObjectID object_id,
@@ -135,6 +165,20 @@ Status SendSealReply(const std::shared_ptr<Client> &client,
 
 Status ReadSealReply(uint8_t *data, size_t size, ObjectID *object_id);
 
+Status SendSealManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                           const std::vector<ObjectID> &object_ids,
+                           const std::vector<uint64_t> &content_hashes);
+
+Status ReadSealManyRequest(uint8_t *data,
+                           size_t size,
+                           std::vector<ObjectID> *object_ids,
+                           std::vector<uint64_t> *content_hashes);
+
+Status SendSealManyReply(const std::shared_ptr<Client> &client,
+                         const std::vector<ObjectID> &object_ids);
+
+Status ReadSealManyReply(uint8_t *data, size_t size, std::vector<ObjectID> *object_ids);
+
 /* Plasma Get message functions. */
 
 Status SendGetRequest(const std::shared_ptr<StoreConn> &store_conn,
@@ -185,6 +229,13 @@ Status ReadReleaseReply(uint8_t *data,
                         ObjectID *object_id,
                         bool *should_unmap);
 
+Status SendReleaseManyRequest(const std::shared_ptr<StoreConn> &store_conn,
+                              const std::vector<ObjectID> &object_ids);
+
+Status ReadReleaseManyRequest(uint8_t *data,
+                              size_t size,
+                              std::vector<ObjectID> *object_ids);
+
 /* Plasma Delete objects message functions. */
 
 Status SendDeleteRequest(const std::shared_ptr<StoreConn> &store_conn,
@@ -219,13 +270,19 @@ Status ReadContainsReply(uint8_t *data,
 
 /* Plasma Connect message functions. */
 
-Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn);
+Status SendConnectRequest(const std::shared_ptr<StoreConn> &store_conn,
+                          bool command_ring = false);
 
-Status ReadConnectRequest(uint8_t *data, size_t size);
+Status ReadConnectRequest(uint8_t *data, size_t size, bool *command_ring);
 
-Status SendConnectReply(const std::shared_ptr<Client> &client, int64_t memory_capacity);
+Status SendConnectReply(const std::shared_ptr<Client> &client,
+                        int64_t memory_capacity,
+                        bool command_ring = false);
 
-Status ReadConnectReply(uint8_t *data, size_t size, int64_t *memory_capacity);
+Status ReadConnectReply(uint8_t *data,
+                        size_t size,
+                        int64_t *memory_capacity,
+                        bool *command_ring);
 
 /* Plasma Evict message functions (no reply so far). */
 
@@ -0,0 +1,254 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/slab_allocator.h"
+
+#include <algorithm>
+
+#include "ray/util/logging.h"
+
+namespace plasma {
+
+namespace {
+
+// Chunk sizes are multiples of the alignment of the PlasmaAllocator, so that all
+// chunks are aligned like the other allocations.
+const int64_t kChunkAlignment = 64;
+
+// Number of size classes between two powers of two. With 4 classes, at most 20% of
+// a chunk is wasted by rounding up the allocation size.
+const int64_t kSizeClassesPerDoubling = 4;
+
+}  // namespace
+
+SlabAllocator::SlabAllocator(IAllocator &allocator,
+                             int64_t max_object_size,
+                             int64_t slab_size)
+    : allocator_(allocator), max_object_size_(max_object_size), slab_size_(slab_size) {
+  RAY_CHECK(max_object_size_ > 0);
+  RAY_CHECK(slab_size_ >= max_object_size_)
+      << "Slab size " << slab_size_ << " is smaller than the max object size "
+      << max_object_size_;
+  int64_t chunk_size = kChunkAlignment;
+  while (true) {
+    if (chunk_size >= max_object_size_) {
+      // The top class may round up past the slab size, in which case its chunks take
+      // the whole slab.
+      size_classes_.emplace_back();
+      size_classes_.back().chunk_size = std::min(chunk_size, slab_size_);
+      break;
+    }
+    size_classes_.emplace_back();
+    size_classes_.back().chunk_size = chunk_size;
+    // The largest power of two not above chunk_size.
+    int64_t power_of_two = 1;
+    while (power_of_two * 2 <= chunk_size) {
+      power_of_two *= 2;
+    }
+    chunk_size += std::max(kChunkAlignment, power_of_two / kSizeClassesPerDoubling);
+  }
+}
+
+SlabAllocator::~SlabAllocator() {
+  for (auto &entry : slabs_) {
+    allocator_.Free(std::move(entry.second->allocation));
+  }
+}
+
+absl::optional<Allocation> SlabAllocator::Allocate(size_t bytes) {
+  if (bytes > 0 && static_cast<int64_t>(bytes) <= max_object_size_) {
+    auto it = std::lower_bound(
+        size_classes_.begin(),
+        size_classes_.end(),
+        static_cast<int64_t>(bytes),
+        [](const SizeClass &size_class, int64_t size) {
+          return size_class.chunk_size < size;
+        });
+    RAY_CHECK(it != size_classes_.end());
+    auto allocation = AllocateChunk(it - size_classes_.begin(), bytes);
+    if (allocation.has_value()) {
+      return allocation;
+    }
+    // There is no room for a new slab, but there may still be a smaller free range.
+  }
+  auto allocation = allocator_.Allocate(bytes);
+  if (!allocation.has_value() && FreeEmptySlabs()) {
+    allocation = allocator_.Allocate(bytes);
+  }
+  return allocation;
+}
+
+absl::optional<Allocation> SlabAllocator::FallbackAllocate(size_t bytes) {
+  return allocator_.FallbackAllocate(bytes);
+}
+
+void SlabAllocator::Free(Allocation allocation) {
+  Slab *slab = FindSlab(allocation.address);
+  if (slab == nullptr) {
+    allocator_.Free(std::move(allocation));
+    return;
+  }
+  auto &size_class = size_classes_[slab->size_class];
+  auto *base = static_cast<uint8_t *>(slab->allocation.address);
+  const int64_t offset = static_cast<uint8_t *>(allocation.address) - base;
+  RAY_CHECK(offset % size_class.chunk_size == 0)
+      << "Freeing " << allocation.address << " which is not the start of a chunk";
+  slab->free_chunks.push_back(offset / size_class.chunk_size);
+  size_class.num_chunks_in_use--;
+  size_class.bytes_in_use -= allocation.size;
+
+  if (static_cast<int64_t>(slab->free_chunks.size()) == slab->num_chunks) {
+    num_empty_slabs_++;
+    size_class.slabs_with_free_chunks.erase(base);
+    if (!size_class.slabs_with_free_chunks.empty()) {
+      // Free the empty slab only if the class has other free chunks, to not
+      // free and allocate a slab each time an object is created and deleted.
+      FreeSlab(slab);
+      return;
+    }
+  }
+  size_class.slabs_with_free_chunks.insert(base);
+}
+
+int64_t SlabAllocator::GetFootprintLimit() const {
+  return allocator_.GetFootprintLimit();
+}
+
+int64_t SlabAllocator::Allocated() const {
+  return allocator_.Allocated() - num_empty_slabs_ * slab_size_;
+}
+
+int64_t SlabAllocator::FallbackAllocated() const {
+  return allocator_.FallbackAllocated();
+}
+
+std::vector<SizeClassStats> SlabAllocator::GetSizeClassStats() const {
+  std::vector<SizeClassStats> stats;
+  stats.reserve(size_classes_.size());
+  for (const auto &size_class : size_classes_) {
+    const int64_t chunks_per_slab = slab_size_ / size_class.chunk_size;
+    stats.push_back({size_class.chunk_size,
+                     size_class.num_slabs,
+                     size_class.num_slabs * chunks_per_slab,
+                     size_class.num_chunks_in_use,
+                     size_class.bytes_in_use});
+  }
+  return stats;
+}
+
+absl::optional<Allocation> SlabAllocator::AllocateChunk(size_t size_class_index,
+                                                        size_t bytes) {
+  auto &size_class = size_classes_[size_class_index];
+  Slab *slab;
+  if (size_class.slabs_with_free_chunks.empty()) {
+    slab = AllocateSlab(size_class_index);
+    if (slab == nullptr && FreeEmptySlabs()) {
+      slab = AllocateSlab(size_class_index);
+    }
+    if (slab == nullptr) {
+      return absl::nullopt;
+    }
+  } else {
+    slab = slabs_.at(*size_class.slabs_with_free_chunks.begin()).get();
+  }
+
+  auto *base = static_cast<uint8_t *>(slab->allocation.address);
+  if (static_cast<int64_t>(slab->free_chunks.size()) == slab->num_chunks) {
+    num_empty_slabs_--;
+  }
+  const int64_t offset = slab->free_chunks.back() * size_class.chunk_size;
+  slab->free_chunks.pop_back();
+  if (slab->free_chunks.empty()) {
+    size_class.slabs_with_free_chunks.erase(base);
+  }
+  size_class.num_chunks_in_use++;
+  size_class.bytes_in_use += bytes;
+
+  const auto &slab_allocation = slab->allocation;
+  return Allocation(base + offset,
+                    static_cast<int64_t>(bytes),
+                    slab_allocation.fd,
+                    slab_allocation.offset + offset,
+                    slab_allocation.device_num,
+                    slab_allocation.mmap_size,
+                    slab_allocation.fallback_allocated);
+}
+
+SlabAllocator::Slab *SlabAllocator::AllocateSlab(size_t size_class_index) {
+  auto allocation = allocator_.Allocate(slab_size_);
+  if (!allocation.has_value()) {
+    return nullptr;
+  }
+  auto &size_class = size_classes_[size_class_index];
+  auto slab = std::make_unique<Slab>(std::move(allocation.value()));
+  slab->size_class = size_class_index;
+  slab->num_chunks = slab_size_ / size_class.chunk_size;
+  RAY_CHECK(slab->num_chunks > 0);
+  // Pushed in reverse so that chunks are allocated from the start of the slab.
+  slab->free_chunks.reserve(slab->num_chunks);
+  for (int64_t i = slab->num_chunks - 1; i >= 0; i--) {
+    slab->free_chunks.push_back(i);
+  }
+  auto *base = static_cast<uint8_t *>(slab->allocation.address);
+  size_class.slabs_with_free_chunks.insert(base);
+  size_class.num_slabs++;
+  num_empty_slabs_++;
+  RAY_LOG(DEBUG) << "Allocated slab at " << static_cast<void *>(base)
+                 << " for chunks of " << size_class.chunk_size << " bytes";
+  return slabs_.emplace(base, std::move(slab)).first->second.get();
+}
+
+void SlabAllocator::FreeSlab(Slab *slab) {
+  RAY_CHECK(static_cast<int64_t>(slab->free_chunks.size()) == slab->num_chunks);
+  auto &size_class = size_classes_[slab->size_class];
+  auto *base = static_cast<uint8_t *>(slab->allocation.address);
+  size_class.slabs_with_free_chunks.erase(base);
+  size_class.num_slabs--;
+  num_empty_slabs_--;
+  auto it = slabs_.find(base);
+  RAY_CHECK(it != slabs_.end());
+  auto owned_slab = std::move(it->second);
+  slabs_.erase(it);
+  allocator_.Free(std::move(owned_slab->allocation));
+}
+
+bool SlabAllocator::FreeEmptySlabs() {
+  std::vector<Slab *> empty_slabs;
+  for (const auto &entry : slabs_) {
+    if (static_cast<int64_t>(entry.second->free_chunks.size()) ==
+        entry.second->num_chunks) {
+      empty_slabs.push_back(entry.second.get());
+    }
+  }
+  for (auto *slab : empty_slabs) {
+    FreeSlab(slab);
+  }
+  return !empty_slabs.empty();
+}
+
+SlabAllocator::Slab *SlabAllocator::FindSlab(const void *address) const {
+  auto *ptr = static_cast<uint8_t *>(const_cast<void *>(address));
+  // The last slab that starts at or before the address.
+  auto it = slabs_.upper_bound(ptr);
+  if (it == slabs_.begin()) {
+    return nullptr;
+  }
+  --it;
+  if (ptr >= it->first + slab_size_) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+}  // namespace plasma
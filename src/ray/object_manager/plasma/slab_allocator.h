@@ -0,0 +1,123 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "ray/object_manager/plasma/allocator.h"
+
+namespace plasma {
+
+// SlabAllocator serves small allocations from slabs that it allocates from
+// another allocator, normally the PlasmaAllocator, and passes the other
+// allocations through.
+//
+// Each slab is split into chunks of one size class, and each size class keeps the
+// slabs that have free chunks. Small objects are therefore packed together
+// instead of being spread over the arena by dlmalloc, where a few of them left
+// alive can keep large free ranges from coalescing. A slab is returned to the
+// underlying allocator when all its chunks are freed.
+//
+// Like the other allocators, it's not thread safe.
+class SlabAllocator : public IAllocator {
+ public:
+  /// \param allocator The allocator to allocate slabs and large objects from.
+  /// \param max_object_size Allocations up to this size are served from slabs.
+  /// \param slab_size Size of each slab. Must be at least max_object_size.
+  SlabAllocator(IAllocator &allocator, int64_t max_object_size, int64_t slab_size);
+
+  ~SlabAllocator() override;
+
+  /// Allocates from a slab of the smallest size class that fits, or from the
+  /// underlying allocator for large objects. Small objects are also allocated
+  /// from the underlying allocator if there is no room for a new slab.
+  absl::optional<Allocation> Allocate(size_t bytes) override;
+
+  /// Fallback allocations are always passed through.
+  absl::optional<Allocation> FallbackAllocate(size_t bytes) override;
+
+  void Free(Allocation allocation) override;
+
+  int64_t GetFootprintLimit() const override;
+
+  /// Get the number of bytes allocated so far. Slabs count for their full size, since
+  /// their free chunks only fit objects of their size class, so the eviction policy
+  /// doesn't take them for free space. Empty slabs don't count, since they're returned
+  /// to the underlying allocator when it's full.
+  int64_t Allocated() const override;
+
+  int64_t FallbackAllocated() const override;
+
+  std::vector<SizeClassStats> GetSizeClassStats() const override;
+
+ private:
+  struct Slab {
+    explicit Slab(Allocation allocation) : allocation(std::move(allocation)) {}
+
+    /// The memory of the slab, from the underlying allocator.
+    Allocation allocation;
+    /// Index of the size class of the slab.
+    size_t size_class;
+    /// Indexes of the free chunks.
+    std::vector<int64_t> free_chunks;
+    /// Total number of chunks.
+    int64_t num_chunks;
+  };
+
+  struct SizeClass {
+    int64_t chunk_size;
+    /// Base addresses of the slabs with free chunks. Chunks are allocated from the
+    /// lowest slab first, so that the slabs at higher addresses can drain.
+    std::set<uint8_t *> slabs_with_free_chunks;
+    int64_t num_slabs = 0;
+    int64_t num_chunks_in_use = 0;
+    int64_t bytes_in_use = 0;
+  };
+
+  /// Allocate a chunk of the given size class.
+  absl::optional<Allocation> AllocateChunk(size_t size_class, size_t bytes);
+
+  /// Allocate a new slab for the given size class.
+  ///
+  /// \return The slab, or nullptr if the underlying allocator is full.
+  Slab *AllocateSlab(size_t size_class);
+
+  /// Return a slab to the underlying allocator. All its chunks must be free.
+  void FreeSlab(Slab *slab);
+
+  /// Return the slabs that have no chunks in use to the underlying allocator.
+  ///
+  /// \return Whether any slab was freed.
+  bool FreeEmptySlabs();
+
+  /// Find the slab that contains the address, if any.
+  Slab *FindSlab(const void *address) const;
+
+  IAllocator &allocator_;
+  const int64_t max_object_size_;
+  const int64_t slab_size_;
+  /// The size classes, from the smallest chunk size.
+  std::vector<SizeClass> size_classes_;
+  /// All slabs, by base address.
+  std::map<uint8_t *, std::unique_ptr<Slab>> slabs_;
+  /// Number of slabs with no chunks in use.
+  int64_t num_empty_slabs_ = 0;
+};
+
+}  // namespace plasma
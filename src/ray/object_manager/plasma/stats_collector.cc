@@ -220,6 +220,47 @@ void ObjectStatsCollector::RecordMetrics() const {
       bytes_by_loc_seal_.Get({/* fallback_allocated */ true, /* sealed */ false}),
       {{ray::stats::LocationKey, ray::stats::kObjectLocMmapDisk},
        {ray::stats::ObjectStateKey, ray::stats::kObjectUnsealed}});
+
+  if (allocator_ != nullptr) {
+    for (const auto &stats : allocator_->GetSizeClassStats()) {
+      const auto size_class = std::to_string(stats.chunk_size);
+      const int64_t chunk_bytes_in_use = stats.num_chunks_in_use * stats.chunk_size;
+      ray::stats::STATS_object_store_slab_memory.Record(
+          stats.bytes_in_use, {{"SizeClass", size_class}, {"State", "IN_USE"}});
+      ray::stats::STATS_object_store_slab_memory.Record(
+          chunk_bytes_in_use - stats.bytes_in_use,
+          {{"SizeClass", size_class}, {"State", "ROUNDING"}});
+      ray::stats::STATS_object_store_slab_memory.Record(
+          (stats.num_chunks - stats.num_chunks_in_use) * stats.chunk_size,
+          {{"SizeClass", size_class}, {"State", "FREE"}});
+    }
+  }
+}
+
+void ObjectStatsCollector::GetSizeClassDebugDump(std::stringstream &buffer) const {
+  const auto size_class_stats = allocator_->GetSizeClassStats();
+  if (size_class_stats.empty()) {
+    return;
+  }
+  int64_t slab_bytes = 0;
+  int64_t bytes_in_use = 0;
+  std::stringstream classes;
+  for (const auto &stats : size_class_stats) {
+    slab_bytes += stats.num_chunks * stats.chunk_size;
+    bytes_in_use += stats.bytes_in_use;
+    if (stats.num_slabs > 0) {
+      classes << "  - " << stats.chunk_size << " bytes: " << stats.num_slabs
+              << " slabs, " << stats.num_chunks_in_use << " / " << stats.num_chunks
+              << " chunks in use\n";
+    }
+  }
+  buffer << "\n";
+  buffer << "- bytes in slabs: " << slab_bytes << "\n";
+  buffer << "- slab bytes in use: " << bytes_in_use << "\n";
+  buffer << "- slab fragmentation: "
+         << (slab_bytes > 0 ? 1.0 - static_cast<double>(bytes_in_use) / slab_bytes : 0)
+         << "\n";
+  buffer << "- slabs by size class:\n" << classes.str();
 }
 
 void ObjectStatsCollector::GetDebugDump(std::stringstream &buffer) const {
@@ -241,6 +282,10 @@ void ObjectStatsCollector::GetDebugDump(std::stringstream &buffer) const {
   buffer << "- bytes received: " << num_bytes_received_ << "\n";
   buffer << "- objects errored: " << num_objects_errored_ << "\n";
   buffer << "- bytes errored: " << num_bytes_errored_ << "\n";
+
+  if (allocator_ != nullptr) {
+    GetSizeClassDebugDump(buffer);
+  }
 }
 
 int64_t ObjectStatsCollector::GetNumBytesInUse() const { return num_bytes_in_use_; }
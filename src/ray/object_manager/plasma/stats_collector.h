@@ -19,6 +19,7 @@
 
 #include <utility>  // std::pair
 
+#include "ray/object_manager/plasma/allocator.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/util/counter_map.h"  // CounterMap
 
@@ -31,6 +32,10 @@ namespace plasma {
 // ObjectLifeCycleManager into this class.
 class ObjectStatsCollector {
  public:
+  /// \param allocator If set, the occupancy of its size classes is also recorded.
+  explicit ObjectStatsCollector(const IAllocator *allocator = nullptr)
+      : allocator_(allocator) {}
+
   virtual ~ObjectStatsCollector() = default;
 
   // Called after a new object is created.
@@ -72,6 +77,11 @@ class ObjectStatsCollector {
 
   int64_t GetNumBytesCreatedCurrent() const;
 
+  /// Debug dump the occupancy of the size classes of the allocator.
+  void GetSizeClassDebugDump(std::stringstream &buffer) const;
+
+  const IAllocator *allocator_;
+
   CounterMap<std::pair</* fallback_allocated*/ bool, /*sealed*/ bool>> bytes_by_loc_seal_;
   int64_t num_objects_spillable_ = 0;
   int64_t num_bytes_spillable_ = 0;
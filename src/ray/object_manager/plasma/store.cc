@@ -33,6 +33,7 @@
 #include <string.h>
 
 #include <boost/bind/bind.hpp>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <deque>
@@ -48,6 +49,9 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/client_connection.h"
 #include "ray/object_manager/plasma/common.h"
+#ifndef _WIN32
+#include "ray/object_manager/plasma/fling.h"
+#endif
 #include "ray/object_manager/plasma/get_request_queue.h"
 #include "ray/object_manager/plasma/malloc.h"
 #include "ray/object_manager/plasma/plasma_allocator.h"
@@ -100,7 +104,8 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
           [this]() ABSL_NO_THREAD_SAFETY_ANALYSIS {
             mutex_.AssertHeld();
             return GetDebugDump();
-          }),
+          },
+          RayConfig::instance().plasma_create_small_request_max_size()),
       total_consumed_bytes_(0),
       get_request_queue_(
           io_context_,
@@ -112,7 +117,11 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
             mutex_.AssertHeld();
             this->AddToClientObjectIds(object_id, fallback_allocated_fd, request->client);
           },
-          [this](const auto &request) { this->ReturnFromGet(request); }) {
+          [this](const auto &request) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+            mutex_.AssertHeld();
+            this->ReturnFromGet(request);
+          },
+          &mutex_) {
   ray::SetCloseOnExec(acceptor_);
 
   if (RayConfig::instance().event_stats_print_interval_ms() > 0 &&
@@ -123,17 +132,66 @@ PlasmaStore::PlasmaStore(instrumented_io_context &main_service,
   if (RayConfig::instance().metrics_report_interval_ms() > 0) {
     ScheduleRecordMetrics();
   }
+
+  if (RayConfig::instance().plasma_access_trace_capacity() > 0 &&
+      !RayConfig::instance().plasma_access_trace_path().empty() &&
+      RayConfig::instance().plasma_access_trace_dump_interval_ms() > 0) {
+    ScheduleDumpAccessTrace();
+  }
 }
 
 // TODO(pcm): Get rid of this destructor by using RAII to clean up data.
-PlasmaStore::~PlasmaStore() {}
+PlasmaStore::~PlasmaStore() {
+  std::unique_ptr<PlasmaCommandRingPoller> poller;
+  {
+    absl::MutexLock lock(&mutex_);
+    poller.swap(command_ring_poller_);
+    command_ring_clients_.clear();
+  }
+  // The thread serving the rings is joined here, outside of the lock.
+  poller.reset();
+  StopClientThreads();
+}
 
 void PlasmaStore::Start() {
+  // Start the store threads other than the main one. Clients are spread across all of
+  // them, while their requests still take the store lock.
+  const uint32_t num_threads =
+      std::max<uint32_t>(RayConfig::instance().plasma_store_num_threads(), 1);
+  for (uint32_t i = 1; i < num_threads; i++) {
+    auto io_context = std::make_unique<instrumented_io_context>();
+    client_io_works_.push_back(
+        std::make_unique<boost::asio::io_service::work>(*io_context));
+    client_threads_.emplace_back([io_context = io_context.get(), i]() {
+      SetThreadName("store.io." + std::to_string(i));
+      io_context->run();
+    });
+    client_io_contexts_.push_back(std::move(io_context));
+  }
   // Start listening for clients.
   DoAccept();
 }
 
-void PlasmaStore::Stop() { acceptor_.close(); }
+void PlasmaStore::Stop() {
+  acceptor_.close();
+  StopClientThreads();
+
+  if (RayConfig::instance().plasma_access_trace_capacity() > 0 &&
+      !RayConfig::instance().plasma_access_trace_path().empty()) {
+    DumpAccessTrace();
+  }
+}
+
+void PlasmaStore::StopClientThreads() {
+  for (auto &io_context : client_io_contexts_) {
+    io_context->stop();
+  }
+  for (auto &thread : client_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
 
 // If this client is not already using the object, add the client to the
 // object's list of clients, otherwise do nothing.
@@ -219,27 +277,59 @@ void PlasmaStore::ReturnFromGet(const std::shared_ptr<GetRequest> &get_request)
       }
     }
   }
-  // Send the get reply to the client.
-  Status s = SendGetReply(std::dynamic_pointer_cast<Client>(get_request->client),
-                          &get_request->object_ids[0],
-                          get_request->objects,
-                          get_request->object_ids.size(),
-                          store_fds,
-                          mmap_sizes);
-  // If we successfully sent the get reply message to the client, then also send
-  // the file descriptors.
-  if (s.ok()) {
-    // Send all of the file descriptors for the present objects.
-    for (MEMFD_TYPE store_fd : store_fds) {
-      Status send_fd_status = get_request->client->SendFd(store_fd);
-      if (!send_fd_status.ok()) {
-        RAY_LOG(ERROR) << "Failed to send mmap results to client on fd "
-                       << get_request->client;
-      }
-    }
-  } else {
-    RAY_LOG(ERROR) << "Failed to send Get reply to client on fd " << get_request->client;
+  // The request may be satisfied by another client's seal, or time out on the main
+  // store thread, so the reply is sent from the thread that serves the client.
+  auto client = std::dynamic_pointer_cast<Client>(get_request->client);
+  SendToClient(client,
+               [client,
+                get_request,
+                store_fds = std::move(store_fds),
+                mmap_sizes = std::move(mmap_sizes)]() {
+                 // Send the get reply to the client.
+                 Status s = SendGetReply(client,
+                                         &get_request->object_ids[0],
+                                         get_request->objects,
+                                         get_request->object_ids.size(),
+                                         store_fds,
+                                         mmap_sizes);
+                 // If we successfully sent the get reply message to the client, then
+                 // also send the file descriptors.
+                 if (s.ok()) {
+                   // Send all of the file descriptors for the present objects.
+                   for (MEMFD_TYPE store_fd : store_fds) {
+                     Status send_fd_status = client->SendFd(store_fd);
+                     if (!send_fd_status.ok()) {
+                       RAY_LOG(ERROR) << "Failed to send mmap results to client on fd "
+                                      << client;
+                     }
+                   }
+                 } else {
+                   RAY_LOG(ERROR) << "Failed to send Get reply to client on fd "
+                                  << client;
+                 }
+               });
+}
+
+void PlasmaStore::SendToClient(const std::shared_ptr<Client> &client,
+                               std::function<void()> send) {
+  auto it = client_io_context_of_.find(client.get());
+  if (it == client_io_context_of_.end()) {
+    return;
+  }
+  auto &io_context = *it->second;
+  if (io_context.get_executor().running_in_this_thread()) {
+    send();
+    return;
   }
+  io_context.post(
+      [this, client, send = std::move(send)]() {
+        absl::MutexLock lock(&mutex_);
+        // The client holds on to its entry, so the entry is still the client's own.
+        if (client_io_context_of_.contains(client.get())) {
+          send();
+        }
+      },
+      "PlasmaStore.SendToClient");
 }
 
 void PlasmaStore::ProcessGetRequest(const std::shared_ptr<Client> &client,
@@ -260,6 +350,12 @@ bool PlasmaStore::RemoveFromClientObjectIds(const ObjectID &object_id,
     bool should_unmap = client->MarkObjectAsUnused(object_id);
     RAY_LOG(DEBUG) << "Object " << object_id
                    << " no longer in use by client, should_unmap = " << should_unmap;
+    auto retired_it = dedup_retired_allocation_holders_.find(object_id);
+    if (retired_it != dedup_retired_allocation_holders_.end() &&
+        retired_it->second == client.get()) {
+      dedup_retired_allocation_holders_.erase(retired_it);
+      object_lifecycle_mgr_.FreeRetiredAllocation(object_id);
+    }
     // Decrease reference count.
     object_lifecycle_mgr_.RemoveReference(object_id);
     // Return true to indicate that the client should unmap the fd for this object_id.
@@ -280,11 +376,14 @@ bool PlasmaStore::ReleaseObject(const ObjectID &object_id,
   return false;
 }
 
-void PlasmaStore::SealObjects(const std::vector<ObjectID> &object_ids) {
+void PlasmaStore::SealObjects(const std::vector<ObjectID> &object_ids,
+                              const std::vector<uint64_t> &content_hashes,
+                              const std::shared_ptr<Client> &client) {
   for (size_t i = 0; i < object_ids.size(); ++i) {
     RAY_LOG(DEBUG) << "sealing object " << object_ids[i];
     auto entry = object_lifecycle_mgr_.SealObject(object_ids[i]);
     RAY_CHECK(entry) << object_ids[i] << " is missing or not sealed.";
+    DeduplicateSealedObject(object_ids[i], content_hashes[i], client);
     add_object_callback_(entry->GetObjectInfo());
   }
 
@@ -293,6 +392,22 @@ void PlasmaStore::SealObjects(const std::vector<ObjectID> &object_ids) {
   }
 }
 
+void PlasmaStore::DeduplicateSealedObject(const ObjectID &object_id,
+                                          uint64_t content_hash,
+                                          const std::shared_ptr<Client> &client) {
+  auto entry = object_lifecycle_mgr_.GetObject(object_id);
+  bool held_by_client = client->GetObjectIDs().count(object_id) > 0;
+  if (entry->GetRefCount() > (held_by_client ? 1 : 0)) {
+    // Another client maps the object's memory and we don't know when it's done with
+    // it, so the object keeps its own copy.
+    return;
+  }
+  if (object_lifecycle_mgr_.DeduplicateObject(object_id, content_hash, held_by_client) &&
+      held_by_client) {
+    dedup_retired_allocation_holders_[object_id] = client.get();
+  }
+}
+
 int PlasmaStore::AbortObject(const ObjectID &object_id,
                              const std::shared_ptr<Client> &client) {
   auto &object_ids = client->GetObjectIDs();
@@ -310,11 +425,13 @@ int PlasmaStore::AbortObject(const ObjectID &object_id,
 
 void PlasmaStore::ConnectClient(const boost::system::error_code &error) {
   if (!error) {
+    absl::MutexLock lock(&mutex_);
     // Accept a new local client and dispatch it to the node manager.
     auto new_connection = Client::Create(
         // NOLINTNEXTLINE : handler must be of boost::AcceptHandler type.
         boost::bind(&PlasmaStore::ProcessMessage, this, ph::_1, ph::_2, ph::_3),
         std::move(socket_));
+    client_io_context_of_[new_connection.get()] = accepting_io_context_;
   }
 
   if (error != boost::asio::error::operation_aborted) {
@@ -353,6 +470,87 @@ void PlasmaStore::DisconnectClient(const std::shared_ptr<Client> &client) {
   }
 
   create_request_queue_.RemoveDisconnectedClientRequests(client);
+
+  if (command_ring_clients_.erase(client.get()) > 0) {
+    command_ring_poller_->Remove(client.get());
+  }
+  client_io_context_of_.erase(client.get());
+}
+
+Status PlasmaStore::ConnectCommandRing(const std::shared_ptr<Client> &client) {
+  auto status = Status::OK();
+  if (command_ring_poller_ == nullptr) {
+    status = PlasmaCommandRingPoller::Create(&command_ring_poller_);
+  }
+  std::unique_ptr<PlasmaCommandRing> ring;
+  if (status.ok()) {
+    status = PlasmaCommandRing::Create(RayConfig::instance().plasma_command_ring_slots(),
+                                       &ring);
+  }
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to create a command ring for client " << client
+                     << ", it will send all its requests on the socket: " << status;
+    return SendConnectReply(client, allocator_.GetFootprintLimit());
+  }
+  RAY_RETURN_NOT_OK(SendConnectReply(
+      client, allocator_.GetFootprintLimit(), /*command_ring=*/true));
+#ifndef _WIN32
+  if (send_fd(client->GetNativeHandle(), ring->GetFd()) <= 0 ||
+      send_fd(client->GetNativeHandle(), command_ring_poller_->GetDoorbellFd()) <= 0) {
+    return Status::IOError("Failed to send the command ring to the client.");
+  }
+#endif
+  std::weak_ptr<Client> weak_client = client;
+  command_ring_clients_.insert(client.get());
+  command_ring_poller_->Add(
+      client.get(),
+      std::move(ring),
+      [this, weak_client](RingCommandType type, const ObjectID &object_id, uint64_t arg) {
+        return ProcessRingCommand(weak_client, type, object_id, arg);
+      });
+  return Status::OK();
+}
+
+int32_t PlasmaStore::ProcessRingCommand(const std::weak_ptr<Client> &weak_client,
+                                        RingCommandType type,
+                                        const ObjectID &object_id,
+                                        uint64_t arg) {
+  absl::MutexLock lock(&mutex_);
+  auto client = weak_client.lock();
+  if (client == nullptr || !command_ring_clients_.contains(client.get())) {
+    return -1;
+  }
+  switch (type) {
+  case RingCommandType::kSeal: {
+    auto entry = object_lifecycle_mgr_.SealObject(object_id);
+    RAY_CHECK(entry) << object_id << " is missing or not sealed.";
+    DeduplicateSealedObject(object_id, /*content_hash=*/arg, client);
+    add_object_callback_(entry->GetObjectInfo());
+    // The get requests own timers of the main store thread, so the ones waiting for
+    // the object are completed there. Their replies go through SendToClient.
+    io_context_.post(
+        [this, object_id]() {
+          absl::MutexLock lock(&mutex_);
+          if (object_lifecycle_mgr_.IsObjectSealed(object_id)) {
+            get_request_queue_.MarkObjectSealed(object_id);
+          }
+        },
+        "PlasmaStore.MarkObjectSealed");
+    return static_cast<int32_t>(PlasmaError::OK);
+  }
+  case RingCommandType::kRelease: {
+    bool should_unmap = ReleaseObject(object_id, client);
+    RAY_CHECK(!should_unmap) << "Plasma client released a fallback-allocated object "
+                                "through the command ring. Object ID: "
+                             << object_id;
+    return 0;
+  }
+  case RingCommandType::kContains:
+    return object_lifecycle_mgr_.IsObjectSealed(object_id) ? 1 : 0;
+  }
+  RAY_LOG(ERROR) << "Unknown command " << static_cast<uint32_t>(type)
+                 << " in the command ring of client " << client;
+  return -1;
 }
 
 Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
@@ -391,8 +589,8 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
         static_cast<void>(client->SendFd(result.store_fd));
       }
     } else {
-      auto req_id =
-          create_request_queue_.AddRequest(object_id, client, handle_create, object_size);
+      auto req_id = create_request_queue_.AddRequest(
+          object_id, client, handle_create, object_size, request->priority());
       RAY_LOG(DEBUG) << "Received create request for object " << object_id
                      << " assigned request ID " << req_id << ", " << object_size
                      << " bytes";
@@ -406,6 +604,12 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     const auto &object_id = ObjectID::FromBinary(request->object_id()->str());
     ReplyToCreateClient(client, object_id, request->request_id());
   } break;
+  case fb::MessageType::PlasmaCreateManyRequest: {
+    std::vector<ray::ObjectInfo> object_infos;
+    std::vector<fb::ObjectSource> sources;
+    ReadCreateManyRequest(input, input_size, &object_infos, &sources);
+    RAY_RETURN_NOT_OK(HandleCreateManyRequest(client, object_infos, sources));
+  } break;
   case fb::MessageType::PlasmaAbortRequest: {
     RAY_RETURN_NOT_OK(ReadAbortRequest(input, input_size, &object_id));
     RAY_CHECK(AbortObject(object_id, client) == 1) << "To abort an object, the only "
@@ -440,6 +644,15 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     }
 
   } break;
+  case fb::MessageType::PlasmaReleaseManyRequest: {
+    std::vector<ObjectID> object_ids;
+    RAY_RETURN_NOT_OK(ReadReleaseManyRequest(input, input_size, &object_ids));
+    for (const auto &object_id : object_ids) {
+      RAY_CHECK(!ReleaseObject(object_id, client))
+          << "Plasma client batched the release of a fallback-allocated object "
+          << object_id;
+    }
+  } break;
   case fb::MessageType::PlasmaDeleteRequest: {
     std::vector<ObjectID> object_ids;
     std::vector<PlasmaError> error_codes;
@@ -459,10 +672,19 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     }
   } break;
   case fb::MessageType::PlasmaSealRequest: {
-    RAY_RETURN_NOT_OK(ReadSealRequest(input, input_size, &object_id));
-    SealObjects({object_id});
+    uint64_t content_hash;
+    RAY_RETURN_NOT_OK(ReadSealRequest(input, input_size, &object_id, &content_hash));
+    SealObjects({object_id}, {content_hash}, client);
     RAY_RETURN_NOT_OK(SendSealReply(client, object_id, PlasmaError::OK));
   } break;
+  case fb::MessageType::PlasmaSealManyRequest: {
+    std::vector<ObjectID> object_ids;
+    std::vector<uint64_t> content_hashes;
+    RAY_RETURN_NOT_OK(
+        ReadSealManyRequest(input, input_size, &object_ids, &content_hashes));
+    SealObjects(object_ids, content_hashes, client);
+    RAY_RETURN_NOT_OK(SendSealManyReply(client, object_ids));
+  } break;
   case fb::MessageType::PlasmaEvictRequest: {
     // This code path should only be used for testing.
     int64_t num_bytes;
@@ -471,7 +693,13 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
     RAY_RETURN_NOT_OK(SendEvictReply(client, num_bytes_evicted));
   } break;
   case fb::MessageType::PlasmaConnectRequest: {
-    RAY_RETURN_NOT_OK(SendConnectReply(client, allocator_.GetFootprintLimit()));
+    bool command_ring;
+    RAY_RETURN_NOT_OK(ReadConnectRequest(input, input_size, &command_ring));
+    if (command_ring) {
+      RAY_RETURN_NOT_OK(ConnectCommandRing(client));
+    } else {
+      RAY_RETURN_NOT_OK(SendConnectReply(client, allocator_.GetFootprintLimit()));
+    }
   } break;
   case fb::MessageType::PlasmaDisconnectClient:
     RAY_LOG(DEBUG) << "Disconnecting client on fd " << client;
@@ -490,11 +718,19 @@ Status PlasmaStore::ProcessMessage(const std::shared_ptr<Client> &client,
 }
 
 void PlasmaStore::DoAccept() {
+  // The accepted client is served by the io context of the socket.
+  accepting_io_context_ = &NextClientIoContext();
+  socket_ = ray::local_stream_socket(*accepting_io_context_);
   acceptor_.async_accept(
       socket_,
       boost::bind(&PlasmaStore::ConnectClient, this, boost::asio::placeholders::error));
 }
 
+instrumented_io_context &PlasmaStore::NextClientIoContext() {
+  const size_t index = num_accepted_clients_++ % (client_io_contexts_.size() + 1);
+  return index == 0 ? io_context_ : *client_io_contexts_[index - 1];
+}
+
 void PlasmaStore::ProcessCreateRequests() {
   // Only try to process requests if the timer is not set. If the timer is set,
   // that means that the first request is currently not serviceable because
@@ -547,6 +783,34 @@ void PlasmaStore::ReplyToCreateClient(const std::shared_ptr<Client> &client,
   }
 }
 
+Status PlasmaStore::HandleCreateManyRequest(
+    const std::shared_ptr<Client> &client,
+    const std::vector<ray::ObjectInfo> &object_infos,
+    const std::vector<fb::ObjectSource> &sources) {
+  std::vector<ObjectID> object_ids;
+  std::vector<PlasmaObject> objects(object_infos.size());
+  std::vector<PlasmaError> errors;
+  object_ids.reserve(object_infos.size());
+  errors.reserve(object_infos.size());
+  for (size_t i = 0; i < object_infos.size(); i++) {
+    object_ids.push_back(object_infos[i].object_id);
+    // Don't take memory ahead of the requests that are waiting for it.
+    PlasmaError error = PlasmaError::OutOfMemory;
+    if (create_request_queue_.NumPendingRequests() == 0) {
+      error = CreateObject(
+          object_infos[i], sources[i], client, /*fallback_allocator=*/false, &objects[i]);
+    }
+    errors.push_back(error);
+  }
+  RAY_RETURN_NOT_OK(SendCreateManyReply(client, object_ids, objects, errors));
+  for (size_t i = 0; i < objects.size(); i++) {
+    if (errors[i] == PlasmaError::OK) {
+      static_cast<void>(client->SendFd(objects[i].store_fd));
+    }
+  }
+  return Status::OK();
+}
+
 int64_t PlasmaStore::GetConsumedBytes() { return total_consumed_bytes_; }
 
 bool PlasmaStore::IsObjectSpillable(const ObjectID &object_id) {
@@ -559,6 +823,11 @@ bool PlasmaStore::IsObjectSpillable(const ObjectID &object_id) {
   return entry->Sealed() && entry->GetRefCount() == 1;
 }
 
+void PlasmaStore::RecordObjectSpilled(const ObjectID &object_id) {
+  absl::MutexLock lock(&mutex_);
+  object_lifecycle_mgr_.RecordObjectSpilled(object_id);
+}
+
 void PlasmaStore::PrintAndRecordDebugDump() const {
   absl::MutexLock lock(&mutex_);
   RAY_LOG(INFO) << GetDebugDump();
@@ -580,6 +849,31 @@ void PlasmaStore::ScheduleRecordMetrics() const {
       std::chrono::milliseconds(RayConfig::instance().metrics_report_interval_ms() / 2));
 }
 
+void PlasmaStore::ScheduleDumpAccessTrace() const {
+  DumpAccessTrace();
+  absl::MutexLock lock(&mutex_);
+  access_trace_timer_ = execute_after(
+      io_context_,
+      [this]() { ScheduleDumpAccessTrace(); },
+      std::chrono::milliseconds(
+          RayConfig::instance().plasma_access_trace_dump_interval_ms()));
+}
+
+void PlasmaStore::DumpAccessTrace() const {
+  std::vector<ObjectAccessEvent> events;
+  {
+    absl::MutexLock lock(&mutex_);
+    events = object_lifecycle_mgr_.GetAccessTraceEvents();
+  }
+  // The file is written without the store lock, so that clients aren't blocked.
+  absl::MutexLock lock(&access_trace_file_mutex_);
+  auto status = WriteObjectAccessTraceFile(
+      RayConfig::instance().plasma_access_trace_path(), events);
+  if (!status.ok()) {
+    RAY_LOG(WARNING) << "Failed to write the plasma access trace: " << status;
+  }
+}
+
 std::string PlasmaStore::GetDebugDump() const {
   std::stringstream buffer;
   buffer << "Plasma store debug dump: \n";
@@ -18,19 +18,24 @@
 #pragma once
 
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/file_system_monitor.h"
 #include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/object_manager/common.h"
+#include "ray/object_manager/plasma/command_ring.h"
 #include "ray/object_manager/plasma/common.h"
 #include "ray/object_manager/plasma/connection.h"
 #include "ray/object_manager/plasma/create_request_queue.h"
@@ -80,6 +85,9 @@ class PlasmaStore {
   /// before the object is pinned by raylet for the first time.
   bool IsObjectSpillable(const ObjectID &object_id) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Record in the access trace that the raylet spilled the object.
+  void RecordObjectSpilled(const ObjectID &object_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
   /// Return the plasma object bytes that are consumed by core workers.
   int64_t GetConsumedBytes();
 
@@ -182,7 +190,27 @@ class PlasmaStore {
   /// get.
   ///
   /// \param object_ids The vector of Object IDs of the objects to be sealed.
-  void SealObjects(const std::vector<ObjectID> &object_ids)
+  /// \param content_hashes The content hashes computed by the client, see
+  /// DeduplicateSealedObject.
+  /// \param client The client sealing the objects.
+  void SealObjects(const std::vector<ObjectID> &object_ids,
+                   const std::vector<uint64_t> &content_hashes,
+                   const std::shared_ptr<Client> &client)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Share the memory of a just sealed object with an identical object, if dedup is
+  /// enabled. Only the creator of an object can hold it before it's sealed, so if
+  /// the sealing client holds it, its own allocation is kept until that client
+  /// releases the object.
+  ///
+  /// \param object_id The object ID of the sealed object.
+  /// \param content_hash The hash of the object's content, computed by the client
+  /// before it sealed the object so that the store doesn't hash it under its lock, or
+  /// kNoContentHash.
+  /// \param client The client that sealed the object.
+  void DeduplicateSealedObject(const ObjectID &object_id,
+                               uint64_t content_hash,
+                               const std::shared_ptr<Client> &client)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   /// Record the fact that a particular client is no longer using an object.
@@ -197,8 +225,7 @@ class PlasmaStore {
   /// Connect a new client to the PlasmaStore.
   ///
   /// \param error The error code from the acceptor.
-  void ConnectClient(const boost::system::error_code &error)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ConnectClient(const boost::system::error_code &error) ABSL_LOCKS_EXCLUDED(mutex_);
 
   /// Disconnect a client from the PlasmaStore.
   ///
@@ -210,6 +237,20 @@ class PlasmaStore {
                         plasma::flatbuf::MessageType type,
                         const std::vector<uint8_t> &message) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Create a command ring for a client, start serving it, and send it to the client
+  /// after the connect reply.
+  Status ConnectCommandRing(const std::shared_ptr<Client> &client)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Run a command posted to the ring of a client. Called by the thread polling the
+  /// rings.
+  ///
+  /// \return The result of the command, or -1 if the client is disconnected.
+  int32_t ProcessRingCommand(const std::weak_ptr<Client> &weak_client,
+                             RingCommandType type,
+                             const ObjectID &object_id,
+                             uint64_t arg) ABSL_LOCKS_EXCLUDED(mutex_);
+
   PlasmaError HandleCreateObjectRequest(const std::shared_ptr<Client> &client,
                                         const std::vector<uint8_t> &message,
                                         bool fallback_allocator,
@@ -220,12 +261,28 @@ class PlasmaStore {
                            const ObjectID &object_id,
                            uint64_t req_id) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Create a batch of objects for a client and reply with all of them. An object is
+  /// only created if there is memory for it without spilling, and no request is
+  /// already waiting for memory. Otherwise, the client creates it on its own.
+  Status HandleCreateManyRequest(const std::shared_ptr<Client> &client,
+                                 const std::vector<ray::ObjectInfo> &object_infos,
+                                 const std::vector<flatbuf::ObjectSource> &sources)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   void AddToClientObjectIds(const ObjectID &object_id,
                             std::optional<MEMFD_TYPE> fallback_allocated_fd,
                             const std::shared_ptr<ClientInterface> &client)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
-  void ReturnFromGet(const std::shared_ptr<GetRequest> &get_request);
+  void ReturnFromGet(const std::shared_ptr<GetRequest> &get_request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Run `send` on the store thread that serves the client, since only that thread
+  /// may write to the client's socket. It runs right away if this is that thread, and
+  /// otherwise with the store lock held once that thread gets to it. It doesn't run
+  /// if the client is disconnected.
+  void SendToClient(const std::shared_ptr<Client> &client, std::function<void()> send)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Returns: the client should unmap the mmap section for this object.
   bool RemoveFromClientObjectIds(const ObjectID &object_id,
@@ -235,6 +292,12 @@ class PlasmaStore {
   // Start listening for clients.
   void DoAccept();
 
+  /// The io context that serves the next client, in turn among the store threads.
+  instrumented_io_context &NextClientIoContext();
+
+  /// Stop the store threads other than the main one, and wait for them.
+  void StopClientThreads();
+
   void PrintAndRecordDebugDump() const ABSL_LOCKS_EXCLUDED(mutex_);
 
   std::string GetDebugDump() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -244,6 +307,12 @@ class PlasmaStore {
 
   void ScheduleRecordMetrics() const ABSL_LOCKS_EXCLUDED(mutex_);
 
+  /// Write the access trace now, and then every plasma_access_trace_dump_interval_ms.
+  void ScheduleDumpAccessTrace() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  /// Write the access trace to plasma_access_trace_path.
+  void DumpAccessTrace() const ABSL_LOCKS_EXCLUDED(mutex_, access_trace_file_mutex_);
+
   // A reference to the asio io context.
   instrumented_io_context &io_context_;
   /// The name of the socket this object store listens on.
@@ -252,13 +321,24 @@ class PlasmaStore {
   boost::asio::basic_socket_acceptor<ray::local_stream_protocol> acceptor_;
   /// The socket to listen on for new clients.
   ray::local_stream_socket socket_;
+  /// The io contexts of the store threads other than the main one, which serve some of
+  /// the clients, with the work that keeps them running until the store is stopped.
+  std::vector<std::unique_ptr<instrumented_io_context>> client_io_contexts_;
+  std::vector<std::unique_ptr<boost::asio::io_service::work>> client_io_works_;
+  std::vector<std::thread> client_threads_;
+  /// The number of clients accepted so far.
+  uint64_t num_accepted_clients_ = 0;
+  /// The io context of `socket_`, which serves the client being accepted.
+  instrumented_io_context *accepting_io_context_ = nullptr;
 
   /// This mutex is used in order to make plasma store threas-safe with raylet.
   /// Raylet's local_object_manager needs to ping access plasma store's method in order to
   /// figure out the correct view of the object store. recursive_mutex is used to avoid
   /// deadlock while we keep the simplest possible change. NOTE(sang): Avoid adding more
   /// interface that node manager or object manager can access the plasma store with this
-  /// mutex if it is not absolutely necessary.
+  /// mutex if it is not absolutely necessary. It's also shared by the store threads, so
+  /// that they see a single object table and make eviction and spilling decisions for
+  /// the whole store.
   mutable absl::Mutex mutex_;
 
   /// The allocator that allocates mmaped memory.
@@ -296,6 +376,13 @@ class PlasmaStore {
   mutable std::shared_ptr<boost::asio::deadline_timer> metric_timer_
       ABSL_GUARDED_BY(mutex_);
 
+  /// Timer for writing the access trace.
+  mutable std::shared_ptr<boost::asio::deadline_timer> access_trace_timer_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// Serializes the writes of the access trace file, which happen without `mutex_`.
+  mutable absl::Mutex access_trace_file_mutex_;
+
   /// Queue of object creation requests.
   CreateRequestQueue create_request_queue_ ABSL_GUARDED_BY(mutex_);
 
@@ -307,6 +394,23 @@ class PlasmaStore {
   bool dumped_on_oom_ ABSL_GUARDED_BY(mutex_) = false;
 
   GetRequestQueue get_request_queue_ ABSL_GUARDED_BY(mutex_);
+
+  /// The thread that serves the command rings of all the clients, started when the
+  /// first client asks for a ring.
+  std::unique_ptr<PlasmaCommandRingPoller> command_ring_poller_ ABSL_GUARDED_BY(mutex_);
+
+  /// The connected clients whose ring is served by the poller.
+  absl::flat_hash_set<const Client *> command_ring_clients_ ABSL_GUARDED_BY(mutex_);
+
+  /// The io contexts of the store threads that serve the connected clients. Only
+  /// these threads may write to the clients' sockets.
+  absl::flat_hash_map<const Client *, instrumented_io_context *> client_io_context_of_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// The creators of deduplicated objects that still map the object's own
+  /// allocation. The allocation is freed when the creator releases the object.
+  absl::flat_hash_map<ObjectID, const Client *> dedup_retired_allocation_holders_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace plasma
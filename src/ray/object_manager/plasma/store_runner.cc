@@ -90,6 +90,14 @@ void PlasmaStoreRunner::Start(ray::SpillObjectsCallback spill_objects_callback,
     absl::MutexLock lock(&store_runner_mutex_);
     allocator_ = std::make_unique<PlasmaAllocator>(
         plasma_directory_, fallback_directory_, hugepages_enabled_, system_memory_);
+    IAllocator *allocator = allocator_.get();
+    if (RayConfig::instance().plasma_slab_max_object_size() > 0) {
+      slab_allocator_ = std::make_unique<SlabAllocator>(
+          *allocator_,
+          RayConfig::instance().plasma_slab_max_object_size(),
+          RayConfig::instance().plasma_slab_size_bytes());
+      allocator = slab_allocator_.get();
+    }
 #ifndef _WIN32
     std::vector<std::string> local_spilling_paths;
     if (RayConfig::instance().is_external_storage_type_fs()) {
@@ -106,7 +114,7 @@ void PlasmaStoreRunner::Start(ray::SpillObjectsCallback spill_objects_callback,
     fs_monitor_ = std::make_unique<ray::FileSystemMonitor>();
 #endif
     store_.reset(new PlasmaStore(main_service_,
-                                 *allocator_,
+                                 *allocator,
                                  *fs_monitor_,
                                  socket_name_,
                                  RayConfig::instance().object_store_full_delay_ms(),
@@ -140,6 +148,10 @@ bool PlasmaStoreRunner::IsPlasmaObjectSpillable(const ObjectID &object_id) {
   return store_->IsObjectSpillable(object_id);
 }
 
+void PlasmaStoreRunner::RecordObjectSpilled(const ObjectID &object_id) {
+  store_->RecordObjectSpilled(object_id);
+}
+
 int64_t PlasmaStoreRunner::GetConsumedBytes() { return store_->GetConsumedBytes(); }
 
 int64_t PlasmaStoreRunner::GetFallbackAllocated() const {
@@ -7,6 +7,7 @@
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/file_system_monitor.h"
 #include "ray/object_manager/plasma/plasma_allocator.h"
+#include "ray/object_manager/plasma/slab_allocator.h"
 #include "ray/object_manager/plasma/store.h"
 
 namespace plasma {
@@ -26,6 +27,8 @@ class PlasmaStoreRunner {
 
   bool IsPlasmaObjectSpillable(const ObjectID &object_id);
 
+  void RecordObjectSpilled(const ObjectID &object_id);
+
   int64_t GetConsumedBytes();
 
   int64_t GetCumulativeCreatedObjects() const {
@@ -53,12 +56,14 @@ class PlasmaStoreRunner {
   std::string fallback_directory_;
   mutable instrumented_io_context main_service_;
   std::unique_ptr<PlasmaAllocator> allocator_;
+  /// Serves small objects from slabs of allocator_, if enabled.
+  std::unique_ptr<SlabAllocator> slab_allocator_;
   std::unique_ptr<ray::FileSystemMonitor> fs_monitor_;
   std::unique_ptr<PlasmaStore> store_;
 };
 
 // We use a global variable for Plasma Store instance here because:
-// 1) There is only one plasma store thread in Raylet.
+// 1) There is only one plasma store in Raylet.
 // 2) The thirdparty dlmalloc library cannot be contained in a local variable,
 //    so even we use a local variable for plasma store, it does not provide
 //    better isolation.
@@ -0,0 +1,154 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/object_manager/plasma/client.h"
+#include "ray/object_manager/plasma/store_runner.h"
+
+namespace plasma {
+
+/// Runs a plasma store in the test process, shared by all the tests since the
+/// allocator is global.
+class PlasmaClientBatchTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    socket_name_ = "/tmp/plasma_client_batch_test." + std::to_string(getpid());
+    runner_ = std::make_unique<PlasmaStoreRunner>(socket_name_,
+                                                  /*system_memory=*/256 << 20,
+                                                  /*hugepages_enabled=*/false,
+                                                  /*plasma_directory=*/"",
+                                                  /*fallback_directory=*/"");
+    store_thread_ = std::thread([]() {
+      runner_->Start([]() { return false; },
+                     []() {},
+                     [](const ray::ObjectInfo &object_info) {},
+                     [](const ObjectID &object_id) {});
+    });
+  }
+
+  static void TearDownTestSuite() {
+    runner_->Stop();
+    store_thread_.join();
+    runner_.reset();
+  }
+
+  void SetUp() override {
+    RAY_CHECK_OK(client_.Connect(socket_name_, ""));
+    RAY_CHECK_OK(other_client_.Connect(socket_name_, ""));
+  }
+
+  void TearDown() override {
+    RAY_CHECK_OK(client_.Disconnect());
+    RAY_CHECK_OK(other_client_.Disconnect());
+  }
+
+  /// Create, write, seal and release objects one at a time.
+  void PutOneByOne(const std::vector<ObjectID> &object_ids, int64_t size) {
+    for (const auto &object_id : object_ids) {
+      std::shared_ptr<Buffer> data;
+      RAY_CHECK_OK(client_.CreateAndSpillIfNeeded(object_id,
+                                                  ray::rpc::Address(),
+                                                  /*is_mutable=*/false,
+                                                  size,
+                                                  nullptr,
+                                                  0,
+                                                  &data,
+                                                  flatbuf::ObjectSource::CreatedByWorker));
+      std::memset(data->Data(), 1, size);
+      RAY_CHECK_OK(client_.Seal(object_id));
+      RAY_CHECK_OK(client_.Release(object_id));
+    }
+  }
+
+  static std::string socket_name_;
+  static std::unique_ptr<PlasmaStoreRunner> runner_;
+  static std::thread store_thread_;
+
+  PlasmaClient client_;
+  PlasmaClient other_client_;
+};
+
+std::string PlasmaClientBatchTest::socket_name_;
+std::unique_ptr<PlasmaStoreRunner> PlasmaClientBatchTest::runner_;
+std::thread PlasmaClientBatchTest::store_thread_;
+
+TEST_F(PlasmaClientBatchTest, TestCreateAndSealMany) {
+  RayConfig::instance().initialize(R"({"plasma_client_release_batch_size": 16})");
+  const auto existing_id = ObjectID::FromRandom();
+  PutOneByOne({existing_id}, 8);
+
+  std::vector<ObjectID> object_ids;
+  for (int i = 0; i < 100; i++) {
+    object_ids.push_back(ObjectID::FromRandom());
+  }
+  object_ids.push_back(existing_id);
+  std::vector<int64_t> data_sizes;
+  std::vector<int64_t> metadata_sizes;
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    data_sizes.push_back(i + 1);
+    metadata_sizes.push_back(1);
+  }
+  const uint8_t metadata = 7;
+  std::vector<std::shared_ptr<Buffer>> data;
+  ASSERT_TRUE(client_
+                  .CreateMany(object_ids,
+                              ray::rpc::Address(),
+                              data_sizes,
+                              std::vector<const uint8_t *>(object_ids.size(), &metadata),
+                              metadata_sizes,
+                              &data,
+                              flatbuf::ObjectSource::CreatedByWorker)
+                  .ok());
+  ASSERT_EQ(data.size(), object_ids.size());
+  // The object that already exists isn't created.
+  ASSERT_EQ(data.back(), nullptr);
+  object_ids.pop_back();
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    ASSERT_NE(data[i], nullptr);
+    ASSERT_EQ(data[i]->Size(), static_cast<size_t>(data_sizes[i]));
+    std::memset(data[i]->Data(), i, data_sizes[i]);
+  }
+  ASSERT_TRUE(client_.SealMany(object_ids).ok());
+  ASSERT_TRUE(client_.SealMany({object_ids[0]}).IsObjectAlreadySealed());
+  data.clear();
+  for (const auto &object_id : object_ids) {
+    ASSERT_TRUE(client_.Release(object_id).ok());
+    ASSERT_FALSE(client_.IsInUse(object_id));
+  }
+  ASSERT_TRUE(client_.FlushReleases().ok());
+
+  std::vector<ObjectBuffer> object_buffers;
+  ASSERT_TRUE(other_client_.Get(object_ids, 0, &object_buffers, false).ok());
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    ASSERT_NE(object_buffers[i].data, nullptr);
+    ASSERT_EQ(object_buffers[i].data->Size(), static_cast<size_t>(data_sizes[i]));
+    ASSERT_EQ(object_buffers[i].data->Data()[0], static_cast<uint8_t>(i));
+    ASSERT_EQ(object_buffers[i].metadata->Data()[0], metadata);
+  }
+  object_buffers.clear();
+  // The objects are no longer in use by any client, so they can be deleted.
+  ASSERT_TRUE(other_client_.Delete(object_ids).ok());
+  bool has_object;
+  ASSERT_TRUE(other_client_.Contains(object_ids[0], &has_object).ok());
+  ASSERT_FALSE(has_object);
+}
+
+}  // namespace plasma
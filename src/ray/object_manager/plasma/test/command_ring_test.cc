@@ -0,0 +1,156 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/command_ring.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "ray/util/logging.h"
+
+namespace plasma {
+
+namespace {
+
+/// Create a ring served by `poller`, and map its client side, as the client does with
+/// the fds sent by the store.
+std::unique_ptr<PlasmaCommandRing> AddRing(PlasmaCommandRingPoller &poller,
+                                           uint32_t num_slots,
+                                           PlasmaCommandRingPoller::Handler handler) {
+  std::unique_ptr<PlasmaCommandRing> ring;
+  RAY_CHECK_OK(PlasmaCommandRing::Create(num_slots, &ring));
+  std::unique_ptr<PlasmaCommandRing> client;
+  RAY_CHECK_OK(
+      PlasmaCommandRing::Map(dup(ring->GetFd()), dup(poller.GetDoorbellFd()), &client));
+  poller.Add(client.get(), std::move(ring), std::move(handler));
+  return client;
+}
+
+std::unique_ptr<PlasmaCommandRingPoller> CreatePoller() {
+  std::unique_ptr<PlasmaCommandRingPoller> poller;
+  RAY_CHECK_OK(PlasmaCommandRingPoller::Create(&poller));
+  return poller;
+}
+
+}  // namespace
+
+TEST(PlasmaCommandRingTest, TestCall) {
+  auto poller = CreatePoller();
+  const auto sealed_id = ObjectID::FromRandom();
+  auto handler = [&sealed_id](
+                     RingCommandType type, const ObjectID &object_id, uint64_t arg) {
+    if (type == RingCommandType::kSeal) {
+      return static_cast<int32_t>(arg);
+    }
+    return type == RingCommandType::kContains && object_id == sealed_id ? 1 : 0;
+  };
+  auto client = AddRing(*poller, 4, handler);
+
+  int32_t result;
+  ASSERT_TRUE(client->Call(RingCommandType::kContains, sealed_id, &result));
+  ASSERT_EQ(result, 1);
+  ASSERT_TRUE(client->Call(RingCommandType::kContains, ObjectID::FromRandom(), &result));
+  ASSERT_EQ(result, 0);
+  ASSERT_TRUE(client->Call(RingCommandType::kSeal, sealed_id, &result));
+  ASSERT_EQ(result, 0);
+  // The argument of a command gets to the store.
+  ASSERT_TRUE(client->Call(RingCommandType::kSeal, sealed_id, &result, /*arg=*/42));
+  ASSERT_EQ(result, 42);
+}
+
+TEST(PlasmaCommandRingTest, TestPostedCommandsRunInOrder) {
+  auto poller = CreatePoller();
+  std::vector<ObjectID> run;
+  // Fewer slots than commands, so the client waits for free slots.
+  auto client =
+      AddRing(*poller,
+              8,
+              [&run](RingCommandType type, const ObjectID &object_id, uint64_t arg) {
+                run.push_back(object_id);
+                return 0;
+              });
+
+  std::vector<ObjectID> posted;
+  for (int i = 0; i < 1000; i++) {
+    posted.push_back(ObjectID::FromRandom());
+    ASSERT_TRUE(client->Post(RingCommandType::kRelease, posted.back()));
+  }
+  ASSERT_TRUE(client->Drain());
+  ASSERT_EQ(run, posted);
+}
+
+TEST(PlasmaCommandRingTest, TestManyRingsOnePoller) {
+  auto poller = CreatePoller();
+  std::vector<std::unique_ptr<PlasmaCommandRing>> clients;
+  for (int i = 0; i < 16; i++) {
+    clients.push_back(
+        AddRing(*poller,
+                4,
+                [i](RingCommandType type, const ObjectID &object_id, uint64_t arg) {
+                  return i;
+                }));
+  }
+  ASSERT_EQ(poller->NumRings(), 16);
+  // Let the poller go to sleep, so that the clients have to wake it up.
+  absl::SleepFor(absl::Milliseconds(10));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 16; i++) {
+      int32_t result;
+      ASSERT_TRUE(
+          clients[i]->Call(RingCommandType::kSeal, ObjectID::FromRandom(), &result));
+      ASSERT_EQ(result, i);
+    }
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+TEST(PlasmaCommandRingTest, TestIdlePollerSleeps) {
+  auto poller = CreatePoller();
+  std::vector<std::unique_ptr<PlasmaCommandRing>> clients;
+  for (int i = 0; i < 64; i++) {
+    clients.push_back(AddRing(
+        *poller,
+        4,
+        [](RingCommandType type, const ObjectID &object_id, uint64_t arg) { return 0; }));
+  }
+  struct timespec start, end;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start);
+  absl::SleepFor(absl::Milliseconds(500));
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end);
+  const int64_t cpu_us = (end.tv_sec - start.tv_sec) * 1000000 +
+                         (end.tv_nsec - start.tv_nsec) / 1000;
+  // Idle clients cost nothing: the poller sleeps on the doorbell instead of spinning.
+  ASSERT_LT(cpu_us, 50000);
+}
+
+TEST(PlasmaCommandRingTest, TestRemoveFailsClient) {
+  auto poller = CreatePoller();
+  auto client = AddRing(
+      *poller,
+      4,
+      [](RingCommandType type, const ObjectID &object_id, uint64_t arg) { return 0; });
+  poller->Remove(client.get());
+  ASSERT_EQ(poller->NumRings(), 0);
+
+  int32_t result;
+  ASSERT_FALSE(client->Call(RingCommandType::kSeal, ObjectID::FromRandom(), &result));
+  ASSERT_FALSE(client->Post(RingCommandType::kRelease, ObjectID::FromRandom()));
+  ASSERT_TRUE(client->IsClosed());
+}
+
+}  // namespace plasma
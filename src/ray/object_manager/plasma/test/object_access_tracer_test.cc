@@ -0,0 +1,183 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/object_access_tracer.h"
+
+#include <filesystem>
+#include <limits>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "ray/object_manager/plasma/object_access_trace_analyzer.h"
+#include "ray/util/util.h"
+
+namespace plasma {
+
+namespace {
+using Type = ObjectAccessEventType;
+
+ObjectAccessEvent Event(int64_t timestamp_ms,
+                        Type type,
+                        const ObjectID &object_id,
+                        int64_t size = 10) {
+  return {timestamp_ms * 1000, object_id, size, type};
+}
+}  // namespace
+
+TEST(ObjectAccessTracerTest, KeepsLatestEvents) {
+  ObjectAccessTracer tracer(3);
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 5; i++) {
+    ids.push_back(ObjectID::FromRandom());
+    tracer.Record(Type::CREATE, ids.back(), i);
+  }
+  EXPECT_EQ(tracer.GetNumEventsTotal(), 5);
+  auto events = tracer.GetEvents();
+  ASSERT_EQ(events.size(), 3u);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(events[i].object_id, ids[i + 2]);
+    EXPECT_EQ(events[i].object_size, i + 2);
+  }
+}
+
+TEST(ObjectAccessTracerTest, DumpAndRead) {
+  ObjectAccessTracer tracer(100);
+  auto id1 = ObjectID::FromRandom();
+  auto id2 = ObjectID::FromRandom();
+  tracer.Record(Type::CREATE, id1, 100);
+  tracer.Record(Type::SEAL, id1, 100);
+  tracer.Record(Type::CREATE, id2, 1 << 20);
+  tracer.Record(Type::GET, id1, 100);
+  tracer.Record(Type::RELEASE, id1, 100);
+  tracer.Record(Type::SPILL, id2, 1 << 20);
+  tracer.Record(Type::EVICT, id2, 1 << 20);
+  tracer.Record(Type::DELETE, id1, 100);
+
+  std::stringstream trace;
+  tracer.Dump(trace);
+  std::vector<ObjectAccessEvent> events;
+  ASSERT_TRUE(ReadObjectAccessTrace(trace, &events).ok());
+  auto expected = tracer.GetEvents();
+  ASSERT_EQ(events.size(), expected.size());
+  for (size_t i = 0; i < events.size(); i++) {
+    EXPECT_EQ(events[i].timestamp_us, expected[i].timestamp_us);
+    EXPECT_EQ(events[i].object_id, expected[i].object_id);
+    EXPECT_EQ(events[i].object_size, expected[i].object_size);
+    EXPECT_EQ(events[i].type, expected[i].type);
+  }
+
+  // A truncated trace is rejected.
+  std::string truncated = trace.str();
+  truncated.pop_back();
+  std::stringstream truncated_trace(truncated);
+  EXPECT_TRUE(ReadObjectAccessTrace(truncated_trace, &events).IsInvalid());
+  std::stringstream garbage("not a trace");
+  EXPECT_TRUE(ReadObjectAccessTrace(garbage, &events).IsInvalid());
+}
+
+TEST(ObjectAccessTracerTest, WriteFile) {
+  ObjectAccessTracer tracer(/*capacity=*/4);
+  auto id = ObjectID::FromRandom();
+  tracer.Record(Type::CREATE, id, 100);
+  tracer.Record(Type::SEAL, id, 100);
+  const auto path = std::filesystem::temp_directory_path() / GenerateUUIDV4();
+
+  // Rewriting the file replaces the previous trace.
+  ASSERT_TRUE(WriteObjectAccessTraceFile(path.string(), tracer.GetEvents()).ok());
+  tracer.Record(Type::DELETE, id, 100);
+  ASSERT_TRUE(WriteObjectAccessTraceFile(path.string(), tracer.GetEvents()).ok());
+  std::vector<ObjectAccessEvent> events;
+  ASSERT_TRUE(ReadObjectAccessTraceFile(path.string(), &events).ok());
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events.back().type, Type::DELETE);
+  EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+  std::filesystem::remove(path);
+}
+
+TEST(ObjectAccessTraceAnalyzerTest, ReuseDistance) {
+  auto a = ObjectID::FromRandom();
+  auto b = ObjectID::FromRandom();
+  auto c = ObjectID::FromRandom();
+  // Gets: a b c a a b.
+  ObjectAccessTraceAnalyzer analyzer({Event(0, Type::GET, a),
+                                      Event(1, Type::GET, b),
+                                      Event(2, Type::GET, c),
+                                      Event(3, Type::RELEASE, a),
+                                      Event(4, Type::GET, a),
+                                      Event(5, Type::GET, a),
+                                      Event(6, Type::GET, b)});
+  int64_t num_cold_gets;
+  auto histogram = analyzer.GetReuseDistanceHistogram(&num_cold_gets);
+  EXPECT_EQ(num_cold_gets, 3);
+  // a after {b, c}: 2, a after {}: 0, b after {c, a}: 2.
+  EXPECT_EQ(histogram, (std::map<int64_t, int64_t>{{0, 1}, {2, 2}}));
+}
+
+TEST(ObjectAccessTraceAnalyzerTest, Lifetime) {
+  auto a = ObjectID::FromRandom();
+  auto b = ObjectID::FromRandom();
+  auto c = ObjectID::FromRandom();
+  auto d = ObjectID::FromRandom();
+  ObjectAccessTraceAnalyzer analyzer({Event(0, Type::CREATE, a),
+                                      Event(0, Type::CREATE, b),
+                                      Event(0, Type::CREATE, c),
+                                      Event(5, Type::DELETE, a),
+                                      Event(500, Type::EVICT, b),
+                                      // Created before the trace started.
+                                      Event(600, Type::DELETE, d),
+                                      // Still alive at the end: c.
+                                      Event(100000, Type::CREATE, b),
+                                      Event(200000, Type::DELETE, b)});
+  EXPECT_EQ(analyzer.GetLifetimeHistogram(),
+            (std::map<int64_t, int64_t>{
+                {10, 1}, {1000, 1}, {std::numeric_limits<int64_t>::max(), 1}}));
+}
+
+TEST(ObjectAccessTraceAnalyzerTest, Replay) {
+  auto a = ObjectID::FromRandom();
+  auto b = ObjectID::FromRandom();
+  auto c = ObjectID::FromRandom();
+  std::vector<ObjectAccessEvent> events = {Event(0, Type::CREATE, a),
+                                           Event(1, Type::CREATE, b),
+                                           Event(2, Type::GET, a),
+                                           Event(3, Type::CREATE, c),
+                                           Event(4, Type::RELEASE, a),
+                                           // The original store evicted b, and
+                                           // restored it later.
+                                           Event(5, Type::EVICT, b),
+                                           Event(6, Type::CREATE, b),
+                                           Event(7, Type::GET, b),
+                                           Event(8, Type::GET, c),
+                                           Event(9, Type::GET, a)};
+  ObjectAccessTraceAnalyzer analyzer(events);
+
+  // Everything fits.
+  auto result = analyzer.Replay(30);
+  EXPECT_EQ(result.num_gets, 4);
+  EXPECT_EQ(result.num_hits, 4);
+  EXPECT_EQ(result.num_misses, 0);
+  EXPECT_EQ(result.num_evictions, 0);
+
+  // Creating c evicts b, since a is pinned by the get. The restore of b is a
+  // miss and evicts c, getting c again evicts a, and a is then a miss too.
+  result = analyzer.Replay(20);
+  EXPECT_EQ(result.num_gets, 4);
+  EXPECT_EQ(result.num_hits, 2);
+  EXPECT_EQ(result.num_misses, 3);
+  EXPECT_EQ(result.bytes_missed, 30);
+  EXPECT_EQ(result.num_evictions, 3);
+  EXPECT_EQ(result.bytes_evicted, 30);
+}
+
+}  // namespace plasma
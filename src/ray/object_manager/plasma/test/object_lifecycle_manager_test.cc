@@ -20,6 +20,7 @@
 #include "absl/strings/str_format.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
 
 using namespace ray;
 using namespace testing;
@@ -46,6 +47,9 @@ class MockObjectStore : public IObjectStore {
   MOCK_CONST_METHOD1(GetObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(SealObject, const LocalObject *(const ObjectID &));
   MOCK_METHOD1(DeleteObject, bool(const ObjectID &));
+  MOCK_METHOD3(DeduplicateObject, bool(const ObjectID &, uint64_t, bool));
+  MOCK_METHOD1(FreeRetiredAllocation, void(const ObjectID &));
+  MOCK_CONST_METHOD0(GetNumBytesDeduplicated, int64_t());
   MOCK_CONST_METHOD1(GetDebugDump, void(std::stringstream &buffer));
 };
 
@@ -343,6 +347,37 @@ TEST_F(ObjectLifecycleManagerTest, RemoveReferenceOneRefEagerlyDeletion) {
   std::vector<ObjectID> expect_notified_ids{id1_};
   EXPECT_EQ(expect_notified_ids, notify_deleted_ids_);
 }
+
+TEST_F(ObjectLifecycleManagerTest, DeduplicateObjectHashedAndLargeEnough) {
+  RayConfig::instance().initialize(R"({"plasma_dedup_min_object_size": 10})");
+  LocalObject small_object{Allocation()};
+  small_object.object_info.data_size = 9;
+  LocalObject large_object{Allocation()};
+  large_object.object_info.data_size = 1L << 33;
+  LocalObject object{Allocation()};
+  object.object_info.data_size = 90;
+  object.object_info.metadata_size = 10;
+
+  EXPECT_CALL(*object_store_, GetObject(id1_)).WillRepeatedly(Return(&small_object));
+  EXPECT_CALL(*object_store_, GetObject(id2_)).WillRepeatedly(Return(&large_object));
+  EXPECT_CALL(*object_store_, GetObject(id3_)).WillRepeatedly(Return(&object));
+  // Objects that are too small, or that the client didn't hash, aren't compared.
+  EXPECT_CALL(*object_store_, DeduplicateObject(id1_, _, _)).Times(0);
+  EXPECT_CALL(*object_store_, DeduplicateObject(id3_, kNoContentHash, _)).Times(0);
+  // There's no upper bound, since the store doesn't hash the objects itself.
+  EXPECT_CALL(*object_store_, DeduplicateObject(id2_, 7, false))
+      .Times(1)
+      .WillOnce(Return(false));
+  EXPECT_CALL(*object_store_, DeduplicateObject(id3_, 7, false))
+      .Times(1)
+      .WillOnce(Return(true));
+
+  EXPECT_FALSE(manager_->DeduplicateObject(id1_, 7, false));
+  EXPECT_FALSE(manager_->DeduplicateObject(id3_, kNoContentHash, false));
+  EXPECT_FALSE(manager_->DeduplicateObject(id2_, 7, false));
+  EXPECT_TRUE(manager_->DeduplicateObject(id3_, 7, false));
+  RayConfig::instance().initialize("");
+}
 }  // namespace plasma
 
 int main(int argc, char **argv) {
@@ -65,6 +65,15 @@ ObjectInfo CreateObjectInfo(ObjectID object_id, int64_t object_size) {
   return info;
 }
 
+ObjectInfo CreateObjectInfo(ObjectID object_id,
+                            int64_t data_size,
+                            int64_t metadata_size) {
+  auto info = CreateObjectInfo(object_id, data_size + metadata_size);
+  info.data_size = data_size;
+  info.metadata_size = metadata_size;
+  return info;
+}
+
 const ObjectID kId1 = ObjectID::FromRandom();
 const ObjectID kId2 = []() {
   auto id = ObjectID::FromRandom();
@@ -175,6 +184,75 @@ TEST(ObjectStoreTest, PassThroughTest) {
     EXPECT_TRUE(store.DeleteObject(kId2));
   }
 }
+
+TEST(ObjectStoreTest, DeduplicationTest) {
+  MockAllocator allocator;
+  ObjectStore store(allocator);
+  std::vector<void *> freed;
+  EXPECT_CALL(allocator, Free(_)).WillRepeatedly(Invoke([&](auto &&allocation) {
+    freed.push_back(allocation.address);
+  }));
+
+  std::string content1 = "model weights and metadata";
+  std::string content2 = content1;
+  std::string content3 = "other weights and metadata";
+  const ObjectID kId3 = ObjectID::FromRandom();
+  int64_t size = content1.size();
+  auto create = [&](const ObjectID &object_id, std::string &content) {
+    auto allocation = CreateAllocation(Allocation(), size);
+    allocation.address = content.data();
+    EXPECT_CALL(allocator, Allocate(size)).WillOnce(Invoke([&](size_t bytes) {
+      return absl::optional<Allocation>(std::move(allocation));
+    }));
+    EXPECT_NE(nullptr,
+              store.CreateObject(CreateObjectInfo(object_id, size - 8, 8),
+                                 {},
+                                 /*fallback_allocate*/ false));
+  };
+  create(kId1, content1);
+  create(kId2, content2);
+  create(kId3, content3);
+
+  auto hash = [size](const std::string &content) {
+    return ObjectContentHash(reinterpret_cast<const uint8_t *>(content.data()), size);
+  };
+  EXPECT_EQ(hash(content1), hash(content2));
+
+  // unsealed objects are not deduplicated
+  EXPECT_FALSE(store.DeduplicateObject(kId1, hash(content1), /*keep_allocation*/ false));
+  store.SealObject(kId1);
+  store.SealObject(kId2);
+  store.SealObject(kId3);
+
+  // the first object keeps its buffer
+  EXPECT_FALSE(store.DeduplicateObject(kId1, hash(content1), /*keep_allocation*/ false));
+  EXPECT_EQ(store.GetObject(kId1)->allocation.address, content1.data());
+
+  // an identical object points to the buffer of the first one, its own
+  // allocation is kept until it's retired
+  EXPECT_TRUE(store.DeduplicateObject(kId2, hash(content2), /*keep_allocation*/ true));
+  EXPECT_EQ(store.GetObject(kId2)->allocation.address, content1.data());
+  EXPECT_EQ(store.GetNumBytesDeduplicated(), size);
+  EXPECT_TRUE(freed.empty());
+  store.FreeRetiredAllocation(kId2);
+  EXPECT_THAT(freed, ElementsAre(content2.data()));
+
+  // objects are deduplicated once
+  EXPECT_FALSE(store.DeduplicateObject(kId2, hash(content2), /*keep_allocation*/ false));
+
+  // same size, different content, even if the client sent the same hash
+  EXPECT_FALSE(store.DeduplicateObject(kId3, hash(content1), /*keep_allocation*/ false));
+  EXPECT_EQ(store.GetObject(kId3)->allocation.address, content3.data());
+
+  // the buffer is freed with the last object pointing to it
+  EXPECT_TRUE(store.DeleteObject(kId1));
+  EXPECT_EQ(store.GetNumBytesDeduplicated(), 0);
+  EXPECT_THAT(freed, ElementsAre(content2.data()));
+  EXPECT_TRUE(store.DeleteObject(kId2));
+  EXPECT_THAT(freed, ElementsAre(content2.data(), content1.data()));
+  EXPECT_TRUE(store.DeleteObject(kId3));
+  EXPECT_THAT(freed, ElementsAre(content2.data(), content1.data(), content3.data()));
+}
 }  // namespace plasma
 
 int main(int argc, char **argv) {
@@ -0,0 +1,184 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/object_manager/plasma/slab_allocator.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+#include "ray/util/logging.h"
+
+namespace plasma {
+
+namespace {
+const int64_t kKB = 1024;
+const int64_t kMB = 1024 * 1024;
+}  // namespace
+
+/// Allocates from the heap, up to a limit.
+class DummyAllocator : public IAllocator {
+ public:
+  explicit DummyAllocator(int64_t limit) : limit_(limit) {}
+
+  absl::optional<Allocation> Allocate(size_t bytes) override {
+    if (allocated_ + static_cast<int64_t>(bytes) > limit_) {
+      return absl::nullopt;
+    }
+    void *address;
+    RAY_CHECK(posix_memalign(&address, 64, bytes) == 0);
+    allocated_ += bytes;
+    return Allocation(address,
+                      bytes,
+                      MEMFD_TYPE(),
+                      reinterpret_cast<ptrdiff_t>(address),
+                      0,
+                      limit_,
+                      false);
+  }
+
+  absl::optional<Allocation> FallbackAllocate(size_t bytes) override {
+    return absl::nullopt;
+  }
+
+  void Free(Allocation allocation) override {
+    free(allocation.address);
+    allocated_ -= allocation.size;
+  }
+
+  int64_t GetFootprintLimit() const override { return limit_; }
+
+  int64_t Allocated() const override { return allocated_; }
+
+  int64_t FallbackAllocated() const override { return 0; }
+
+ private:
+  const int64_t limit_;
+  int64_t allocated_ = 0;
+};
+
+TEST(SlabAllocatorTest, TestSmallObjectsShareSlabs) {
+  DummyAllocator backing(16 * kMB);
+  SlabAllocator allocator(backing, 64 * kKB, kMB);
+
+  std::vector<Allocation> allocations;
+  for (int i = 0; i < 100; i++) {
+    auto allocation = allocator.Allocate(1000);
+    ASSERT_TRUE(allocation.has_value());
+    ASSERT_EQ(allocation->size, 1000);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(allocation->address) % 64, 0);
+    allocations.push_back(std::move(allocation.value()));
+  }
+  // All the chunks are from one slab, at the offsets of their addresses. The slab
+  // counts as allocated, since its free chunks only fit objects of its class.
+  ASSERT_EQ(backing.Allocated(), kMB);
+  ASSERT_EQ(allocator.Allocated(), kMB);
+  for (const auto &allocation : allocations) {
+    ASSERT_EQ(allocation.offset - allocations[0].offset,
+              static_cast<uint8_t *>(allocation.address) -
+                  static_cast<uint8_t *>(allocations[0].address));
+    ASSERT_EQ(allocation.mmap_size, allocations[0].mmap_size);
+  }
+
+  int64_t num_slabs = 0;
+  for (const auto &stats : allocator.GetSizeClassStats()) {
+    num_slabs += stats.num_slabs;
+    if (stats.chunk_size == 1024) {
+      ASSERT_EQ(stats.num_slabs, 1);
+      ASSERT_EQ(stats.num_chunks, 1024);
+      ASSERT_EQ(stats.num_chunks_in_use, 100);
+      ASSERT_EQ(stats.bytes_in_use, 100 * 1000);
+    }
+  }
+  ASSERT_EQ(num_slabs, 1);
+
+  // Freed chunks are reused.
+  auto *address = allocations[50].address;
+  allocator.Free(std::move(allocations[50]));
+  auto allocation = allocator.Allocate(1024);
+  ASSERT_EQ(allocation->address, address);
+  allocations[50] = std::move(allocation.value());
+
+  for (auto &allocation : allocations) {
+    allocator.Free(std::move(allocation));
+  }
+  // The last slab of the class is kept for the next objects, but it doesn't count as
+  // allocated, since it's freed when the underlying allocator needs room.
+  ASSERT_EQ(allocator.Allocated(), 0);
+  ASSERT_EQ(backing.Allocated(), kMB);
+  allocation = allocator.Allocate(kKB);
+  ASSERT_EQ(allocator.Allocated(), kMB);
+  allocator.Free(std::move(allocation.value()));
+}
+
+TEST(SlabAllocatorTest, TestLargeObjectsPassThrough) {
+  DummyAllocator backing(16 * kMB);
+  SlabAllocator allocator(backing, 64 * kKB, kMB);
+
+  auto allocation = allocator.Allocate(64 * kKB + 1);
+  ASSERT_TRUE(allocation.has_value());
+  ASSERT_EQ(backing.Allocated(), 64 * kKB + 1);
+  ASSERT_EQ(allocator.Allocated(), 64 * kKB + 1);
+  for (const auto &stats : allocator.GetSizeClassStats()) {
+    ASSERT_EQ(stats.num_slabs, 0);
+  }
+  allocator.Free(std::move(allocation.value()));
+  ASSERT_EQ(backing.Allocated(), 0);
+}
+
+TEST(SlabAllocatorTest, TestNoRoomForSlab) {
+  DummyAllocator backing(kMB + 512 * kKB);
+  SlabAllocator allocator(backing, 64 * kKB, kMB);
+
+  // Takes a slab for the 1KB class.
+  auto small = allocator.Allocate(kKB);
+  ASSERT_TRUE(small.has_value());
+  // There is no room for a slab of another class, so the object is allocated
+  // directly.
+  auto other = allocator.Allocate(8 * kKB);
+  ASSERT_TRUE(other.has_value());
+  ASSERT_EQ(backing.Allocated(), kMB + 8 * kKB);
+  allocator.Free(std::move(other.value()));
+
+  // The empty slab of the 1KB class is kept until another allocation needs room.
+  allocator.Free(std::move(small.value()));
+  ASSERT_EQ(backing.Allocated(), kMB);
+  auto large = allocator.Allocate(kMB + 256 * kKB);
+  ASSERT_TRUE(large.has_value());
+  ASSERT_EQ(backing.Allocated(), kMB + 256 * kKB);
+  for (const auto &stats : allocator.GetSizeClassStats()) {
+    ASSERT_EQ(stats.num_slabs, 0);
+  }
+  allocator.Free(std::move(large.value()));
+}
+
+TEST(SlabAllocatorTest, TestMaxObjectSizeIsSlabSize) {
+  // The size class that fits the largest objects rounds up to 1MB, past the slab.
+  const int64_t slab_size = 1000 * 1000;
+  DummyAllocator backing(4 * kMB);
+  SlabAllocator allocator(backing, slab_size, slab_size);
+  const auto stats = allocator.GetSizeClassStats();
+  ASSERT_EQ(stats.back().chunk_size, slab_size);
+
+  auto first = allocator.Allocate(slab_size);
+  ASSERT_TRUE(first.has_value());
+  auto second = allocator.Allocate(slab_size - 1);
+  ASSERT_TRUE(second.has_value());
+  ASSERT_EQ(backing.Allocated(), 2 * slab_size);
+  ASSERT_EQ(allocator.GetSizeClassStats().back().num_slabs, 2);
+  allocator.Free(std::move(first.value()));
+  allocator.Free(std::move(second.value()));
+  ASSERT_EQ(allocator.Allocated(), 0);
+}
+
+}  // namespace plasma
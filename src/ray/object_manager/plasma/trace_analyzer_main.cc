@@ -0,0 +1,59 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints the statistics of a plasma access trace written by the store when
+// plasma_access_trace_capacity and plasma_access_trace_path are set, and
+// replays it against stores of other capacities.
+
+#include <iostream>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "gflags/gflags.h"
+#include "ray/object_manager/plasma/object_access_trace_analyzer.h"
+
+DEFINE_string(trace_file, "", "The path of the plasma access trace.");
+DEFINE_string(capacities,
+              "",
+              "Comma-separated store capacities in bytes to replay the trace with.");
+
+int main(int argc, char *argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_trace_file.empty()) {
+    std::cerr << "--trace_file is required." << std::endl;
+    return 1;
+  }
+
+  std::vector<int64_t> capacities;
+  for (absl::string_view capacity_str :
+       absl::StrSplit(FLAGS_capacities, ',', absl::SkipEmpty())) {
+    int64_t capacity;
+    if (!absl::SimpleAtoi(capacity_str, &capacity) || capacity < 0) {
+      std::cerr << "Invalid capacity: " << capacity_str << std::endl;
+      return 1;
+    }
+    capacities.push_back(capacity);
+  }
+  gflags::ShutDownCommandLineFlags();
+
+  std::vector<plasma::ObjectAccessEvent> events;
+  auto status = plasma::ReadObjectAccessTraceFile(FLAGS_trace_file, &events);
+  if (!status.ok()) {
+    std::cerr << status.ToString() << std::endl;
+    return 1;
+  }
+  plasma::ObjectAccessTraceAnalyzer analyzer(std::move(events));
+  std::cout << analyzer.Report(capacities) << std::endl;
+  return 0;
+}
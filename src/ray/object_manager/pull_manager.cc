@@ -14,6 +14,8 @@
 
 #include "ray/object_manager/pull_manager.h"
 
+#include <algorithm>
+
 #include "ray/common/common_protocol.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/container_util.h"
@@ -83,16 +85,23 @@ uint64_t PullManager::Pull(const std::vector<rpc::ObjectReference> &object_ref_b
         bundle_pull_request.MarkObjectAsPullable(obj_id);
       }
     }
-    it->second.bundle_request_ids.insert(req_id);
+    const bool inserted = it->second.bundle_request_ids.insert(req_id).second;
+    if (inserted && prio == BundlePriority::PREFETCH) {
+      it->second.num_prefetch_bundle_requests++;
+    }
+    absl::MutexLock lock(&active_objects_mu_);
+    UpdateInactivePrefetchOnly(obj_id, it->second);
   }
 
   if (prio == BundlePriority::GET_REQUEST) {
     get_request_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
   } else if (prio == BundlePriority::WAIT_REQUEST) {
     wait_request_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
-  } else {
-    RAY_CHECK(prio == BundlePriority::TASK_ARGS);
+  } else if (prio == BundlePriority::TASK_ARGS) {
     task_argument_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
+  } else {
+    RAY_CHECK(prio == BundlePriority::PREFETCH);
+    prefetch_bundles_.AddBundlePullRequest(req_id, std::move(bundle_pull_request));
   }
 
   // We have a new request. Activate the new request, if the
@@ -159,6 +168,7 @@ bool PullManager::ActivateNextBundlePullRequest(BundlePullRequestQueue &bundles,
         RAY_LOG(DEBUG) << "Activating pull for object " << obj_id;
         auto &request = map_find_or_die(object_pull_requests_, obj_id);
         request.activate_time_ms = absl::GetCurrentTimeNanos() / 1e3;
+        UpdateInactivePrefetchOnly(obj_id, request);
 
         TryPinObject(obj_id);
         objects_to_pull->push_back(obj_id);
@@ -187,9 +197,10 @@ void PullManager::DeactivateBundlePullRequest(
     }
     if (it->second.empty()) {
       RAY_LOG(DEBUG) << "Deactivating pull for object " << obj_id;
-      num_bytes_being_pulled_ -=
-          map_find_or_die(object_pull_requests_, obj_id).object_size;
+      auto &object_request = map_find_or_die(object_pull_requests_, obj_id);
+      num_bytes_being_pulled_ -= object_request.object_size;
       active_object_pull_requests_.erase(obj_id);
+      UpdateInactivePrefetchOnly(obj_id, object_request);
       UnpinObject(obj_id);
       objects_to_cancel->insert(obj_id);
     }
@@ -199,6 +210,23 @@ void PullManager::DeactivateBundlePullRequest(
   num_active_bundles_ -= 1;
 }
 
+void PullManager::UpdateInactivePrefetchOnly(const ObjectID &object_id,
+                                             ObjectPullRequest &request) {
+  const bool inactive_prefetch_only =
+      request.num_prefetch_bundle_requests > 0 &&
+      request.num_prefetch_bundle_requests == request.bundle_request_ids.size() &&
+      active_object_pull_requests_.count(object_id) == 0;
+  if (inactive_prefetch_only == request.inactive_prefetch_only) {
+    return;
+  }
+  request.inactive_prefetch_only = inactive_prefetch_only;
+  if (inactive_prefetch_only) {
+    num_inactive_prefetch_only_objects_++;
+  } else {
+    num_inactive_prefetch_only_objects_--;
+  }
+}
+
 void PullManager::DeactivateUntilMarginAvailable(
     const std::string &debug_name,
     BundlePullRequestQueue &bundles,
@@ -225,6 +253,15 @@ int64_t PullManager::RemainingQuota() {
 
 bool PullManager::OverQuota() { return RemainingQuota() < 0L; }
 
+int64_t PullManager::RemainingPrefetchQuota() {
+  const double fraction = std::clamp(
+      static_cast<double>(RayConfig::instance().task_arg_prefetch_max_memory_fraction()),
+      0.0,
+      1.0);
+  const int64_t reserved = static_cast<int64_t>(num_bytes_available_ * (1 - fraction));
+  return RemainingQuota() - reserved;
+}
+
 void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available) {
   if (num_bytes_available_ != num_bytes_available) {
     RAY_LOG(DEBUG) << "Updating pulls based on available memory: " << num_bytes_available;
@@ -241,6 +278,11 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
   bool get_requests_remaining = !get_request_bundles_.inactive_requests.empty();
   while (get_requests_remaining) {
     const int64_t margin_required = NextRequestBundleSize(get_request_bundles_);
+    DeactivateUntilMarginAvailable("prefetch request",
+                                   prefetch_bundles_,
+                                   /*retain_min=*/0,
+                                   /*quota_margin=*/margin_required,
+                                   &object_ids_to_cancel);
     DeactivateUntilMarginAvailable("task args request",
                                    task_argument_bundles_,
                                    /*retain_min=*/0,
@@ -262,6 +304,11 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
   bool wait_requests_remaining = !wait_request_bundles_.inactive_requests.empty();
   while (wait_requests_remaining) {
     const int64_t margin_required = NextRequestBundleSize(wait_request_bundles_);
+    DeactivateUntilMarginAvailable("prefetch request",
+                                   prefetch_bundles_,
+                                   /*retain_min=*/0,
+                                   /*quota_margin=*/margin_required,
+                                   &object_ids_to_cancel);
     DeactivateUntilMarginAvailable("task args request",
                                    task_argument_bundles_,
                                    /*retain_min=*/0,
@@ -274,14 +321,37 @@ void PullManager::UpdatePullsBasedOnAvailableMemory(int64_t num_bytes_available)
                                                             &objects_to_pull);
   }
 
-  // Do the same but for task arg requests (lowest priority).
-  // allowed for task arg requests.
-  while (ActivateNextBundlePullRequest(task_argument_bundles_,
-                                       /*respect_quota=*/true,
-                                       &objects_to_pull)) {
+  // Do the same but for task arg requests.
+  bool task_args_requests_remaining = !task_argument_bundles_.inactive_requests.empty();
+  while (task_args_requests_remaining) {
+    const int64_t margin_required = NextRequestBundleSize(task_argument_bundles_);
+    DeactivateUntilMarginAvailable("prefetch request",
+                                   prefetch_bundles_,
+                                   /*retain_min=*/0,
+                                   /*quota_margin=*/margin_required,
+                                   &object_ids_to_cancel);
+
+    task_args_requests_remaining = ActivateNextBundlePullRequest(
+        task_argument_bundles_, /*respect_quota=*/true, &objects_to_pull);
+  }
+
+  // Prefetch requests (lowest priority) only use the spare capacity that is left
+  // once every other request has been activated. Unlike the other queues, we
+  // never force-activate a prefetch to guarantee progress.
+  while (!prefetch_bundles_.inactive_requests.empty() &&
+         NextRequestBundleSize(prefetch_bundles_) <= RemainingPrefetchQuota()) {
+    if (!ActivateNextBundlePullRequest(
+            prefetch_bundles_, /*respect_quota=*/false, &objects_to_pull)) {
+      break;
+    }
   }
 
   // While we are over capacity, deactivate requests starting from the back of the queues.
+  while (RemainingPrefetchQuota() < 0 && !prefetch_bundles_.active_requests.empty()) {
+    const uint64_t request_id = *(prefetch_bundles_.active_requests.rbegin());
+    RAY_LOG(DEBUG) << "Deactivating prefetch request " << request_id;
+    DeactivateBundlePullRequest(prefetch_bundles_, request_id, &object_ids_to_cancel);
+  }
   DeactivateUntilMarginAvailable("task args request",
                                  task_argument_bundles_,
                                  /*retain_min=*/1,
@@ -335,7 +405,14 @@ std::vector<ObjectID> PullManager::CancelPull(uint64_t request_id) {
     auto it = object_pull_requests_.find(obj_id);
     if (it != object_pull_requests_.end()) {
       RAY_LOG(DEBUG) << "Removing an object pull request of id: " << obj_id;
-      it->second.bundle_request_ids.erase(bundle_it->first);
+      const bool erased = it->second.bundle_request_ids.erase(bundle_it->first) > 0;
+      if (erased && &bundles == &prefetch_bundles_) {
+        it->second.num_prefetch_bundle_requests--;
+      }
+      {
+        absl::MutexLock lock(&active_objects_mu_);
+        UpdateInactivePrefetchOnly(obj_id, it->second);
+      }
       if (it->second.bundle_request_ids.empty()) {
         ray::stats::STATS_pull_manager_object_request_time_ms.Record(
             absl::GetCurrentTimeNanos() / 1e3 - it->second.request_start_time_ms,
@@ -640,9 +717,11 @@ const PullManager::BundlePullRequestQueue &PullManager::GetBundlePullRequestQueu
     return get_request_bundles_;
   } else if (wait_request_bundles_.requests.contains(request_id)) {
     return wait_request_bundles_;
-  } else {
-    RAY_CHECK(task_argument_bundles_.requests.contains(request_id));
+  } else if (task_argument_bundles_.requests.contains(request_id)) {
     return task_argument_bundles_;
+  } else {
+    RAY_CHECK(prefetch_bundles_.requests.contains(request_id));
+    return prefetch_bundles_;
   }
 }
 
@@ -662,7 +741,8 @@ bool PullManager::PullRequestActiveOrWaitingForMetadata(uint64_t request_id) con
 
 bool PullManager::HasPullsQueued() const {
   absl::MutexLock lock(&active_objects_mu_);
-  return active_object_pull_requests_.size() != object_pull_requests_.size();
+  return active_object_pull_requests_.size() + num_inactive_prefetch_only_objects_ !=
+         object_pull_requests_.size();
 }
 
 std::string PullManager::BundleInfo(const BundlePullRequestQueue &bundles) const {
@@ -730,6 +810,8 @@ void PullManager::RecordMetrics() const {
       wait_request_bundles_.requests.size(), "Wait");
   ray::stats::STATS_pull_manager_requested_bundles.Record(
       task_argument_bundles_.requests.size(), "TaskArgs");
+  ray::stats::STATS_pull_manager_requested_bundles.Record(
+      prefetch_bundles_.requests.size(), "Prefetch");
   ray::stats::STATS_pull_manager_requested_bundles.Record(next_req_id_,
                                                           "CumulativeTotal");
   ray::stats::STATS_pull_manager_requests.Record(object_pull_requests_.size(), "Queued");
@@ -756,6 +838,7 @@ std::string PullManager::DebugString() const {
   result << "\n- get request bundles: " << get_request_bundles_.DebugString();
   result << "\n- wait request bundles: " << wait_request_bundles_.DebugString();
   result << "\n- task request bundles: " << task_argument_bundles_.DebugString();
+  result << "\n- prefetch request bundles: " << prefetch_bundles_.DebugString();
   result << "\n- first get request bundle: " << BundleInfo(get_request_bundles_);
   result << "\n- first wait request bundle: " << BundleInfo(wait_request_bundles_);
   result << "\n- first task request bundle: " << BundleInfo(task_argument_bundles_);
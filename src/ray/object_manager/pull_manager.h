@@ -46,6 +46,9 @@ enum BundlePriority {
   WAIT_REQUEST,
   /// Bundle requested for fetching task arguments.
   TASK_ARGS,
+  /// Bundle requested ahead of time for the arguments of a task that is still
+  /// waiting to be scheduled. Only uses spare pull capacity.
+  PREFETCH,
 };
 
 // Not thread-safe except for IsObjectActive().
@@ -204,6 +207,10 @@ class PullManager {
     // object. This includes bundle requests whose objects are not actively
     // being pulled.
     absl::flat_hash_set<uint64_t> bundle_request_ids;
+    // How many of `bundle_request_ids` are prefetches.
+    size_t num_prefetch_bundle_requests = 0;
+    // Whether the object counts in num_inactive_prefetch_only_objects_.
+    bool inactive_prefetch_only = false;
 
     // An object is pullable if we know the size and it's not pending
     // creation due to object reconstruction.
@@ -410,6 +417,11 @@ class PullManager {
                                    uint64_t request_id,
                                    std::unordered_set<ObjectID> *objects_to_cancel);
 
+  /// Update whether the object counts in num_inactive_prefetch_only_objects_, after
+  /// the bundles that want it changed or it was (de)activated.
+  void UpdateInactivePrefetchOnly(const ObjectID &object_id, ObjectPullRequest &request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(active_objects_mu_);
+
   /// Helper method that deactivates requests from the given queue until the pull
   /// memory usage is within quota.
   ///
@@ -426,6 +438,11 @@ class PullManager {
   /// Return debug info about this bundle queue.
   std::string BundleInfo(const BundlePullRequestQueue &bundles) const;
 
+  /// Returns the number of bytes of quota that argument prefetches may still use.
+  /// Prefetches must leave (1 - task_arg_prefetch_max_memory_fraction) of the
+  /// available memory free for higher-priority pulls.
+  int64_t RemainingPrefetchQuota();
+
   /// Return the incremental space required to pull the next bundle, if available.
   /// If the next bundle is not ready for pulling, 0L will be returned.
   int64_t NextRequestBundleSize(const BundlePullRequestQueue &bundles) const;
@@ -464,6 +481,10 @@ class PullManager {
   BundlePullRequestQueue wait_request_bundles_;
   /// Bundle pull requests of arguments of queued tasks.
   BundlePullRequestQueue task_argument_bundles_;
+  /// Bundle pull requests of arguments of tasks that are not yet scheduled.
+  /// These are only activated with spare capacity and are deactivated before
+  /// any other bundle.
+  BundlePullRequestQueue prefetch_bundles_;
 
   /// The total number of bytes that we are currently pulling. This is the
   /// total size of the objects requested that we are actively pulling. To
@@ -496,6 +517,10 @@ class PullManager {
   absl::flat_hash_map<ObjectID, absl::flat_hash_set<uint64_t>>
       active_object_pull_requests_ ABSL_GUARDED_BY(active_objects_mu_);
 
+  /// The number of objects that are not active and only wanted by prefetches. They
+  /// don't count as queued pulls, since prefetches never wait for capacity.
+  size_t num_inactive_prefetch_only_objects_ ABSL_GUARDED_BY(active_objects_mu_) = 0;
+
   /// Tracks the objects we have pinned. Keys are subset of active_object_pull_requests_.
   /// We need to pin these objects so that parts of in-progress bundles aren't evicted
   /// due to self-induced memory pressure.
@@ -14,6 +14,9 @@
 
 #include "ray/object_manager/plasma/create_request_queue.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ray/common/status.h"
@@ -525,6 +528,232 @@ TEST_F(CreateRequestQueueTest, TestFallbackAllocationFailled) {
   AssertNoLeaks();
 }
 
+TEST_F(CreateRequestQueueTest, TestPriority) {
+  std::vector<int> order;
+  auto request = [&](int i) {
+    return [&order, i](bool fallback, PlasmaObject *result) {
+      result->data_size = 1234;
+      order.push_back(i);
+      return PlasmaError::OK;
+    };
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto req_id1 = queue_.AddRequest(ObjectID::Nil(), client, request(1), 1234);
+  auto req_id2 = queue_.AddRequest(ObjectID::Nil(), client, request(2), 1234, 1);
+  auto req_id3 = queue_.AddRequest(ObjectID::Nil(), client, request(3), 1234);
+  auto req_id4 = queue_.AddRequest(ObjectID::Nil(), client, request(4), 1234, 1);
+
+  // Higher priority first, then in order.
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_EQ(order, std::vector<int>({2, 4, 1, 3}));
+  ASSERT_REQUEST_FINISHED(queue_, req_id1, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue_, req_id2, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue_, req_id3, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue_, req_id4, PlasmaError::OK);
+  AssertNoLeaks();
+}
+
+TEST_F(CreateRequestQueueTest, TestSmallRequestsServedWhileSpilling) {
+  CreateRequestQueue queue(
+      monitor_,
+      /*oom_grace_period_s=*/oom_grace_period_s_,
+      /*spill_object_callback=*/[&]() { return true; },
+      /*on_global_gc=*/[&]() { num_global_gc_++; },
+      /*get_time=*/[&]() { return current_time_ns_; },
+      /*debug_dump_handler*/ nullptr,
+      /*small_request_max_size=*/1234);
+
+  int64_t available = 2000;
+  auto create = [&](int64_t size) {
+    return [&available, size](bool fallback, PlasmaObject *result) {
+      if (size > available) {
+        return PlasmaError::OutOfMemory;
+      }
+      available -= size;
+      result->data_size = 1234;
+      return PlasmaError::OK;
+    };
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto large_req_id = queue.AddRequest(ObjectID::Nil(), client, create(10000), 10000);
+  auto small_req_id1 = queue.AddRequest(ObjectID::Nil(), client, create(1234), 1234);
+  auto small_req_id2 = queue.AddRequest(ObjectID::Nil(), client, create(1234), 1234);
+  auto medium_req_id = queue.AddRequest(ObjectID::Nil(), client, create(1500), 1500);
+
+  // The first small request fits in the free memory, the second doesn't, and the
+  // medium one is over the size limit.
+  ASSERT_TRUE(queue.ProcessRequests().IsTransientObjectStoreFull());
+  ASSERT_REQUEST_FINISHED(queue, small_req_id1, PlasmaError::OK);
+  ASSERT_REQUEST_UNFINISHED(queue, large_req_id);
+  ASSERT_REQUEST_UNFINISHED(queue, small_req_id2);
+  ASSERT_REQUEST_UNFINISHED(queue, medium_req_id);
+
+  // Spilling made room for everything.
+  available = 20000;
+  ASSERT_TRUE(queue.ProcessRequests().ok());
+  ASSERT_REQUEST_FINISHED(queue, large_req_id, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue, small_req_id2, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue, medium_req_id, PlasmaError::OK);
+  ASSERT_EQ(queue.NumPendingRequests(), 0);
+}
+
+TEST_F(CreateRequestQueueTest, TestSmallRequestsAheadOfHeadAreBounded) {
+  CreateRequestQueue queue(
+      monitor_,
+      /*oom_grace_period_s=*/oom_grace_period_s_,
+      /*spill_object_callback=*/[&]() { return true; },
+      /*on_global_gc=*/[&]() { num_global_gc_++; },
+      /*get_time=*/[&]() { return current_time_ns_; },
+      /*debug_dump_handler*/ nullptr,
+      /*small_request_max_size=*/1000);
+
+  // The small requests always fit, and the large one once it's spilled for.
+  bool spilled = false;
+  auto create = [&](int64_t size) {
+    return [&spilled, size](bool fallback, PlasmaObject *result) {
+      if (size > 1000 && !spilled) {
+        return PlasmaError::OutOfMemory;
+      }
+      result->data_size = 1234;
+      return PlasmaError::OK;
+    };
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto large_req_id = queue.AddRequest(ObjectID::Nil(), client, create(3000), 3000);
+  std::vector<uint64_t> small_req_ids;
+  for (int i = 0; i < 5; i++) {
+    small_req_ids.push_back(
+        queue.AddRequest(ObjectID::Nil(), client, create(1000), 1000));
+  }
+
+  // The small requests go ahead of the large one up to its size in total.
+  ASSERT_TRUE(queue.ProcessRequests().IsTransientObjectStoreFull());
+  ASSERT_TRUE(queue.ProcessRequests().IsTransientObjectStoreFull());
+  for (int i = 0; i < 3; i++) {
+    ASSERT_REQUEST_FINISHED(queue, small_req_ids[i], PlasmaError::OK);
+  }
+  ASSERT_REQUEST_UNFINISHED(queue, small_req_ids[3]);
+  ASSERT_REQUEST_UNFINISHED(queue, small_req_ids[4]);
+
+  // The rest follow the large request.
+  spilled = true;
+  ASSERT_TRUE(queue.ProcessRequests().ok());
+  ASSERT_REQUEST_FINISHED(queue, large_req_id, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue, small_req_ids[3], PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue, small_req_ids[4], PlasmaError::OK);
+  ASSERT_EQ(queue.NumPendingRequests(), 0);
+}
+
+TEST_F(CreateRequestQueueTest, TestOomTimerRestartsWhenHeadChanges) {
+  int num_fallbacks = 0;
+  auto oom_request = [&](bool fallback, PlasmaObject *result) {
+    if (fallback) {
+      result->data_size = 1234;
+      num_fallbacks += 1;
+      return PlasmaError::OK;
+    }
+    return PlasmaError::OutOfMemory;
+  };
+
+  auto client = std::make_shared<MockClient>();
+  auto req_id1 = queue_.AddRequest(ObjectID::Nil(), client, oom_request, 1234);
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+
+  // A request of a higher priority takes the head near the end of the grace period of
+  // the first one.
+  current_time_ns_ += oom_grace_period_s_ * 0.9e9;
+  auto req_id2 = queue_.AddRequest(ObjectID::Nil(), client, oom_request, 1234, 1);
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+
+  // It gets a grace period of its own.
+  current_time_ns_ += oom_grace_period_s_ * 0.5e9;
+  ASSERT_TRUE(queue_.ProcessRequests().IsObjectStoreFull());
+  ASSERT_EQ(num_fallbacks, 0);
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id1);
+  ASSERT_REQUEST_UNFINISHED(queue_, req_id2);
+
+  // Once it's over, both requests fall back, since the store is still full.
+  current_time_ns_ += oom_grace_period_s_ * 0.5e9;
+  ASSERT_TRUE(queue_.ProcessRequests().ok());
+  ASSERT_EQ(num_fallbacks, 2);
+  ASSERT_REQUEST_FINISHED(queue_, req_id1, PlasmaError::OK);
+  ASSERT_REQUEST_FINISHED(queue_, req_id2, PlasmaError::OK);
+  AssertNoLeaks();
+}
+
+/// Simulate a full store that spills a fixed number of bytes per tick, while a
+/// client creates a large object and then small objects at every tick.
+struct MemoryPressureSimulation {
+  /// Wait of the slowest small request, in ticks.
+  int64_t max_small_wait_ticks = 0;
+  /// Wait of the large request, in ticks.
+  int64_t large_wait_ticks = -1;
+
+  explicit MemoryPressureSimulation(size_t small_request_max_size) {
+    const int64_t kCapacity = 1000;
+    const int64_t kSpilledPerTick = 50;
+    const int64_t kLargeSize = 500;
+    const int64_t kSmallSize = 10;
+    const int kNumTicks = 100;
+
+    int64_t tick = 0;
+    int64_t used = 950;
+    ray::FileSystemMonitor monitor{{"/"}, 1};
+    CreateRequestQueue queue(
+        monitor,
+        /*oom_grace_period_s=*/1000,
+        /*spill_object_callback=*/[&]() { return used > 0; },
+        /*on_global_gc=*/[]() {},
+        /*get_time=*/[&]() { return tick; },
+        /*debug_dump_handler*/ nullptr,
+        small_request_max_size);
+
+    auto create = [&](int64_t size, int64_t created_tick, bool large) {
+      return [&, size, created_tick, large](bool fallback, PlasmaObject *result) {
+        if (used + size > kCapacity) {
+          return PlasmaError::OutOfMemory;
+        }
+        used += size;
+        int64_t wait = tick - created_tick;
+        if (large) {
+          large_wait_ticks = wait;
+        } else {
+          max_small_wait_ticks = std::max(max_small_wait_ticks, wait);
+        }
+        return PlasmaError::OK;
+      };
+    };
+
+    auto client = std::make_shared<MockClient>();
+    static_cast<void>(queue.AddRequest(
+        ObjectID::Nil(), client, create(kLargeSize, 0, true), kLargeSize));
+    for (; tick < kNumTicks; tick++) {
+      static_cast<void>(queue.AddRequest(
+          ObjectID::Nil(), client, create(kSmallSize, tick, false), kSmallSize));
+      static_cast<void>(queue.ProcessRequests());
+      used = std::max<int64_t>(0, used - kSpilledPerTick);
+    }
+    EXPECT_EQ(queue.NumPendingRequests(), 0u);
+  }
+};
+
+TEST(CreateRequestQueueParameterTest, TestSmallRequestsUnderMemoryPressure) {
+  MemoryPressureSimulation in_order(/*small_request_max_size=*/0);
+  MemoryPressureSimulation small_first(/*small_request_max_size=*/100);
+
+  // In order, the small requests wait for the large one to be spilled for.
+  ASSERT_GT(in_order.large_wait_ticks, 5);
+  ASSERT_GE(in_order.max_small_wait_ticks, in_order.large_wait_ticks);
+  // Served from the free memory, they don't wait.
+  ASSERT_EQ(small_first.max_small_wait_ticks, 0);
+  // The large request waits a bit longer, for the memory the small ones took.
+  ASSERT_GE(small_first.large_wait_ticks, in_order.large_wait_ticks);
+  ASSERT_LT(small_first.large_wait_ticks, 2 * in_order.large_wait_ticks);
+}
+
 }  // namespace plasma
 
 int main(int argc, char **argv) {
@@ -60,10 +60,12 @@ class PullManagerTestWithCapacity {
     ASSERT_TRUE(pull_manager_.get_request_bundles_.Empty());
     ASSERT_TRUE(pull_manager_.wait_request_bundles_.Empty());
     ASSERT_TRUE(pull_manager_.task_argument_bundles_.Empty());
+    ASSERT_TRUE(pull_manager_.prefetch_bundles_.Empty());
     ASSERT_EQ(pull_manager_.num_active_bundles_, 0);
     ASSERT_TRUE(pull_manager_.object_pull_requests_.empty());
     absl::MutexLock lock(&pull_manager_.active_objects_mu_);
     ASSERT_TRUE(pull_manager_.active_object_pull_requests_.empty());
+    ASSERT_EQ(pull_manager_.num_inactive_prefetch_only_objects_, 0);
     ASSERT_TRUE(pull_manager_.pinned_objects_.empty());
     ASSERT_EQ(pull_manager_.pinned_objects_size_, 0);
     // Most tests should not timeout any pull requests.
@@ -1186,6 +1188,76 @@ TEST_F(PullManagerWithAdmissionControlTest, TestPrioritizeWorkerRequests) {
   AssertNoLeaks();
 }
 
+TEST_F(PullManagerWithAdmissionControlTest, TestPrefetchUsesSpareCapacity) {
+  /// Test that prefetch requests only use their share of the spare capacity and
+  /// are deactivated before any other request.
+  RayConfig::instance().task_arg_prefetch_max_memory_fraction() = 0.5;
+  int object_size = 2;
+  std::unordered_set<NodeID> client_ids;
+  client_ids.insert(NodeID::FromRandom());
+
+  // Submit three prefetch requests. Half of the capacity (5 bytes) is enough for
+  // only two of them.
+  std::vector<rpc::ObjectReference> objects_to_locate;
+  std::vector<uint64_t> prefetch_req_ids;
+  std::vector<ObjectID> prefetch_oids;
+  for (int i = 0; i < 3; i++) {
+    auto refs = CreateObjectRefs(1);
+    prefetch_req_ids.push_back(pull_manager_.Pull(
+        refs, BundlePriority::PREFETCH, {"", false}, &objects_to_locate));
+    prefetch_oids.push_back(ObjectRefsToIds(refs)[0]);
+    pull_manager_.OnLocationChange(
+        prefetch_oids.back(), client_ids, "", NodeID::Nil(), false, object_size);
+  }
+  AssertNumActiveBundlesEquals(2);
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[1]));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[2]));
+  // Inactive prefetches don't count as queued pulls.
+  ASSERT_FALSE(pull_manager_.HasPullsQueued());
+
+  // A task args request comes in. The prefetches are deactivated to make room
+  // for it, even though they were submitted first.
+  auto refs = CreateObjectRefs(1);
+  auto task_req_id = pull_manager_.Pull(
+      refs, BundlePriority::TASK_ARGS, {"", false}, &objects_to_locate);
+  auto task_oid = ObjectRefsToIds(refs)[0];
+  pull_manager_.OnLocationChange(task_oid, client_ids, "", NodeID::Nil(), false, 8);
+  AssertNumActiveBundlesEquals(1);
+  ASSERT_TRUE(pull_manager_.IsObjectActive(task_oid));
+  for (const auto &oid : prefetch_oids) {
+    ASSERT_FALSE(pull_manager_.IsObjectActive(oid));
+  }
+  ASSERT_FALSE(pull_manager_.HasPullsQueued());
+
+  // An inactive object counts as queued once a task args request also wants it.
+  auto other_refs = CreateObjectRefs(1);
+  auto other_prefetch_req_id = pull_manager_.Pull(
+      other_refs, BundlePriority::PREFETCH, {"", false}, &objects_to_locate);
+  ASSERT_FALSE(pull_manager_.HasPullsQueued());
+  auto other_task_req_id = pull_manager_.Pull(
+      other_refs, BundlePriority::TASK_ARGS, {"", false}, &objects_to_locate);
+  ASSERT_TRUE(pull_manager_.HasPullsQueued());
+  pull_manager_.CancelPull(other_task_req_id);
+  ASSERT_FALSE(pull_manager_.HasPullsQueued());
+  pull_manager_.CancelPull(other_prefetch_req_id);
+
+  // The prefetches resume once the task args request is canceled.
+  pull_manager_.CancelPull(task_req_id);
+  AssertNumActiveBundlesEquals(2);
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[0]));
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[1]));
+  ASSERT_FALSE(pull_manager_.IsObjectActive(prefetch_oids[2]));
+
+  pull_manager_.CancelPull(prefetch_req_ids[0]);
+  ASSERT_TRUE(pull_manager_.IsObjectActive(prefetch_oids[2]));
+  for (size_t i = 1; i < prefetch_req_ids.size(); i++) {
+    pull_manager_.CancelPull(prefetch_req_ids[i]);
+  }
+  RayConfig::instance().task_arg_prefetch_max_memory_fraction() = 0.2;
+  AssertNoLeaks();
+}
+
 TEST_P(PullManagerTest, TestTimeOut) {
   BundlePriority prio = GetParam();
   auto refs = CreateObjectRefs(1);
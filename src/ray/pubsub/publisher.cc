@@ -14,7 +14,9 @@
 
 #include "ray/pubsub/publisher.h"
 
+#include "google/protobuf/unknown_field_set.h"
 #include "ray/common/ray_config.h"
+#include "ray/stats/metric_defs.h"
 
 namespace ray {
 
@@ -22,12 +24,16 @@ namespace pubsub {
 
 namespace pub_internal {
 
-bool EntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
+bool EntityState::Publish(std::shared_ptr<rpc::PubMessage> msg,
+                          std::shared_ptr<std::string> serialized_message) {
   if (subscribers_.empty()) {
     return false;
   }
 
-  const int64_t message_size = msg->ByteSizeLong();
+  const int64_t message_size =
+      serialized_message ? serialized_message->size() : msg->ByteSizeLong();
+  // A message serialized once is buffered twice, as the message and as its bytes.
+  const int64_t buffered_size = serialized_message ? 2 * message_size : message_size;
 
   if (message_size > max_message_size_bytes_) {
     RAY_LOG_EVERY_N_OR_DEBUG(WARNING, 10000)
@@ -50,7 +56,7 @@ bool EntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
       // The message has no other reference.
       // This means that it has been published to all subscribers.
     } else if (max_buffered_bytes_ > 0 &&
-               total_size_ + message_size > max_buffered_bytes_) {
+               total_size_ + buffered_size > max_buffered_bytes_) {
       RAY_LOG_EVERY_N_OR_DEBUG(WARNING, 10000)
           << "Pub/sub message is dropped to stay under the maximum configured buffer "
              "size="
@@ -67,6 +73,11 @@ bool EntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
       // threaded. NOTE: calling Clear() does not release memory from the underlying
       // protobuf message object.
       *front_msg = rpc::PubMessage();
+      // The serialized bytes are shared by the mailboxes too, so they're released
+      // here rather than when the last subscriber pops the message.
+      if (auto front_serialized = pending_serialized_messages_.front().lock()) {
+        std::string().swap(*front_serialized);
+      }
     } else {
       // No message to drop.
       break;
@@ -76,16 +87,18 @@ bool EntityState::Publish(std::shared_ptr<rpc::PubMessage> msg) {
     // it has been dropped due to memory cap. Subtract it from memory
     // accounting.
     pending_messages_.pop();
+    pending_serialized_messages_.pop();
     total_size_ -= message_sizes_.front();
     message_sizes_.pop();
   }
 
   pending_messages_.push(msg);
-  total_size_ += message_size;
-  message_sizes_.push(message_size);
+  pending_serialized_messages_.push(serialized_message);
+  total_size_ += buffered_size;
+  message_sizes_.push(buffered_size);
 
   for (auto &[id, subscriber] : subscribers_) {
-    subscriber->QueueMessage(msg);
+    subscriber->QueueMessage(msg, /*try_publish=*/true, serialized_message);
   }
   return true;
 }
@@ -105,7 +118,15 @@ const absl::flat_hash_map<SubscriberID, SubscriberState *> &EntityState::Subscri
 
 SubscriptionIndex::SubscriptionIndex(rpc::ChannelType channel_type)
     : channel_type_(channel_type),
-      subscribers_to_all_(CreateEntityState(channel_type_)) {}
+      coalesce_messages_(false),
+      subscribers_to_all_(CreateEntityState(channel_type_)) {
+  for (const auto &channel_name :
+       RayConfig::instance().publisher_coalesced_channels()) {
+    if (channel_name == rpc::ChannelType_Name(channel_type_)) {
+      coalesce_messages_ = true;
+    }
+  }
+}
 
 int64_t SubscriptionIndex::GetNumBufferedBytes() const {
   // TODO(swang): Some messages may get published to both subscribers listening
@@ -120,15 +141,56 @@ int64_t SubscriptionIndex::GetNumBufferedBytes() const {
 }
 
 bool SubscriptionIndex::Publish(std::shared_ptr<rpc::PubMessage> pub_message) {
-  const bool publish_to_all = subscribers_to_all_->Publish(pub_message);
-  bool publish_to_entity = false;
   auto it = entities_.find(pub_message->key_id());
+  std::shared_ptr<std::string> serialized_message;
+  if (RayConfig::instance().publisher_serialize_messages_once() &&
+      (subscribers_to_all_->HasSubscribers() ||
+       (it != entities_.end() && it->second->HasSubscribers()))) {
+    serialized_message = std::make_shared<std::string>(pub_message->SerializeAsString());
+  }
+  const bool publish_to_all =
+      subscribers_to_all_->Publish(pub_message, serialized_message);
+  bool publish_to_entity = false;
   if (it != entities_.end()) {
-    publish_to_entity = it->second->Publish(pub_message);
+    publish_to_entity = it->second->Publish(pub_message, serialized_message);
+  }
+  if (coalesce_messages_ && (publish_to_all || publish_to_entity)) {
+    CoalescePendingMessage(pub_message, serialized_message);
   }
   return publish_to_all || publish_to_entity;
 }
 
+void SubscriptionIndex::CoalescePendingMessage(
+    const std::shared_ptr<rpc::PubMessage> &pub_message,
+    const std::shared_ptr<std::string> &serialized_message) {
+  auto &pending_message = pending_message_by_key_id_[pub_message->key_id()];
+  auto previous_message = pending_message.message.lock();
+  if (previous_message != nullptr &&
+      previous_message->inner_message_case() != rpc::PubMessage::INNER_MESSAGE_NOT_SET) {
+    // All the subscribers which still hold the previous message have just got the new
+    // one queued after it. Clearing the shared message makes them skip it, the same
+    // way as the messages dropped because of the buffer limit.
+    *previous_message = rpc::PubMessage();
+    // Its serialized bytes are shared by the mailboxes too, so release them now.
+    if (auto previous_serialized = pending_message.serialized_message.lock()) {
+      std::string().swap(*previous_serialized);
+    }
+    ++num_coalesced_messages_;
+    ray::stats::STATS_pubsub_coalesced_messages.Record(
+        1, rpc::ChannelType_Name(channel_type_));
+  }
+  pending_message = PendingMessage{pub_message, serialized_message};
+
+  // Keys of the messages that have been acknowledged by all the subscribers are no
+  // longer needed. Remove them once the map has doubled in size, so the cost is
+  // amortized over the publishes.
+  if (pending_message_by_key_id_.size() > 2 * num_pending_keys_after_cleanup_) {
+    absl::erase_if(pending_message_by_key_id_,
+                   [](const auto &entry) { return entry.second.message.expired(); });
+    num_pending_keys_after_cleanup_ = pending_message_by_key_id_.size();
+  }
+}
+
 bool SubscriptionIndex::AddEntry(const std::string &key_id, SubscriberState *subscriber) {
   if (key_id.empty()) {
     return subscribers_to_all_->AddSubscriber(subscriber);
@@ -277,19 +339,7 @@ std::unique_ptr<EntityState> SubscriptionIndex::CreateEntityState(
 void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request,
                                           rpc::PubsubLongPollingReply *reply,
                                           rpc::SendReplyCallback send_reply_callback) {
-  int64_t max_processed_sequence_id = request.max_processed_sequence_id();
-  if (request.publisher_id().empty() ||
-      publisher_id_ != PublisherID::FromBinary(request.publisher_id())) {
-    // in case the publisher_id mismatches, we should ignore the
-    // max_processed_sequence_id.
-    max_processed_sequence_id = 0;
-  }
-
-  // clean up messages that have already been processed.
-  while (!mailbox_.empty() &&
-         mailbox_.front()->sequence_id() <= max_processed_sequence_id) {
-    mailbox_.pop_front();
-  }
+  AcknowledgeMessages(request);
 
   if (long_polling_connection_) {
     // Because of the new long polling request, flush the current polling request with an
@@ -305,16 +355,80 @@ void SubscriberState::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &r
   PublishIfPossible();
 }
 
-void SubscriberState::QueueMessage(const std::shared_ptr<rpc::PubMessage> &pub_message,
-                                   bool try_publish) {
+void SubscriberState::ConnectToStream(const rpc::PubsubLongPollingRequest &request,
+                                      SubscriberStream *stream) {
+  RAY_CHECK(stream != nullptr);
+  if (stream_ != stream) {
+    if (stream_ != nullptr) {
+      // The subscriber has reconnected, so the old stream is stale.
+      stream_->Close();
+    }
+    stream_ = stream;
+    stream_write_in_flight_ = false;
+    num_streamed_messages_ = 0;
+  }
+  AcknowledgeMessages(request);
+  last_connection_update_time_ms_ = get_time_ms_();
+  PublishToStreamIfPossible();
+}
+
+void SubscriberState::HandleStreamWriteDone(SubscriberStream *stream, bool ok) {
+  if (stream_ != stream) {
+    return;
+  }
+  stream_write_in_flight_ = false;
+  if (!ok) {
+    stream_->Close();
+    DisconnectStream(stream);
+    return;
+  }
+  PublishToStreamIfPossible();
+}
+
+void SubscriberState::DisconnectStream(SubscriberStream *stream) {
+  if (stream_ != stream) {
+    return;
+  }
+  stream_ = nullptr;
+  stream_write_in_flight_ = false;
+  num_streamed_messages_ = 0;
+  last_connection_update_time_ms_ = get_time_ms_();
+}
+
+void SubscriberState::AcknowledgeMessages(const rpc::PubsubLongPollingRequest &request) {
+  int64_t max_processed_sequence_id = request.max_processed_sequence_id();
+  if (request.publisher_id().empty() ||
+      publisher_id_ != PublisherID::FromBinary(request.publisher_id())) {
+    // in case the publisher_id mismatches, we should ignore the
+    // max_processed_sequence_id.
+    max_processed_sequence_id = 0;
+  }
+
+  // clean up messages that have already been processed.
+  while (!mailbox_.empty() &&
+         mailbox_.front().message->sequence_id() <= max_processed_sequence_id) {
+    mailbox_.pop_front();
+    if (num_streamed_messages_ > 0) {
+      --num_streamed_messages_;
+    }
+  }
+}
+
+void SubscriberState::QueueMessage(
+    const std::shared_ptr<rpc::PubMessage> &pub_message,
+    bool try_publish,
+    std::shared_ptr<std::string> serialized_message) {
   RAY_LOG(DEBUG) << "enqueue: " << pub_message->sequence_id();
-  mailbox_.push_back(pub_message);
+  mailbox_.push_back(QueuedMessage{pub_message, std::move(serialized_message)});
   if (try_publish) {
     PublishIfPossible();
   }
 }
 
 bool SubscriberState::PublishIfPossible(bool force_noop) {
+  if (stream_ != nullptr && !force_noop) {
+    return PublishToStreamIfPossible();
+  }
   if (!long_polling_connection_) {
     return false;
   }
@@ -325,30 +439,8 @@ bool SubscriberState::PublishIfPossible(bool force_noop) {
   // No message should have been added to the reply.
   RAY_CHECK(long_polling_connection_->reply->pub_messages().empty());
   *long_polling_connection_->reply->mutable_publisher_id() = publisher_id_.Binary();
-  int64_t num_total_bytes = 0;
   if (!force_noop) {
-    for (auto it = mailbox_.begin(); it != mailbox_.end(); it++) {
-      if (long_polling_connection_->reply->pub_messages().size() >= publish_batch_size_) {
-        break;
-      }
-
-      const rpc::PubMessage &msg = **it;
-
-      int64_t msg_size_bytes = msg.ByteSizeLong();
-      if (num_total_bytes > 0 && num_total_bytes + msg_size_bytes >
-                                     RayConfig::instance().max_grpc_message_size()) {
-        // Adding this message to the batch would put us over the serialization
-        // size threshold.
-        break;
-      }
-      num_total_bytes += msg_size_bytes;
-
-      // Avoid sending empty message to the subscriber. The message might have been
-      // cleared because the subscribed entity's buffer was full.
-      if (msg.inner_message_case() != rpc::PubMessage::INNER_MESSAGE_NOT_SET) {
-        *long_polling_connection_->reply->add_pub_messages() = msg;
-      }
-    }
+    AddMessagesToReply(0, long_polling_connection_->reply);
   }
 
   RAY_LOG(DEBUG) << "sending reply back"
@@ -362,6 +454,66 @@ bool SubscriberState::PublishIfPossible(bool force_noop) {
   return true;
 }
 
+bool SubscriberState::PublishToStreamIfPossible() {
+  if (stream_write_in_flight_ || num_streamed_messages_ >= mailbox_.size()) {
+    return false;
+  }
+  rpc::PubsubLongPollingReply reply;
+  *reply.mutable_publisher_id() = publisher_id_.Binary();
+  num_streamed_messages_ += AddMessagesToReply(num_streamed_messages_, &reply);
+
+  stream_write_in_flight_ = true;
+  last_connection_update_time_ms_ = get_time_ms_();
+  stream_->Write(std::move(reply));
+  return true;
+}
+
+size_t SubscriberState::AddMessagesToReply(size_t begin,
+                                           rpc::PubsubLongPollingReply *reply) const {
+  int64_t num_total_bytes = 0;
+  int64_t num_messages = 0;
+  bool add_as_unknown_fields = false;
+  size_t i = begin;
+  for (; i < mailbox_.size(); i++) {
+    if (num_messages >= publish_batch_size_) {
+      break;
+    }
+
+    const rpc::PubMessage &msg = *mailbox_[i].message;
+    const auto &serialized_message = mailbox_[i].serialized_message;
+
+    int64_t msg_size_bytes =
+        serialized_message ? serialized_message->size() : msg.ByteSizeLong();
+    if (num_total_bytes > 0 && num_total_bytes + msg_size_bytes >
+                                   RayConfig::instance().max_grpc_message_size()) {
+      // Adding this message to the batch would put us over the serialization
+      // size threshold.
+      break;
+    }
+    num_total_bytes += msg_size_bytes;
+
+    // Avoid sending empty message to the subscriber. The message might have been
+    // cleared because the subscribed entity's buffer was full.
+    if (msg.inner_message_case() == rpc::PubMessage::INNER_MESSAGE_NOT_SET) {
+      continue;
+    }
+    if (serialized_message || add_as_unknown_fields) {
+      // A length delimited unknown field has the same wire format as an element of
+      // `pub_messages`, so the subscriber parses it as a regular message. Unknown
+      // fields are serialized after `pub_messages`, so once a message is added as one,
+      // the following messages must be too, to keep them in order.
+      reply->GetReflection()->MutableUnknownFields(reply)->AddLengthDelimited(
+          rpc::PubsubLongPollingReply::kPubMessagesFieldNumber,
+          serialized_message ? *serialized_message : msg.SerializeAsString());
+      add_as_unknown_fields = true;
+    } else {
+      *reply->add_pub_messages() = msg;
+    }
+    ++num_messages;
+  }
+  return i - begin;
+}
+
 bool SubscriberState::CheckNoLeaks() const {
   // If all message in the mailbox has been replied, consider there is no leak.
   return mailbox_.empty();
@@ -372,6 +524,10 @@ bool SubscriberState::ConnectionExists() const {
 }
 
 bool SubscriberState::IsActive() const {
+  // The stream breaks if the subscriber dies, so it's active while it's open.
+  if (stream_ != nullptr && !stream_->IsFinished()) {
+    return true;
+  }
   return get_time_ms_() - last_connection_update_time_ms_ < connection_timeout_ms_;
 }
 
@@ -387,6 +543,40 @@ void Publisher::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request
   RAY_LOG(DEBUG) << "Long polling connection initiated by " << subscriber_id.Hex()
                  << ", publisher_id " << publisher_id_.Hex();
   absl::MutexLock lock(&mutex_);
+  // May flush the current long poll with an empty message, if a poll request exists.
+  GetOrCreateSubscriber(subscriber_id)
+      ->ConnectToSubscriber(request, reply, std::move(send_reply_callback));
+}
+
+void Publisher::HandleStreamRequest(const rpc::PubsubLongPollingRequest &request,
+                                    pub_internal::SubscriberStream *stream) {
+  const auto subscriber_id = SubscriberID::FromBinary(request.subscriber_id());
+  absl::MutexLock lock(&mutex_);
+  GetOrCreateSubscriber(subscriber_id)->ConnectToStream(request, stream);
+}
+
+void Publisher::HandleStreamWriteDone(const SubscriberID &subscriber_id,
+                                      pub_internal::SubscriberStream *stream,
+                                      bool ok) {
+  absl::MutexLock lock(&mutex_);
+  auto it = subscribers_.find(subscriber_id);
+  if (it != subscribers_.end()) {
+    it->second->HandleStreamWriteDone(stream, ok);
+  }
+}
+
+void Publisher::DisconnectStream(const SubscriberID &subscriber_id,
+                                 pub_internal::SubscriberStream *stream) {
+  RAY_LOG(DEBUG) << "Pubsub stream of " << subscriber_id.Hex() << " is disconnected.";
+  absl::MutexLock lock(&mutex_);
+  auto it = subscribers_.find(subscriber_id);
+  if (it != subscribers_.end()) {
+    it->second->DisconnectStream(stream);
+  }
+}
+
+pub_internal::SubscriberState *Publisher::GetOrCreateSubscriber(
+    const SubscriberID &subscriber_id) {
   auto it = subscribers_.find(subscriber_id);
   if (it == subscribers_.end()) {
     it = subscribers_
@@ -399,29 +589,14 @@ void Publisher::ConnectToSubscriber(const rpc::PubsubLongPollingRequest &request
                                                                  publisher_id_))
              .first;
   }
-  auto &subscriber = it->second;
-
-  // May flush the current long poll with an empty message, if a poll request exists.
-  subscriber->ConnectToSubscriber(request, reply, std::move(send_reply_callback));
+  return it->second.get();
 }
 
 bool Publisher::RegisterSubscription(const rpc::ChannelType channel_type,
                                      const SubscriberID &subscriber_id,
                                      const std::optional<std::string> &key_id) {
   absl::MutexLock lock(&mutex_);
-  auto it = subscribers_.find(subscriber_id);
-  if (it == subscribers_.end()) {
-    it = subscribers_
-             .emplace(
-                 subscriber_id,
-                 std::make_unique<pub_internal::SubscriberState>(subscriber_id,
-                                                                 get_time_ms_,
-                                                                 subscriber_timeout_ms_,
-                                                                 publish_batch_size_,
-                                                                 publisher_id_))
-             .first;
-  }
-  pub_internal::SubscriberState *subscriber = it->second.get();
+  pub_internal::SubscriberState *subscriber = GetOrCreateSubscriber(subscriber_id);
   auto subscription_index_it = subscription_index_map_.find(channel_type);
   RAY_CHECK(subscription_index_it != subscription_index_map_.end());
   return subscription_index_it->second.AddEntry(key_id.value_or(""), subscriber);
@@ -558,6 +733,8 @@ std::string Publisher::DebugString() const {
     auto index_it = subscription_index_map_.find(channel_type);
     if (index_it != subscription_index_map_.end()) {
       result << "\n- current buffered bytes: " << index_it->second.GetNumBufferedBytes();
+      result << "\n- cumulative coalesced messages: "
+             << index_it->second.GetNumCoalescedMessages();
     }
   }
   return result.str();
@@ -51,7 +51,14 @@ class EntityState {
 
   /// Publishes the message to subscribers of the entity.
   /// Returns true if there are subscribers, returns false otherwise.
-  bool Publish(std::shared_ptr<rpc::PubMessage> pub_message);
+  ///
+  /// \param serialized_message If not null, the serialized `pub_message`, which is
+  /// sent to the subscribers as is.
+  bool Publish(std::shared_ptr<rpc::PubMessage> pub_message,
+               std::shared_ptr<std::string> serialized_message = nullptr);
+
+  /// Returns true if the entity has any subscriber.
+  bool HasSubscribers() const { return !subscribers_.empty(); }
 
   /// Manages the set of subscribers of this entity.
   bool AddSubscriber(SubscriberState *subscriber);
@@ -72,6 +79,9 @@ class EntityState {
   // individual subscribers, and get deleted after no subscriber has
   // the message in buffer.
   std::queue<std::weak_ptr<rpc::PubMessage>> pending_messages_;
+  // The serialized bytes of each inflight message, if it was serialized once for all
+  // subscribers, or an empty pointer.
+  std::queue<std::weak_ptr<std::string>> pending_serialized_messages_;
   // Size of each inflight message.
   std::queue<int64_t> message_sizes_;
   // Protobuf messages fail to serialize if 2GB or larger. Cap published
@@ -96,7 +106,9 @@ class SubscriptionIndex {
   SubscriptionIndex(SubscriptionIndex &&) noexcept = default;
   SubscriptionIndex &operator=(SubscriptionIndex &&) noexcept = default;
 
-  /// Publishes the message to relevant subscribers.
+  /// Publishes the message to relevant subscribers. If
+  /// `publisher_serialize_messages_once` is enabled, the message is serialized here
+  /// once for all the subscribers.
   /// Returns true if there are subscribers listening on the entity key of the message,
   /// returns false otherwise.
   bool Publish(std::shared_ptr<rpc::PubMessage> pub_message);
@@ -130,14 +142,43 @@ class SubscriptionIndex {
 
   int64_t GetNumBufferedBytes() const;
 
+  /// Returns the number of messages dropped because a newer message of the same key
+  /// was published before they were acknowledged.
+  uint64_t GetNumCoalescedMessages() const { return num_coalesced_messages_; }
+
   /// Returns true if there's no metadata remained in the private attribute.
   bool CheckNoLeaks() const;
 
  private:
   static std::unique_ptr<EntityState> CreateEntityState(rpc::ChannelType channel_type);
 
+  /// Drop the pending message of the same key as `pub_message`, and track
+  /// `pub_message` as the pending message of the key instead.
+  ///
+  /// \param pub_message The message just published.
+  /// \param serialized_message The serialized `pub_message`, if it was serialized
+  /// once for all subscribers.
+  void CoalescePendingMessage(const std::shared_ptr<rpc::PubMessage> &pub_message,
+                              const std::shared_ptr<std::string> &serialized_message);
+
+  /// A message that may still be coalesced, and its serialized bytes if any.
+  struct PendingMessage {
+    std::weak_ptr<rpc::PubMessage> message;
+    std::weak_ptr<std::string> serialized_message;
+  };
+
   // Type of channel this index is for.
   rpc::ChannelType channel_type_;
+  // Whether only the latest message of each key is delivered.
+  bool coalesce_messages_;
+  // Mapping from key id -> the latest message published for the key. The messages
+  // are owned by the mailboxes of the subscribers. Only used if `coalesce_messages_`.
+  absl::flat_hash_map<std::string, PendingMessage> pending_message_by_key_id_;
+  // Size of `pending_message_by_key_id_` after the last removal of the expired
+  // entries.
+  size_t num_pending_keys_after_cleanup_ = 0;
+  // Number of messages dropped because of coalescing.
+  uint64_t num_coalesced_messages_ = 0;
   // Collection of subscribers that subscribe to all entities of the channel.
   std::unique_ptr<EntityState> subscribers_to_all_;
   // Mapping from subscribed entity id -> entity state.
@@ -157,6 +198,27 @@ struct LongPollConnection {
   rpc::SendReplyCallback send_reply_callback;
 };
 
+/// A stream to push published messages to the subscriber, the streaming alternative
+/// to the long polling connection. Its methods are only called with the publisher's
+/// lock held.
+class SubscriberStream {
+ public:
+  virtual ~SubscriberStream() = default;
+
+  /// Send `reply` to the subscriber. At most one write is in flight at a time. The
+  /// stream keeps `reply` until the write is done, since the subscriber state may be
+  /// gone before that.
+  virtual void Write(rpc::PubsubLongPollingReply reply) = 0;
+
+  /// Close the stream from the publisher side. Nothing is written to the stream
+  /// afterwards.
+  virtual void Close() = 0;
+
+  /// Whether the stream is closed, or broken because the subscriber is gone. Such a
+  /// stream doesn't keep the subscriber alive while it's being detached.
+  virtual bool IsFinished() const = 0;
+};
+
 /// Keeps the state of each connected subscriber.
 class SubscriberState {
  public:
@@ -176,6 +238,9 @@ class SubscriberState {
     // Force a push to close the long-polling.
     // Otherwise, there will be a connection leak.
     PublishIfPossible(true);
+    if (stream_ != nullptr) {
+      stream_->Close();
+    }
   }
 
   /// Connect to the subscriber. Currently, it means we cache the long polling request to
@@ -187,13 +252,30 @@ class SubscriberState {
                            rpc::PubsubLongPollingReply *reply,
                            rpc::SendReplyCallback send_reply_callback);
 
+  /// Handle a request read from a stream to the subscriber. The request acknowledges
+  /// the processed messages, and attaches `stream` if it's not the current one. Once a
+  /// stream is attached, queued messages are pushed through it instead of the long
+  /// polling connection.
+  void ConnectToStream(const rpc::PubsubLongPollingRequest &request,
+                       SubscriberStream *stream);
+
+  /// Handle the completion of the last write to `stream`.
+  void HandleStreamWriteDone(SubscriberStream *stream, bool ok);
+
+  /// Detach `stream` if it's the current stream. Messages that were written to it but
+  /// not acknowledged yet will be published again.
+  void DisconnectStream(SubscriberStream *stream);
+
   /// Queue the pubsub message to publish to the subscriber.
   ///
   /// \param pub_message A message to publish.
   /// \param try_publish If true, try publishing the object id if there is a connection.
   ///     Currently only set to false in tests.
+  /// \param serialized_message If not null, the serialized `pub_message`. It's shared
+  ///     by all the subscribers and appended to the reply without re-encoding.
   void QueueMessage(const std::shared_ptr<rpc::PubMessage> &pub_message,
-                    bool try_publish = true);
+                    bool try_publish = true,
+                    std::shared_ptr<std::string> serialized_message = nullptr);
 
   /// Publish all queued messages if possible.
   ///
@@ -209,6 +291,9 @@ class SubscriberState {
   /// Returns true if there is a long polling connection.
   bool ConnectionExists() const;
 
+  /// Returns true if there is a stream attached.
+  bool StreamExists() const { return stream_ != nullptr; }
+
   /// Returns true if there are recent activities (requests or replies) between the
   /// subscriber and publisher.
   bool IsActive() const;
@@ -217,12 +302,32 @@ class SubscriberState {
   const SubscriberID &id() const { return subscriber_id_; }
 
  private:
+  struct QueuedMessage {
+    std::shared_ptr<rpc::PubMessage> message;
+    /// The serialized `message`, or null if the message is serialized with the reply.
+    std::shared_ptr<std::string> serialized_message;
+  };
+
+  /// Drop the messages which the subscriber has processed according to `request`.
+  void AcknowledgeMessages(const rpc::PubsubLongPollingRequest &request);
+
+  /// Add the queued messages from `mailbox_[begin]` to `reply`, within the batch size
+  /// and the gRPC message size limits.
+  ///
+  /// \return The number of queued messages consumed, including the cleared ones which
+  /// are not added.
+  size_t AddMessagesToReply(size_t begin, rpc::PubsubLongPollingReply *reply) const;
+
+  /// Write the queued messages that haven't been written to the stream yet, if there
+  /// is no write in flight.
+  bool PublishToStreamIfPossible();
+
   /// Subscriber ID, for logging and debugging.
   const SubscriberID subscriber_id_;
   /// Inflight long polling reply callback, for replying to the subscriber.
   std::unique_ptr<LongPollConnection> long_polling_connection_;
   /// Queued messages to publish.
-  std::deque<std::shared_ptr<rpc::PubMessage>> mailbox_;
+  std::deque<QueuedMessage> mailbox_;
   /// Callback to get the current time.
   const std::function<double()> get_time_ms_;
   /// The time in which the connection is considered as timed out.
@@ -232,6 +337,13 @@ class SubscriberState {
   /// The last time long polling was connected in milliseconds.
   double last_connection_update_time_ms_;
   PublisherID publisher_id_;
+  /// The stream to the subscriber, or null if it polls instead.
+  SubscriberStream *stream_ = nullptr;
+  /// Whether a reply is being written to the stream.
+  bool stream_write_in_flight_ = false;
+  /// The number of messages at the front of `mailbox_` written to the stream but not
+  /// acknowledged yet.
+  size_t num_streamed_messages_ = 0;
 };
 
 }  // namespace pub_internal
@@ -286,6 +398,9 @@ class PublisherInterface {
 /// - Publisher caches the long polling request and reply whenever there are published
 /// messages.
 /// - Publishes messages are batched in order to avoid gRPC message limit.
+/// - Alternatively, the subscriber opens a PubsubStream and the publisher writes the
+/// batches to it as soon as messages are published, one write at a time. Subscribers
+/// acknowledge processed messages through the stream. See publisher_stream.h.
 /// - Look at CheckDeadSubscribers for failure handling mechanism.
 ///
 /// How to add new publisher channel?
@@ -337,6 +452,32 @@ class Publisher : public PublisherInterface {
                            rpc::PubsubLongPollingReply *reply,
                            rpc::SendReplyCallback send_reply_callback);
 
+  /// Handle a request read from a pubsub stream. The first request of a stream attaches
+  /// it to the subscriber, and every request acknowledges the processed messages.
+  /// Published messages are pushed through the stream until it's disconnected.
+  ///
+  /// \param request The request read from the stream.
+  /// \param stream The stream the request is read from.
+  void HandleStreamRequest(const rpc::PubsubLongPollingRequest &request,
+                           pub_internal::SubscriberStream *stream);
+
+  /// Handle the completion of the last write to a pubsub stream.
+  ///
+  /// \param subscriber_id The subscriber the stream is attached to.
+  /// \param stream The stream written to.
+  /// \param ok False if the write failed because the stream is broken.
+  void HandleStreamWriteDone(const SubscriberID &subscriber_id,
+                             pub_internal::SubscriberStream *stream,
+                             bool ok);
+
+  /// Detach a pubsub stream which is closed. Pending messages are published once the
+  /// subscriber reconnects.
+  ///
+  /// \param subscriber_id The subscriber the stream is attached to.
+  /// \param stream The closed stream.
+  void DisconnectStream(const SubscriberID &subscriber_id,
+                        pub_internal::SubscriberStream *stream);
+
   /// Register the subscription.
   ///
   /// \param channel_type The type of the channel.
@@ -419,6 +560,11 @@ class Publisher : public PublisherInterface {
   FRIEND_TEST(PublisherTest, TestUnregisterSubscription);
   FRIEND_TEST(PublisherTest, TestUnregisterSubscriber);
   FRIEND_TEST(PublisherTest, TestRegistrationIdempotency);
+  FRIEND_TEST(PublisherTest, TestSerializeMessagesOnce);
+  FRIEND_TEST(PublisherTest, TestStream);
+  FRIEND_TEST(PublisherTest, TestFinishedStreamIsNotActive);
+  FRIEND_TEST(IntegrationTest, StreamClosedBySubscriber);
+  FRIEND_TEST(IntegrationTest, SubscriberUnregisteredWhileWriting);
   friend class MockPublisher;
 
   /// Testing only.
@@ -434,6 +580,9 @@ class Publisher : public PublisherInterface {
   int UnregisterSubscriberInternal(const SubscriberID &subscriber_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  pub_internal::SubscriberState *GetOrCreateSubscriber(const SubscriberID &subscriber_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Periodic runner to invoke CheckDeadSubscribers.
   // The pointer must outlive the Publisher.
   // Nonnull in production, may be nullptr in tests.
@@ -0,0 +1,146 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/pubsub/publisher_stream.h"
+
+#include <utility>
+
+namespace ray {
+
+namespace pubsub {
+
+namespace {
+
+/// Finishes the stream right away with the given status.
+class RejectedStreamReactor
+    : public grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest,
+                                     rpc::PubsubLongPollingReply> {
+ public:
+  explicit RejectedStreamReactor(const grpc::Status &status) { Finish(status); }
+
+ private:
+  void OnDone() override { delete this; }
+};
+
+}  // namespace
+
+PubsubStreamServerReactor::PubsubStreamServerReactor(instrumented_io_context &io_context,
+                                                     Publisher &publisher)
+    : io_context_(io_context), publisher_(publisher) {
+  StartRead(&request_);
+}
+
+void PubsubStreamServerReactor::Write(rpc::PubsubLongPollingReply reply) {
+  absl::MutexLock lock(&mutex_);
+  if (finished_) {
+    return;
+  }
+  reply_ = std::move(reply);
+  StartWrite(&reply_);
+}
+
+void PubsubStreamServerReactor::Close() {
+  absl::MutexLock lock(&mutex_);
+  if (!finished_) {
+    finished_ = true;
+    Finish(grpc::Status::OK);
+  }
+}
+
+bool PubsubStreamServerReactor::IsFinished() const {
+  absl::MutexLock lock(&mutex_);
+  return finished_ || broken_;
+}
+
+void PubsubStreamServerReactor::Disconnect() {
+  if (!subscriber_id_.IsNil()) {
+    publisher_.DisconnectStream(subscriber_id_, this);
+  }
+  Close();
+}
+
+// Reactions are posted rather than dispatched: the publisher writes to the stream with
+// its lock held, and a write may complete inline.
+void PubsubStreamServerReactor::OnReadDone(bool ok) {
+  if (!ok) {
+    // The subscriber has closed its side of the stream, or is gone.
+    broken_ = true;
+    io_context_.post([this]() { Disconnect(); }, "PubsubStreamServerReactor.OnReadDone");
+    return;
+  }
+  auto request = std::make_shared<rpc::PubsubLongPollingRequest>();
+  request->Swap(&request_);
+  io_context_.post(
+      [this, request]() {
+        if (IsFinished()) {
+          return;
+        }
+        if (subscriber_id_.IsNil()) {
+          subscriber_id_ = SubscriberID::FromBinary(request->subscriber_id());
+        }
+        // Not under the lock, since the publisher writes to the stream with its own lock
+        // held.
+        publisher_.HandleStreamRequest(*request, this);
+        absl::MutexLock lock(&mutex_);
+        if (!finished_ && !broken_) {
+          StartRead(&request_);
+        }
+      },
+      "PubsubStreamServerReactor.OnReadDone");
+}
+
+void PubsubStreamServerReactor::OnWriteDone(bool ok) {
+  if (!ok) {
+    broken_ = true;
+  }
+  io_context_.post(
+      [this, ok]() {
+        {
+          absl::MutexLock lock(&mutex_);
+          reply_.Clear();
+        }
+        publisher_.HandleStreamWriteDone(subscriber_id_, this, ok);
+      },
+      "PubsubStreamServerReactor.OnWriteDone");
+}
+
+void PubsubStreamServerReactor::OnCancel() {
+  broken_ = true;
+  io_context_.post([this]() { Disconnect(); }, "PubsubStreamServerReactor.OnCancel");
+}
+
+void PubsubStreamServerReactor::OnDone() {
+  io_context_.post(
+      [this]() {
+        if (!subscriber_id_.IsNil()) {
+          publisher_.DisconnectStream(subscriber_id_, this);
+        }
+        delete this;
+      },
+      "PubsubStreamServerReactor.OnDone");
+}
+
+grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest, rpc::PubsubLongPollingReply>
+    *PubsubStreamService::PubsubStream(grpc::CallbackServerContext *context) {
+  auto *publisher = publisher_.load();
+  if (publisher == nullptr) {
+    return new RejectedStreamReactor(
+        grpc::Status(grpc::StatusCode::UNAVAILABLE, "The publisher is not ready."));
+  }
+  return new PubsubStreamServerReactor(io_context_, *publisher);
+}
+
+}  // namespace pubsub
+
+}  // namespace ray
@@ -0,0 +1,101 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <atomic>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/pubsub/publisher.h"
+#include "src/ray/protobuf/pubsub.grpc.pb.h"
+
+namespace ray {
+
+namespace pubsub {
+
+/// The publisher side of a PubsubStream. Requests read from the stream are handed to
+/// the publisher, which writes the published messages back through `Write`.
+///
+/// gRPC reactions are dispatched to `io_context`. The reactor deletes itself once the
+/// stream is done, after detaching from the publisher.
+class PubsubStreamServerReactor
+    : public grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest,
+                                     rpc::PubsubLongPollingReply>,
+      public pub_internal::SubscriberStream {
+ public:
+  PubsubStreamServerReactor(instrumented_io_context &io_context, Publisher &publisher);
+
+  /// pub_internal::SubscriberStream.
+  void Write(rpc::PubsubLongPollingReply reply) override;
+  void Close() override;
+  bool IsFinished() const override;
+
+ private:
+  void OnReadDone(bool ok) override;
+  void OnWriteDone(bool ok) override;
+  void OnCancel() override;
+  void OnDone() override;
+
+  /// Close the stream from this side, and detach it from the publisher.
+  void Disconnect();
+
+  instrumented_io_context &io_context_;
+  Publisher &publisher_;
+  /// The subscriber on the other side, known once the first request is read. Only
+  /// accessed from `io_context_`.
+  SubscriberID subscriber_id_;
+  /// The buffer of the read in flight.
+  rpc::PubsubLongPollingRequest request_;
+  /// Serializes the operations on the stream with Finish, since the publisher may
+  /// close the stream from any thread. Nothing is started after Finish.
+  mutable absl::Mutex mutex_;
+  /// The buffer of the write in flight. It's owned by the reactor rather than the
+  /// publisher, since the subscriber may be unregistered before the write is done.
+  rpc::PubsubLongPollingReply reply_ ABSL_GUARDED_BY(mutex_);
+  /// Whether Finish is called.
+  bool finished_ ABSL_GUARDED_BY(mutex_) = false;
+  /// Whether a read or a write failed, or the call was cancelled. Atomic rather than
+  /// guarded, since a read or a write started with the lock held may fail inline.
+  std::atomic<bool> broken_{false};
+};
+
+/// Serves PubsubStream for the publisher. The other methods of SubscriberService are
+/// left unimplemented, since they are served by the owner's own service.
+///
+/// The service is registered before the publisher gets created, so streams opened
+/// before `SetPublisher` are rejected and the subscribers fall back to long polling.
+class PubsubStreamService : public rpc::SubscriberService::CallbackService {
+ public:
+  explicit PubsubStreamService(instrumented_io_context &io_context)
+      : io_context_(io_context) {}
+
+  /// Set the publisher to serve the streams for. It must outlive the gRPC server.
+  void SetPublisher(Publisher *publisher) { publisher_.store(publisher); }
+
+  grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest, rpc::PubsubLongPollingReply>
+      *PubsubStream(grpc::CallbackServerContext *context) override;
+
+ private:
+  instrumented_io_context &io_context_;
+  std::atomic<Publisher *> publisher_{nullptr};
+};
+
+}  // namespace pubsub
+
+}  // namespace ray
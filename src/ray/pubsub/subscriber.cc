@@ -14,6 +14,11 @@
 
 #include "ray/pubsub/subscriber.h"
 
+#include "ray/common/asio/asio_util.h"
+#include "ray/common/ray_config.h"
+#include "ray/pubsub/subscriber_stream.h"
+#include "ray/util/exponential_backoff.h"
+
 namespace ray {
 
 namespace pubsub {
@@ -278,7 +283,9 @@ bool Subscriber::Unsubscribe(const rpc::ChannelType channel_type,
   commands_[publisher_id].emplace(std::move(command));
   SendCommandBatchIfPossible(publisher_address);
 
-  return Channel(channel_type)->Unsubscribe(publisher_address, key_id);
+  const bool unsubscribed = Channel(channel_type)->Unsubscribe(publisher_address, key_id);
+  CancelStreamIfNotSubscribed(publisher_id);
+  return unsubscribed;
 }
 
 bool Subscriber::UnsubscribeChannel(const rpc::ChannelType channel_type,
@@ -293,7 +300,10 @@ bool Subscriber::UnsubscribeChannel(const rpc::ChannelType channel_type,
   commands_[publisher_id].emplace(std::move(command));
   SendCommandBatchIfPossible(publisher_address);
 
-  return Channel(channel_type)->Unsubscribe(publisher_address, std::nullopt);
+  const bool unsubscribed =
+      Channel(channel_type)->Unsubscribe(publisher_address, std::nullopt);
+  CancelStreamIfNotSubscribed(publisher_id);
+  return unsubscribed;
 }
 
 bool Subscriber::IsSubscribed(const rpc::ChannelType channel_type,
@@ -344,7 +354,9 @@ void Subscriber::MakeLongPollingConnectionIfNotConnected(
   auto publishers_connected_it = publishers_connected_.find(publisher_id);
   if (publishers_connected_it == publishers_connected_.end()) {
     publishers_connected_.emplace(publisher_id);
-    MakeLongPollingPubsubConnection(publisher_address);
+    if (!MakeStreamPubsubConnection(publisher_address)) {
+      MakeLongPollingPubsubConnection(publisher_address);
+    }
   }
 }
 
@@ -352,13 +364,8 @@ void Subscriber::MakeLongPollingPubsubConnection(const rpc::Address &publisher_a
   const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
   RAY_LOG(DEBUG) << "Make a long polling request to " << publisher_id;
   auto subscriber_client = get_client_(publisher_address);
-  rpc::PubsubLongPollingRequest long_polling_request;
-  long_polling_request.set_subscriber_id(subscriber_id_.Binary());
-  auto &processed_state = processed_sequences_[publisher_id];
-  long_polling_request.set_publisher_id(processed_state.first.Binary());
-  long_polling_request.set_max_processed_sequence_id(processed_state.second);
   subscriber_client->PubsubLongPolling(
-      long_polling_request,
+      MakePollingRequest(publisher_id),
       [this, publisher_address](Status status, rpc::PubsubLongPollingReply &&reply) {
         absl::MutexLock lock(&mutex_);
         HandleLongPollingResponse(publisher_address, status, std::move(reply));
@@ -384,60 +391,188 @@ void Subscriber::HandleLongPollingResponse(const rpc::Address &publisher_address
     // Empty the command queue because we cannot send commands anymore.
     commands_.erase(publisher_id);
   } else {
-    RAY_CHECK(!reply.publisher_id().empty()) << "publisher_id is empty.";
-    auto reply_publisher_id = PublisherID::FromBinary(reply.publisher_id());
-    if (reply_publisher_id != processed_sequences_[publisher_id].first) {
-      if (processed_sequences_[publisher_id].first != kDefaultPublisherID) {
-        RAY_LOG(INFO) << "Received publisher_id " << reply_publisher_id.Hex()
-                      << " is different from last seen publisher_id "
-                      << processed_sequences_[publisher_id].first
-                      << ", this can only happen when gcs failsover.";
-      }
-      // reset publisher_id and processed_sequence
-      // if the publisher_id changes.
-      processed_sequences_[publisher_id].first = reply_publisher_id;
-      processed_sequences_[publisher_id].second = 0;
+    HandlePublishedMessages(publisher_address, std::move(reply));
+  }
+
+  if (SubscriptionExists(publisher_id)) {
+    // If streams are enabled, the request checked that the publisher is alive after
+    // its stream kept breaking, so the stream is reopened.
+    if (!status.ok() || !MakeStreamPubsubConnection(publisher_address)) {
+      MakeLongPollingPubsubConnection(publisher_address);
+    }
+  } else {
+    processed_sequences_.erase(publisher_id);
+    publishers_connected_.erase(publisher_id);
+    publishers_without_stream_.erase(publisher_id);
+  }
+}
+
+void Subscriber::HandlePublishedMessages(const rpc::Address &publisher_address,
+                                         rpc::PubsubLongPollingReply &&reply) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_CHECK(!reply.publisher_id().empty()) << "publisher_id is empty.";
+  auto reply_publisher_id = PublisherID::FromBinary(reply.publisher_id());
+  if (reply_publisher_id != processed_sequences_[publisher_id].first) {
+    if (processed_sequences_[publisher_id].first != kDefaultPublisherID) {
+      RAY_LOG(INFO) << "Received publisher_id " << reply_publisher_id.Hex()
+                    << " is different from last seen publisher_id "
+                    << processed_sequences_[publisher_id].first
+                    << ", this can only happen when gcs failsover.";
     }
+    // reset publisher_id and processed_sequence
+    // if the publisher_id changes.
+    processed_sequences_[publisher_id].first = reply_publisher_id;
+    processed_sequences_[publisher_id].second = 0;
+  }
 
-    for (int i = 0; i < reply.pub_messages_size(); i++) {
-      const auto &msg = reply.pub_messages(i);
-      const auto channel_type = msg.channel_type();
-      const auto &key_id = msg.key_id();
-      RAY_CHECK_GT(msg.sequence_id(), 0)
-          << "message's sequence_id is invalid " << msg.sequence_id();
-
-      if (msg.sequence_id() <= processed_sequences_[publisher_id].second) {
-        RAY_LOG_EVERY_MS(WARNING, 10000)
-            << "Received message out of order, publisher_id: "
-            << processed_sequences_[publisher_id].first
-            << ", received message sequence_id "
-            << processed_sequences_[publisher_id].second
-            << ", received message sequence_id " << msg.sequence_id();
-        continue;
-      }
-      processed_sequences_[publisher_id].second = msg.sequence_id();
-      // If the published message is a failure message, the publisher indicates
-      // this key id is failed. Invoke the failure callback. At this time, we should not
-      // unsubscribe the publisher because there are other entries that subscribe from the
-      // publisher.
-      if (msg.has_failure_message()) {
-        RAY_LOG(DEBUG) << "Failure message has published from a channel " << channel_type;
-        Channel(channel_type)->HandlePublisherFailure(publisher_address, key_id);
-        continue;
-      }
-
-      // Otherwise, invoke the subscription callback, consuming the pub message.
-      Channel(channel_type)
-          ->HandlePublishedMessage(publisher_address,
-                                   std::move(*reply.mutable_pub_messages(i)));
+  for (int i = 0; i < reply.pub_messages_size(); i++) {
+    const auto &msg = reply.pub_messages(i);
+    const auto channel_type = msg.channel_type();
+    const auto &key_id = msg.key_id();
+    RAY_CHECK_GT(msg.sequence_id(), 0)
+        << "message's sequence_id is invalid " << msg.sequence_id();
+
+    if (msg.sequence_id() <= processed_sequences_[publisher_id].second) {
+      RAY_LOG_EVERY_MS(WARNING, 10000)
+          << "Received message out of order, publisher_id: "
+          << processed_sequences_[publisher_id].first
+          << ", received message sequence_id "
+          << processed_sequences_[publisher_id].second
+          << ", received message sequence_id " << msg.sequence_id();
+      continue;
     }
+    processed_sequences_[publisher_id].second = msg.sequence_id();
+    // If the published message is a failure message, the publisher indicates
+    // this key id is failed. Invoke the failure callback. At this time, we should not
+    // unsubscribe the publisher because there are other entries that subscribe from the
+    // publisher.
+    if (msg.has_failure_message()) {
+      RAY_LOG(DEBUG) << "Failure message has published from a channel " << channel_type;
+      Channel(channel_type)->HandlePublisherFailure(publisher_address, key_id);
+      continue;
+    }
+
+    // Otherwise, invoke the subscription callback, consuming the pub message.
+    Channel(channel_type)
+        ->HandlePublishedMessage(publisher_address,
+                                 std::move(*reply.mutable_pub_messages(i)));
+  }
+}
+
+rpc::PubsubLongPollingRequest Subscriber::MakePollingRequest(
+    const PublisherID &publisher_id) {
+  rpc::PubsubLongPollingRequest request;
+  request.set_subscriber_id(subscriber_id_.Binary());
+  auto &processed_state = processed_sequences_[publisher_id];
+  request.set_publisher_id(processed_state.first.Binary());
+  request.set_max_processed_sequence_id(processed_state.second);
+  return request;
+}
+
+bool Subscriber::MakeStreamPubsubConnection(const rpc::Address &publisher_address) {
+  if (!RayConfig::instance().pubsub_use_bidi_stream() || callback_service_ == nullptr) {
+    return false;
+  }
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  if (publishers_without_stream_.contains(publisher_id)) {
+    return false;
   }
+  auto channel = get_client_(publisher_address)->PubsubStreamChannel();
+  if (channel == nullptr) {
+    return false;
+  }
+  RAY_LOG(DEBUG) << "Open a pubsub stream to " << publisher_id;
+  auto *stream = new PubsubStreamClientReactor(
+      channel,
+      *callback_service_,
+      [this, publisher_address](rpc::PubsubLongPollingReply &&reply) {
+        absl::MutexLock lock(&mutex_);
+        HandleStreamReply(publisher_address, std::move(reply));
+      },
+      [this, publisher_address](const grpc::Status &status) {
+        absl::MutexLock lock(&mutex_);
+        HandleStreamDone(publisher_address, status);
+      });
+  publisher_streams_[publisher_id] = stream;
+  stream->Start(MakePollingRequest(publisher_id));
+  return true;
+}
 
+void Subscriber::HandleStreamReply(const rpc::Address &publisher_address,
+                                   rpc::PubsubLongPollingReply &&reply) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  auto it = publisher_streams_.find(publisher_id);
+  RAY_CHECK(it != publisher_streams_.end());
+  stream_failures_.erase(publisher_id);
+  HandlePublishedMessages(publisher_address, std::move(reply));
   if (SubscriptionExists(publisher_id)) {
-    MakeLongPollingPubsubConnection(publisher_address);
+    it->second->Acknowledge(MakePollingRequest(publisher_id));
   } else {
+    it->second->Cancel();
+  }
+}
+
+void Subscriber::HandleStreamDone(const rpc::Address &publisher_address,
+                                  const grpc::Status &status) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_LOG(DEBUG) << "Pubsub stream to " << publisher_id
+                 << " is done, status: " << status.error_message();
+  publisher_streams_.erase(publisher_id);
+  RAY_CHECK(publishers_connected_.count(publisher_id));
+  if (!SubscriptionExists(publisher_id)) {
+    stream_failures_.erase(publisher_id);
+    processed_sequences_.erase(publisher_id);
+    publishers_connected_.erase(publisher_id);
+    return;
+  }
+  if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+    RAY_LOG(DEBUG) << "Publisher " << publisher_id
+                   << " doesn't serve pubsub streams, long polling it instead.";
+    stream_failures_.erase(publisher_id);
+    publishers_without_stream_.insert(publisher_id);
+    MakeLongPollingPubsubConnection(publisher_address);
+    return;
+  }
+  auto &num_failures = stream_failures_[publisher_id];
+  if (num_failures >= RayConfig::instance().pubsub_stream_max_retries()) {
+    // The stream keeps breaking, possibly because the publisher is dead. Long polling
+    // detects the failure, and the stream is reopened once the request is replied.
+    stream_failures_.erase(publisher_id);
+    MakeLongPollingPubsubConnection(publisher_address);
+    return;
+  }
+  const auto delay_ms = ExponentialBackoff::GetBackoffMs(
+      num_failures, RayConfig::instance().pubsub_stream_retry_base_ms());
+  ++num_failures;
+  execute_after(
+      *callback_service_,
+      [this, publisher_address]() {
+        absl::MutexLock lock(&mutex_);
+        RetryStreamPubsubConnection(publisher_address);
+      },
+      std::chrono::milliseconds(delay_ms));
+}
+
+void Subscriber::RetryStreamPubsubConnection(const rpc::Address &publisher_address) {
+  const auto publisher_id = PublisherID::FromBinary(publisher_address.worker_id());
+  RAY_CHECK(publishers_connected_.count(publisher_id));
+  if (!SubscriptionExists(publisher_id)) {
+    stream_failures_.erase(publisher_id);
     processed_sequences_.erase(publisher_id);
     publishers_connected_.erase(publisher_id);
+    return;
+  }
+  if (!MakeStreamPubsubConnection(publisher_address)) {
+    // Streaming has been disabled since the stream broke.
+    stream_failures_.erase(publisher_id);
+    MakeLongPollingPubsubConnection(publisher_address);
+  }
+}
+
+void Subscriber::CancelStreamIfNotSubscribed(const PublisherID &publisher_id) {
+  auto it = publisher_streams_.find(publisher_id);
+  if (it != publisher_streams_.end() && !SubscriptionExists(publisher_id)) {
+    it->second->Cancel();
   }
 }
 
@@ -515,8 +650,9 @@ bool Subscriber::CheckNoLeaks() const {
       leaks = true;
     }
   }
-  return !leaks && publishers_connected_.empty() && command_batch_sent_.empty() &&
-         commands_.empty() && processed_sequences_.empty();
+  return !leaks && publishers_connected_.empty() && publisher_streams_.empty() &&
+         stream_failures_.empty() && publishers_without_stream_.empty() &&
+         command_batch_sent_.empty() && commands_.empty() && processed_sequences_.empty();
 }
 
 std::string Subscriber::DebugString() const {
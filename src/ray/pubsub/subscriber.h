@@ -32,6 +32,8 @@ namespace ray {
 
 namespace pubsub {
 
+class PubsubStreamClientReactor;
+
 using SubscriberID = UniqueID;
 using PublisherID = UniqueID;
 using SubscribeDoneCallback = std::function<void(const Status &)>;
@@ -309,6 +311,10 @@ class SubscriberClientInterface {
       const rpc::PubsubCommandBatchRequest &request,
       const rpc::ClientCallback<rpc::PubsubCommandBatchReply> &callback) = 0;
 
+  /// The channel to open a PubsubStream to the publisher with, or nullptr if the
+  /// client only supports long polling.
+  virtual std::shared_ptr<grpc::Channel> PubsubStreamChannel() { return nullptr; }
+
   virtual ~SubscriberClientInterface() = default;
 };
 
@@ -320,6 +326,11 @@ class SubscriberClientInterface {
 /// - Subscriber always try making reconnection as long as there are subscribed entries.
 /// - If long polling request is failed (if non-OK status is returned from the RPC),
 /// consider the publisher is dead.
+/// - If pubsub_use_bidi_stream is enabled, the subscriber receives the messages through
+/// a PubsubStream instead, if the client supports it. A broken stream is reopened with
+/// backoff. If it keeps breaking, a long polling request checks whether the publisher
+/// is dead, and the stream is reopened once it's replied. The subscriber only stays on
+/// long polling if the publisher doesn't implement streams.
 ///
 /// How to extend new channels.
 ///
@@ -337,7 +348,8 @@ class Subscriber : public SubscriberInterface {
       instrumented_io_context *callback_service)
       : subscriber_id_(subscriber_id),
         max_command_batch_size_(max_command_batch_size),
-        get_client_(get_client) {
+        get_client_(get_client),
+        callback_service_(callback_service) {
     for (auto type : channels) {
       channels_.emplace(type,
                         std::make_unique<SubscriberChannel>(type, callback_service));
@@ -392,6 +404,9 @@ class Subscriber : public SubscriberInterface {
 
   FRIEND_TEST(IntegrationTest, SubscribersToOneIDAndAllIDs);
   FRIEND_TEST(IntegrationTest, GcsFailsOver);
+  FRIEND_TEST(IntegrationTest, SubscribeThroughStream);
+  FRIEND_TEST(IntegrationTest, StreamReopenedAfterFailure);
+  FRIEND_TEST(IntegrationTest, LongPollingWhenStreamIsUnimplemented);
   FRIEND_TEST(SubscriberTest, TestBasicSubscription);
   FRIEND_TEST(SubscriberTest, TestSingleLongPollingWithMultipleSubscriptions);
   FRIEND_TEST(SubscriberTest, TestMultiLongPollingWithTheSameSubscription);
@@ -428,6 +443,43 @@ class Subscriber : public SubscriberInterface {
   void MakeLongPollingPubsubConnection(const rpc::Address &publisher_address)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  /// Open a PubsubStream to the publisher for receiving the published messages.
+  ///
+  /// \return False if streaming is disabled or not supported by the publisher, in
+  /// which case the caller should make a long polling connection.
+  bool MakeStreamPubsubConnection(const rpc::Address &publisher_address)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Handle a reply read from the PubsubStream, and acknowledge it.
+  void HandleStreamReply(const rpc::Address &publisher_address,
+                         rpc::PubsubLongPollingReply &&reply)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Handle the end of the PubsubStream. If the publisher is still subscribed, the
+  /// stream is reopened after a backoff, or long polling takes over if the publisher
+  /// doesn't implement streams or the stream keeps breaking.
+  void HandleStreamDone(const rpc::Address &publisher_address,
+                        const grpc::Status &status) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Reopen the PubsubStream once the backoff after it broke is over, if the publisher
+  /// is still subscribed.
+  void RetryStreamPubsubConnection(const rpc::Address &publisher_address)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Cancel the PubsubStream if there is no subscription to the publisher anymore.
+  void CancelStreamIfNotSubscribed(const PublisherID &publisher_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Invoke the callbacks of the published messages in `reply`.
+  void HandlePublishedMessages(const rpc::Address &publisher_address,
+                               rpc::PubsubLongPollingReply &&reply)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Make a request that identifies this subscriber and acknowledges the messages
+  /// processed from the publisher.
+  rpc::PubsubLongPollingRequest MakePollingRequest(const PublisherID &publisher_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   /// Private method to handle long polling responses. Long polling responses contain the
   /// published messages.
   void HandleLongPollingResponse(const rpc::Address &publisher_address,
@@ -468,6 +520,9 @@ class Subscriber : public SubscriberInterface {
   const std::function<std::shared_ptr<SubscriberClientInterface>(const rpc::Address &)>
       get_client_;
 
+  /// The io context PubsubStream reactions run on.
+  instrumented_io_context *callback_service_;
+
   /// Protects below fields. Since the coordinator runs in a core worker, it should be
   /// thread safe.
   mutable absl::Mutex mutex_;
@@ -483,9 +538,20 @@ class Subscriber : public SubscriberInterface {
   absl::flat_hash_map<PublisherID, CommandQueue> commands_ ABSL_GUARDED_BY(mutex_);
 
   /// A set to cache the connected publisher ids. "Connected" means the long polling
-  /// request is in flight.
+  /// request or the PubsubStream is in flight.
   absl::flat_hash_set<PublisherID> publishers_connected_ ABSL_GUARDED_BY(mutex_);
 
+  /// The open PubsubStreams, by publisher id. A stream deletes itself once it's done.
+  absl::flat_hash_map<PublisherID, PubsubStreamClientReactor *> publisher_streams_
+      ABSL_GUARDED_BY(mutex_);
+
+  /// The number of times in a row the PubsubStream to each publisher broke before
+  /// anything was read from it.
+  absl::flat_hash_map<PublisherID, uint64_t> stream_failures_ ABSL_GUARDED_BY(mutex_);
+
+  /// The publishers which don't implement PubsubStream, and are long polled instead.
+  absl::flat_hash_set<PublisherID> publishers_without_stream_ ABSL_GUARDED_BY(mutex_);
+
   /// A set to keep track of in-flight command batch requests
   absl::flat_hash_set<PublisherID> command_batch_sent_ ABSL_GUARDED_BY(mutex_);
 
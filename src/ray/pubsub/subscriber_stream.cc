@@ -0,0 +1,105 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/pubsub/subscriber_stream.h"
+
+namespace ray {
+
+namespace pubsub {
+
+PubsubStreamClientReactor::PubsubStreamClientReactor(
+    const std::shared_ptr<grpc::Channel> &channel,
+    instrumented_io_context &io_context,
+    ReplyCallback reply_callback,
+    DoneCallback done_callback)
+    : io_context_(io_context),
+      stub_(rpc::SubscriberService::NewStub(channel)),
+      reply_callback_(std::move(reply_callback)),
+      done_callback_(std::move(done_callback)) {}
+
+void PubsubStreamClientReactor::Start(const rpc::PubsubLongPollingRequest &request) {
+  // Posted, since the write state is only accessed from `io_context_`.
+  io_context_.post(
+      [this, request]() {
+        stub_->async()->PubsubStream(&context_, this);
+        request_ = request;
+        write_in_flight_ = true;
+        StartWrite(&request_);
+        StartRead(&reply_);
+        // Acknowledgements are written from outside of the reactions, so hold the
+        // stream open until the read side is done.
+        AddHold();
+        StartCall();
+      },
+      "PubsubStreamClientReactor.Start");
+}
+
+void PubsubStreamClientReactor::Acknowledge(
+    const rpc::PubsubLongPollingRequest &request) {
+  pending_request_ = request;
+  WriteIfPossible();
+}
+
+void PubsubStreamClientReactor::WriteIfPossible() {
+  if (read_done_ || write_in_flight_ || !pending_request_) {
+    return;
+  }
+  request_ = std::move(*pending_request_);
+  pending_request_.reset();
+  write_in_flight_ = true;
+  StartWrite(&request_);
+}
+
+void PubsubStreamClientReactor::OnReadDone(bool ok) {
+  if (!ok) {
+    io_context_.post(
+        [this]() {
+          read_done_ = true;
+          pending_request_.reset();
+          RemoveHold();
+        },
+        "PubsubStreamClientReactor.OnReadDone");
+    return;
+  }
+  auto reply = std::make_shared<rpc::PubsubLongPollingReply>();
+  reply->Swap(&reply_);
+  io_context_.post([this, reply]() { reply_callback_(std::move(*reply)); },
+                   "PubsubStreamClientReactor.OnReadDone");
+  StartRead(&reply_);
+}
+
+void PubsubStreamClientReactor::OnWriteDone(bool ok) {
+  io_context_.post(
+      [this, ok]() {
+        write_in_flight_ = false;
+        // A failed write means the stream is broken, which also fails the read.
+        if (ok) {
+          WriteIfPossible();
+        }
+      },
+      "PubsubStreamClientReactor.OnWriteDone");
+}
+
+void PubsubStreamClientReactor::OnDone(const grpc::Status &status) {
+  io_context_.post(
+      [this, status]() {
+        done_callback_(status);
+        delete this;
+      },
+      "PubsubStreamClientReactor.OnDone");
+}
+
+}  // namespace pubsub
+
+}  // namespace ray
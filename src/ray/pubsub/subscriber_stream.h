@@ -0,0 +1,87 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include "ray/common/asio/instrumented_io_context.h"
+#include "src/ray/protobuf/pubsub.grpc.pb.h"
+
+namespace ray {
+
+namespace pubsub {
+
+/// The subscriber side of a PubsubStream. The first request identifies the
+/// subscriber, and the following ones acknowledge the processed messages. Published
+/// messages are read from the stream until it's cancelled or broken.
+///
+/// Replies and the final status are handed to the callbacks on `io_context`. The
+/// reactor deletes itself once the stream is done, after `done_callback` returns.
+class PubsubStreamClientReactor
+    : public grpc::ClientBidiReactor<rpc::PubsubLongPollingRequest,
+                                     rpc::PubsubLongPollingReply> {
+ public:
+  using ReplyCallback = std::function<void(rpc::PubsubLongPollingReply &&)>;
+  using DoneCallback = std::function<void(const grpc::Status &)>;
+
+  PubsubStreamClientReactor(const std::shared_ptr<grpc::Channel> &channel,
+                            instrumented_io_context &io_context,
+                            ReplyCallback reply_callback,
+                            DoneCallback done_callback);
+
+  /// Open the stream on `io_context`, and send `request` as the first request.
+  void Start(const rpc::PubsubLongPollingRequest &request);
+
+  /// Acknowledge the processed messages. If a write is in flight, only the latest
+  /// acknowledgement is sent once it completes. Must be called on `io_context`.
+  void Acknowledge(const rpc::PubsubLongPollingRequest &request);
+
+  /// Cancel the stream. Thread-safe, but must be called before `done_callback` runs.
+  void Cancel() { context_.TryCancel(); }
+
+ private:
+  void OnReadDone(bool ok) override;
+  void OnWriteDone(bool ok) override;
+  void OnDone(const grpc::Status &status) override;
+
+  /// Write the pending acknowledgement, if there is no write in flight.
+  void WriteIfPossible();
+
+  instrumented_io_context &io_context_;
+  std::unique_ptr<rpc::SubscriberService::Stub> stub_;
+  grpc::ClientContext context_;
+  const ReplyCallback reply_callback_;
+  const DoneCallback done_callback_;
+  /// The buffer of the read in flight.
+  rpc::PubsubLongPollingReply reply_;
+
+  /// Below fields are only accessed from `io_context_`.
+  ///
+  /// The request being written.
+  rpc::PubsubLongPollingRequest request_;
+  /// The acknowledgement to write once the write in flight completes.
+  std::optional<rpc::PubsubLongPollingRequest> pending_request_;
+  bool write_in_flight_ = false;
+  /// Whether the read side is done, after which nothing is written anymore.
+  bool read_done_ = false;
+};
+
+}  // namespace pubsub
+
+}  // namespace ray
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -24,7 +25,9 @@
 #include "ray/common/asio/io_service_pool.h"
 #include "ray/common/asio/periodical_runner.h"
 #include "ray/common/grpc_util.h"
+#include "ray/common/ray_config.h"
 #include "ray/pubsub/publisher.h"
+#include "ray/pubsub/publisher_stream.h"
 #include "ray/pubsub/subscriber.h"
 #include "src/ray/protobuf/pubsub.grpc.pb.h"
 #include "src/ray/protobuf/pubsub.pb.h"
@@ -32,11 +35,23 @@
 namespace ray {
 namespace pubsub {
 
+// Finishes a PubsubStream right away with the given status.
+class RejectedStreamReactor
+    : public grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest,
+                                     rpc::PubsubLongPollingReply> {
+ public:
+  explicit RejectedStreamReactor(const grpc::Status &status) { Finish(status); }
+
+ private:
+  void OnDone() override { delete this; }
+};
+
 // Implements SubscriberService for handling subscriber polling.
 class SubscriberServiceImpl final : public rpc::SubscriberService::CallbackService {
  public:
-  explicit SubscriberServiceImpl(std::unique_ptr<Publisher> publisher)
-      : publisher_(std::move(publisher)) {}
+  SubscriberServiceImpl(std::unique_ptr<Publisher> publisher,
+                        instrumented_io_context &io_context)
+      : publisher_(std::move(publisher)), io_context_(io_context) {}
 
   grpc::ServerUnaryReactor *PubsubLongPolling(
       grpc::CallbackServerContext *context,
@@ -86,18 +101,37 @@ class SubscriberServiceImpl final : public rpc::SubscriberService::CallbackServi
     return reactor;
   }
 
+  grpc::ServerBidiReactor<rpc::PubsubLongPollingRequest, rpc::PubsubLongPollingReply>
+      *PubsubStream(grpc::CallbackServerContext *context) override {
+    if (num_streams_to_reject_ > 0) {
+      --num_streams_to_reject_;
+      return new RejectedStreamReactor(grpc::Status(reject_code_, "Rejected."));
+    }
+    return new PubsubStreamServerReactor(io_context_, *publisher_);
+  }
+
   Publisher &GetPublisher() { return *publisher_; }
 
+  // Reject the next `num_streams` streams with `code`. Not thread-safe, so only called
+  // before the subscriber opens any stream.
+  void RejectStreams(int num_streams, grpc::StatusCode code) {
+    num_streams_to_reject_ = num_streams;
+    reject_code_ = code;
+  }
+
  private:
   std::unique_ptr<Publisher> publisher_;
+  instrumented_io_context &io_context_;
+  std::atomic<int> num_streams_to_reject_{0};
+  grpc::StatusCode reject_code_ = grpc::StatusCode::UNAVAILABLE;
 };
 
 // Adapts GcsRpcClient to SubscriberClientInterface for making RPC calls. Thread safe.
 class CallbackSubscriberClient final : public pubsub::SubscriberClientInterface {
  public:
   explicit CallbackSubscriberClient(const std::string &address) {
-    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
-    stub_ = rpc::SubscriberService::NewStub(std::move(channel));
+    channel_ = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    stub_ = rpc::SubscriberService::NewStub(channel_);
   }
 
   ~CallbackSubscriberClient() final = default;
@@ -128,7 +162,10 @@ class CallbackSubscriberClient final : public pubsub::SubscriberClientInterface
         });
   }
 
+  std::shared_ptr<grpc::Channel> PubsubStreamChannel() final { return channel_; }
+
  private:
+  std::shared_ptr<grpc::Channel> channel_;
   std::unique_ptr<rpc::SubscriberService::Stub> stub_;
 };
 
@@ -170,7 +207,8 @@ class IntegrationTest : public ::testing::Test {
         /*get_time_ms=*/[]() -> double { return absl::ToUnixMicros(absl::Now()); },
         /*subscriber_timeout_ms=*/absl::ToInt64Microseconds(absl::Seconds(30)),
         /*batch_size=*/100);
-    subscriber_service_ = std::make_unique<SubscriberServiceImpl>(std::move(publisher));
+    subscriber_service_ =
+        std::make_unique<SubscriberServiceImpl>(std::move(publisher), *io_service_.Get());
 
     grpc::EnableDefaultHealthCheckService(true);
     grpc::ServerBuilder builder;
@@ -301,5 +339,321 @@ TEST_F(IntegrationTest, SubscribersToOneIDAndAllIDs) {
     absl::SleepFor(absl::Seconds(1));
   }
 }
+
+class ScopedPubsubStream {
+ public:
+  ScopedPubsubStream() : prev_enabled_(RayConfig::instance().pubsub_use_bidi_stream()) {
+    RayConfig::instance().pubsub_use_bidi_stream() = true;
+  }
+
+  ~ScopedPubsubStream() {
+    RayConfig::instance().pubsub_use_bidi_stream() = prev_enabled_;
+  }
+
+ private:
+  const bool prev_enabled_;
+};
+
+TEST_F(IntegrationTest, SubscribeThroughStream) {
+  ScopedPubsubStream pubsub_stream;
+  const std::string subscribed_actor =
+      ActorID::FromHex("f4ce02420592ca68c1738a0d01000000").Binary();
+  absl::BlockingCounter counter(1);
+  absl::Mutex mu;
+
+  std::vector<rpc::ActorTableData> actors;
+  auto subscriber = CreateSubscriber();
+  subscriber->Subscribe(
+      std::make_unique<rpc::SubMessage>(),
+      rpc::ChannelType::GCS_ACTOR_CHANNEL,
+      address_proto_,
+      subscribed_actor,
+      /*subscribe_done_callback=*/
+      [&counter](Status status) {
+        RAY_CHECK_OK(status);
+        counter.DecrementCount();
+      },
+      /*subscribe_item_callback=*/
+      [&mu, &actors](const rpc::PubMessage &msg) {
+        absl::MutexLock lock(&mu);
+        actors.push_back(msg.actor_message());
+      },
+      /*subscription_failure_callback=*/
+      [](const std::string &, const Status &status) { RAY_CHECK_OK(status); });
+
+  // Wait for subscriptions done before trying to publish.
+  counter.Wait();
+  {
+    absl::MutexLock lock(&subscriber->mutex_);
+    ASSERT_EQ(subscriber->publisher_streams_.size(), 1);
+  }
+
+  for (int i = 0; i < 3; i++) {
+    rpc::PubMessage msg;
+    msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+    msg.set_key_id(subscribed_actor);
+    msg.mutable_actor_message()->set_actor_id(subscribed_actor);
+    msg.mutable_actor_message()->set_name(absl::StrCat("test actor ", i));
+    subscriber_service_->GetPublisher().Publish(msg);
+  }
+
+  {
+    absl::MutexLock lock(&mu);
+    auto received_all = [&mu, &actors]() {
+      mu.AssertReaderHeld();  // For annotalysis.
+      return actors.size() == 3;
+    };
+    if (!mu.AwaitWithTimeout(absl::Condition(&received_all), absl::Seconds(10))) {
+      FAIL() << "Subscriber did not receive the published messages through the stream.";
+    }
+    for (int i = 0; i < 3; i++) {
+      EXPECT_EQ(actors[i].name(), absl::StrCat("test actor ", i));
+    }
+  }
+
+  // Unsubscribing cancels the stream, which cleans up the subscriber.
+  subscriber->Unsubscribe(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, address_proto_, subscribed_actor);
+  int wait_count = 0;
+  while (!subscriber->CheckNoLeaks()) {
+    ASSERT_LT(wait_count, 60) << "Subscriber still has inflight operations after 60s";
+    ++wait_count;
+    absl::SleepFor(absl::Seconds(1));
+  }
+}
+
+TEST_F(IntegrationTest, StreamReopenedAfterFailure) {
+  ScopedPubsubStream pubsub_stream;
+  const std::string subscribed_actor =
+      ActorID::FromHex("f4ce02420592ca68c1738a0d01000000").Binary();
+  // The stream breaks a few times, as if the publisher wasn't ready yet.
+  subscriber_service_->RejectStreams(2, grpc::StatusCode::UNAVAILABLE);
+  absl::BlockingCounter counter(1);
+  absl::Mutex mu;
+  std::vector<rpc::ActorTableData> actors;
+  auto subscriber = CreateSubscriber();
+  subscriber->Subscribe(
+      std::make_unique<rpc::SubMessage>(),
+      rpc::ChannelType::GCS_ACTOR_CHANNEL,
+      address_proto_,
+      subscribed_actor,
+      /*subscribe_done_callback=*/
+      [&counter](Status status) {
+        RAY_CHECK_OK(status);
+        counter.DecrementCount();
+      },
+      /*subscribe_item_callback=*/
+      [&mu, &actors](const rpc::PubMessage &msg) {
+        absl::MutexLock lock(&mu);
+        actors.push_back(msg.actor_message());
+      },
+      /*subscription_failure_callback=*/
+      [](const std::string &, const Status &status) { RAY_CHECK_OK(status); });
+  counter.Wait();
+
+  rpc::PubMessage msg;
+  msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+  msg.set_key_id(subscribed_actor);
+  msg.mutable_actor_message()->set_actor_id(subscribed_actor);
+  subscriber_service_->GetPublisher().Publish(msg);
+  {
+    absl::MutexLock lock(&mu);
+    auto received = [&mu, &actors]() {
+      mu.AssertReaderHeld();  // For annotalysis.
+      return actors.size() == 1;
+    };
+    if (!mu.AwaitWithTimeout(absl::Condition(&received), absl::Seconds(10))) {
+      FAIL() << "Subscriber did not receive the published message.";
+    }
+  }
+
+  // The message is received through a reopened stream, rather than long polling.
+  {
+    absl::MutexLock lock(&subscriber->mutex_);
+    ASSERT_EQ(subscriber->publisher_streams_.size(), 1);
+    ASSERT_TRUE(subscriber->stream_failures_.empty());
+    ASSERT_TRUE(subscriber->publishers_without_stream_.empty());
+  }
+
+  subscriber->Unsubscribe(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, address_proto_, subscribed_actor);
+  int wait_count = 0;
+  while (!subscriber->CheckNoLeaks()) {
+    ASSERT_LT(wait_count, 60) << "Subscriber still has inflight operations after 60s";
+    ++wait_count;
+    absl::SleepFor(absl::Seconds(1));
+  }
+}
+
+TEST_F(IntegrationTest, LongPollingWhenStreamIsUnimplemented) {
+  ScopedPubsubStream pubsub_stream;
+  const std::string subscribed_actor =
+      ActorID::FromHex("f4ce02420592ca68c1738a0d01000000").Binary();
+  subscriber_service_->RejectStreams(1, grpc::StatusCode::UNIMPLEMENTED);
+  absl::BlockingCounter counter(1);
+  absl::Mutex mu;
+  std::vector<rpc::ActorTableData> actors;
+  auto subscriber = CreateSubscriber();
+  subscriber->Subscribe(
+      std::make_unique<rpc::SubMessage>(),
+      rpc::ChannelType::GCS_ACTOR_CHANNEL,
+      address_proto_,
+      subscribed_actor,
+      /*subscribe_done_callback=*/
+      [&counter](Status status) {
+        RAY_CHECK_OK(status);
+        counter.DecrementCount();
+      },
+      /*subscribe_item_callback=*/
+      [&mu, &actors](const rpc::PubMessage &msg) {
+        absl::MutexLock lock(&mu);
+        actors.push_back(msg.actor_message());
+      },
+      /*subscription_failure_callback=*/
+      [](const std::string &, const Status &status) { RAY_CHECK_OK(status); });
+  counter.Wait();
+
+  // The subscriber moves to long polling, and stays there.
+  for (int i = 0; i < 2; i++) {
+    rpc::PubMessage msg;
+    msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+    msg.set_key_id(subscribed_actor);
+    msg.mutable_actor_message()->set_actor_id(subscribed_actor);
+    subscriber_service_->GetPublisher().Publish(msg);
+    absl::MutexLock lock(&mu);
+    auto received = [&mu, &actors, i]() {
+      mu.AssertReaderHeld();  // For annotalysis.
+      return actors.size() == static_cast<size_t>(i + 1);
+    };
+    if (!mu.AwaitWithTimeout(absl::Condition(&received), absl::Seconds(10))) {
+      FAIL() << "Subscriber did not receive the published message.";
+    }
+  }
+  {
+    absl::MutexLock lock(&subscriber->mutex_);
+    ASSERT_TRUE(subscriber->publisher_streams_.empty());
+    ASSERT_EQ(subscriber->publishers_without_stream_.size(), 1);
+  }
+
+  subscriber->Unsubscribe(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, address_proto_, subscribed_actor);
+  int wait_count = 0;
+  while (!subscriber->CheckNoLeaks()) {
+    // Flush the inflight long polling.
+    subscriber_service_->GetPublisher().UnregisterAll();
+    ASSERT_LT(wait_count, 60) << "Subscriber still has inflight operations after 60s";
+    ++wait_count;
+    absl::SleepFor(absl::Seconds(1));
+  }
+}
+
+TEST_F(IntegrationTest, StreamClosedBySubscriber) {
+  const std::string subscribed_actor =
+      ActorID::FromHex("f4ce02420592ca68c1738a0d01000000").Binary();
+  const auto subscriber_id = UniqueID::FromRandom();
+  auto &publisher = subscriber_service_->GetPublisher();
+  publisher.RegisterSubscription(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, subscriber_id, subscribed_actor);
+  auto publish = [&publisher, &subscribed_actor]() {
+    rpc::PubMessage msg;
+    msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+    msg.set_key_id(subscribed_actor);
+    msg.mutable_actor_message()->set_actor_id(subscribed_actor);
+    publisher.Publish(msg);
+  };
+  auto stream_attached = [&publisher, &subscriber_id]() {
+    absl::MutexLock lock(&publisher.mutex_);
+    return publisher.subscribers_.at(subscriber_id)->StreamExists();
+  };
+
+  auto stub = rpc::SubscriberService::NewStub(
+      grpc::CreateChannel(address_, grpc::InsecureChannelCredentials()));
+  auto context = std::make_unique<grpc::ClientContext>();
+  auto stream = stub->PubsubStream(context.get());
+  rpc::PubsubLongPollingRequest request;
+  request.set_subscriber_id(subscriber_id.Binary());
+  ASSERT_TRUE(stream->Write(request));
+  publish();
+  rpc::PubsubLongPollingReply reply;
+  ASSERT_TRUE(stream->Read(&reply));
+  ASSERT_EQ(reply.pub_messages_size(), 1);
+  ASSERT_TRUE(stream_attached());
+
+  // The subscriber goes away in the middle of the stream, with messages being pushed
+  // and none of them acknowledged.
+  publish();
+  context->TryCancel();
+  for (int i = 0; i < 10; i++) {
+    publish();
+  }
+  int wait_count = 0;
+  while (stream_attached()) {
+    ASSERT_LT(wait_count, 100) << "The stream is still attached after 10s";
+    ++wait_count;
+    absl::SleepFor(absl::Milliseconds(100));
+  }
+  stream.reset();
+  context.reset();
+
+  // The messages are kept for the subscriber to poll for them, and publishing goes on.
+  publish();
+  {
+    absl::MutexLock lock(&publisher.mutex_);
+    ASSERT_FALSE(publisher.subscribers_.at(subscriber_id)->CheckNoLeaks());
+  }
+  publisher.UnregisterAll();
+  ASSERT_TRUE(publisher.CheckNoLeaks());
+}
+
+TEST_F(IntegrationTest, SubscriberUnregisteredWhileWriting) {
+  const std::string subscribed_actor =
+      ActorID::FromHex("f4ce02420592ca68c1738a0d01000000").Binary();
+  const auto subscriber_id = UniqueID::FromRandom();
+  auto &publisher = subscriber_service_->GetPublisher();
+  publisher.RegisterSubscription(
+      rpc::ChannelType::GCS_ACTOR_CHANNEL, subscriber_id, subscribed_actor);
+
+  auto stub = rpc::SubscriberService::NewStub(
+      grpc::CreateChannel(address_, grpc::InsecureChannelCredentials()));
+  grpc::ClientContext context;
+  auto stream = stub->PubsubStream(&context);
+  rpc::PubsubLongPollingRequest request;
+  request.set_subscriber_id(subscriber_id.Binary());
+  ASSERT_TRUE(stream->Write(request));
+  int wait_count = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&publisher.mutex_);
+      if (publisher.subscribers_.at(subscriber_id)->StreamExists()) {
+        break;
+      }
+    }
+    ASSERT_LT(wait_count, 100) << "The stream is not attached after 10s";
+    ++wait_count;
+    absl::SleepFor(absl::Milliseconds(100));
+  }
+
+  // The message is larger than the flow control window, so its write stays in flight
+  // until the subscriber reads it.
+  const std::string name(2 * 1024 * 1024, 'a');
+  rpc::PubMessage msg;
+  msg.set_channel_type(rpc::ChannelType::GCS_ACTOR_CHANNEL);
+  msg.set_key_id(subscribed_actor);
+  msg.mutable_actor_message()->set_actor_id(subscribed_actor);
+  msg.mutable_actor_message()->set_name(name);
+  publisher.Publish(msg);
+  absl::SleepFor(absl::Milliseconds(100));
+
+  // The subscriber state is gone before the write is done, but the reply is still
+  // delivered in full, and the stream is finished after it.
+  ASSERT_TRUE(publisher.UnregisterSubscriber(subscriber_id));
+  rpc::PubsubLongPollingReply reply;
+  ASSERT_TRUE(stream->Read(&reply));
+  ASSERT_EQ(reply.pub_messages_size(), 1);
+  ASSERT_EQ(reply.pub_messages(0).actor_message().name(), name);
+  ASSERT_FALSE(stream->Read(&reply));
+  ASSERT_TRUE(stream->Finish().ok());
+  ASSERT_TRUE(publisher.CheckNoLeaks());
+}
 }  // namespace pubsub
 }  // namespace ray
@@ -1267,6 +1267,363 @@ TEST_F(PublisherTest, TestMaxMessageSize) {
   }
 }
 
+class ScopedSerializeMessagesOnce {
+ public:
+  explicit ScopedSerializeMessagesOnce(bool enabled)
+      : prev_enabled_(RayConfig::instance().publisher_serialize_messages_once()) {
+    RayConfig::instance().publisher_serialize_messages_once() = enabled;
+  }
+
+  ~ScopedSerializeMessagesOnce() {
+    RayConfig::instance().publisher_serialize_messages_once() = prev_enabled_;
+  }
+
+ private:
+  const bool prev_enabled_;
+};
+
+TEST_F(PublisherTest, TestSerializeMessagesOnce) {
+  ScopedSerializeMessagesOnce serialize_once(true);
+  const std::string job_id = JobID::FromInt(1234).Binary();
+  const int num_subscribers = 3;
+
+  std::vector<rpc::PubsubLongPollingRequest> requests(num_subscribers);
+  std::vector<rpc::PubsubLongPollingReply> replies(num_subscribers);
+  // The replies as parsed by the subscribers, after going through the wire.
+  std::vector<rpc::PubsubLongPollingReply> received(num_subscribers);
+  for (int i = 0; i < num_subscribers; i++) {
+    const auto subscriber_id = SubscriberID::FromRandom();
+    requests[i].set_subscriber_id(subscriber_id.Binary());
+    requests[i].set_publisher_id(kDefaultPublisherId.Binary());
+    publisher_->RegisterSubscription(
+        rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id, job_id);
+  }
+  auto connect = [&](int i) {
+    replies[i].Clear();
+    publisher_->ConnectToSubscriber(
+        requests[i],
+        &replies[i],
+        [&replies, &received, i](Status status,
+                                 std::function<void()> success,
+                                 std::function<void()> failure) {
+          ASSERT_TRUE(received[i].ParseFromString(replies[i].SerializeAsString()));
+        });
+  };
+
+  for (int i = 0; i < num_subscribers; i++) {
+    connect(i);
+  }
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "first"));
+  for (int i = 0; i < num_subscribers; i++) {
+    // The message is stitched in as serialized bytes, so it only shows up once parsed.
+    ASSERT_EQ(replies[i].pub_messages_size(), 0);
+    ASSERT_EQ(received[i].pub_messages_size(), 1);
+    ASSERT_EQ(received[i].publisher_id(), kDefaultPublisherId.Binary());
+    const auto &msg = received[i].pub_messages(0);
+    ASSERT_EQ(msg.key_id(), job_id);
+    ASSERT_EQ(msg.error_info_message().error_message(), "first");
+    requests[i].set_max_processed_sequence_id(msg.sequence_id());
+  }
+
+  // Messages queued while disconnected are batched into the next reply.
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "second"));
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "third"));
+  for (int i = 0; i < num_subscribers; i++) {
+    connect(i);
+    ASSERT_EQ(received[i].pub_messages_size(), 2);
+    ASSERT_EQ(received[i].pub_messages(0).error_info_message().error_message(),
+              "second");
+    ASSERT_EQ(received[i].pub_messages(1).error_info_message().error_message(),
+              "third");
+    requests[i].set_max_processed_sequence_id(received[i].pub_messages(1).sequence_id());
+  }
+
+  // Acknowledged messages are not sent again.
+  for (int i = 0; i < num_subscribers; i++) {
+    connect(i);
+  }
+  publisher_->UnregisterAll();
+  for (int i = 0; i < num_subscribers; i++) {
+    ASSERT_EQ(received[i].pub_messages_size(), 0);
+  }
+  ASSERT_TRUE(publisher_->CheckNoLeaks());
+}
+
+TEST_F(PublisherTest, TestMixedSerializedMessagesKeepOrder) {
+  const std::string job_id = JobID::FromInt(1234).Binary();
+  const auto subscriber_id = SubscriberID::FromRandom();
+  rpc::PubsubLongPollingRequest request;
+  request.set_subscriber_id(subscriber_id.Binary());
+  request.set_publisher_id(kDefaultPublisherId.Binary());
+  publisher_->RegisterSubscription(
+      rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id, job_id);
+
+  // Only the second message is serialized once, while the others are queued as is.
+  for (const auto &[message, serialize_once] :
+       std::vector<std::pair<std::string, bool>>{
+           {"first", false}, {"second", true}, {"third", false}}) {
+    ScopedSerializeMessagesOnce serialize_once_config(serialize_once);
+    publisher_->Publish(GenerateErrorInfoMessage(job_id, message));
+  }
+
+  rpc::PubsubLongPollingReply reply;
+  rpc::PubsubLongPollingReply received;
+  publisher_->ConnectToSubscriber(
+      request,
+      &reply,
+      [&reply, &received](Status status,
+                          std::function<void()> success,
+                          std::function<void()> failure) {
+        ASSERT_TRUE(received.ParseFromString(reply.SerializeAsString()));
+      });
+  ASSERT_EQ(received.pub_messages_size(), 3);
+  ASSERT_EQ(received.pub_messages(0).error_info_message().error_message(), "first");
+  ASSERT_EQ(received.pub_messages(1).error_info_message().error_message(), "second");
+  ASSERT_EQ(received.pub_messages(2).error_info_message().error_message(), "third");
+  publisher_->UnregisterAll();
+}
+
+TEST_F(PublisherTest, TestMaxBufferSizeSerializeMessagesOnce) {
+  ScopedSerializeMessagesOnce serialize_once(true);
+  ScopedEntityBufferMaxBytes max_bytes(20000);
+
+  SubscriptionIndex subscription_index(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+  auto job_id = JobID::FromInt(1234);
+  auto *subscriber = CreateSubscriber();
+  subscription_index.AddEntry(job_id.Binary(), subscriber);
+
+  rpc::PubMessage pub_message;
+  pub_message.set_key_id(job_id.Binary());
+  pub_message.set_channel_type(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+  for (char c : {'a', 'b', 'c'}) {
+    pub_message.set_sequence_id(GetNextSequenceId());
+    pub_message.mutable_error_info_message()->set_error_message(std::string(4000, c));
+    EXPECT_TRUE(
+        subscription_index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  }
+  // Each message is buffered with its serialized bytes, so only two fit and the first
+  // one is dropped.
+  const int64_t message_size = pub_message.ByteSizeLong();
+  EXPECT_EQ(subscription_index.GetNumBufferedBytes(), 2 * 2 * message_size);
+
+  auto reply = FlushSubscriber(subscriber);
+  rpc::PubsubLongPollingReply received;
+  ASSERT_TRUE(received.ParseFromString(reply->SerializeAsString()));
+  ASSERT_EQ(received.pub_messages().size(), 2);
+  EXPECT_EQ(received.pub_messages(0).error_info_message().error_message(),
+            std::string(4000, 'b'));
+  EXPECT_EQ(received.pub_messages(1).error_info_message().error_message(),
+            std::string(4000, 'c'));
+}
+
+class ScopedCoalescedChannels {
+ public:
+  explicit ScopedCoalescedChannels(std::vector<std::string> channels)
+      : prev_channels_(RayConfig::instance().publisher_coalesced_channels()) {
+    RayConfig::instance().publisher_coalesced_channels() = std::move(channels);
+  }
+
+  ~ScopedCoalescedChannels() {
+    RayConfig::instance().publisher_coalesced_channels() = prev_channels_;
+  }
+
+ private:
+  const std::vector<std::string> prev_channels_;
+};
+
+TEST_F(PublisherTest, TestCoalescedChannel) {
+  ScopedCoalescedChannels coalesced_channels({"RAY_ERROR_INFO_CHANNEL"});
+  SubscriptionIndex coalesced_index(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+  SubscriptionIndex regular_index(rpc::ChannelType::RAY_LOG_CHANNEL);
+
+  auto *subscriber_to_all = CreateSubscriber();
+  auto *subscriber_to_key = CreateSubscriber();
+  auto *regular_subscriber = CreateSubscriber();
+  coalesced_index.AddEntry("", subscriber_to_all);
+  coalesced_index.AddEntry("a", subscriber_to_key);
+  regular_index.AddEntry("", regular_subscriber);
+
+  auto publish = [this](SubscriptionIndex &index,
+                        const std::string &key_id,
+                        const std::string &text) {
+    rpc::PubMessage pub_message;
+    pub_message.set_key_id(key_id);
+    pub_message.set_channel_type(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+    pub_message.mutable_error_info_message()->set_error_message(text);
+    pub_message.set_sequence_id(GetNextSequenceId());
+    EXPECT_TRUE(index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  };
+  for (auto *index : {&coalesced_index, &regular_index}) {
+    publish(*index, "a", "a1");
+    publish(*index, "b", "b1");
+    publish(*index, "a", "a2");
+    publish(*index, "a", "a3");
+  }
+
+  // Only the latest message of each key is delivered, in publish order.
+  auto reply = FlushSubscriber(subscriber_to_all);
+  ASSERT_EQ(reply->pub_messages_size(), 2);
+  ASSERT_EQ(reply->pub_messages(0).error_info_message().error_message(), "b1");
+  ASSERT_EQ(reply->pub_messages(1).error_info_message().error_message(), "a3");
+  const int64_t max_processed_seq_id = reply->pub_messages(1).sequence_id();
+
+  reply = FlushSubscriber(subscriber_to_key);
+  ASSERT_EQ(reply->pub_messages_size(), 1);
+  ASSERT_EQ(reply->pub_messages(0).error_info_message().error_message(), "a3");
+  ASSERT_EQ(coalesced_index.GetNumCoalescedMessages(), 2);
+
+  // Other channels still deliver every message.
+  reply = FlushSubscriber(regular_subscriber);
+  ASSERT_EQ(reply->pub_messages_size(), 4);
+  ASSERT_EQ(regular_index.GetNumCoalescedMessages(), 0);
+
+  // Once acknowledged, the messages are released, and a new message of the same key
+  // is delivered as is.
+  FlushSubscriber(subscriber_to_all, max_processed_seq_id);
+  FlushSubscriber(subscriber_to_key, max_processed_seq_id);
+  ASSERT_TRUE(subscriber_to_all->CheckNoLeaks());
+  ASSERT_TRUE(subscriber_to_key->CheckNoLeaks());
+  publish(coalesced_index, "a", "a4");
+  reply = FlushSubscriber(subscriber_to_key, max_processed_seq_id);
+  ASSERT_EQ(reply->pub_messages_size(), 1);
+  ASSERT_EQ(reply->pub_messages(0).error_info_message().error_message(), "a4");
+  ASSERT_EQ(coalesced_index.GetNumCoalescedMessages(), 2);
+}
+
+TEST_F(PublisherTest, TestCoalescedChannelSerializeMessagesOnce) {
+  ScopedCoalescedChannels coalesced_channels({"RAY_ERROR_INFO_CHANNEL"});
+  ScopedSerializeMessagesOnce serialize_once(true);
+  SubscriptionIndex index(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+  auto *subscriber = CreateSubscriber();
+  index.AddEntry("a", subscriber);
+
+  rpc::PubMessage pub_message;
+  pub_message.set_key_id("a");
+  pub_message.set_channel_type(rpc::ChannelType::RAY_ERROR_INFO_CHANNEL);
+  for (const std::string text : {"a1", "a2"}) {
+    pub_message.mutable_error_info_message()->set_error_message(text);
+    pub_message.set_sequence_id(GetNextSequenceId());
+    EXPECT_TRUE(index.Publish(std::make_shared<rpc::PubMessage>(pub_message)));
+  }
+
+  // The coalesced message is skipped along with its serialized bytes.
+  auto reply = FlushSubscriber(subscriber);
+  rpc::PubsubLongPollingReply received;
+  ASSERT_TRUE(received.ParseFromString(reply->SerializeAsString()));
+  ASSERT_EQ(received.pub_messages_size(), 1);
+  ASSERT_EQ(received.pub_messages(0).error_info_message().error_message(), "a2");
+  ASSERT_EQ(index.GetNumCoalescedMessages(), 1);
+}
+
+class FakeSubscriberStream : public SubscriberStream {
+ public:
+  void Write(rpc::PubsubLongPollingReply reply) override {
+    ASSERT_FALSE(write_in_flight);
+    write_in_flight = true;
+    replies.push_back(std::move(reply));
+  }
+
+  void Close() override { closed = true; }
+
+  bool IsFinished() const override { return closed || broken; }
+
+  std::vector<rpc::PubsubLongPollingReply> replies;
+  bool write_in_flight = false;
+  bool closed = false;
+  bool broken = false;
+};
+
+TEST_F(PublisherTest, TestStream) {
+  const std::string job_id = JobID::FromInt(1234).Binary();
+  publisher_->RegisterSubscription(
+      rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id_, job_id);
+  auto write_done = [this](FakeSubscriberStream &stream) {
+    stream.write_in_flight = false;
+    publisher_->HandleStreamWriteDone(subscriber_id_, &stream, /*ok=*/true);
+  };
+
+  FakeSubscriberStream stream;
+  publisher_->HandleStreamRequest(request_, &stream);
+  ASSERT_TRUE(stream.replies.empty());
+
+  // Messages are pushed as soon as they are published, one write at a time.
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "first"));
+  ASSERT_EQ(stream.replies.size(), 1);
+  ASSERT_EQ(stream.replies[0].publisher_id(), kDefaultPublisherId.Binary());
+  ASSERT_EQ(stream.replies[0].pub_messages_size(), 1);
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "second"));
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "third"));
+  ASSERT_EQ(stream.replies.size(), 1);
+  write_done(stream);
+  ASSERT_EQ(stream.replies.size(), 2);
+  ASSERT_EQ(stream.replies[1].pub_messages_size(), 2);
+  write_done(stream);
+  ASSERT_EQ(stream.replies.size(), 2);
+
+  // The subscriber is alive as long as the stream is attached.
+  request_.set_max_processed_sequence_id(stream.replies[0].pub_messages(0).sequence_id());
+  publisher_->HandleStreamRequest(request_, &stream);
+  current_time_ += subscriber_timeout_ms_ * 3;
+  publisher_->CheckDeadSubscribers();
+  ASSERT_TRUE(publisher_->subscribers_.contains(subscriber_id_));
+
+  // Messages which are not acknowledged are sent again through the next stream.
+  publisher_->DisconnectStream(subscriber_id_, &stream);
+  FakeSubscriberStream new_stream;
+  publisher_->HandleStreamRequest(request_, &new_stream);
+  ASSERT_EQ(new_stream.replies.size(), 1);
+  ASSERT_EQ(new_stream.replies[0].pub_messages_size(), 2);
+  ASSERT_EQ(new_stream.replies[0].pub_messages(0).error_info_message().error_message(),
+            "second");
+
+  // Writes to the detached stream are ignored, and a newer stream closes the old one.
+  write_done(stream);
+  ASSERT_EQ(stream.replies.size(), 2);
+  FakeSubscriberStream newer_stream;
+  publisher_->HandleStreamRequest(request_, &newer_stream);
+  ASSERT_TRUE(new_stream.closed);
+  ASSERT_EQ(newer_stream.replies.size(), 1);
+
+  request_.set_max_processed_sequence_id(
+      newer_stream.replies[0].pub_messages(1).sequence_id());
+  publisher_->HandleStreamRequest(request_, &newer_stream);
+  publisher_->UnregisterAll();
+  ASSERT_TRUE(newer_stream.closed);
+  ASSERT_TRUE(publisher_->CheckNoLeaks());
+}
+
+TEST_F(PublisherTest, TestFinishedStreamIsNotActive) {
+  const std::string job_id = JobID::FromInt(1234).Binary();
+  publisher_->RegisterSubscription(
+      rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id_, job_id);
+  FakeSubscriberStream stream;
+  publisher_->HandleStreamRequest(request_, &stream);
+  publisher_->Publish(GenerateErrorInfoMessage(job_id, "first"));
+  ASSERT_EQ(stream.replies.size(), 1);
+  auto *subscriber = publisher_->subscribers_.at(subscriber_id_).get();
+  ASSERT_TRUE(subscriber->IsActive());
+
+  // The subscriber is gone while a write is in flight. The stream is still attached
+  // until its reactions are handled, but it no longer keeps the subscriber alive.
+  stream.broken = true;
+  current_time_ += subscriber_timeout_ms_ * 3;
+  ASSERT_TRUE(subscriber->StreamExists());
+  ASSERT_FALSE(subscriber->IsActive());
+  publisher_->CheckDeadSubscribers();
+  ASSERT_FALSE(publisher_->subscribers_.contains(subscriber_id_));
+
+  // The same for a stream closed by the publisher.
+  publisher_->RegisterSubscription(
+      rpc::ChannelType::RAY_ERROR_INFO_CHANNEL, subscriber_id_, job_id);
+  FakeSubscriberStream closed_stream;
+  publisher_->HandleStreamRequest(request_, &closed_stream);
+  subscriber = publisher_->subscribers_.at(subscriber_id_).get();
+  ASSERT_TRUE(subscriber->IsActive());
+  closed_stream.Close();
+  current_time_ += subscriber_timeout_ms_ * 3;
+  ASSERT_FALSE(subscriber->IsActive());
+}
+
 }  // namespace pubsub
 
 }  // namespace ray
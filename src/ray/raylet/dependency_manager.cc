@@ -230,6 +230,42 @@ void DependencyManager::RemoveTaskDependencies(const TaskID &task_id) {
   queued_task_requests_.erase(task_entry);
 }
 
+void DependencyManager::PrefetchTaskDependencies(
+    const TaskID &task_id,
+    const std::vector<rpc::ObjectReference> &required_objects,
+    const TaskMetricsKey &task_key) {
+  if (prefetch_requests_.contains(task_id)) {
+    return;
+  }
+
+  std::vector<rpc::ObjectReference> missing_objects;
+  for (const auto &ref : required_objects) {
+    if (!local_objects_.count(ObjectRefToId(ref))) {
+      missing_objects.push_back(ref);
+    }
+  }
+  if (missing_objects.empty()) {
+    return;
+  }
+
+  const uint64_t request_id =
+      object_manager_.Pull(missing_objects, BundlePriority::PREFETCH, task_key);
+  RAY_LOG(DEBUG) << "Started prefetch for dependencies of task " << task_id
+                 << " request: " << request_id;
+  prefetch_requests_.emplace(task_id, request_id);
+}
+
+void DependencyManager::CancelTaskDependenciesPrefetch(const TaskID &task_id) {
+  auto it = prefetch_requests_.find(task_id);
+  if (it == prefetch_requests_.end()) {
+    return;
+  }
+  RAY_LOG(DEBUG) << "Canceling prefetch for dependencies of task " << task_id
+                 << " request: " << it->second;
+  object_manager_.CancelPull(it->second);
+  prefetch_requests_.erase(it);
+}
+
 std::vector<TaskID> DependencyManager::HandleObjectMissing(
     const ray::ObjectID &object_id) {
   RAY_CHECK(local_objects_.erase(object_id))
@@ -320,6 +356,7 @@ std::string DependencyManager::DebugString() const {
   std::stringstream result;
   result << "TaskDependencyManager:";
   result << "\n- task deps map size: " << queued_task_requests_.size();
+  result << "\n- prefetch req map size: " << prefetch_requests_.size();
   result << "\n- get req map size: " << get_requests_.size();
   result << "\n- wait req map size: " << wait_requests_.size();
   result << "\n- local objects map size: " << local_objects_.size();
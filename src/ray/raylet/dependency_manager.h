@@ -33,6 +33,11 @@ class TaskDependencyManagerInterface {
       const std::vector<rpc::ObjectReference> &required_objects,
       const TaskMetricsKey &task_key) = 0;
   virtual void RemoveTaskDependencies(const TaskID &task_id) = 0;
+  virtual void PrefetchTaskDependencies(
+      const TaskID &task_id,
+      const std::vector<rpc::ObjectReference> &required_objects,
+      const TaskMetricsKey &task_key) = 0;
+  virtual void CancelTaskDependenciesPrefetch(const TaskID &task_id) = 0;
   virtual bool TaskDependenciesBlocked(const TaskID &task_id) const = 0;
   virtual bool CheckObjectLocal(const ObjectID &object_id) const = 0;
   virtual ~TaskDependencyManagerInterface(){};
@@ -167,6 +172,24 @@ class DependencyManager : public TaskDependencyManagerInterface {
   /// \return Void.
   void RemoveTaskDependencies(const TaskID &task_id);
 
+  /// Start pulling the arguments of a task that has not been scheduled yet, at
+  /// the lowest pull priority. Unlike RequestTaskDependencies, this does not
+  /// track when the objects become local and the pull may be deactivated at any
+  /// time to make room for other requests. Calling this for a task that is
+  /// already being prefetched is a no-op.
+  ///
+  /// \param task_id The task that requires the objects.
+  /// \param required_objects The objects required by the task.
+  /// \param task_key The task name / is_retry tuple used for metrics tracking.
+  void PrefetchTaskDependencies(const TaskID &task_id,
+                                const std::vector<rpc::ObjectReference> &required_objects,
+                                const TaskMetricsKey &task_key);
+
+  /// Cancel the prefetch of a task's arguments, if any.
+  ///
+  /// \param task_id The task whose arguments were prefetched.
+  void CancelTaskDependenciesPrefetch(const TaskID &task_id);
+
   /// Handle an object becoming locally available.
   ///
   /// \param object_id The object ID of the object to mark as locally
@@ -289,6 +312,10 @@ class DependencyManager : public TaskDependencyManagerInterface {
   /// dependencies are all local or not.
   absl::flat_hash_map<TaskID, std::unique_ptr<TaskDependencies>> queued_task_requests_;
 
+  /// A map from the ID of a task that is not scheduled yet to the pull request
+  /// ID used to prefetch its arguments.
+  absl::flat_hash_map<TaskID, uint64_t> prefetch_requests_;
+
   /// A map from worker ID to the set of objects that the worker called
   /// `ray.get` on and a pull request ID for these objects. The pull request ID
   /// should be used to cancel the pull request in the object manager once the
@@ -38,6 +38,8 @@ class MockObjectManager : public ObjectManagerInterface {
       active_get_requests.insert(req_id);
     } else if (prio == BundlePriority::WAIT_REQUEST) {
       active_wait_requests.insert(req_id);
+    } else if (prio == BundlePriority::PREFETCH) {
+      active_prefetch_requests.insert(req_id);
     } else {
       active_task_requests.insert(req_id);
     }
@@ -47,13 +49,15 @@ class MockObjectManager : public ObjectManagerInterface {
   void CancelPull(uint64_t request_id) {
     ASSERT_TRUE(active_get_requests.erase(request_id) ||
                 active_wait_requests.erase(request_id) ||
-                active_task_requests.erase(request_id));
+                active_task_requests.erase(request_id) ||
+                active_prefetch_requests.erase(request_id));
   }
 
   bool PullRequestActiveOrWaitingForMetadata(uint64_t request_id) const {
     return active_get_requests.count(request_id) ||
            active_wait_requests.count(request_id) ||
-           active_task_requests.count(request_id);
+           active_task_requests.count(request_id) ||
+           active_prefetch_requests.count(request_id);
   }
 
   int64_t PullManagerNumInactivePullsByTaskName(const TaskMetricsKey &task_key) const {
@@ -64,6 +68,7 @@ class MockObjectManager : public ObjectManagerInterface {
   std::unordered_set<uint64_t> active_get_requests;
   std::unordered_set<uint64_t> active_wait_requests;
   std::unordered_set<uint64_t> active_task_requests;
+  std::unordered_set<uint64_t> active_prefetch_requests;
 };
 
 class DependencyManagerTest : public ::testing::Test {
@@ -82,11 +87,13 @@ class DependencyManagerTest : public ::testing::Test {
     ASSERT_TRUE(dependency_manager_.queued_task_requests_.empty());
     ASSERT_TRUE(dependency_manager_.get_requests_.empty());
     ASSERT_TRUE(dependency_manager_.wait_requests_.empty());
+    ASSERT_TRUE(dependency_manager_.prefetch_requests_.empty());
     ASSERT_TRUE(dependency_manager_.waiting_tasks_counter_.Total() == 0);
     // All pull requests are canceled.
     ASSERT_TRUE(object_manager_mock_.active_task_requests.empty());
     ASSERT_TRUE(object_manager_mock_.active_get_requests.empty());
     ASSERT_TRUE(object_manager_mock_.active_wait_requests.empty());
+    ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
   }
 
   MockObjectManager object_manager_mock_;
@@ -388,6 +395,44 @@ TEST_F(DependencyManagerTest, TestRemoveTaskDependenciesBeforeLocal) {
   AssertNoLeaks();
 }
 
+/// Test that prefetching a task's arguments pulls only the missing objects, does
+/// not count the task as waiting, and is independent of the task's own request.
+TEST_F(DependencyManagerTest, TestPrefetchTaskDependencies) {
+  ObjectID local_arg = ObjectID::FromRandom();
+  dependency_manager_.HandleObjectLocal(local_arg);
+  TaskID task_id = RandomTaskId();
+
+  // Nothing to prefetch if all arguments are already local.
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs({local_arg}), {"foo", false});
+  ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
+
+  std::vector<ObjectID> arguments = {local_arg, ObjectID::FromRandom()};
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_EQ(object_manager_mock_.active_prefetch_requests.size(), 1);
+  ASSERT_EQ(NumWaitingTotal(), 0);
+  // Prefetching the same task again is a no-op.
+  dependency_manager_.PrefetchTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_EQ(object_manager_mock_.active_prefetch_requests.size(), 1);
+
+  // The task is scheduled locally and requests its arguments before the prefetch
+  // is canceled.
+  bool ready = dependency_manager_.RequestTaskDependencies(
+      task_id, ObjectIdsToRefs(arguments), {"foo", false});
+  ASSERT_FALSE(ready);
+  ASSERT_EQ(object_manager_mock_.active_task_requests.size(), 1);
+  dependency_manager_.CancelTaskDependenciesPrefetch(task_id);
+  ASSERT_TRUE(object_manager_mock_.active_prefetch_requests.empty());
+  // Canceling twice is a no-op.
+  dependency_manager_.CancelTaskDependenciesPrefetch(task_id);
+
+  dependency_manager_.RemoveTaskDependencies(task_id);
+  dependency_manager_.HandleObjectMissing(local_arg);
+  AssertNoLeaks();
+}
+
 }  // namespace raylet
 
 }  // namespace ray
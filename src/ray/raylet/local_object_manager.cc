@@ -411,6 +411,9 @@ void LocalObjectManager::OnObjectSpilled(const std::vector<ObjectID> &object_ids
     spilled_bytes_total_ += object_size;
     spilled_bytes_current_ += object_size;
     spilled_objects_total_++;
+    if (on_object_spilled_) {
+      on_object_spilled_(object_id);
+    }
 
     // Asynchronously Update the spilled URL.
     auto freed_it = local_objects_.find(object_id);
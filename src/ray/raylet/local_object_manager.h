@@ -56,7 +56,8 @@ class LocalObjectManager {
       std::function<void(const std::vector<ObjectID> &)> on_objects_freed,
       std::function<bool(const ray::ObjectID &)> is_plasma_object_spillable,
       pubsub::SubscriberInterface *core_worker_subscriber,
-      IObjectDirectory *object_directory)
+      IObjectDirectory *object_directory,
+      std::function<void(const ObjectID &)> on_object_spilled = nullptr)
       : self_node_id_(node_id),
         self_node_address_(self_node_address),
         self_node_port_(self_node_port),
@@ -75,7 +76,8 @@ class LocalObjectManager {
         max_fused_object_count_(max_fused_object_count),
         next_spill_error_log_bytes_(RayConfig::instance().verbose_spill_logs()),
         core_worker_subscriber_(core_worker_subscriber),
-        object_directory_(object_directory) {}
+        object_directory_(object_directory),
+        on_object_spilled_(std::move(on_object_spilled)) {}
 
   /// Pin objects.
   ///
@@ -347,6 +349,9 @@ class LocalObjectManager {
   /// The object directory interface to access object information.
   IObjectDirectory *object_directory_;
 
+  /// Callback to report each object spilled to external storage. May be null.
+  std::function<void(const ObjectID &)> on_object_spilled_;
+
   ///
   /// Stats
   ///
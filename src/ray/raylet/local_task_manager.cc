@@ -117,6 +117,7 @@ void LocalTaskManager::ScheduleAndDispatchTasks() {
   // in the PullManager or periodically, to make sure that we spill waiting
   // tasks that are blocked.
   SpillWaitingTasks();
+  PrefetchWaitingTaskArguments();
 }
 
 void LocalTaskManager::DispatchScheduledTasksToWorkers() {
@@ -915,6 +916,66 @@ bool LocalTaskManager::CancelTasks(
   return tasks_cancelled;
 }
 
+void LocalTaskManager::PrefetchTaskArguments(const RayTask &task) {
+  const auto &spec = task.GetTaskSpecification();
+  if (spec.GetDependencies().empty()) {
+    return;
+  }
+  task_dependency_manager_.PrefetchTaskDependencies(
+      spec.TaskId(), task.GetDependencies(), {spec.GetName(), spec.IsRetry()});
+}
+
+void LocalTaskManager::CancelTaskArgumentsPrefetch(const TaskID &task_id) {
+  if (prefetched_waiting_tasks_.contains(task_id)) {
+    // The task was scheduled here, and the lookahead took over its prefetch.
+    return;
+  }
+  task_dependency_manager_.CancelTaskDependenciesPrefetch(task_id);
+}
+
+void LocalTaskManager::PrefetchWaitingTaskArguments() {
+  // Drop the prefetches of the tasks that are no longer waiting for their arguments.
+  for (auto it = prefetched_waiting_tasks_.begin();
+       it != prefetched_waiting_tasks_.end();) {
+    if (!waiting_tasks_index_.contains(*it)) {
+      task_dependency_manager_.CancelTaskDependenciesPrefetch(*it);
+      prefetched_waiting_tasks_.erase(it++);
+    } else {
+      it++;
+    }
+  }
+
+  const int64_t lookahead = RayConfig::instance().task_arg_prefetch_lookahead();
+  if (lookahead <= 0 && prefetched_waiting_tasks_.empty()) {
+    return;
+  }
+  // The waiting tasks whose argument pulls are active don't need a prefetch. The
+  // other ones are queued behind them in the pull manager, and their prefetches may
+  // still fit in the spare pull capacity.
+  absl::flat_hash_map<SchedulingClass, int64_t> num_prefetched;
+  for (const auto &work : waiting_task_queue_) {
+    const auto &spec = work->task.GetTaskSpecification();
+    const auto &task_id = spec.TaskId();
+    bool prefetch = false;
+    if (task_dependency_manager_.TaskDependenciesBlocked(task_id)) {
+      auto &num_class_prefetched = num_prefetched[spec.GetSchedulingClass()];
+      if (num_class_prefetched < lookahead) {
+        num_class_prefetched++;
+        prefetch = true;
+      }
+    }
+    if (!prefetch) {
+      if (prefetched_waiting_tasks_.erase(task_id) > 0) {
+        task_dependency_manager_.CancelTaskDependenciesPrefetch(task_id);
+      }
+    } else if (prefetched_waiting_tasks_.insert(task_id).second) {
+      RAY_LOG(DEBUG) << "Prefetching arguments of waiting task " << task_id;
+      task_dependency_manager_.PrefetchTaskDependencies(
+          task_id, work->task.GetDependencies(), {spec.GetName(), spec.IsRetry()});
+    }
+  }
+}
+
 bool LocalTaskManager::CancelTask(
     const TaskID &task_id,
     rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
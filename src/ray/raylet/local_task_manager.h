@@ -121,6 +121,17 @@ class LocalTaskManager : public ILocalTaskManager {
                    rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
                    const std::string &scheduling_failure_message) override;
 
+  /// Start pulling the arguments of a task that is not queued here yet.
+  ///
+  /// \param task: The task whose arguments to prefetch.
+  void PrefetchTaskArguments(const RayTask &task) override;
+
+  /// Cancel a prefetch started by PrefetchTaskArguments, if any. The prefetch is kept
+  /// if the task is waiting here and within the lookahead.
+  ///
+  /// \param task_id: The task whose arguments were prefetched.
+  void CancelTaskArgumentsPrefetch(const TaskID &task_id) override;
+
   /// Return if any tasks are pending resource acquisition.
   ///
   /// \param[out] example: An example task that is deadlocking.
@@ -234,6 +245,11 @@ class LocalTaskManager : public ILocalTaskManager {
   // queue.
   void SpillWaitingTasks();
 
+  /// Prefetch the arguments of the first `task_arg_prefetch_lookahead` waiting tasks
+  /// of each scheduling class whose argument pulls are blocked, and cancel the
+  /// prefetches of the other tasks.
+  void PrefetchWaitingTaskArguments();
+
   /// Calculate the maximum number of running tasks for a given scheduling
   /// class. https://github.com/ray-project/ray/issues/16973
   ///
@@ -341,6 +357,9 @@ class LocalTaskManager : public ILocalTaskManager {
   absl::flat_hash_map<TaskID, std::list<std::shared_ptr<internal::Work>>::iterator>
       waiting_tasks_index_;
 
+  /// The waiting tasks whose arguments are being prefetched.
+  absl::flat_hash_set<TaskID> prefetched_waiting_tasks_;
+
   /// Track the backlog of all workers belonging to this raylet.
   absl::flat_hash_map<SchedulingClass, absl::flat_hash_map<WorkerID, int64_t>>
       backlog_tracker_;
@@ -395,6 +414,7 @@ class LocalTaskManager : public ILocalTaskManager {
   friend class SchedulerStats;
   friend class LocalTaskManagerTest;
   FRIEND_TEST(ClusterTaskManagerTest, FeasibleToNonFeasible);
+  FRIEND_TEST(ClusterTaskManagerTest, TestPrefetchBlockedWaitingTasks);
   FRIEND_TEST(LocalTaskManagerTest, TestTaskDispatchingOrder);
 };
 }  // namespace raylet
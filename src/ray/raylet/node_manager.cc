@@ -274,7 +274,14 @@ NodeManager::NodeManager(
             return object_manager_.IsPlasmaObjectSpillable(object_id);
           },
           /*core_worker_subscriber_=*/core_worker_subscriber_.get(),
-          object_directory_.get()),
+          object_directory_.get(),
+          /*on_object_spilled*/
+          RayConfig::instance().plasma_access_trace_capacity() > 0
+              ? std::function<void(const ObjectID &)>(
+                    [this](const ObjectID &object_id) {
+                      object_manager_.RecordPlasmaObjectSpilled(object_id);
+                    })
+              : nullptr),
       high_plasma_storage_usage_(RayConfig::instance().high_plasma_storage_usage()),
       local_gc_run_time_ns_(absl::GetCurrentTimeNanos()),
       local_gc_throttler_(RayConfig::instance().local_gc_min_interval_s() * 1e9),
@@ -1281,7 +1288,8 @@ void NodeManager::ProcessClientMessage(const std::shared_ptr<ClientConnection> &
     return;
   } break;
   case protocol::MessageType::FetchOrReconstruct: {
-    ProcessFetchOrReconstructMessage(client, message_data);
+    ProcessFetchOrReconstructMessage(
+        client, *flatbuffers::GetRoot<protocol::FetchOrReconstruct>(message_data));
   } break;
   case protocol::MessageType::NotifyDirectCallTaskBlocked: {
     ProcessDirectCallTaskBlocked(client, message_data);
@@ -1314,6 +1322,9 @@ void NodeManager::ProcessClientMessage(const std::shared_ptr<ClientConnection> &
   case protocol::MessageType::SubscribePlasmaReady: {
     ProcessSubscribePlasmaReady(client, message_data);
   } break;
+  case protocol::MessageType::CoalescedMessages: {
+    ProcessCoalescedMessages(client, message_data);
+  } break;
   default:
     RAY_LOG(FATAL) << "Received unexpected message type " << message_type;
   }
@@ -1648,13 +1659,13 @@ void NodeManager::ProcessDisconnectClientMessage(
 }
 
 void NodeManager::ProcessFetchOrReconstructMessage(
-    const std::shared_ptr<ClientConnection> &client, const uint8_t *message_data) {
-  auto message = flatbuffers::GetRoot<protocol::FetchOrReconstruct>(message_data);
+    const std::shared_ptr<ClientConnection> &client,
+    const protocol::FetchOrReconstruct &message) {
   const auto refs =
-      FlatbufferToObjectReference(*message->object_ids(), *message->owner_addresses());
+      FlatbufferToObjectReference(*message.object_ids(), *message.owner_addresses());
   // TODO(ekl) we should be able to remove the fetch only flag along with the legacy
   // non-direct call support.
-  if (message->fetch_only()) {
+  if (message.fetch_only()) {
     std::shared_ptr<WorkerInterface> worker = worker_pool_.GetRegisteredWorker(client);
     if (!worker) {
       worker = worker_pool_.GetRegisteredDriver(client);
@@ -1671,7 +1682,7 @@ void NodeManager::ProcessFetchOrReconstructMessage(
     // subscribe to in the task dependency manager. These objects will be
     // pulled from remote node managers. If an object's owner dies, an error
     // will be stored as the object's value.
-    const TaskID task_id = from_flatbuf<TaskID>(*message->task_id());
+    const TaskID task_id = from_flatbuf<TaskID>(*message.task_id());
     AsyncResolveObjects(client,
                         refs,
                         task_id,
@@ -1679,6 +1690,34 @@ void NodeManager::ProcessFetchOrReconstructMessage(
   }
 }
 
+void NodeManager::ProcessCoalescedMessages(
+    const std::shared_ptr<ClientConnection> &client, const uint8_t *message_data) {
+  auto message = flatbuffers::GetRoot<protocol::CoalescedMessages>(message_data);
+  for (const auto *coalesced_message : *message->messages()) {
+    switch (coalesced_message->message_type()) {
+    case protocol::CoalescedMessageBody::FetchOrReconstruct: {
+      ProcessFetchOrReconstructMessage(
+          client, *coalesced_message->message_as_FetchOrReconstruct());
+    } break;
+    case protocol::CoalescedMessageBody::NotifyUnblocked: {
+      const auto *notify_unblocked = coalesced_message->message_as_NotifyUnblocked();
+      AsyncResolveObjectsFinish(client,
+                                from_flatbuf<TaskID>(*notify_unblocked->task_id()));
+    } break;
+    case protocol::CoalescedMessageBody::NotifyDirectCallTaskBlocked: {
+      HandleDirectCallTaskBlocked(worker_pool_.GetRegisteredWorker(client),
+                                  /*release_resources=*/true);
+    } break;
+    case protocol::CoalescedMessageBody::NotifyDirectCallTaskUnblocked: {
+      HandleDirectCallTaskUnblocked(worker_pool_.GetRegisteredWorker(client));
+    } break;
+    default:
+      RAY_LOG(FATAL) << "Received unexpected coalesced message type "
+                     << static_cast<int>(coalesced_message->message_type());
+    }
+  }
+}
+
 void NodeManager::ProcessDirectCallTaskBlocked(
     const std::shared_ptr<ClientConnection> &client, const uint8_t *message_data) {
   auto message =
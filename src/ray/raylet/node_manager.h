@@ -462,10 +462,19 @@ class NodeManager : public rpc::NodeManagerServiceHandler,
   /// Process client message of FetchOrReconstruct
   ///
   /// \param client The client that sent the message.
-  /// \param message_data A pointer to the message data.
+  /// \param message The message.
   /// \return Void.
   void ProcessFetchOrReconstructMessage(const std::shared_ptr<ClientConnection> &client,
-                                        const uint8_t *message_data);
+                                        const protocol::FetchOrReconstruct &message);
+
+  /// Process client message of CoalescedMessages, handling each of the coalesced
+  /// messages in order.
+  ///
+  /// \param client The client that sent the message.
+  /// \param message_data A pointer to the message data.
+  /// \return Void.
+  void ProcessCoalescedMessages(const std::shared_ptr<ClientConnection> &client,
+                                const uint8_t *message_data);
 
   /// Process client message of WaitRequest
   ///
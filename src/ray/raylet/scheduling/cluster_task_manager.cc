@@ -18,6 +18,7 @@
 
 #include <boost/range/join.hpp>
 
+#include "ray/common/ray_config.h"
 #include "ray/stats/metric_defs.h"
 #include "ray/util/logging.h"
 
@@ -94,6 +95,7 @@ bool ClusterTaskManager::CancelTasks(
           RAY_LOG(DEBUG) << "Canceling task "
                          << work->task.GetTaskSpecification().TaskId()
                          << " from schedule queue.";
+          CancelTaskArgumentsPrefetch(work->task.GetTaskSpecification().TaskId());
           ReplyCancelled(*work, failure_type, scheduling_failure_message);
           tasks_cancelled = true;
           return true;
@@ -176,6 +178,7 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
           // This can only happen if the target node doesn't exist or is infeasible.
           // The task will never be schedulable in either case so we should fail it.
           if (cluster_resource_scheduler_.IsLocalNodeWithRaylet()) {
+            CancelTaskArgumentsPrefetch(task.GetTaskSpecification().TaskId());
             ReplyCancelled(
                 *work,
                 rpc::RequestWorkerLeaseReply::SCHEDULING_CANCELLED_UNSCHEDULABLE,
@@ -214,6 +217,12 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
         announce_infeasible_task_(task);
       }
 
+      // Infeasible tasks won't run any time soon, so stop fetching their arguments.
+      for (const auto &infeasible_work : work_queue) {
+        CancelTaskArgumentsPrefetch(
+            infeasible_work->task.GetTaskSpecification().TaskId());
+      }
+
       // TODO(sang): Use a shared pointer deque to reduce copy overhead.
       infeasible_tasks_[shapes_it->first] = shapes_it->second;
       tasks_to_schedule_.erase(shapes_it++);
@@ -235,9 +244,41 @@ void ClusterTaskManager::ScheduleAndDispatchTasks() {
   }
   works_to_cancel.clear();
 
+  PrefetchQueuedTaskArguments();
+
   local_task_manager_.ScheduleAndDispatchTasks();
 }
 
+void ClusterTaskManager::PrefetchQueuedTaskArguments() {
+  const int64_t lookahead = RayConfig::instance().task_arg_prefetch_lookahead();
+  if (lookahead <= 0) {
+    return;
+  }
+  for (const auto &shapes_it : tasks_to_schedule_) {
+    int64_t num_prefetched = 0;
+    for (const auto &work : shapes_it.second) {
+      if (num_prefetched >= lookahead) {
+        break;
+      }
+      const auto &task_spec = work->task.GetTaskSpecification();
+      if (task_spec.GetDependencies().empty()) {
+        continue;
+      }
+      num_prefetched++;
+      if (prefetched_tasks_.insert(task_spec.TaskId()).second) {
+        RAY_LOG(DEBUG) << "Prefetching arguments of queued task " << task_spec.TaskId();
+        local_task_manager_.PrefetchTaskArguments(work->task);
+      }
+    }
+  }
+}
+
+void ClusterTaskManager::CancelTaskArgumentsPrefetch(const TaskID &task_id) {
+  if (prefetched_tasks_.erase(task_id) > 0) {
+    local_task_manager_.CancelTaskArgumentsPrefetch(task_id);
+  }
+}
+
 void ClusterTaskManager::TryScheduleInfeasibleTask() {
   for (auto shapes_it = infeasible_tasks_.begin();
        shapes_it != infeasible_tasks_.end();) {
@@ -366,11 +407,17 @@ std::string ClusterTaskManager::DebugStr() const {
 
 void ClusterTaskManager::ScheduleOnNode(const NodeID &spillback_to,
                                         const std::shared_ptr<internal::Work> &work) {
+  const TaskID task_id = work->task.GetTaskSpecification().TaskId();
   if (spillback_to == self_node_id_) {
     local_task_manager_.QueueAndScheduleTask(work);
+    // Cancel the prefetch only after the local task manager has requested the
+    // arguments, so that objects that are already being pulled stay active.
+    CancelTaskArgumentsPrefetch(task_id);
     return;
   }
 
+  CancelTaskArgumentsPrefetch(task_id);
+
   auto send_reply_callback = work->callback;
 
   if (work->grant_or_reject) {
@@ -153,6 +153,13 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
   void ScheduleOnNode(const NodeID &node_to_schedule,
                       const std::shared_ptr<internal::Work> &work);
 
+  /// Start prefetching the arguments of the first `task_arg_prefetch_lookahead`
+  /// tasks with arguments in each scheduling class of tasks_to_schedule_.
+  void PrefetchQueuedTaskArguments();
+
+  /// Cancel the argument prefetch of a task, if one was started.
+  void CancelTaskArgumentsPrefetch(const TaskID &task_id);
+
   /// Recompute the debug stats.
   /// It is needed because updating the debug state is expensive for cluster_task_manager.
   /// TODO(sang): Update the internal states value dynamically instead of iterating the
@@ -188,9 +195,14 @@ class ClusterTaskManager : public ClusterTaskManagerInterface {
   /// Returns the current time in milliseconds.
   std::function<int64_t()> get_time_ms_;
 
+  /// The tasks in tasks_to_schedule_ whose arguments are being prefetched.
+  absl::flat_hash_set<TaskID> prefetched_tasks_;
+
   friend class SchedulerStats;
   friend class ClusterTaskManagerTest;
   FRIEND_TEST(ClusterTaskManagerTest, FeasibleToNonFeasible);
+  FRIEND_TEST(ClusterTaskManagerTest, TestPrefetchKeptWhenScheduledLocally);
+  FRIEND_TEST(ClusterTaskManagerTestWithoutRaylet, TestPrefetchCanceledWhenInfeasible);
 };
 }  // namespace raylet
 }  // namespace ray
@@ -124,7 +124,11 @@ class MockWorkerPool : public WorkerPoolInterface {
 };
 
 std::shared_ptr<ClusterResourceScheduler> CreateSingleNodeScheduler(
-    const std::string &id, double num_cpus, double num_gpus, gcs::GcsClient &gcs_client) {
+    const std::string &id,
+    double num_cpus,
+    double num_gpus,
+    gcs::GcsClient &gcs_client,
+    bool is_local_node_with_raylet = true) {
   absl::flat_hash_map<std::string, double> local_node_resources;
   local_node_resources[ray::kCPU_ResourceLabel] = num_cpus;
   local_node_resources[ray::kGPU_ResourceLabel] = num_gpus;
@@ -133,10 +137,12 @@ std::shared_ptr<ClusterResourceScheduler> CreateSingleNodeScheduler(
   auto scheduler = std::make_shared<ClusterResourceScheduler>(
       io_context,
       scheduling::NodeID(id),
-      local_node_resources,
-      /*is_node_available_fn*/ [&gcs_client](scheduling::NodeID node_id) {
+      ResourceMapToNodeResources(local_node_resources, local_node_resources),
+      /*is_node_available_fn*/
+      [&gcs_client](scheduling::NodeID node_id) {
         return gcs_client.Nodes().Get(NodeID::FromBinary(node_id.Binary())) != nullptr;
-      });
+      },
+      is_local_node_with_raylet);
 
   return scheduler;
 }
@@ -209,6 +215,16 @@ class MockTaskDependencyManager : public TaskDependencyManagerInterface {
     RAY_CHECK(subscribed_tasks.erase(task_id));
   }
 
+  void PrefetchTaskDependencies(const TaskID &task_id,
+                                const std::vector<rpc::ObjectReference> &required_objects,
+                                const TaskMetricsKey &task_key) {
+    prefetched_tasks.insert(task_id);
+  }
+
+  void CancelTaskDependenciesPrefetch(const TaskID &task_id) {
+    prefetched_tasks.erase(task_id);
+  }
+
   bool TaskDependenciesBlocked(const TaskID &task_id) const {
     return blocked_tasks.count(task_id);
   }
@@ -217,6 +233,7 @@ class MockTaskDependencyManager : public TaskDependencyManagerInterface {
 
   std::unordered_set<ObjectID> &missing_objects_;
   std::unordered_set<TaskID> subscribed_tasks;
+  std::unordered_set<TaskID> prefetched_tasks;
   std::unordered_set<TaskID> blocked_tasks;
 };
 
@@ -239,11 +256,15 @@ testing::Environment *const env =
 class ClusterTaskManagerTest : public ::testing::Test {
  public:
   explicit ClusterTaskManagerTest(double num_cpus_at_head = 8.0,
-                                  double num_gpus_at_head = 0.0)
+                                  double num_gpus_at_head = 0.0,
+                                  bool is_local_node_with_raylet = true)
       : gcs_client_(std::make_unique<gcs::MockGcsClient>()),
         id_(NodeID::FromRandom()),
-        scheduler_(CreateSingleNodeScheduler(
-            id_.Binary(), num_cpus_at_head, num_gpus_at_head, *gcs_client_)),
+        scheduler_(CreateSingleNodeScheduler(id_.Binary(),
+                                             num_cpus_at_head,
+                                             num_gpus_at_head,
+                                             *gcs_client_,
+                                             is_local_node_with_raylet)),
         is_owner_alive_(true),
         dependency_manager_(missing_objects_),
         local_task_manager_(std::make_unique<LocalTaskManager>(
@@ -336,6 +357,7 @@ class ClusterTaskManagerTest : public ::testing::Test {
     ASSERT_TRUE(local_task_manager_->info_by_sched_cls_.empty());
     ASSERT_EQ(local_task_manager_->pinned_task_arguments_bytes_, 0);
     ASSERT_TRUE(dependency_manager_.subscribed_tasks.empty());
+    ASSERT_TRUE(local_task_manager_->prefetched_waiting_tasks_.empty());
   }
 
   void AssertPinnedTaskArgumentsPresent(const RayTask &task) {
@@ -403,6 +425,57 @@ class ClusterTaskManagerTestWithoutCPUsAtHead : public ClusterTaskManagerTest {
       : ClusterTaskManagerTest(/*num_cpus_at_head=*/0.0) {}
 };
 
+// Like the GCS scheduler, which keeps the tasks that no node has room for in the
+// schedule queue.
+class ClusterTaskManagerTestWithoutRaylet : public ClusterTaskManagerTest {
+ public:
+  ClusterTaskManagerTestWithoutRaylet()
+      : ClusterTaskManagerTest(/*num_cpus_at_head=*/0.0,
+                               /*num_gpus_at_head=*/0.0,
+                               /*is_local_node_with_raylet=*/false) {}
+
+  void SetUp() override {
+    ClusterTaskManagerTest::SetUp();
+    RayConfig::instance().task_arg_prefetch_lookahead() = 2;
+    // The remote node fits the tasks but is busy, so they stay in the schedule queue.
+    remote_node_id_ = NodeID::FromRandom();
+    AddNode(remote_node_id_, 8);
+    ASSERT_TRUE(scheduler_->AllocateRemoteTaskResources(
+        scheduling::NodeID(remote_node_id_.Binary()), {{ray::kCPU_ResourceLabel, 8}}));
+  }
+
+  void TearDown() override { RayConfig::instance().task_arg_prefetch_lookahead() = 0; }
+
+  /// Queue tasks that need the whole remote node, with the given numbers of args.
+  std::vector<RayTask> QueueTasks(const std::vector<int> &num_args) {
+    std::vector<RayTask> tasks;
+    for (int n : num_args) {
+      tasks.push_back(CreateTask({{ray::kCPU_ResourceLabel, 8}}, n));
+      task_manager_.QueueAndScheduleTask(
+          tasks.back(),
+          false,
+          false,
+          &replies_[tasks.back().GetTaskSpecification().TaskId()],
+          [this](Status, std::function<void()>, std::function<void()>) {
+            num_callbacks_++;
+          });
+    }
+    return tasks;
+  }
+
+  std::unordered_set<TaskID> TaskIds(const std::vector<RayTask> &tasks) {
+    std::unordered_set<TaskID> task_ids;
+    for (const auto &task : tasks) {
+      task_ids.insert(task.GetTaskSpecification().TaskId());
+    }
+    return task_ids;
+  }
+
+  NodeID remote_node_id_;
+  std::unordered_map<TaskID, rpc::RequestWorkerLeaseReply> replies_;
+  int num_callbacks_ = 0;
+};
+
 TEST_F(ClusterTaskManagerTest, BasicTest) {
   /*
     Test basic scheduler functionality:
@@ -1818,6 +1891,104 @@ TEST_F(ClusterTaskManagerTest, FeasibleToNonFeasible) {
             task1.GetTaskSpecification().TaskId());
 }
 
+TEST_F(ClusterTaskManagerTestWithoutRaylet, TestPrefetchLookahead) {
+  // Only the first two tasks with args are prefetched.
+  auto tasks = QueueTasks({0, 1, 1, 1});
+  ASSERT_EQ(num_callbacks_, 0);
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[1], tasks[2]}));
+
+  // The next task is prefetched once one of them is canceled.
+  ASSERT_TRUE(task_manager_.CancelTask(tasks[1].GetTaskSpecification().TaskId()));
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[2]}));
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[2], tasks[3]}));
+}
+
+TEST_F(ClusterTaskManagerTestWithoutRaylet, TestPrefetchCanceledOnSpillback) {
+  auto tasks = QueueTasks({1, 1, 1});
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[0], tasks[1]}));
+
+  // The remote node frees up and the first task is spilled back to it.
+  AddNode(remote_node_id_, 8);
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(num_callbacks_, 1);
+  ASSERT_EQ(replies_[tasks[0].GetTaskSpecification().TaskId()]
+                .retry_at_raylet_address()
+                .raylet_id(),
+            remote_node_id_.Binary());
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[1], tasks[2]}));
+}
+
+TEST_F(ClusterTaskManagerTestWithoutRaylet, TestPrefetchCanceledWhenInfeasible) {
+  auto tasks = QueueTasks({1, 1, 1});
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, TaskIds({tasks[0], tasks[1]}));
+
+  // The remote node shrinks, so none of the tasks fit anywhere any more.
+  AddNode(remote_node_id_, 4);
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(num_callbacks_, 0);
+  ASSERT_EQ(task_manager_.infeasible_tasks_.size(), 1);
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+}
+
+TEST_F(ClusterTaskManagerTest, TestPrefetchBlockedWaitingTasks) {
+  RayConfig::instance().task_arg_prefetch_lookahead() = 1;
+  rpc::RequestWorkerLeaseReply reply;
+  auto callback = [](Status, std::function<void()>, std::function<void()>) {};
+
+  // Three tasks wait for their args here. The pull of the first one is active, and the
+  // pulls of the others are queued behind it.
+  std::vector<TaskID> task_ids;
+  std::vector<ObjectID> args;
+  for (int i = 0; i < 3; i++) {
+    auto task = CreateTask({{ray::kCPU_ResourceLabel, 1}}, 1);
+    task_ids.push_back(task.GetTaskSpecification().TaskId());
+    args.push_back(task.GetTaskSpecification().GetDependencyIds()[0]);
+    missing_objects_.insert(args.back());
+    if (i > 0) {
+      dependency_manager_.blocked_tasks.insert(task_ids.back());
+    }
+    task_manager_.QueueAndScheduleTask(task, false, false, &reply, callback);
+  }
+  ASSERT_EQ(local_task_manager_->waiting_task_queue_.size(), 3);
+
+  // Only the first blocked task is prefetched.
+  ASSERT_EQ(dependency_manager_.prefetched_tasks,
+            std::unordered_set<TaskID>({task_ids[1]}));
+
+  // Once its pull is active, the next blocked task is prefetched instead.
+  dependency_manager_.blocked_tasks.erase(task_ids[1]);
+  task_manager_.ScheduleAndDispatchTasks();
+  ASSERT_EQ(dependency_manager_.prefetched_tasks,
+            std::unordered_set<TaskID>({task_ids[2]}));
+
+  // The prefetch is canceled once the task's args are local.
+  missing_objects_.erase(args[2]);
+  local_task_manager_->TasksUnblocked({task_ids[2]});
+  ASSERT_TRUE(dependency_manager_.prefetched_tasks.empty());
+  ASSERT_TRUE(local_task_manager_->prefetched_waiting_tasks_.empty());
+  RayConfig::instance().task_arg_prefetch_lookahead() = 0;
+}
+
+TEST_F(ClusterTaskManagerTest, TestPrefetchKeptWhenScheduledLocally) {
+  RayConfig::instance().task_arg_prefetch_lookahead() = 1;
+  auto task = CreateTask({{ray::kCPU_ResourceLabel, 1}}, 1);
+  const auto task_id = task.GetTaskSpecification().TaskId();
+  missing_objects_.insert(task.GetTaskSpecification().GetDependencyIds()[0]);
+  dependency_manager_.blocked_tasks.insert(task_id);
+
+  // The prefetch started while the task was in the schedule queue is kept once the
+  // task waits here with its pull blocked.
+  local_task_manager_->PrefetchTaskArguments(task);
+  task_manager_.prefetched_tasks_.insert(task_id);
+  rpc::RequestWorkerLeaseReply reply;
+  auto callback = [](Status, std::function<void()>, std::function<void()>) {};
+  task_manager_.QueueAndScheduleTask(task, false, false, &reply, callback);
+  ASSERT_TRUE(task_manager_.prefetched_tasks_.empty());
+  ASSERT_EQ(dependency_manager_.prefetched_tasks, std::unordered_set<TaskID>({task_id}));
+  RayConfig::instance().task_arg_prefetch_lookahead() = 0;
+}
+
 TEST_F(ClusterTaskManagerTestWithGPUsAtHead, RleaseAndReturnWorkerCpuResources) {
   // Add PG CPU and GPU resources.
   scheduler_->GetLocalResourceManager().AddLocalResourceInstances(
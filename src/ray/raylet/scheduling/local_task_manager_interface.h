@@ -48,6 +48,17 @@ class ILocalTaskManager {
       rpc::RequestWorkerLeaseReply::SchedulingFailureType failure_type,
       const std::string &scheduling_failure_message) = 0;
 
+  /// Start pulling the arguments of a task that is still waiting to be scheduled,
+  /// so that they are (partially) local by the time the task is queued here.
+  ///
+  /// \param task: The task whose arguments to prefetch.
+  virtual void PrefetchTaskArguments(const RayTask &task) = 0;
+
+  /// Cancel a prefetch started by PrefetchTaskArguments, if any.
+  ///
+  /// \param task_id: The task whose arguments were prefetched.
+  virtual void CancelTaskArgumentsPrefetch(const TaskID &task_id) = 0;
+
   virtual const absl::flat_hash_map<SchedulingClass,
                                     std::deque<std::shared_ptr<internal::Work>>>
       &GetTaskToDispatch() const = 0;
@@ -92,6 +103,10 @@ class NoopLocalTaskManager : public ILocalTaskManager {
     return false;
   }
 
+  void PrefetchTaskArguments(const RayTask &task) override {}
+
+  void CancelTaskArgumentsPrefetch(const TaskID &task_id) override {}
+
   const absl::flat_hash_map<SchedulingClass, std::deque<std::shared_ptr<internal::Work>>>
       &GetTaskToDispatch() const override {
     static const absl::flat_hash_map<SchedulingClass,
@@ -14,6 +14,8 @@
 
 #include "ray/raylet_client/raylet_client.h"
 
+#include <algorithm>
+
 #include "absl/synchronization/notification.h"
 #include "ray/common/client_connection.h"
 #include "ray/common/common_protocol.h"
@@ -94,6 +96,184 @@ void raylet::RayletConnection::ShutdownIfLocalRayletDisconnected(const Status &s
   }
 }
 
+raylet::RayletMessageCoalescer::RayletMessageCoalescer(
+    instrumented_io_context &io_service,
+    std::shared_ptr<RayletConnection> conn,
+    int64_t window_us)
+    : io_service_(io_service), conn_(std::move(conn)), window_us_(window_us) {}
+
+void raylet::RayletMessageCoalescer::FetchOrReconstruct(
+    const std::vector<ObjectID> &object_ids,
+    const std::vector<rpc::Address> &owner_addresses,
+    bool fetch_only,
+    const TaskID &current_task_id) {
+  absl::MutexLock lock(&mutex_);
+  // Merge into a held fetch of the same task, unless an unblock since has canceled
+  // it. The raylet accumulates the objects of a worker's fetches anyway.
+  for (auto it = pending_messages_.rbegin(); it != pending_messages_.rend(); it++) {
+    if (it->type == MessageType::NotifyUnblocked ||
+        it->type == MessageType::NotifyDirectCallTaskUnblocked) {
+      break;
+    }
+    if (it->type == MessageType::FetchOrReconstruct && it->fetch_only == fetch_only &&
+        it->task_id == current_task_id) {
+      for (size_t i = 0; i < object_ids.size(); i++) {
+        if (it->object_id_set.insert(object_ids[i]).second) {
+          it->object_ids.push_back(object_ids[i]);
+          it->owner_addresses.push_back(owner_addresses[i]);
+        }
+      }
+      return;
+    }
+  }
+  PendingMessage message;
+  message.type = MessageType::FetchOrReconstruct;
+  message.task_id = current_task_id;
+  for (size_t i = 0; i < object_ids.size(); i++) {
+    if (message.object_id_set.insert(object_ids[i]).second) {
+      message.object_ids.push_back(object_ids[i]);
+      message.owner_addresses.push_back(owner_addresses[i]);
+    }
+  }
+  message.fetch_only = fetch_only;
+  AddPendingMessage(std::move(message));
+}
+
+void raylet::RayletMessageCoalescer::NotifyUnblocked(const TaskID &current_task_id) {
+  absl::MutexLock lock(&mutex_);
+  // The raylet cancels all the get requests of the worker on unblock.
+  DropPendingFetches();
+  if (!pending_messages_.empty() &&
+      (pending_messages_.back().type == MessageType::NotifyUnblocked ||
+       pending_messages_.back().type == MessageType::NotifyDirectCallTaskUnblocked)) {
+    return;
+  }
+  PendingMessage message;
+  message.type = MessageType::NotifyUnblocked;
+  message.task_id = current_task_id;
+  AddPendingMessage(std::move(message));
+}
+
+void raylet::RayletMessageCoalescer::NotifyDirectCallTaskBlocked() {
+  absl::MutexLock lock(&mutex_);
+  // The raylet ignores a blocked notification if the worker is already blocked.
+  for (auto it = pending_messages_.rbegin(); it != pending_messages_.rend(); it++) {
+    if (it->type == MessageType::NotifyDirectCallTaskUnblocked) {
+      break;
+    }
+    if (it->type == MessageType::NotifyDirectCallTaskBlocked) {
+      return;
+    }
+  }
+  PendingMessage message;
+  message.type = MessageType::NotifyDirectCallTaskBlocked;
+  AddPendingMessage(std::move(message));
+}
+
+void raylet::RayletMessageCoalescer::NotifyDirectCallTaskUnblocked() {
+  absl::MutexLock lock(&mutex_);
+  // Unblocking cancels the get requests of the worker and returns its resources,
+  // which undoes all the held messages. Only the unblock itself is needed, for the
+  // requests and the resources of before the window.
+  pending_messages_.clear();
+  PendingMessage message;
+  message.type = MessageType::NotifyDirectCallTaskUnblocked;
+  AddPendingMessage(std::move(message));
+}
+
+Status raylet::RayletMessageCoalescer::Flush() {
+  absl::MutexLock lock(&mutex_);
+  return FlushLocked();
+}
+
+void raylet::RayletMessageCoalescer::AddPendingMessage(PendingMessage message) {
+  pending_messages_.push_back(std::move(message));
+  if (flush_scheduled_) {
+    return;
+  }
+  flush_scheduled_ = true;
+  io_service_.post(
+      [weak_this = weak_from_this()]() {
+        if (auto this_ptr = weak_this.lock()) {
+          absl::MutexLock lock(&this_ptr->mutex_);
+          this_ptr->flush_scheduled_ = false;
+          auto status = this_ptr->FlushLocked();
+          if (!status.ok()) {
+            RAY_LOG(WARNING) << "Failed to write coalesced messages to the raylet: "
+                             << status;
+          }
+        }
+      },
+      "RayletMessageCoalescer.Flush",
+      window_us_);
+}
+
+void raylet::RayletMessageCoalescer::DropPendingFetches() {
+  pending_messages_.erase(
+      std::remove_if(pending_messages_.begin(),
+                     pending_messages_.end(),
+                     [](const PendingMessage &message) {
+                       return message.type == MessageType::FetchOrReconstruct;
+                     }),
+      pending_messages_.end());
+}
+
+Status raylet::RayletMessageCoalescer::FlushLocked() {
+  if (pending_messages_.empty()) {
+    return Status::OK();
+  }
+  // Build each message as a member of the CoalescedMessageBody union. A single
+  // message is sent as is.
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<protocol::CoalescedMessage>> messages;
+  protocol::CoalescedMessageBody body_type = protocol::CoalescedMessageBody::NONE;
+  flatbuffers::Offset<void> body;
+  for (const auto &message : pending_messages_) {
+    switch (message.type) {
+    case MessageType::FetchOrReconstruct:
+      body_type = protocol::CoalescedMessageBody::FetchOrReconstruct;
+      body = protocol::CreateFetchOrReconstruct(
+                 fbb,
+                 to_flatbuf(fbb, message.object_ids),
+                 AddressesToFlatbuffer(fbb, message.owner_addresses),
+                 message.fetch_only,
+                 to_flatbuf(fbb, message.task_id))
+                 .Union();
+      break;
+    case MessageType::NotifyUnblocked:
+      body_type = protocol::CoalescedMessageBody::NotifyUnblocked;
+      body = protocol::CreateNotifyUnblocked(fbb, to_flatbuf(fbb, message.task_id))
+                 .Union();
+      break;
+    case MessageType::NotifyDirectCallTaskBlocked:
+      body_type = protocol::CoalescedMessageBody::NotifyDirectCallTaskBlocked;
+      body = protocol::CreateNotifyDirectCallTaskBlocked(fbb, /*release_resources=*/true)
+                 .Union();
+      break;
+    case MessageType::NotifyDirectCallTaskUnblocked:
+      body_type = protocol::CoalescedMessageBody::NotifyDirectCallTaskUnblocked;
+      body = protocol::CreateNotifyDirectCallTaskUnblocked(fbb).Union();
+      break;
+    default:
+      RAY_LOG(FATAL) << "Unexpected coalesced message type "
+                     << protocol::EnumNameMessageType(message.type);
+    }
+    if (pending_messages_.size() > 1) {
+      messages.push_back(protocol::CreateCoalescedMessage(fbb, body_type, body));
+    }
+  }
+  MessageType type;
+  if (pending_messages_.size() > 1) {
+    fbb.Finish(protocol::CreateCoalescedMessages(fbb, fbb.CreateVector(messages)));
+    type = MessageType::CoalescedMessages;
+  } else {
+    fbb.Finish(body);
+    type = pending_messages_.front().type;
+  }
+  pending_messages_.clear();
+  return conn_->WriteMessage(type, &fbb);
+}
+
 raylet::RayletClient::RayletClient(
     std::shared_ptr<rpc::NodeManagerWorkerClient> grpc_client)
     : grpc_client_(std::move(grpc_client)) {}
@@ -114,7 +294,7 @@ raylet::RayletClient::RayletClient(
     const std::string &serialized_job_config,
     StartupToken startup_token)
     : grpc_client_(std::move(grpc_client)), worker_id_(worker_id) {
-  conn_ = std::make_unique<raylet::RayletConnection>(io_service, raylet_socket, -1, -1);
+  conn_ = std::make_shared<raylet::RayletConnection>(io_service, raylet_socket, -1, -1);
 
   flatbuffers::FlatBufferBuilder fbb;
   // TODO(suquark): Use `WorkerType` in `common.proto` without converting to int.
@@ -134,7 +314,7 @@ raylet::RayletClient::RayletClient(
   // Register the process ID with the raylet.
   // NOTE(swang): If raylet exits and we are registered as a worker, we will get killed.
   std::vector<uint8_t> reply;
-  auto request_status = conn_->AtomicRequestReply(
+  auto request_status = AtomicRequestReply(
       MessageType::RegisterClientRequest, MessageType::RegisterClientReply, &reply, &fbb);
   if (!request_status.ok()) {
     *status =
@@ -153,6 +333,31 @@ raylet::RayletClient::RayletClient(
   }
   *raylet_id = NodeID::FromBinary(reply_message->raylet_id()->str());
   *port = reply_message->port();
+
+  const int64_t coalesce_window_us =
+      RayConfig::instance().raylet_client_coalesce_window_us();
+  if (coalesce_window_us > 0) {
+    coalescer_ = std::make_shared<raylet::RayletMessageCoalescer>(
+        io_service, conn_, coalesce_window_us);
+  }
+}
+
+Status raylet::RayletClient::WriteMessage(MessageType type,
+                                          flatbuffers::FlatBufferBuilder *fbb) {
+  if (coalescer_) {
+    RAY_RETURN_NOT_OK(coalescer_->Flush());
+  }
+  return conn_->WriteMessage(type, fbb);
+}
+
+Status raylet::RayletClient::AtomicRequestReply(MessageType request_type,
+                                                MessageType reply_type,
+                                                std::vector<uint8_t> *reply_message,
+                                                flatbuffers::FlatBufferBuilder *fbb) {
+  if (coalescer_) {
+    RAY_RETURN_NOT_OK(coalescer_->Flush());
+  }
+  return conn_->AtomicRequestReply(request_type, reply_type, reply_message, fbb);
 }
 
 Status raylet::RayletClient::Disconnect(
@@ -180,7 +385,7 @@ Status raylet::RayletClient::Disconnect(
   builder.add_disconnect_type(static_cast<int>(exit_type));
   builder.add_disconnect_detail(fb_exit_detail);
   fbb.Finish(builder.Finish());
-  auto status = conn_->WriteMessage(MessageType::DisconnectClient, &fbb);
+  auto status = WriteMessage(MessageType::DisconnectClient, &fbb);
   // Don't be too strict for disconnection errors.
   // Just create logs and prevent it from crash.
   // TODO (myan): In the current implementation, if raylet is already terminated in the
@@ -202,7 +407,7 @@ Status raylet::RayletClient::AnnounceWorkerPortForWorker(int port) {
   flatbuffers::FlatBufferBuilder fbb;
   auto message = protocol::CreateAnnounceWorkerPort(fbb, port, fbb.CreateString(""));
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::AnnounceWorkerPort, &fbb);
+  return WriteMessage(MessageType::AnnounceWorkerPort, &fbb);
 }
 
 Status raylet::RayletClient::AnnounceWorkerPortForDriver(int port,
@@ -212,10 +417,10 @@ Status raylet::RayletClient::AnnounceWorkerPortForDriver(int port,
       protocol::CreateAnnounceWorkerPort(fbb, port, fbb.CreateString(entrypoint));
   fbb.Finish(message);
   std::vector<uint8_t> reply;
-  RAY_RETURN_NOT_OK(conn_->AtomicRequestReply(MessageType::AnnounceWorkerPort,
-                                              MessageType::AnnounceWorkerPortReply,
-                                              &reply,
-                                              &fbb));
+  RAY_RETURN_NOT_OK(AtomicRequestReply(MessageType::AnnounceWorkerPort,
+                                       MessageType::AnnounceWorkerPortReply,
+                                       &reply,
+                                       &fbb));
   auto reply_message =
       flatbuffers::GetRoot<protocol::AnnounceWorkerPortReply>(reply.data());
   if (reply_message->success()) {
@@ -225,7 +430,7 @@ Status raylet::RayletClient::AnnounceWorkerPortForDriver(int port,
 }
 
 Status raylet::RayletClient::ActorCreationTaskDone() {
-  return conn_->WriteMessage(MessageType::ActorCreationTaskDone);
+  return WriteMessage(MessageType::ActorCreationTaskDone);
 }
 
 Status raylet::RayletClient::FetchOrReconstruct(
@@ -234,6 +439,11 @@ Status raylet::RayletClient::FetchOrReconstruct(
     bool fetch_only,
     const TaskID &current_task_id) {
   RAY_CHECK(object_ids.size() == owner_addresses.size());
+  if (coalescer_) {
+    coalescer_->FetchOrReconstruct(
+        object_ids, owner_addresses, fetch_only, current_task_id);
+    return Status::OK();
+  }
   flatbuffers::FlatBufferBuilder fbb;
   auto object_ids_message = to_flatbuf(fbb, object_ids);
   auto message =
@@ -243,28 +453,41 @@ Status raylet::RayletClient::FetchOrReconstruct(
                                          fetch_only,
                                          to_flatbuf(fbb, current_task_id));
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::FetchOrReconstruct, &fbb);
+  return WriteMessage(MessageType::FetchOrReconstruct, &fbb);
 }
 
 Status raylet::RayletClient::NotifyUnblocked(const TaskID &current_task_id) {
+  if (coalescer_) {
+    coalescer_->NotifyUnblocked(current_task_id);
+    return Status::OK();
+  }
   flatbuffers::FlatBufferBuilder fbb;
   auto message = protocol::CreateNotifyUnblocked(fbb, to_flatbuf(fbb, current_task_id));
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::NotifyUnblocked, &fbb);
+  return WriteMessage(MessageType::NotifyUnblocked, &fbb);
 }
 
 Status raylet::RayletClient::NotifyDirectCallTaskBlocked(bool release_resources) {
+  // The raylet only handles blocked notifications that release resources.
+  if (coalescer_ && release_resources) {
+    coalescer_->NotifyDirectCallTaskBlocked();
+    return Status::OK();
+  }
   flatbuffers::FlatBufferBuilder fbb;
   auto message = protocol::CreateNotifyDirectCallTaskBlocked(fbb, release_resources);
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::NotifyDirectCallTaskBlocked, &fbb);
+  return WriteMessage(MessageType::NotifyDirectCallTaskBlocked, &fbb);
 }
 
 Status raylet::RayletClient::NotifyDirectCallTaskUnblocked() {
+  if (coalescer_) {
+    coalescer_->NotifyDirectCallTaskUnblocked();
+    return Status::OK();
+  }
   flatbuffers::FlatBufferBuilder fbb;
   auto message = protocol::CreateNotifyDirectCallTaskUnblocked(fbb);
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::NotifyDirectCallTaskUnblocked, &fbb);
+  return WriteMessage(MessageType::NotifyDirectCallTaskUnblocked, &fbb);
 }
 
 Status raylet::RayletClient::Wait(const std::vector<ObjectID> &object_ids,
@@ -283,7 +506,9 @@ Status raylet::RayletClient::Wait(const std::vector<ObjectID> &object_ids,
                                              to_flatbuf(fbb, current_task_id));
   fbb.Finish(message);
   std::vector<uint8_t> reply;
-  RAY_RETURN_NOT_OK(conn_->AtomicRequestReply(
+  // Not coalesced: the caller blocks on the reply, so holding the request would only
+  // delay it. The held messages are sent first.
+  RAY_RETURN_NOT_OK(AtomicRequestReply(
       MessageType::WaitRequest, MessageType::WaitReply, &reply, &fbb));
   // Parse the flatbuffer object.
   auto reply_message = flatbuffers::GetRoot<protocol::WaitReply>(reply.data());
@@ -312,7 +537,7 @@ Status raylet::RayletClient::WaitForDirectActorCallArgs(
   auto message = protocol::CreateWaitForDirectActorCallArgsRequest(
       fbb, to_flatbuf(fbb, object_ids), AddressesToFlatbuffer(fbb, owner_addresses), tag);
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::WaitForDirectActorCallArgsRequest, &fbb);
+  return WriteMessage(MessageType::WaitForDirectActorCallArgsRequest, &fbb);
 }
 
 Status raylet::RayletClient::PushError(const JobID &job_id,
@@ -326,7 +551,7 @@ Status raylet::RayletClient::PushError(const JobID &job_id,
                                                   fbb.CreateString(error_message),
                                                   timestamp);
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::PushErrorRequest, &fbb);
+  return WriteMessage(MessageType::PushErrorRequest, &fbb);
 }
 
 Status raylet::RayletClient::FreeObjects(const std::vector<ObjectID> &object_ids,
@@ -335,7 +560,7 @@ Status raylet::RayletClient::FreeObjects(const std::vector<ObjectID> &object_ids
   auto message =
       protocol::CreateFreeObjectsRequest(fbb, local_only, to_flatbuf(fbb, object_ids));
   fbb.Finish(message);
-  return conn_->WriteMessage(MessageType::FreeObjectsInObjectStoreRequest, &fbb);
+  return WriteMessage(MessageType::FreeObjectsInObjectStoreRequest, &fbb);
 }
 
 void raylet::RayletClient::RequestWorkerLease(
@@ -628,7 +853,7 @@ void raylet::RayletClient::SubscribeToPlasma(const ObjectID &object_id,
       fbb, to_flatbuf(fbb, object_id), to_flatbuf(fbb, owner_address));
   fbb.Finish(message);
 
-  RAY_CHECK_OK(conn_->WriteMessage(MessageType::SubscribePlasmaReady, &fbb));
+  RAY_CHECK_OK(WriteMessage(MessageType::SubscribePlasmaReady, &fbb));
 }
 
 void raylet::RayletClient::GetSystemConfig(
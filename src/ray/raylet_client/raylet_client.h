@@ -18,6 +18,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
 #include "ray/common/asio/instrumented_io_context.h"
 #include "ray/common/buffer.h"
 #include "ray/common/bundle_spec.h"
@@ -290,6 +292,67 @@ class RayletConnection {
   std::mutex write_mutex_;
 };
 
+/// Holds the FetchOrReconstruct and blocked/unblocked notifications of a worker
+/// for a short window, so that the fine-grained get and wait loops of the worker
+/// don't send the raylet a message per call. Fetches are merged, transitions that
+/// a later unblock cancels on the raylet anyway are dropped, and the rest are
+/// written as a single CoalescedMessages message.
+///
+/// This class is thread safe. The messages of each thread are written in order.
+class RayletMessageCoalescer
+    : public std::enable_shared_from_this<RayletMessageCoalescer> {
+ public:
+  /// \param io_service The event loop that flushes the held messages.
+  /// \param conn The connection to write the messages to.
+  /// \param window_us How long to hold a message before it's written.
+  RayletMessageCoalescer(instrumented_io_context &io_service,
+                         std::shared_ptr<RayletConnection> conn,
+                         int64_t window_us);
+
+  void FetchOrReconstruct(const std::vector<ObjectID> &object_ids,
+                          const std::vector<rpc::Address> &owner_addresses,
+                          bool fetch_only,
+                          const TaskID &current_task_id);
+
+  void NotifyUnblocked(const TaskID &current_task_id);
+
+  void NotifyDirectCallTaskBlocked();
+
+  void NotifyDirectCallTaskUnblocked();
+
+  /// Write the held messages now.
+  ray::Status Flush();
+
+ private:
+  struct PendingMessage {
+    MessageType type;
+    /// The task ID of FetchOrReconstruct and NotifyUnblocked messages.
+    TaskID task_id;
+    /// The objects of FetchOrReconstruct messages.
+    std::vector<ObjectID> object_ids;
+    std::vector<rpc::Address> owner_addresses;
+    absl::flat_hash_set<ObjectID> object_id_set;
+    bool fetch_only = false;
+  };
+
+  /// Hold a message, and schedule a flush if none is scheduled.
+  void AddPendingMessage(PendingMessage message) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Drop the held FetchOrReconstruct messages, whose get requests are canceled by
+  /// an unblock.
+  void DropPendingFetches() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  ray::Status FlushLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  instrumented_io_context &io_service_;
+  const std::shared_ptr<RayletConnection> conn_;
+  const int64_t window_us_;
+
+  absl::Mutex mutex_;
+  std::vector<PendingMessage> pending_messages_ ABSL_GUARDED_BY(mutex_);
+  bool flush_scheduled_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
 class RayletClient : public RayletClientInterface {
  public:
   /// Connect to the raylet.
@@ -573,8 +636,23 @@ class RayletClient : public RayletClientInterface {
   /// for this worker. Each pair consists of the resource ID and the fraction
   /// of that resource allocated for this worker.
   ResourceMappingType resource_ids_;
+  /// Write a message to the raylet, after the messages held by coalescer_.
+  ray::Status WriteMessage(MessageType type,
+                           flatbuffers::FlatBufferBuilder *fbb = nullptr);
+
+  /// Send a request to the raylet and wait for the reply, after the messages held by
+  /// coalescer_.
+  ray::Status AtomicRequestReply(MessageType request_type,
+                                 MessageType reply_type,
+                                 std::vector<uint8_t> *reply_message,
+                                 flatbuffers::FlatBufferBuilder *fbb = nullptr);
+
   /// The connection to the raylet server.
-  std::unique_ptr<RayletConnection> conn_;
+  std::shared_ptr<RayletConnection> conn_;
+
+  /// Coalesces the fetch and notify messages to the raylet. Null if
+  /// raylet_client_coalesce_window_us is 0.
+  std::shared_ptr<RayletMessageCoalescer> coalescer_;
 
   /// The number of object ID pin RPCs currently in flight.
   std::atomic<int64_t> pins_in_flight_{0};
@@ -0,0 +1,107 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "ray/common/common_protocol.h"
+#include "ray/raylet_client/raylet_client.h"
+#include "ray/util/util.h"
+
+namespace ray {
+namespace raylet {
+
+class RayletMessageCoalescerTest : public ::testing::Test {
+ public:
+  RayletMessageCoalescerTest()
+      : socket_path_("/tmp/raylet_coalescer_test_" + UniqueID::FromRandom().Hex()),
+        acceptor_(io_service_, ParseUrlEndpoint(socket_path_)),
+        task_id_(TaskID::FromRandom(JobID::FromInt(1))) {
+    auto conn = std::make_shared<RayletConnection>(io_service_, socket_path_, 1, 100);
+    local_stream_socket socket(io_service_);
+    acceptor_.accept(socket);
+    reader_ = ServerConnection::Create(std::move(socket));
+    // Only explicit flushes write messages, since io_service_ isn't run.
+    coalescer_ = std::make_shared<RayletMessageCoalescer>(
+        io_service_, conn, /*window_us=*/1000 * 1000);
+  }
+
+  ~RayletMessageCoalescerTest() { std::remove(socket_path_.c_str()); }
+
+  void Fetch(const std::vector<ObjectID> &object_ids) {
+    std::vector<rpc::Address> owner_addresses(object_ids.size());
+    coalescer_->FetchOrReconstruct(
+        object_ids, owner_addresses, /*fetch_only=*/false, task_id_);
+  }
+
+  std::vector<uint8_t> Read(MessageType type) {
+    std::vector<uint8_t> message;
+    RAY_CHECK_OK(reader_->ReadMessage(static_cast<int64_t>(type), &message));
+    return message;
+  }
+
+ protected:
+  instrumented_io_context io_service_;
+  const std::string socket_path_;
+  boost::asio::basic_socket_acceptor<local_stream_protocol> acceptor_;
+  const TaskID task_id_;
+  std::shared_ptr<ServerConnection> reader_;
+  std::shared_ptr<RayletMessageCoalescer> coalescer_;
+};
+
+TEST_F(RayletMessageCoalescerTest, TestMergeFetchesAndBlocks) {
+  auto a = ObjectID::FromRandom();
+  auto b = ObjectID::FromRandom();
+  auto c = ObjectID::FromRandom();
+  Fetch({a, b});
+  coalescer_->NotifyDirectCallTaskBlocked();
+  Fetch({b, c});
+  coalescer_->NotifyDirectCallTaskBlocked();
+  RAY_CHECK_OK(coalescer_->Flush());
+
+  auto data = Read(MessageType::CoalescedMessages);
+  auto message = flatbuffers::GetRoot<protocol::CoalescedMessages>(data.data());
+  ASSERT_EQ(message->messages()->size(), 2u);
+  auto fetch = message->messages()->Get(0)->message_as_FetchOrReconstruct();
+  ASSERT_NE(fetch, nullptr);
+  ASSERT_EQ(from_flatbuf<ObjectID>(*fetch->object_ids()),
+            std::vector<ObjectID>({a, b, c}));
+  ASSERT_EQ(fetch->owner_addresses()->size(), 3u);
+  ASSERT_EQ(from_flatbuf<TaskID>(*fetch->task_id()), task_id_);
+  ASSERT_NE(message->messages()->Get(1)->message_as_NotifyDirectCallTaskBlocked(),
+            nullptr);
+}
+
+TEST_F(RayletMessageCoalescerTest, TestUnblockCancelsHeldMessages) {
+  coalescer_->NotifyDirectCallTaskBlocked();
+  Fetch({ObjectID::FromRandom()});
+  coalescer_->NotifyDirectCallTaskUnblocked();
+  coalescer_->NotifyDirectCallTaskUnblocked();
+  RAY_CHECK_OK(coalescer_->Flush());
+  // Nothing is written without held messages.
+  RAY_CHECK_OK(coalescer_->Flush());
+
+  Fetch({ObjectID::FromRandom()});
+  coalescer_->NotifyUnblocked(task_id_);
+  RAY_CHECK_OK(coalescer_->Flush());
+
+  // A single message is written as is.
+  Read(MessageType::NotifyDirectCallTaskUnblocked);
+  auto data = Read(MessageType::NotifyUnblocked);
+  auto message = flatbuffers::GetRoot<protocol::NotifyUnblocked>(data.data());
+  ASSERT_EQ(from_flatbuf<TaskID>(*message->task_id()), task_id_);
+}
+
+}  // namespace raylet
+}  // namespace ray
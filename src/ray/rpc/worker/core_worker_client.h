@@ -16,16 +16,22 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/hash/hash.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_config.h"
 #include "ray/common/status.h"
 #include "ray/pubsub/subscriber.h"
 #include "ray/rpc/retryable_grpc_client.h"
+#include "ray/rpc/worker/push_task_batch_stream.h"
+#include "ray/rpc/worker/shared_memory_channel.h"
 #include "ray/util/logging.h"
 #include "src/ray/protobuf/core_worker.grpc.pb.h"
 #include "src/ray/protobuf/core_worker.pb.h"
@@ -212,9 +218,10 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   CoreWorkerClient(const rpc::Address &address,
                    ClientCallManager &client_call_manager,
                    std::function<void()> core_worker_unavailable_timeout_callback)
-      : addr_(address) {
+      : addr_(address), main_service_(client_call_manager.GetMainService()) {
     grpc_client_ = std::make_shared<GrpcClient<CoreWorkerService>>(
         addr_.ip_address(), addr_.port(), client_call_manager);
+    task_batch_stub_ = CoreWorkerTaskBatchService::NewStub(grpc_client_->Channel());
 
     retryable_grpc_client_ = RetryableGrpcClient::Create(
         grpc_client_->Channel(),
@@ -238,6 +245,10 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
            (retryable_grpc_client_->NumPendingRequests() == 0);
   }
 
+  std::shared_ptr<grpc::Channel> PubsubStreamChannel() override {
+    return grpc_client_->Channel();
+  }
+
   VOID_RPC_CLIENT_METHOD(CoreWorkerService,
                          DirectActorCallArgWaitComplete,
                          grpc_client_,
@@ -385,6 +396,11 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
       return;
     }
 
+    if (::RayConfig::instance().actor_task_shared_memory_channel_enabled() &&
+        PushActorTaskToChannel(*request, callback)) {
+      return;
+    }
+
     {
       absl::MutexLock lock(&mutex_);
       send_queue_.emplace_back(std::move(request), std::move(callback));
@@ -417,6 +433,12 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// sent at once. This prevents the server scheduling queue from being overwhelmed.
   /// See direct_actor.proto for a description of the ordering protocol.
   void SendRequests() {
+    const int64_t batch_size = RayConfig::instance().actor_task_push_batch_size();
+    if (batch_size > 1) {
+      SendBatchedRequests(batch_size);
+      return;
+    }
+
     absl::MutexLock lock(&mutex_);
     auto this_ptr = this->shared_from_this();
 
@@ -458,6 +480,75 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
     }
   }
 
+  /// Like `SendRequests`, but packs up to `batch_size` queued tasks into each
+  /// PushTaskBatch stream. Until the actor has queued them, at most
+  /// actor_task_push_batch_max_in_flight batches are sent at once, so that the tasks
+  /// pushed meanwhile queue up for the next batch. The tasks are replied one by one as
+  /// they finish.
+  void SendBatchedRequests(int64_t batch_size) {
+    absl::MutexLock lock(&mutex_);
+    auto this_ptr = this->shared_from_this();
+    const int64_t max_batches_in_flight =
+        RayConfig::instance().actor_task_push_batch_max_in_flight();
+
+    while (!send_queue_.empty() && rpc_bytes_in_flight_ < kMaxBytesInFlight &&
+           batches_in_flight_ < max_batches_in_flight) {
+      PushTaskBatchRequest request;
+      // Only accessed from the main service, where the reactor runs its callbacks.
+      auto tasks = std::make_shared<std::vector<BatchedTask>>();
+      while (!send_queue_.empty() && static_cast<int64_t>(tasks->size()) < batch_size) {
+        auto pair = std::move(*send_queue_.begin());
+        send_queue_.pop_front();
+
+        auto &task = *pair.first;
+        const int64_t task_size = RequestSizeInBytes(task);
+        rpc_bytes_in_flight_ += task_size;
+        tasks->push_back({task.sequence_number(), task_size, std::move(pair.second)});
+        task.set_client_processed_up_to(max_finished_seq_no_);
+        request.set_intended_worker_id(task.intended_worker_id());
+        request.add_requests()->Swap(&task);
+      }
+      batches_in_flight_++;
+
+      auto queued_callback = [this, this_ptr]() {
+        {
+          absl::MutexLock lock(&mutex_);
+          batches_in_flight_--;
+        }
+        SendRequests();
+      };
+      auto reply_callback = [this, this_ptr, tasks](
+                                int index, const Status &status, PushTaskReply &&reply) {
+        if (index < 0 || index >= static_cast<int>(tasks->size()) ||
+            (*tasks)[index].callback == nullptr) {
+          RAY_LOG(WARNING) << "Ignoring the reply of unknown task " << index
+                           << " of a PushTaskBatch stream.";
+          return;
+        }
+        FinishBatchedTask((*tasks)[index], status, std::move(reply));
+      };
+      auto done_callback = [this, this_ptr, tasks](const Status &status) {
+        const auto task_status =
+            status.ok() ? Status::IOError("The stream ended before the task was replied.")
+                        : status;
+        for (auto &task : *tasks) {
+          if (task.callback != nullptr) {
+            FinishBatchedTask(task, task_status, PushTaskReply());
+          }
+        }
+      };
+      auto *reactor = new PushTaskBatchClientReactor(main_service_,
+                                                     std::move(queued_callback),
+                                                     std::move(reply_callback),
+                                                     std::move(done_callback));
+      reactor->Start(*task_batch_stub_, std::move(request));
+    }
+
+    if (!send_queue_.empty()) {
+      RAY_LOG(DEBUG) << "client send queue size " << send_queue_.size();
+    }
+  }
+
   /// Returns the max acked sequence number, useful for checking on progress.
   int64_t ClientProcessedUpToSeqno() override {
     absl::MutexLock lock(&mutex_);
@@ -465,6 +556,122 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   }
 
  private:
+  /// A task of a PushTaskBatch stream, until it's replied.
+  struct BatchedTask {
+    int64_t seq_no;
+    int64_t size;
+    /// Reset once the task is replied.
+    ClientCallback<PushTaskReply> callback;
+  };
+
+  /// Reply a task of a PushTaskBatch stream.
+  void FinishBatchedTask(BatchedTask &task, const Status &status, PushTaskReply &&reply) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (task.seq_no > max_finished_seq_no_) {
+        max_finished_seq_no_ = task.seq_no;
+      }
+      rpc_bytes_in_flight_ -= task.size;
+      RAY_CHECK(rpc_bytes_in_flight_ >= 0);
+    }
+    SendRequests();
+    auto callback = std::move(task.callback);
+    task.callback = nullptr;
+    callback(status, std::move(reply));
+  }
+
+  /// Push an actor task through the shared memory channel, if the actor is on the same
+  /// node as the caller. The channel is opened on the first task, and the tasks are
+  /// pushed over gRPC until it's open.
+  ///
+  /// \return False if the task has to be pushed over gRPC instead.
+  bool PushActorTaskToChannel(PushTaskRequest &request,
+                              const ClientCallback<PushTaskReply> &callback) {
+    std::shared_ptr<SharedMemoryChannelClient> channel;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (channel_state_ == ChannelState::kNotOpened) {
+        if (request.task_spec().caller_address().raylet_id() == addr_.raylet_id()) {
+          OpenSharedMemoryChannel();
+        } else {
+          channel_state_ = ChannelState::kUnavailable;
+        }
+      }
+      if (channel_state_ != ChannelState::kOpen) {
+        return false;
+      }
+      channel = channel_;
+      request.set_client_processed_up_to(max_finished_seq_no_);
+    }
+
+    const int64_t seq_no = request.sequence_number();
+    std::weak_ptr<CoreWorkerClient> weak_this = weak_from_this();
+    return channel->PushTask(
+        request,
+        [weak_this, seq_no, callback](const Status &status, PushTaskReply &&reply) {
+          if (auto this_ptr = weak_this.lock()) {
+            absl::MutexLock lock(&this_ptr->mutex_);
+            this_ptr->max_finished_seq_no_ =
+                std::max(this_ptr->max_finished_seq_no_, seq_no);
+          }
+          callback(status, std::move(reply));
+        });
+  }
+
+  /// Create a shared memory channel, and ask the actor to open it.
+  void OpenSharedMemoryChannel() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    // macOS limits the names of shared memory objects to 31 characters.
+    const std::string name = "/ray_" + UniqueID::FromRandom().Hex().substr(0, 16);
+    std::unique_ptr<SharedMemoryChannelClient> channel;
+    auto status = SharedMemoryChannelClient::Create(
+        name,
+        ::RayConfig::instance().actor_task_shared_memory_channel_bytes(),
+        main_service_,
+        &channel);
+    if (!status.ok()) {
+      RAY_LOG(WARNING) << "Failed to create a shared memory channel to worker "
+                       << WorkerID::FromBinary(addr_.worker_id())
+                       << ", actor tasks are pushed over gRPC: " << status;
+      channel_state_ = ChannelState::kUnavailable;
+      return;
+    }
+    channel_state_ = ChannelState::kOpening;
+
+    OpenSharedMemoryChannelRequest request;
+    request.set_intended_worker_id(addr_.worker_id());
+    request.set_channel_name(name);
+    std::weak_ptr<CoreWorkerClient> weak_this = weak_from_this();
+    std::shared_ptr<SharedMemoryChannelClient> shared_channel = std::move(channel);
+    auto callback = [weak_this, shared_channel](const Status &status,
+                                                OpenSharedMemoryChannelReply &&reply) {
+      shared_channel->Unlink();
+      auto this_ptr = weak_this.lock();
+      if (this_ptr == nullptr) {
+        return;
+      }
+      if (status.ok()) {
+        shared_channel->Start();
+      } else {
+        RAY_LOG(WARNING) << "Failed to open a shared memory channel to worker "
+                         << WorkerID::FromBinary(this_ptr->addr_.worker_id())
+                         << ", actor tasks are pushed over gRPC: " << status;
+      }
+      absl::MutexLock lock(&this_ptr->mutex_);
+      if (status.ok()) {
+        this_ptr->channel_ = shared_channel;
+        this_ptr->channel_state_ = ChannelState::kOpen;
+      } else {
+        this_ptr->channel_state_ = ChannelState::kUnavailable;
+      }
+    };
+    RAY_UNUSED(INVOKE_RPC_CALL(CoreWorkerService,
+                               OpenSharedMemoryChannel,
+                               request,
+                               std::move(callback),
+                               grpc_client_,
+                               /*method_timeout_ms*/ -1));
+  }
+
   /// Protects against unsafe concurrent access from the callback thread.
   absl::Mutex mutex_;
 
@@ -474,6 +681,12 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
   /// The RPC client.
   std::shared_ptr<GrpcClient<CoreWorkerService>> grpc_client_;
 
+  /// The stub of the PushTaskBatch streams, on the channel of `grpc_client_`.
+  std::unique_ptr<CoreWorkerTaskBatchService::Stub> task_batch_stub_;
+
+  /// The event loop that the replies are handled on.
+  instrumented_io_context &main_service_;
+
   std::shared_ptr<RetryableGrpcClient> retryable_grpc_client_;
 
   /// Queue of requests to send.
@@ -485,6 +698,17 @@ class CoreWorkerClient : public std::enable_shared_from_this<CoreWorkerClient>,
 
   /// The max sequence number we have processed responses for.
   int64_t max_finished_seq_no_ ABSL_GUARDED_BY(mutex_) = -1;
+
+  /// The number of PushTaskBatch streams whose tasks the actor hasn't queued yet.
+  int64_t batches_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  enum class ChannelState { kNotOpened, kOpening, kOpen, kUnavailable };
+
+  /// The state of the shared memory channel to the actor.
+  ChannelState channel_state_ ABSL_GUARDED_BY(mutex_) = ChannelState::kNotOpened;
+
+  /// The shared memory channel to the actor, once it's open.
+  std::shared_ptr<SharedMemoryChannelClient> channel_ ABSL_GUARDED_BY(mutex_);
 };
 
 using CoreWorkerClientFactoryFn =
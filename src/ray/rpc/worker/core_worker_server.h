@@ -34,6 +34,7 @@ namespace rpc {
 /// Disable gRPC server metrics since it incurs too high cardinality.
 #define RAY_CORE_WORKER_RPC_HANDLERS                                  \
   RAY_CORE_WORKER_RPC_SERVICE_HANDLER(PushTask)                       \
+  RAY_CORE_WORKER_RPC_SERVICE_HANDLER(OpenSharedMemoryChannel)        \
   RAY_CORE_WORKER_RPC_SERVICE_HANDLER(DirectActorCallArgWaitComplete) \
   RAY_CORE_WORKER_RPC_SERVICE_HANDLER(RayletNotifyGCSRestart)         \
   RAY_CORE_WORKER_RPC_SERVICE_HANDLER(GetObjectStatus)                \
@@ -60,6 +61,7 @@ namespace rpc {
 
 #define RAY_CORE_WORKER_DECLARE_RPC_HANDLERS                              \
   DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(PushTask)                       \
+  DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(OpenSharedMemoryChannel)        \
   DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(DirectActorCallArgWaitComplete) \
   DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(RayletNotifyGCSRestart)         \
   DECLARE_VOID_RPC_SERVICE_HANDLER_METHOD(GetObjectStatus)                \
@@ -0,0 +1,238 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/push_task_batch_stream.h"
+
+#include <memory>
+
+#include "ray/common/grpc_util.h"
+
+namespace ray {
+namespace rpc {
+
+PushTaskBatchServerReactor::PushTaskBatchServerReactor(
+    instrumented_io_context &io_context,
+    const PushTaskBatchRequest *request,
+    const PushTaskHandler &handler)
+    : io_context_(io_context),
+      request_(const_cast<PushTaskBatchRequest *>(request)),
+      replies_(request->requests_size()),
+      num_unreplied_(request->requests_size()) {
+  io_context_.post(
+      [this, handler]() {
+        // The tasks are handed over in order, so the scheduling queue receives them in
+        // the order of their sequence numbers.
+        for (int i = 0; i < request_->requests_size(); i++) {
+          handler(std::move(*request_->mutable_requests(i)),
+                  &replies_[i],
+                  [this, i](Status status,
+                            std::function<void()> success,
+                            std::function<void()> failure) {
+                    OnTaskReplied(i, status, std::move(success), std::move(failure));
+                  });
+        }
+        absl::MutexLock lock(&mutex_);
+        queued_ = true;
+        WriteIfPossible();
+      },
+      "PushTaskBatchServerReactor.HandleTasks");
+}
+
+void PushTaskBatchServerReactor::OnTaskReplied(int index,
+                                               const Status &status,
+                                               std::function<void()> success,
+                                               std::function<void()> failure) {
+  bool delete_this = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    num_unreplied_--;
+    if (!finished_) {
+      auto *item = pending_.add_items();
+      item->set_index(index);
+      item->set_status_code(static_cast<int32_t>(status.code()));
+      item->set_status_message(status.message());
+      item->mutable_reply()->Swap(&replies_[index]);
+      pending_callbacks_.emplace_back(std::move(success), std::move(failure));
+      WriteIfPossible();
+      return;
+    }
+    delete_this = done_ && num_unreplied_ == 0;
+  }
+  if (failure != nullptr) {
+    failure();
+  }
+  if (delete_this) {
+    delete this;
+  }
+}
+
+void PushTaskBatchServerReactor::WriteIfPossible() {
+  if (!queued_ || write_in_flight_ || finished_) {
+    return;
+  }
+  if (pending_.items_size() == 0 && first_written_) {
+    if (num_unreplied_ == 0) {
+      finished_ = true;
+      Finish(grpc::Status::OK);
+    }
+    return;
+  }
+  writing_.Swap(&pending_);
+  pending_.Clear();
+  writing_callbacks_.swap(pending_callbacks_);
+  pending_callbacks_.clear();
+  first_written_ = true;
+  write_in_flight_ = true;
+  StartWrite(&writing_);
+}
+
+std::vector<PushTaskBatchServerReactor::ReplyCallbacks>
+PushTaskBatchServerReactor::FinishWithError(const grpc::Status &status) {
+  std::vector<ReplyCallbacks> failed;
+  if (finished_) {
+    return failed;
+  }
+  finished_ = true;
+  Finish(status);
+  failed.swap(pending_callbacks_);
+  pending_.Clear();
+  return failed;
+}
+
+// Reactions are posted rather than dispatched, because the writes are started with the
+// lock held, and a write may complete inline.
+void PushTaskBatchServerReactor::OnWriteDone(bool ok) {
+  io_context_.post(
+      [this, ok]() {
+        std::vector<ReplyCallbacks> written;
+        std::vector<ReplyCallbacks> failed;
+        {
+          absl::MutexLock lock(&mutex_);
+          write_in_flight_ = false;
+          written.swap(writing_callbacks_);
+          writing_.Clear();
+          if (ok && !cancelled_) {
+            WriteIfPossible();
+          } else {
+            failed = FinishWithError(
+                grpc::Status(grpc::StatusCode::CANCELLED, "The caller is gone."));
+          }
+        }
+        for (const auto &callbacks : written) {
+          const auto &callback = ok ? callbacks.first : callbacks.second;
+          if (callback != nullptr) {
+            callback();
+          }
+        }
+        for (const auto &callbacks : failed) {
+          if (callbacks.second != nullptr) {
+            callbacks.second();
+          }
+        }
+      },
+      "PushTaskBatchServerReactor.OnWriteDone");
+}
+
+void PushTaskBatchServerReactor::OnCancel() {
+  io_context_.post(
+      [this]() {
+        std::vector<ReplyCallbacks> failed;
+        {
+          absl::MutexLock lock(&mutex_);
+          cancelled_ = true;
+          // Otherwise the stream is finished once the write in flight is done.
+          if (!write_in_flight_) {
+            failed = FinishWithError(
+                grpc::Status(grpc::StatusCode::CANCELLED, "The caller is gone."));
+          }
+        }
+        for (const auto &callbacks : failed) {
+          if (callbacks.second != nullptr) {
+            callbacks.second();
+          }
+        }
+      },
+      "PushTaskBatchServerReactor.OnCancel");
+}
+
+void PushTaskBatchServerReactor::OnDone() {
+  io_context_.post(
+      [this]() {
+        {
+          absl::MutexLock lock(&mutex_);
+          done_ = true;
+          if (num_unreplied_ > 0) {
+            // The last task to be replied deletes the reactor.
+            return;
+          }
+        }
+        delete this;
+      },
+      "PushTaskBatchServerReactor.OnDone");
+}
+
+grpc::ServerWriteReactor<PushTaskBatchReply> *PushTaskBatchService::PushTaskBatch(
+    grpc::CallbackServerContext *context, const PushTaskBatchRequest *request) {
+  return new PushTaskBatchServerReactor(io_context_, request, handler_);
+}
+
+void PushTaskBatchClientReactor::Start(CoreWorkerTaskBatchService::Stub &stub,
+                                       PushTaskBatchRequest request) {
+  request_ = std::move(request);
+  stub.async()->PushTaskBatch(&context_, &request_, this);
+  StartRead(&reply_);
+  StartCall();
+}
+
+void PushTaskBatchClientReactor::SetQueued() {
+  if (!queued_) {
+    queued_ = true;
+    queued_callback_();
+  }
+}
+
+void PushTaskBatchClientReactor::OnReadDone(bool ok) {
+  if (!ok) {
+    // OnDone follows.
+    return;
+  }
+  auto reply = std::make_shared<PushTaskBatchReply>();
+  reply->Swap(&reply_);
+  io_context_.post(
+      [this, reply]() {
+        SetQueued();
+        for (auto &item : *reply->mutable_items()) {
+          const auto code = static_cast<StatusCode>(item.status_code());
+          reply_callback_(
+              item.index(),
+              code == StatusCode::OK ? Status::OK() : Status(code, item.status_message()),
+              std::move(*item.mutable_reply()));
+        }
+      },
+      "PushTaskBatchClientReactor.OnReadDone");
+  StartRead(&reply_);
+}
+
+void PushTaskBatchClientReactor::OnDone(const grpc::Status &status) {
+  io_context_.post(
+      [this, status]() {
+        SetQueued();
+        done_callback_(GrpcStatusToRayStatus(status));
+        delete this;
+      },
+      "PushTaskBatchClientReactor.OnDone");
+}
+
+}  // namespace rpc
+}  // namespace ray
@@ -0,0 +1,159 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/status.h"
+#include "ray/rpc/server_call.h"
+#include "src/ray/protobuf/core_worker.grpc.pb.h"
+
+namespace ray {
+namespace rpc {
+
+using PushTaskHandler = std::function<void(
+    PushTaskRequest request, PushTaskReply *reply, SendReplyCallback callback)>;
+
+/// The actor side of a PushTaskBatch stream. The tasks are handed to the handler in the
+/// order of the batch on `io_context`, and their replies are written back as they
+/// finish. Replies that finish while a write is in flight go out together in the next
+/// write. The first write goes out once all of the tasks are handed over.
+///
+/// The reactor deletes itself once the stream is done and all of the tasks are replied,
+/// since the tasks may be replied after the caller is gone.
+class PushTaskBatchServerReactor : public grpc::ServerWriteReactor<PushTaskBatchReply> {
+ public:
+  PushTaskBatchServerReactor(instrumented_io_context &io_context,
+                             const PushTaskBatchRequest *request,
+                             const PushTaskHandler &handler);
+
+ private:
+  using ReplyCallbacks = std::pair<std::function<void()>, std::function<void()>>;
+
+  void OnWriteDone(bool ok) override;
+  void OnCancel() override;
+  void OnDone() override;
+
+  /// Called with the reply of the task at `index` of the batch, from any thread.
+  void OnTaskReplied(int index,
+                     const Status &status,
+                     std::function<void()> success,
+                     std::function<void()> failure);
+
+  /// Write the pending replies if no write is in flight, or finish the stream once
+  /// every task is written.
+  void WriteIfPossible() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  /// Finish the stream, failing the replies that aren't written yet.
+  ///
+  /// \return The failure callbacks of those replies, to be run without the lock.
+  std::vector<ReplyCallbacks> FinishWithError(const grpc::Status &status)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  instrumented_io_context &io_context_;
+  /// gRPC keeps the request alive until OnDone, and the tasks are moved out of it.
+  PushTaskBatchRequest *const request_;
+  /// The replies that the handler fills in, one per task. Each one is only accessed by
+  /// its task until the task is replied.
+  std::vector<PushTaskReply> replies_;
+
+  absl::Mutex mutex_;
+  /// Whether all of the tasks are handed to the handler.
+  bool queued_ ABSL_GUARDED_BY(mutex_) = false;
+  /// The number of tasks that the handler hasn't replied yet.
+  int num_unreplied_ ABSL_GUARDED_BY(mutex_);
+  /// The replies that aren't written yet, and their callbacks.
+  PushTaskBatchReply pending_ ABSL_GUARDED_BY(mutex_);
+  std::vector<ReplyCallbacks> pending_callbacks_ ABSL_GUARDED_BY(mutex_);
+  /// The buffer of the write in flight, and the callbacks of its replies.
+  PushTaskBatchReply writing_ ABSL_GUARDED_BY(mutex_);
+  std::vector<ReplyCallbacks> writing_callbacks_ ABSL_GUARDED_BY(mutex_);
+  bool write_in_flight_ ABSL_GUARDED_BY(mutex_) = false;
+  bool first_written_ ABSL_GUARDED_BY(mutex_) = false;
+  /// Whether the caller has cancelled the call.
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+  /// Whether Finish is called.
+  bool finished_ ABSL_GUARDED_BY(mutex_) = false;
+  /// Whether OnDone is called.
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+/// Serves PushTaskBatch with `handler`, which is usually CoreWorker::HandlePushTask.
+class PushTaskBatchService : public CoreWorkerTaskBatchService::CallbackService {
+ public:
+  PushTaskBatchService(instrumented_io_context &io_context, PushTaskHandler handler)
+      : io_context_(io_context), handler_(std::move(handler)) {}
+
+  grpc::ServerWriteReactor<PushTaskBatchReply> *PushTaskBatch(
+      grpc::CallbackServerContext *context,
+      const PushTaskBatchRequest *request) override;
+
+ private:
+  instrumented_io_context &io_context_;
+  const PushTaskHandler handler_;
+};
+
+/// The caller side of a PushTaskBatch stream. The callbacks are run on `io_context`.
+/// The reactor deletes itself after running `done_callback`.
+class PushTaskBatchClientReactor : public grpc::ClientReadReactor<PushTaskBatchReply> {
+ public:
+  /// Called once the actor has queued all of the tasks of the batch, or the stream
+  /// ended before that.
+  using QueuedCallback = std::function<void()>;
+  /// Called with the reply of the task at `index` of the batch.
+  using ReplyCallback =
+      std::function<void(int index, const Status &status, PushTaskReply &&reply)>;
+  /// Called when the stream ends. The tasks that weren't replied by then failed.
+  using DoneCallback = std::function<void(const Status &status)>;
+
+  PushTaskBatchClientReactor(instrumented_io_context &io_context,
+                             QueuedCallback queued_callback,
+                             ReplyCallback reply_callback,
+                             DoneCallback done_callback)
+      : io_context_(io_context),
+        queued_callback_(std::move(queued_callback)),
+        reply_callback_(std::move(reply_callback)),
+        done_callback_(std::move(done_callback)) {}
+
+  void Start(CoreWorkerTaskBatchService::Stub &stub, PushTaskBatchRequest request);
+
+ private:
+  void OnReadDone(bool ok) override;
+  void OnDone(const grpc::Status &status) override;
+
+  /// Run `queued_callback_` if it hasn't run yet. Only called from `io_context_`.
+  void SetQueued();
+
+  instrumented_io_context &io_context_;
+  const QueuedCallback queued_callback_;
+  const ReplyCallback reply_callback_;
+  const DoneCallback done_callback_;
+  grpc::ClientContext context_;
+  PushTaskBatchRequest request_;
+  /// The buffer of the read in flight.
+  PushTaskBatchReply reply_;
+  /// Only accessed from `io_context_`.
+  bool queued_ = false;
+};
+
+}  // namespace rpc
+}  // namespace ray
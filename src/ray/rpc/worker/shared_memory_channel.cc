@@ -0,0 +1,674 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/shared_memory_channel.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace rpc {
+
+namespace {
+
+/// Marks the end of the ring, after which the next message starts at offset 0.
+constexpr uint32_t kWrapMarker = std::numeric_limits<uint32_t>::max();
+/// How many times the reader polls the ring before it goes to sleep.
+constexpr int kSpinIterations = 4096;
+/// How often the channel threads check whether they're stopped, and beat.
+constexpr int64_t kPollIntervalMs = 100;
+
+struct FrameHeader {
+  uint32_t size;
+  uint32_t reserved;
+  uint64_t tag;
+};
+
+/// Frames are 8-byte aligned, so that a frame header never straddles the end.
+uint64_t FrameSize(uint64_t message_size) {
+  return (sizeof(FrameHeader) + message_size + 7) & ~uint64_t{7};
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+#ifdef __linux__
+void FutexWait(std::atomic<uint32_t> *word, uint32_t expected, int64_t timeout_ms) {
+  struct timespec timeout;
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+  // Not FUTEX_PRIVATE_FLAG, since the word is shared with another process.
+  syscall(SYS_futex,
+          reinterpret_cast<uint32_t *>(word),
+          FUTEX_WAIT,
+          expected,
+          &timeout,
+          nullptr,
+          0);
+}
+
+void FutexWake(std::atomic<uint32_t> *word) {
+  syscall(SYS_futex,
+          reinterpret_cast<uint32_t *>(word),
+          FUTEX_WAKE,
+          INT_MAX,
+          nullptr,
+          nullptr,
+          0);
+}
+#endif
+
+std::string ErrnoMessage(const std::string &what, const std::string &name) {
+  return what + " " + name + ": " + std::strerror(errno);
+}
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+/// The header of the ring at the start of the shared memory object. The positions count
+/// the bytes ever written and read, and they're on separate cache lines so that the two
+/// sides don't contend.
+struct SharedMemoryRing::Header {
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> write_pos;
+  alignas(64) std::atomic<uint64_t> read_pos;
+  /// The futex word that the reader sleeps on. 1 if the reader is sleeping.
+  alignas(64) std::atomic<uint32_t> reader_sleeping;
+  std::atomic<uint32_t> closed;
+  /// 1 if the reader should stop waiting for a message.
+  std::atomic<uint32_t> interrupted;
+  /// 1 if the writer is waiting for the reader to free room.
+  alignas(64) std::atomic<uint32_t> room_requested;
+  /// The heartbeats of the process that created the ring, and of the one that opened it.
+  alignas(64) std::atomic<uint64_t> heartbeats[2];
+};
+
+uint64_t SharedMemoryRing::DataOffset() { return (sizeof(Header) + 63) & ~uint64_t{63}; }
+
+Status SharedMemoryRing::Create(const std::string &name,
+                                uint64_t capacity,
+                                std::unique_ptr<SharedMemoryRing> *ring) {
+#ifdef _WIN32
+  return Status::NotImplemented("Shared memory rings are not supported on Windows.");
+#else
+  capacity = (std::max<uint64_t>(capacity, FrameSize(0)) + 7) & ~uint64_t{7};
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return Status::IOError(ErrnoMessage("Failed to create shared memory", name));
+  }
+  const uint64_t mapping_size = DataOffset() + capacity;
+  if (ftruncate(fd, mapping_size) != 0) {
+    auto status = Status::IOError(ErrnoMessage("Failed to resize shared memory", name));
+    close(fd);
+    shm_unlink(name.c_str());
+    return status;
+  }
+  void *mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    auto status = Status::IOError(ErrnoMessage("Failed to map shared memory", name));
+    shm_unlink(name.c_str());
+    return status;
+  }
+  auto *header = new (mapping) Header();
+  header->capacity = capacity;
+  header->write_pos.store(0);
+  header->read_pos.store(0);
+  header->reader_sleeping.store(0);
+  header->closed.store(0);
+  header->interrupted.store(0);
+  header->room_requested.store(0);
+  header->heartbeats[0].store(0);
+  header->heartbeats[1].store(0);
+  ring->reset(new SharedMemoryRing(name, mapping, mapping_size, /*is_creator=*/true));
+  return Status::OK();
+#endif
+}
+
+Status SharedMemoryRing::Open(const std::string &name,
+                              std::unique_ptr<SharedMemoryRing> *ring) {
+#ifdef _WIN32
+  return Status::NotImplemented("Shared memory rings are not supported on Windows.");
+#else
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    return Status::IOError(ErrnoMessage("Failed to open shared memory", name));
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    auto status = Status::IOError(ErrnoMessage("Failed to stat shared memory", name));
+    close(fd);
+    return status;
+  }
+  const uint64_t mapping_size = info.st_size;
+  if (mapping_size <= DataOffset()) {
+    close(fd);
+    return Status::Invalid("Shared memory " + name + " is not a ring.");
+  }
+  void *mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return Status::IOError(ErrnoMessage("Failed to map shared memory", name));
+  }
+  if (static_cast<Header *>(mapping)->capacity != mapping_size - DataOffset()) {
+    munmap(mapping, mapping_size);
+    return Status::Invalid("Shared memory " + name + " is not a ring.");
+  }
+  ring->reset(new SharedMemoryRing(name, mapping, mapping_size, /*is_creator=*/false));
+  return Status::OK();
+#endif
+}
+
+SharedMemoryRing::SharedMemoryRing(std::string name,
+                                   void *mapping,
+                                   uint64_t mapping_size,
+                                   bool is_creator)
+    : name_(std::move(name)),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      header_(static_cast<Header *>(mapping)),
+      data_(static_cast<uint8_t *>(mapping) + DataOffset()),
+      is_creator_(is_creator) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+#ifndef _WIN32
+  munmap(mapping_, mapping_size_);
+#endif
+}
+
+bool SharedMemoryRing::Write(uint64_t tag, const google::protobuf::MessageLite &message) {
+  const uint64_t message_size = message.ByteSizeLong();
+  if (!Fits(message_size) || IsClosed()) {
+    return false;
+  }
+  const uint64_t capacity = header_->capacity;
+  const uint64_t frame_size = FrameSize(message_size);
+  uint64_t write_pos = header_->write_pos.load(std::memory_order_relaxed);
+  // Sequentially consistent, so that either the writer sees the room that the reader
+  // freed, or the reader sees the writer's request for room.
+  const uint64_t read_pos = header_->read_pos.load(std::memory_order_seq_cst);
+  uint64_t offset = write_pos % capacity;
+  // A frame that doesn't fit before the end of the ring starts over at offset 0.
+  const uint64_t padding = capacity - offset < frame_size ? capacity - offset : 0;
+  if (write_pos + padding + frame_size - read_pos > capacity) {
+    return false;
+  }
+  if (padding > 0) {
+    std::memcpy(data_ + offset, &kWrapMarker, sizeof(kWrapMarker));
+    write_pos += padding;
+    offset = 0;
+  }
+
+  FrameHeader frame{static_cast<uint32_t>(message_size), 0, tag};
+  std::memcpy(data_ + offset, &frame, sizeof(frame));
+  message.SerializeWithCachedSizesToArray(data_ + offset + sizeof(frame));
+  // Sequentially consistent, so that either the reader sees the message before it
+  // sleeps, or the writer sees that the reader is sleeping.
+  header_->write_pos.store(write_pos + frame_size, std::memory_order_seq_cst);
+  if (header_->reader_sleeping.load(std::memory_order_seq_cst) != 0) {
+    WakeReader();
+  }
+  return true;
+}
+
+bool SharedMemoryRing::Read(uint64_t *tag,
+                            google::protobuf::MessageLite *message,
+                            int64_t timeout_ms) {
+  uint64_t read_pos = header_->read_pos.load(std::memory_order_relaxed);
+  if (header_->write_pos.load(std::memory_order_acquire) == read_pos &&
+      !WaitForMessage(read_pos, timeout_ms)) {
+    return false;
+  }
+
+  const uint64_t capacity = header_->capacity;
+  uint64_t offset = read_pos % capacity;
+  uint32_t size;
+  std::memcpy(&size, data_ + offset, sizeof(size));
+  if (size == kWrapMarker) {
+    read_pos += capacity - offset;
+    offset = 0;
+  }
+  FrameHeader frame;
+  std::memcpy(&frame, data_ + offset, sizeof(frame));
+  if (FrameSize(frame.size) > capacity - offset) {
+    RAY_LOG(ERROR) << "Shared memory ring " << name_ << " is corrupted, closing it.";
+    Close();
+    return false;
+  }
+  *tag = frame.tag;
+  const bool parsed =
+      message->ParseFromArray(data_ + offset + sizeof(frame), static_cast<int>(frame.size));
+  header_->read_pos.store(read_pos + FrameSize(frame.size), std::memory_order_seq_cst);
+  return parsed;
+}
+
+bool SharedMemoryRing::WaitForMessage(uint64_t read_pos, int64_t timeout_ms) {
+  for (int i = 0; i < kSpinIterations; i++) {
+    if (header_->write_pos.load(std::memory_order_acquire) != read_pos) {
+      return true;
+    }
+    if (IsClosed() || TakeInterrupt()) {
+      return false;
+    }
+    CpuRelax();
+  }
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (true) {
+    header_->reader_sleeping.store(1, std::memory_order_seq_cst);
+    if (header_->write_pos.load(std::memory_order_seq_cst) != read_pos) {
+      header_->reader_sleeping.store(0, std::memory_order_relaxed);
+      return true;
+    }
+    const auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  deadline - std::chrono::steady_clock::now())
+                                  .count();
+    if (IsClosed() || TakeInterrupt() || remaining_ms <= 0) {
+      header_->reader_sleeping.store(0, std::memory_order_relaxed);
+      return false;
+    }
+#ifdef __linux__
+    FutexWait(&header_->reader_sleeping, 1, remaining_ms);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+  }
+}
+
+void SharedMemoryRing::WakeReader() {
+  header_->reader_sleeping.store(0, std::memory_order_seq_cst);
+#ifdef __linux__
+  FutexWake(&header_->reader_sleeping);
+#endif
+}
+
+bool SharedMemoryRing::TakeInterrupt() {
+  return header_->interrupted.load(std::memory_order_seq_cst) != 0 &&
+         header_->interrupted.exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+void SharedMemoryRing::Interrupt() {
+  header_->interrupted.store(1, std::memory_order_seq_cst);
+  if (header_->reader_sleeping.load(std::memory_order_seq_cst) != 0) {
+    WakeReader();
+  }
+}
+
+void SharedMemoryRing::RequestRoom() {
+  header_->room_requested.store(1, std::memory_order_seq_cst);
+}
+
+bool SharedMemoryRing::TakeRoomRequest() {
+  return header_->room_requested.load(std::memory_order_seq_cst) != 0 &&
+         header_->room_requested.exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+void SharedMemoryRing::Close() {
+  header_->closed.store(1, std::memory_order_seq_cst);
+  WakeReader();
+}
+
+bool SharedMemoryRing::IsClosed() const {
+  return header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool SharedMemoryRing::Fits(uint64_t message_size) const {
+  return message_size < kWrapMarker && FrameSize(message_size) <= header_->capacity;
+}
+
+void SharedMemoryRing::Unlink() {
+#ifndef _WIN32
+  if (!unlinked_) {
+    shm_unlink(name_.c_str());
+    unlinked_ = true;
+  }
+#endif
+}
+
+uint64_t SharedMemoryRing::Capacity() const { return header_->capacity; }
+
+void SharedMemoryRing::Heartbeat() {
+  header_->heartbeats[is_creator_ ? 0 : 1].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t SharedMemoryRing::PeerHeartbeats() const {
+  return header_->heartbeats[is_creator_ ? 1 : 0].load(std::memory_order_relaxed);
+}
+
+SharedMemoryRingPeerMonitor::SharedMemoryRingPeerMonitor(const SharedMemoryRing &ring)
+    : ring_(ring),
+      timeout_ms_(RayConfig::instance().actor_task_shared_memory_channel_peer_timeout_ms()),
+      last_heartbeats_(ring.PeerHeartbeats()),
+      last_heartbeat_ms_(NowMs()) {}
+
+bool SharedMemoryRingPeerMonitor::IsPeerAlive() {
+  const uint64_t heartbeats = ring_.PeerHeartbeats();
+  const int64_t now_ms = NowMs();
+  if (heartbeats != last_heartbeats_) {
+    last_heartbeats_ = heartbeats;
+    last_heartbeat_ms_ = now_ms;
+    return true;
+  }
+  return now_ms - last_heartbeat_ms_ < timeout_ms_;
+}
+
+Status SharedMemoryChannelClient::Create(
+    const std::string &name,
+    uint64_t capacity,
+    instrumented_io_context &io_context,
+    std::unique_ptr<SharedMemoryChannelClient> *channel) {
+  auto state = std::make_shared<State>(io_context);
+  RAY_RETURN_NOT_OK(SharedMemoryRing::Create(name + "_req", capacity, &state->requests));
+  auto status = SharedMemoryRing::Create(name + "_rep", capacity, &state->replies);
+  if (!status.ok()) {
+    state->requests->Unlink();
+    return status;
+  }
+  channel->reset(new SharedMemoryChannelClient(name, std::move(state)));
+  return Status::OK();
+}
+
+SharedMemoryChannelClient::SharedMemoryChannelClient(std::string name,
+                                                     std::shared_ptr<State> state)
+    : name_(std::move(name)), state_(std::move(state)) {}
+
+SharedMemoryChannelClient::~SharedMemoryChannelClient() {
+  state_->stopped = true;
+  state_->requests->Close();
+  state_->replies->Close();
+  Unlink();
+  if (reply_thread_.joinable()) {
+    reply_thread_.join();
+  }
+}
+
+void SharedMemoryChannelClient::Unlink() {
+  state_->requests->Unlink();
+  state_->replies->Unlink();
+}
+
+void SharedMemoryChannelClient::Start() {
+  RAY_CHECK(!reply_thread_.joinable());
+  reply_thread_ = std::thread([state = state_]() { ReadReplies(state); });
+}
+
+bool SharedMemoryChannelClient::PushTask(const PushTaskRequest &request,
+                                         ClientCallback<PushTaskReply> callback) {
+  absl::MutexLock lock(&state_->mutex);
+  if (state_->closed) {
+    return false;
+  }
+  const uint64_t tag = state_->next_tag;
+  if (!state_->requests->Write(tag, request)) {
+    return false;
+  }
+  state_->next_tag++;
+  state_->callbacks.emplace(tag, std::move(callback));
+  return true;
+}
+
+void SharedMemoryChannelClient::ReadReplies(const std::shared_ptr<State> &state) {
+  PushTaskBatchReply::Item item;
+  uint64_t tag;
+  // The heartbeats of both sides go through the ring of the requests.
+  SharedMemoryRingPeerMonitor actor(*state->requests);
+  while (!state->stopped) {
+    state->requests->Heartbeat();
+    if (!actor.IsPeerAlive()) {
+      RAY_LOG(WARNING) << "The actor on the other side of a shared memory channel "
+                          "stopped beating, closing the channel.";
+      state->requests->Close();
+      state->replies->Close();
+      break;
+    }
+    if (!state->replies->Read(&tag, &item, kPollIntervalMs)) {
+      if (state->replies->IsClosed()) {
+        break;
+      }
+      continue;
+    }
+    if (state->replies->TakeRoomRequest()) {
+      // The actor has replies queued until there is room for them.
+      state->requests->Interrupt();
+    }
+    ClientCallback<PushTaskReply> callback;
+    {
+      absl::MutexLock lock(&state->mutex);
+      auto it = state->callbacks.find(tag);
+      if (it == state->callbacks.end()) {
+        continue;
+      }
+      callback = std::move(it->second);
+      state->callbacks.erase(it);
+    }
+    const auto code = static_cast<StatusCode>(item.status_code());
+    auto status =
+        code == StatusCode::OK ? Status::OK() : Status(code, item.status_message());
+    auto reply = std::make_shared<PushTaskReply>();
+    reply->Swap(item.mutable_reply());
+    state->io_context.post(
+        [callback = std::move(callback), status, reply]() {
+          callback(status, std::move(*reply));
+        },
+        "SharedMemoryChannelClient.ReadReplies");
+    item.Clear();
+  }
+
+  std::vector<ClientCallback<PushTaskReply>> callbacks;
+  {
+    absl::MutexLock lock(&state->mutex);
+    state->closed = true;
+    if (state->stopped) {
+      return;
+    }
+    for (auto &entry : state->callbacks) {
+      callbacks.push_back(std::move(entry.second));
+    }
+    state->callbacks.clear();
+  }
+  state->io_context.post(
+      [callbacks = std::move(callbacks)]() {
+        for (auto &callback : callbacks) {
+          callback(Status::IOError("The shared memory channel to the actor is closed."),
+                   PushTaskReply());
+        }
+      },
+      "SharedMemoryChannelClient.ReadReplies");
+}
+
+Status SharedMemoryChannelServer::Open(
+    const std::string &name,
+    PushTaskHandler handler,
+    std::function<void()> closed_callback,
+    std::unique_ptr<SharedMemoryChannelServer> *channel) {
+  std::unique_ptr<SharedMemoryRing> requests;
+  std::unique_ptr<SharedMemoryRing> replies;
+  RAY_RETURN_NOT_OK(SharedMemoryRing::Open(name + "_req", &requests));
+  RAY_RETURN_NOT_OK(SharedMemoryRing::Open(name + "_rep", &replies));
+  channel->reset(new SharedMemoryChannelServer(std::move(requests),
+                                               std::move(replies),
+                                               std::move(handler),
+                                               std::move(closed_callback)));
+  return Status::OK();
+}
+
+SharedMemoryChannelServer::SharedMemoryChannelServer(
+    std::unique_ptr<SharedMemoryRing> requests,
+    std::unique_ptr<SharedMemoryRing> replies,
+    PushTaskHandler handler,
+    std::function<void()> closed_callback)
+    : requests_(std::move(requests)),
+      replies_(std::make_shared<Replies>()),
+      handler_(std::move(handler)),
+      closed_callback_(std::move(closed_callback)) {
+  replies_->ring = std::move(replies);
+  request_thread_ = std::thread([this]() { ReadRequests(); });
+}
+
+SharedMemoryChannelServer::~SharedMemoryChannelServer() {
+  stopped_ = true;
+  requests_->Close();
+  request_thread_.join();
+}
+
+bool SharedMemoryChannelServer::IsClosed() const { return requests_->IsClosed(); }
+
+void SharedMemoryChannelServer::ReadRequests() {
+  uint64_t tag;
+  SharedMemoryRingPeerMonitor caller(*requests_);
+  while (!stopped_) {
+    requests_->Heartbeat();
+    WritePendingReplies();
+    if (!caller.IsPeerAlive()) {
+      RAY_LOG(WARNING) << "The caller on the other side of a shared memory channel "
+                          "stopped beating, closing the channel.";
+      requests_->Close();
+      break;
+    }
+    PushTaskRequest request;
+    if (!requests_->Read(&tag, &request, kPollIntervalMs)) {
+      if (requests_->IsClosed()) {
+        break;
+      }
+      continue;
+    }
+    auto reply = std::make_shared<PushTaskReply>();
+    auto *reply_ptr = reply.get();
+    handler_(std::move(request),
+             reply_ptr,
+             [replies = replies_, reply = std::move(reply), tag](
+                 Status status,
+                 std::function<void()> success,
+                 std::function<void()> failure) {
+               PendingReply pending{tag, {}, std::move(success), std::move(failure)};
+               pending.item.mutable_reply()->Swap(reply.get());
+               pending.item.set_status_code(static_cast<int32_t>(status.code()));
+               pending.item.set_status_message(status.message());
+               WriteReply(*replies, std::move(pending));
+             });
+  }
+  CloseReplies();
+  if (!stopped_ && closed_callback_ != nullptr) {
+    closed_callback_();
+  }
+}
+
+void SharedMemoryChannelServer::WriteReply(Replies &replies, PendingReply reply) {
+  std::vector<std::function<void()>> done;
+  {
+    absl::MutexLock lock(&replies.mutex);
+    if (!replies.ring->Fits(reply.item.ByteSizeLong())) {
+      reply.item.Clear();
+      reply.item.set_status_code(static_cast<int32_t>(StatusCode::IOError));
+      reply.item.set_status_message(
+          "The reply of the task doesn't fit into the shared memory channel.");
+    }
+    if (replies.ring->IsClosed()) {
+      done.push_back(std::move(reply.failure));
+    } else {
+      // If the ring is full, the reply stays queued. Rather than waiting for the caller
+      // here, which may be a task execution thread, the request thread writes it once
+      // the caller frees room.
+      replies.pending.push_back(std::move(reply));
+      done = WritePendingRepliesLocked(replies);
+    }
+  }
+  for (const auto &callback : done) {
+    if (callback != nullptr) {
+      callback();
+    }
+  }
+}
+
+void SharedMemoryChannelServer::WritePendingReplies() {
+  std::vector<std::function<void()>> written;
+  {
+    absl::MutexLock lock(&replies_->mutex);
+    written = WritePendingRepliesLocked(*replies_);
+  }
+  for (const auto &success : written) {
+    if (success != nullptr) {
+      success();
+    }
+  }
+}
+
+std::vector<std::function<void()>> SharedMemoryChannelServer::WritePendingRepliesLocked(
+    Replies &replies) {
+  std::vector<std::function<void()>> written;
+  bool requested_room = false;
+  while (!replies.pending.empty()) {
+    auto &reply = replies.pending.front();
+    if (!replies.ring->Write(reply.tag, reply.item)) {
+      if (requested_room) {
+        break;
+      }
+      // Retry once after the request, in case the caller freed room before seeing it.
+      replies.ring->RequestRoom();
+      requested_room = true;
+      continue;
+    }
+    written.push_back(std::move(reply.success));
+    replies.pending.pop_front();
+  }
+  return written;
+}
+
+void SharedMemoryChannelServer::CloseReplies() {
+  std::deque<PendingReply> failed;
+  {
+    absl::MutexLock lock(&replies_->mutex);
+    replies_->ring->Close();
+    failed.swap(replies_->pending);
+  }
+  for (const auto &reply : failed) {
+    if (reply.failure != nullptr) {
+      reply.failure();
+    }
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
@@ -0,0 +1,297 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <google/protobuf/message_lite.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "ray/common/asio/instrumented_io_context.h"
+#include "ray/common/status.h"
+#include "ray/rpc/client_call.h"
+#include "ray/rpc/server_call.h"
+#include "src/ray/protobuf/core_worker.pb.h"
+
+namespace ray {
+namespace rpc {
+
+/// A queue of messages in a POSIX shared memory object, with a single writer and a
+/// single reader, which may be in different processes.
+///
+/// Messages are protobufs tagged with a number, and they are (de)serialized in place.
+/// Neither side makes a syscall while the reader keeps up: the reader spins for a
+/// while before it sleeps on a futex, and only then does the writer have to wake it.
+///
+/// Write and Read are each meant to be called by one thread at a time.
+class SharedMemoryRing {
+ public:
+  /// Create the ring as a new shared memory object.
+  ///
+  /// \param[in] name The name of the shared memory object, see shm_open(3).
+  /// \param[in] capacity The number of bytes of the messages that the ring can hold.
+  /// \param[out] ring The ring.
+  static Status Create(const std::string &name,
+                       uint64_t capacity,
+                       std::unique_ptr<SharedMemoryRing> *ring);
+
+  /// Map the ring created by another process.
+  static Status Open(const std::string &name, std::unique_ptr<SharedMemoryRing> *ring);
+
+  ~SharedMemoryRing();
+
+  SharedMemoryRing(const SharedMemoryRing &) = delete;
+  SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+
+  /// Append a message.
+  ///
+  /// \return False if there is no room for the message, or the ring is closed.
+  bool Write(uint64_t tag, const google::protobuf::MessageLite &message);
+
+  /// Pop the next message, waiting up to `timeout_ms` for one to be written.
+  ///
+  /// \return False if no message was read, e.g., because the ring was closed.
+  bool Read(uint64_t *tag, google::protobuf::MessageLite *message, int64_t timeout_ms);
+
+  /// Make the reader's current or next wait for a message return false right away,
+  /// e.g., so that its thread gets to other work.
+  void Interrupt();
+
+  /// Ask the reader to report, through `TakeRoomRequest`, the next time it frees room
+  /// in the ring. The writer should retry once after this, since the reader may have
+  /// freed room before it saw the request.
+  void RequestRoom();
+
+  /// Whether the writer has requested room since the last call. The reader calls this
+  /// after a read, and notifies the writer if so.
+  bool TakeRoomRequest();
+
+  /// Close the ring. Pending messages can still be read, and the reader is woken up.
+  void Close();
+
+  bool IsClosed() const;
+
+  /// Whether a message of `message_size` bytes could ever fit into the ring.
+  bool Fits(uint64_t message_size) const;
+
+  /// Count a heartbeat of this side of the ring, i.e., of the process that created it
+  /// or of the one that opened it.
+  void Heartbeat();
+
+  /// The number of heartbeats of the other side of the ring.
+  uint64_t PeerHeartbeats() const;
+
+  /// Remove the name of the shared memory object, so that it's freed once both sides
+  /// unmap it. Mapped rings stay valid.
+  void Unlink();
+
+  uint64_t Capacity() const;
+
+ private:
+  struct Header;
+
+  SharedMemoryRing(std::string name,
+                   void *mapping,
+                   uint64_t mapping_size,
+                   bool is_creator);
+
+  /// Where the messages start in the shared memory object, after the header.
+  static uint64_t DataOffset();
+
+  /// Wait for the writer to move past `read_pos`, or the ring to be closed or
+  /// interrupted.
+  bool WaitForMessage(uint64_t read_pos, int64_t timeout_ms);
+
+  /// Clear the interrupt of the reader. Returns whether there was one.
+  bool TakeInterrupt();
+
+  /// Wake up the reader if it's sleeping.
+  void WakeReader();
+
+  const std::string name_;
+  void *mapping_;
+  const uint64_t mapping_size_;
+  Header *header_;
+  uint8_t *data_;
+  /// Whether this process created the ring, rather than opened it.
+  const bool is_creator_;
+  bool unlinked_ = false;
+};
+
+/// Tells whether the other side of a ring is alive, from its heartbeats. The other side
+/// is considered dead once it hasn't beaten for
+/// actor_task_shared_memory_channel_peer_timeout_ms.
+class SharedMemoryRingPeerMonitor {
+ public:
+  explicit SharedMemoryRingPeerMonitor(const SharedMemoryRing &ring);
+
+  bool IsPeerAlive();
+
+ private:
+  const SharedMemoryRing &ring_;
+  const int64_t timeout_ms_;
+  uint64_t last_heartbeats_;
+  int64_t last_heartbeat_ms_;
+};
+
+/// The caller side of a shared memory channel to an actor on the same node. Actor tasks
+/// are pushed through one ring, and their replies are read back from another one by a
+/// dedicated thread, which posts the reply callbacks to the io context.
+///
+/// Replies that are pending when the channel is destroyed are dropped: the task
+/// submitter fails the inflight tasks once the actor is disconnected. If the actor
+/// closes the channel, or its process is gone, the pending replies fail with an
+/// IOError and no more tasks can be pushed.
+class SharedMemoryChannelClient {
+ public:
+  /// Create the rings of the channel, named after `name`. The actor opens them with
+  /// `SharedMemoryChannelServer::Open`. The reply callbacks run on `io_context`.
+  static Status Create(const std::string &name,
+                       uint64_t capacity,
+                       instrumented_io_context &io_context,
+                       std::unique_ptr<SharedMemoryChannelClient> *channel);
+
+  ~SharedMemoryChannelClient();
+
+  /// Remove the names of the rings, once the actor opened the channel or failed to.
+  void Unlink();
+
+  /// Start reading the replies.
+  void Start();
+
+  /// Push an actor task through the channel.
+  ///
+  /// \return False if the task wasn't pushed, e.g., because the ring is full, in which
+  /// case the callback isn't called.
+  bool PushTask(const PushTaskRequest &request, ClientCallback<PushTaskReply> callback);
+
+  const std::string &Name() const { return name_; }
+
+ private:
+  /// The state shared with the reply thread.
+  struct State {
+    explicit State(instrumented_io_context &io_context) : io_context(io_context) {}
+
+    instrumented_io_context &io_context;
+    absl::Mutex mutex;
+    /// Writes to the ring are serialized by `mutex`.
+    std::unique_ptr<SharedMemoryRing> requests;
+    std::unique_ptr<SharedMemoryRing> replies;
+    uint64_t next_tag ABSL_GUARDED_BY(mutex) = 0;
+    absl::flat_hash_map<uint64_t, ClientCallback<PushTaskReply>> callbacks
+        ABSL_GUARDED_BY(mutex);
+    /// Set once the replies can't be read anymore.
+    bool closed ABSL_GUARDED_BY(mutex) = false;
+    std::atomic<bool> stopped{false};
+  };
+
+  SharedMemoryChannelClient(std::string name, std::shared_ptr<State> state);
+
+  static void ReadReplies(const std::shared_ptr<State> &state);
+
+  const std::string name_;
+  std::shared_ptr<State> state_;
+  std::thread reply_thread_;
+};
+
+/// The actor side of a shared memory channel, see `SharedMemoryChannelClient`. A
+/// dedicated thread reads the pushed tasks and hands them to the handler, whose replies
+/// are written back from whichever thread sends them. The replies that don't fit while
+/// the ring is full are queued, and once the caller reads a reply it interrupts the
+/// dedicated thread, which writes the queued ones.
+///
+/// The channel closes itself once the caller closes it or its process is gone.
+class SharedMemoryChannelServer {
+ public:
+  using PushTaskHandler = std::function<void(
+      PushTaskRequest request, PushTaskReply *reply, SendReplyCallback callback)>;
+
+  /// Open the channel created by the caller.
+  ///
+  /// \param[in] name The name of the channel.
+  /// \param[in] handler Handles the pushed tasks, on the channel's thread.
+  /// \param[in] closed_callback Called on the channel's thread once the channel closed
+  /// itself, after which it can be destroyed from another thread.
+  /// \param[out] channel The channel.
+  static Status Open(const std::string &name,
+                     PushTaskHandler handler,
+                     std::function<void()> closed_callback,
+                     std::unique_ptr<SharedMemoryChannelServer> *channel);
+
+  ~SharedMemoryChannelServer();
+
+  /// Whether the caller has closed the channel.
+  bool IsClosed() const;
+
+ private:
+  /// A reply that didn't fit into the ring yet.
+  struct PendingReply {
+    uint64_t tag;
+    PushTaskBatchReply::Item item;
+    std::function<void()> success;
+    std::function<void()> failure;
+  };
+
+  /// The ring of the replies, shared with the reply callbacks, which may outlive the
+  /// channel.
+  struct Replies {
+    absl::Mutex mutex;
+    std::unique_ptr<SharedMemoryRing> ring ABSL_GUARDED_BY(mutex);
+    /// The replies to write once the ring has room, in order.
+    std::deque<PendingReply> pending ABSL_GUARDED_BY(mutex);
+  };
+
+  SharedMemoryChannelServer(std::unique_ptr<SharedMemoryRing> requests,
+                            std::unique_ptr<SharedMemoryRing> replies,
+                            PushTaskHandler handler,
+                            std::function<void()> closed_callback);
+
+  void ReadRequests();
+
+  /// Write a reply, or queue it if the ring is full.
+  static void WriteReply(Replies &replies, PendingReply reply);
+
+  /// Write the queued replies that fit into the ring.
+  void WritePendingReplies();
+
+  /// Write the queued replies that fit into the ring, and if some don't, ask the caller
+  /// to interrupt the request thread once it frees room.
+  ///
+  /// \return The success callbacks of the written replies, to call without the lock.
+  static std::vector<std::function<void()>> WritePendingRepliesLocked(Replies &replies)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(replies.mutex);
+
+  /// Close the ring of the replies, and fail the queued ones.
+  void CloseReplies();
+
+  std::unique_ptr<SharedMemoryRing> requests_;
+  std::shared_ptr<Replies> replies_;
+  const PushTaskHandler handler_;
+  const std::function<void()> closed_callback_;
+  std::atomic<bool> stopped_{false};
+  std::thread request_thread_;
+};
+
+}  // namespace rpc
+}  // namespace ray
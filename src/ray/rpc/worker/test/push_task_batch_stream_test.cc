@@ -0,0 +1,164 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/push_task_batch_stream.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ray/common/ray_config.h"
+#include "ray/rpc/grpc_server.h"
+#include "ray/rpc/worker/core_worker_client.h"
+
+namespace ray {
+namespace rpc {
+
+class PushTaskBatchStreamTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    // Two batches of two tasks, and the second batch is only sent once the first one
+    // is queued.
+    RayConfig::instance().initialize(
+        R"({"actor_task_push_batch_size": 2, "actor_task_push_batch_max_in_flight": 1})");
+
+    server_thread_ = std::thread([this]() {
+      boost::asio::io_service::work work(server_io_service_);
+      server_io_service_.run();
+    });
+    service_ = std::make_unique<PushTaskBatchService>(
+        server_io_service_,
+        [this](PushTaskRequest request,
+               PushTaskReply *reply,
+               SendReplyCallback send_reply_callback) {
+          HandlePushTask(request.sequence_number(), std::move(send_reply_callback));
+        });
+    server_ = std::make_unique<GrpcServer>("test", 0, true);
+    server_->RegisterService(*service_);
+    server_->Run();
+    while (server_->GetPort() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    client_thread_ = std::thread([this]() {
+      boost::asio::io_service::work work(client_io_service_);
+      client_io_service_.run();
+    });
+    client_call_manager_ = std::make_unique<ClientCallManager>(client_io_service_);
+    Address address;
+    address.set_ip_address("127.0.0.1");
+    address.set_port(server_->GetPort());
+    client_ =
+        std::make_shared<CoreWorkerClient>(address, *client_call_manager_, []() {});
+  }
+
+  void TearDown() override {
+    client_.reset();
+    client_call_manager_.reset();
+    client_io_service_.stop();
+    client_thread_.join();
+    server_->Shutdown();
+    // Reply the tasks that are left, so that their reactors are deleted.
+    std::promise<void> replied;
+    server_io_service_.post(
+        [this, &replied]() {
+          for (auto &callback : waiting_tasks_) {
+            callback(Status::OK(), nullptr, nullptr);
+          }
+          waiting_tasks_.clear();
+          replied.set_value();
+        },
+        "PushTaskBatchStreamTest.TearDown");
+    replied.get_future().wait();
+    server_io_service_.stop();
+    server_thread_.join();
+    RayConfig::instance().initialize("");
+  }
+
+ protected:
+  static constexpr int kNumTasks = 4;
+
+  /// Task i finishes after task i + 1, like an async actor method that waits on the
+  /// next call. Only called from `server_io_service_`.
+  void HandlePushTask(int64_t seq_no, SendReplyCallback send_reply_callback) {
+    waiting_tasks_.push_back(std::move(send_reply_callback));
+    if (seq_no != kNumTasks - 1) {
+      return;
+    }
+    while (!waiting_tasks_.empty()) {
+      auto callback = std::move(waiting_tasks_.back());
+      waiting_tasks_.pop_back();
+      callback(Status::OK(), nullptr, nullptr);
+    }
+  }
+
+  instrumented_io_context server_io_service_;
+  std::thread server_thread_;
+  std::unique_ptr<PushTaskBatchService> service_;
+  std::unique_ptr<GrpcServer> server_;
+  std::vector<SendReplyCallback> waiting_tasks_;
+
+  instrumented_io_context client_io_service_;
+  std::thread client_thread_;
+  std::unique_ptr<ClientCallManager> client_call_manager_;
+  std::shared_ptr<CoreWorkerClient> client_;
+};
+
+TEST_F(PushTaskBatchStreamTest, TestTaskWaitsOnLaterTask) {
+  std::vector<std::promise<Status>> replied(kNumTasks);
+  for (int i = 0; i < kNumTasks; i++) {
+    auto request = std::make_unique<PushTaskRequest>();
+    request->set_sequence_number(i);
+    client_->PushActorTask(std::move(request),
+                           /*skip_queue=*/false,
+                           [&replied, i](const Status &status, PushTaskReply &&reply) {
+                             replied[i].set_value(status);
+                           });
+  }
+  // Task 0 can only finish once all of the later tasks, of both batches, are pushed.
+  for (int i = kNumTasks - 1; i >= 0; i--) {
+    auto future = replied[i].get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready)
+        << "Task " << i << " wasn't replied.";
+    ASSERT_TRUE(future.get().ok());
+  }
+  ASSERT_EQ(client_->ClientProcessedUpToSeqno(), kNumTasks - 1);
+}
+
+TEST_F(PushTaskBatchStreamTest, TestTasksFailWhenActorIsGone) {
+  std::vector<std::promise<Status>> replied(kNumTasks - 1);
+  for (int i = 0; i < kNumTasks - 1; i++) {
+    auto request = std::make_unique<PushTaskRequest>();
+    request->set_sequence_number(i);
+    client_->PushActorTask(std::move(request),
+                           /*skip_queue=*/false,
+                           [&replied, i](const Status &status, PushTaskReply &&reply) {
+                             replied[i].set_value(status);
+                           });
+  }
+  // The last task is never pushed, so none of the tasks finish before the server is
+  // gone.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  server_->Shutdown();
+  for (int i = 0; i < kNumTasks - 1; i++) {
+    auto future = replied[i].get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready)
+        << "Task " << i << " wasn't failed.";
+    ASSERT_FALSE(future.get().ok());
+  }
+}
+
+}  // namespace rpc
+}  // namespace ray
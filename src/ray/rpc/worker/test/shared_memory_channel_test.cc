@@ -0,0 +1,315 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/rpc/worker/shared_memory_channel.h"
+
+#include <future>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ray/common/id.h"
+#include "ray/common/ray_config.h"
+#include "ray/util/logging.h"
+
+namespace ray {
+namespace rpc {
+
+namespace {
+
+std::string RandomName() {
+  return "/ray_test_" + UniqueID::FromRandom().Hex().substr(0, 16);
+}
+
+PushTaskRequest CreateRequest(int64_t sequence_number, size_t arg_size = 0) {
+  PushTaskRequest request;
+  request.set_sequence_number(sequence_number);
+  request.mutable_task_spec()->add_args()->set_data(std::string(arg_size, 'x'));
+  return request;
+}
+
+}  // namespace
+
+TEST(SharedMemoryRingTest, TestWriteRead) {
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryRing> writer;
+  ASSERT_TRUE(SharedMemoryRing::Create(name, 1024, &writer).ok());
+  std::unique_ptr<SharedMemoryRing> reader;
+  ASSERT_TRUE(SharedMemoryRing::Open(name, &reader).ok());
+  writer->Unlink();
+  ASSERT_EQ(reader->Capacity(), 1024u);
+
+  uint64_t tag;
+  PushTaskRequest request;
+  ASSERT_FALSE(reader->Read(&tag, &request, /*timeout_ms=*/0));
+
+  // The ring wraps around many times.
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(writer->Write(i, CreateRequest(i, i % 100)));
+    ASSERT_TRUE(writer->Write(i + 1, CreateRequest(i + 1)));
+    ASSERT_TRUE(reader->Read(&tag, &request, /*timeout_ms=*/0));
+    ASSERT_EQ(tag, static_cast<uint64_t>(i));
+    ASSERT_EQ(request.sequence_number(), i);
+    ASSERT_EQ(request.task_spec().args(0).data().size(), static_cast<size_t>(i % 100));
+    ASSERT_TRUE(reader->Read(&tag, &request, /*timeout_ms=*/0));
+    ASSERT_EQ(tag, static_cast<uint64_t>(i + 1));
+  }
+
+  // A message that never fits.
+  ASSERT_FALSE(writer->Write(0, CreateRequest(0, 1024)));
+  // The ring is full until the reader catches up.
+  int num_written = 0;
+  while (writer->Write(num_written, CreateRequest(num_written, 100))) {
+    num_written++;
+  }
+  ASSERT_GT(num_written, 0);
+
+  // Closing wakes up the reader, which can still drain the ring.
+  writer->Close();
+  ASSERT_FALSE(writer->Write(0, CreateRequest(0)));
+  for (int i = 0; i < num_written; i++) {
+    ASSERT_TRUE(reader->Read(&tag, &request, /*timeout_ms=*/1000));
+    ASSERT_EQ(tag, static_cast<uint64_t>(i));
+  }
+  ASSERT_FALSE(reader->Read(&tag, &request, /*timeout_ms=*/1000));
+  ASSERT_TRUE(reader->IsClosed());
+}
+
+TEST(SharedMemoryRingTest, TestOpenMissing) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  ASSERT_TRUE(SharedMemoryRing::Open(RandomName(), &ring).IsIOError());
+}
+
+TEST(SharedMemoryRingTest, TestReaderSleeps) {
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryRing> writer;
+  ASSERT_TRUE(SharedMemoryRing::Create(name, 1024, &writer).ok());
+  std::unique_ptr<SharedMemoryRing> reader;
+  ASSERT_TRUE(SharedMemoryRing::Open(name, &reader).ok());
+  writer->Unlink();
+
+  auto read = std::async(std::launch::async, [&reader]() {
+    uint64_t tag = 0;
+    PushTaskRequest request;
+    RAY_CHECK(reader->Read(&tag, &request, /*timeout_ms=*/10000));
+    return tag;
+  });
+  // Give the reader time to go to sleep.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(writer->Write(42, CreateRequest(0)));
+  ASSERT_EQ(read.get(), 42u);
+}
+
+TEST(SharedMemoryRingTest, TestInterruptAndRoomRequest) {
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryRing> writer;
+  ASSERT_TRUE(SharedMemoryRing::Create(name, 1024, &writer).ok());
+  std::unique_ptr<SharedMemoryRing> reader;
+  ASSERT_TRUE(SharedMemoryRing::Open(name, &reader).ok());
+  writer->Unlink();
+
+  // An interrupt ends the wait of a sleeping reader, long before its timeout.
+  auto read = std::async(std::launch::async, [&reader]() {
+    uint64_t tag = 0;
+    PushTaskRequest request;
+    return reader->Read(&tag, &request, /*timeout_ms=*/10000);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  writer->Interrupt();
+  ASSERT_EQ(read.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  ASSERT_FALSE(read.get());
+  ASSERT_FALSE(reader->IsClosed());
+
+  // The writer requests room once the ring is full, and the reader sees the request
+  // once.
+  int num_written = 0;
+  while (writer->Write(num_written, CreateRequest(num_written, 100))) {
+    num_written++;
+  }
+  ASSERT_FALSE(reader->TakeRoomRequest());
+  writer->RequestRoom();
+  uint64_t tag;
+  PushTaskRequest request;
+  ASSERT_TRUE(reader->Read(&tag, &request, /*timeout_ms=*/0));
+  ASSERT_TRUE(reader->TakeRoomRequest());
+  ASSERT_FALSE(reader->TakeRoomRequest());
+  ASSERT_TRUE(writer->Write(num_written, CreateRequest(num_written, 100)));
+}
+
+class SharedMemoryChannelTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    io_thread_ = std::thread([this]() {
+      boost::asio::io_service::work work(io_service_);
+      io_service_.run();
+    });
+  }
+
+  void TearDown() override {
+    io_service_.stop();
+    io_thread_.join();
+    RayConfig::instance().initialize("");
+  }
+
+ protected:
+  /// Runs the reply callbacks of the channel clients.
+  instrumented_io_context io_service_;
+  std::thread io_thread_;
+};
+
+TEST_F(SharedMemoryChannelTest, TestPushTask) {
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryChannelClient> client;
+  ASSERT_TRUE(
+      SharedMemoryChannelClient::Create(name, 64 * 1024, io_service_, &client).ok());
+  std::unique_ptr<SharedMemoryChannelServer> server;
+  ASSERT_TRUE(SharedMemoryChannelServer::Open(
+                  name,
+                  [](PushTaskRequest request,
+                     PushTaskReply *reply,
+                     SendReplyCallback send_reply_callback) {
+                    if (request.sequence_number() % 2 == 0) {
+                      reply->set_worker_exiting(true);
+                      send_reply_callback(Status::OK(), nullptr, nullptr);
+                    } else {
+                      send_reply_callback(
+                          Status::SchedulingCancelled("cancelled"), nullptr, nullptr);
+                    }
+                  },
+                  /*closed_callback=*/nullptr,
+                  &server)
+                  .ok());
+  client->Unlink();
+  client->Start();
+
+  const int num_tasks = 100;
+  std::vector<std::promise<std::pair<Status, PushTaskReply>>> replies(num_tasks);
+  for (int i = 0; i < num_tasks; i++) {
+    ASSERT_TRUE(client->PushTask(CreateRequest(i),
+                                 [&replies, i](const Status &status, PushTaskReply &&reply) {
+                                   replies[i].set_value({status, std::move(reply)});
+                                 }));
+  }
+  for (int i = 0; i < num_tasks; i++) {
+    auto [status, reply] = replies[i].get_future().get();
+    if (i % 2 == 0) {
+      ASSERT_TRUE(status.ok());
+      ASSERT_TRUE(reply.worker_exiting());
+    } else {
+      ASSERT_TRUE(status.IsSchedulingCancelled());
+      ASSERT_EQ(status.message(), "cancelled");
+    }
+  }
+
+  // Tasks can't be pushed once the actor closed the channel.
+  server.reset();
+  ASSERT_FALSE(client->PushTask(CreateRequest(0),
+                                [](const Status &status, PushTaskReply &&reply) {}));
+}
+
+TEST_F(SharedMemoryChannelTest, TestRepliesOverflowRing) {
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryChannelClient> client;
+  ASSERT_TRUE(SharedMemoryChannelClient::Create(name, 4096, io_service_, &client).ok());
+  // The replies are sent from the request thread, so it would never drain the ring if
+  // it waited for room.
+  std::unique_ptr<SharedMemoryChannelServer> server;
+  ASSERT_TRUE(SharedMemoryChannelServer::Open(
+                  name,
+                  [](PushTaskRequest request,
+                     PushTaskReply *reply,
+                     SendReplyCallback send_reply_callback) {
+                    reply->set_task_execution_error(std::string(1000, 'x'));
+                    send_reply_callback(Status::OK(), nullptr, nullptr);
+                  },
+                  /*closed_callback=*/nullptr,
+                  &server)
+                  .ok());
+  client->Unlink();
+
+  // Push the tasks before the replies are read, so that they don't fit.
+  const int num_tasks = 20;
+  std::vector<std::promise<Status>> replied(num_tasks);
+  int num_pushed = 0;
+  while (num_pushed < num_tasks) {
+    if (client->PushTask(CreateRequest(num_pushed),
+                         [&replied, i = num_pushed](const Status &status,
+                                                    PushTaskReply &&reply) {
+                           replied[i].set_value(status);
+                         })) {
+      num_pushed++;
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  client->Start();
+  for (int i = 0; i < num_tasks; i++) {
+    auto future = replied[i].get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready)
+        << "Task " << i << " wasn't replied.";
+    ASSERT_TRUE(future.get().ok());
+  }
+}
+
+TEST_F(SharedMemoryChannelTest, TestServerDetectsDeadCaller) {
+  RayConfig::instance().initialize(
+      R"({"actor_task_shared_memory_channel_peer_timeout_ms": 500})");
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryChannelClient> client;
+  ASSERT_TRUE(SharedMemoryChannelClient::Create(name, 4096, io_service_, &client).ok());
+  std::promise<void> closed;
+  std::unique_ptr<SharedMemoryChannelServer> server;
+  ASSERT_TRUE(SharedMemoryChannelServer::Open(
+                  name,
+                  [](PushTaskRequest request,
+                     PushTaskReply *reply,
+                     SendReplyCallback send_reply_callback) {
+                    send_reply_callback(Status::OK(), nullptr, nullptr);
+                  },
+                  [&closed]() { closed.set_value(); },
+                  &server)
+                  .ok());
+  client->Unlink();
+
+  // The caller never starts reading the replies, so it never beats, as if its process
+  // were gone.
+  auto future = closed.get_future();
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  ASSERT_TRUE(server->IsClosed());
+  server.reset();
+}
+
+TEST_F(SharedMemoryChannelTest, TestClientDetectsDeadActor) {
+  RayConfig::instance().initialize(
+      R"({"actor_task_shared_memory_channel_peer_timeout_ms": 500})");
+  const auto name = RandomName();
+  std::unique_ptr<SharedMemoryChannelClient> client;
+  ASSERT_TRUE(SharedMemoryChannelClient::Create(name, 4096, io_service_, &client).ok());
+  client->Unlink();
+  client->Start();
+
+  // No actor ever opens the channel, as if its process were gone.
+  std::promise<Status> replied;
+  ASSERT_TRUE(client->PushTask(
+      CreateRequest(0), [&replied](const Status &status, PushTaskReply &&reply) {
+        replied.set_value(status);
+      }));
+  auto future = replied.get_future();
+  ASSERT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  ASSERT_TRUE(future.get().IsIOError());
+  ASSERT_FALSE(client->PushTask(CreateRequest(1),
+                                [](const Status &status, PushTaskReply &&reply) {}));
+}
+
+}  // namespace rpc
+}  // namespace ray
@@ -131,6 +131,26 @@ DEFINE_stats(object_store_dist,
                16384_MiB}),
              ray::stats::HISTOGRAM);
 
+/// Object store memory in the slabs of the allocator for small objects.
+DEFINE_stats(object_store_slab_memory,
+             "Object store memory in slabs by size class",
+             /// State:
+             ///    - IN_USE: bytes of the objects in the slabs.
+             ///    - ROUNDING: bytes wasted by rounding objects up to their chunk
+             ///      size.
+             ///    - FREE: bytes of the free chunks.
+             ("SizeClass", "State"),
+             (),
+             ray::stats::GAUGE);
+
+/// Time that object creation requests wait in the plasma store's queue.
+DEFINE_stats(object_store_create_request_wait_time_ms,
+             "Time in ms that object creation requests wait for memory",
+             /// SizeBucket: <1MiB, 1MiB-100MiB, 100MiB-1GiB or >=1GiB.
+             ("SizeBucket"),
+             ({1, 10, 100, 1000, 10000, 60000}),
+             ray::stats::HISTOGRAM);
+
 /// Placement group metrics from the GCS.
 DEFINE_stats(placement_groups,
              "Number of placement groups broken down by state.",
@@ -377,6 +397,14 @@ DEFINE_stats(
     (),
     ray::stats::COUNT);
 
+/// Pubsub
+DEFINE_stats(pubsub_coalesced_messages,
+             "Number of pubsub messages dropped because a newer message of the same "
+             "key was published before they were delivered.",
+             ("ChannelType"),
+             (),
+             ray::stats::COUNT);
+
 /// Core Worker Task Manager
 DEFINE_stats(
     total_lineage_bytes,
@@ -385,4 +413,27 @@ DEFINE_stats(
     (),
     ray::stats::GAUGE);
 
+/// Core Worker
+DEFINE_stats(object_inline_decisions,
+             "Number of task returns and args inlined or put into plasma, when the "
+             "inline threshold is adaptive.",
+             // Placement: INLINE or PLASMA.
+             // Source: TASK_RETURN or TASK_ARG.
+             // Adapted: whether the placement differs from the static threshold's.
+             ("Placement", "Source", "Adapted"),
+             (),
+             ray::stats::COUNT);
+DEFINE_stats(streaming_generator_report_batch_size,
+             "Number of streaming generator returns per report to the caller.",
+             (),
+             ({1, 2, 4, 8, 16, 32, 64, 128}),
+             ray::stats::HISTOGRAM);
+DEFINE_stats(streaming_generator_item_report_latency_ms,
+             "Time from yielding a streaming generator return until its report to the "
+             "caller is acked, including the time it waits to be batched and the time "
+             "the caller holds the ack for backpressure.",
+             (),
+             ({0.1, 1, 10, 100, 1000, 10000}, ),
+             ray::stats::HISTOGRAM);
+
 }  // namespace ray::stats
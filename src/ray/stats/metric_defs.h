@@ -115,6 +115,8 @@ DECLARE_stats(gcs_task_manager_task_events_reported);
 /// Object Store
 DECLARE_stats(object_store_memory);
 DECLARE_stats(object_store_dist);
+DECLARE_stats(object_store_slab_memory);
+DECLARE_stats(object_store_create_request_wait_time_ms);
 
 /// Placement Group
 DECLARE_stats(gcs_placement_group_creation_latency_ms);
@@ -126,9 +128,17 @@ DECLARE_stats(gcs_actors_count);
 /// Memory Manager
 DECLARE_stats(memory_manager_worker_eviction_total);
 
+/// Pubsub
+DECLARE_stats(pubsub_coalesced_messages);
+
 /// Core Worker Task Manager
 DECLARE_stats(total_lineage_bytes);
 
+/// Core Worker
+DECLARE_stats(object_inline_decisions);
+DECLARE_stats(streaming_generator_report_batch_size);
+DECLARE_stats(streaming_generator_item_report_latency_ms);
+
 /// The below items are legacy implementation of metrics.
 /// TODO(sang): Use DEFINE_stats instead.
 
@@ -0,0 +1,100 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ray {
+
+/// Deduplicates equal values, so that many owners of the same value share a single
+/// immutable copy of it through a handle.
+///
+/// The pool doesn't keep the values alive: an interned value is freed once the last
+/// handle to it is dropped. Entries of freed values are pruned whenever a shard of the
+/// pool has doubled in size since its last pruning, which keeps the amortized cost O(1).
+///
+/// This class is thread-safe. Values are spread over shards by their hash, each with
+/// its own lock, so that threads interning different values rarely contend.
+template <typename T,
+          typename Hash = typename absl::flat_hash_map<T, int>::hasher,
+          typename Eq = typename absl::flat_hash_map<T, int>::key_equal>
+class InternPool {
+ public:
+  /// \param num_shards The number of shards. A pool that is only used under another
+  /// lock needs just one.
+  explicit InternPool(size_t num_shards = 1) : shards_(std::max<size_t>(num_shards, 1)) {}
+
+  InternPool(const InternPool &) = delete;
+  InternPool &operator=(const InternPool &) = delete;
+
+  /// Returns the shared copy of `value`, creating it if there is none alive.
+  std::shared_ptr<const T> Intern(const T &value) {
+    const size_t hash = Hash()(value);
+    // Rehash, so that the shard doesn't correlate with the bits the shard's map uses.
+    auto &shard = shards_[absl::Hash<size_t>()(hash) % shards_.size()];
+    absl::MutexLock lock(&shard.mutex);
+    auto it = shard.values.find(value);
+    if (it != shard.values.end()) {
+      if (auto interned = it->second.lock()) {
+        return interned;
+      }
+      shard.values.erase(it);
+    }
+    auto interned = std::make_shared<const T>(value);
+    shard.values.emplace(*interned, interned);
+    if (shard.values.size() >= 2 * shard.size_after_prune) {
+      Prune(shard);
+    }
+    return interned;
+  }
+
+  /// Number of entries in the pool, including the ones not pruned yet.
+  size_t Size() const {
+    size_t size = 0;
+    for (const auto &shard : shards_) {
+      absl::MutexLock lock(&shard.mutex);
+      size += shard.values.size();
+    }
+    return size;
+  }
+
+ private:
+  /// The shard is not pruned until it reaches this size.
+  static constexpr size_t kMinPruneSize = 64;
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<T, std::weak_ptr<const T>, Hash, Eq> values
+        ABSL_GUARDED_BY(mutex);
+    size_t size_after_prune ABSL_GUARDED_BY(mutex) = kMinPruneSize;
+  };
+
+  static void Prune(Shard &shard) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex) {
+    absl::erase_if(shard.values,
+                   [](const auto &entry) { return entry.second.expired(); });
+    shard.size_after_prune = std::max<size_t>(shard.values.size(), kMinPruneSize);
+  }
+
+  std::vector<Shard> shards_;
+};
+
+}  // namespace ray
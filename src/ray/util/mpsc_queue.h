@@ -0,0 +1,105 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// MpscQueue is an unbounded, lock-free, multi-producer single-consumer queue, after
+// Dmitry Vyukov's intrusive MPSC node-based queue. Any thread may call `Push`, and
+// exactly one thread at a time may call `TryPop` and `Empty`. A push never waits for
+// the consumer or for other producers.
+//
+// A producer that is preempted between its two steps of `Push` hides the elements
+// pushed after its own one until it resumes, so the consumer can briefly see the queue
+// as empty while it isn't. Consumers that sleep when the queue is empty must be woken
+// up by every producer once its `Push` returns.
+//
+// Example usage:
+// MpscQueue<std::function<void()>> queue;
+// // Any thread.
+// queue.Push(std::move(fn));
+//
+// // Consumer thread.
+// std::function<void()> out;
+// while (queue.TryPop(&out)) {
+//   out();
+// }
+
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace ray::utils::container {
+
+template <typename T>
+class MpscQueue final {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  ~MpscQueue() {
+    while (tail_ != nullptr) {
+      Node *next = tail_->next.load(std::memory_order_relaxed);
+      delete tail_;
+      tail_ = next;
+    }
+  }
+
+  // Append `value` to the queue. Can be called from any thread.
+  void Push(T value) {
+    Node *node = new Node(std::move(value));
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    // Sequentially consistent, so that a consumer that announces it's going to sleep
+    // before it checks `Empty` either sees the element or is seen by the producer.
+    prev->next.store(node, std::memory_order_seq_cst);
+  }
+
+  // Pop the oldest element into `out`. Returns false if the queue is empty.
+  //
+  // Must only be called from the consumer thread.
+  bool TryPop(T *out) {
+    Node *next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *out = std::move(*next->value);
+    next->value.reset();
+    delete tail_;
+    // The popped node becomes the stub.
+    tail_ = next;
+    return true;
+  }
+
+  // Must only be called from the consumer thread.
+  bool Empty() const {
+    return tail_->next.load(std::memory_order_seq_cst) == nullptr;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T v) : value(std::move(v)) {}
+
+    std::atomic<Node *> next{nullptr};
+    std::optional<T> value;
+  };
+
+  // The most recently pushed node, which producers link the next one to.
+  std::atomic<Node *> head_;
+  // The stub node, whose successor is the oldest element. Owned by the consumer.
+  Node *tail_;
+};
+
+}  // namespace ray::utils::container
@@ -0,0 +1,101 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+
+namespace ray {
+
+/// A set for a handful of elements, which stores up to `N` of them inline and only
+/// allocates beyond that. Lookups are linear scans, so it's only meant for sets that
+/// stay small, e.g. the locations of an object.
+///
+/// The API is a subset of the one of absl::flat_hash_set. Erasing an element may
+/// reorder the others.
+template <typename T, size_t N = 1>
+class SmallSet {
+  using Storage = absl::InlinedVector<T, N>;
+
+ public:
+  using value_type = T;
+  using iterator = typename Storage::const_iterator;
+  using const_iterator = typename Storage::const_iterator;
+
+  SmallSet() = default;
+
+  template <typename InputIt>
+  SmallSet(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  std::pair<iterator, bool> emplace(T value) {
+    auto it = find(value);
+    if (it != end()) {
+      return {it, false};
+    }
+    elements_.push_back(std::move(value));
+    return {std::prev(elements_.cend()), true};
+  }
+
+  std::pair<iterator, bool> insert(T value) { return emplace(std::move(value)); }
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      emplace(*first);
+    }
+  }
+
+  /// Returns the number of erased elements.
+  size_t erase(const T &value) {
+    auto it = std::find(elements_.begin(), elements_.end(), value);
+    if (it == elements_.end()) {
+      return 0;
+    }
+    // Move the last element to the hole instead of shifting all the following ones.
+    if (it != std::prev(elements_.end())) {
+      *it = std::move(elements_.back());
+    }
+    elements_.pop_back();
+    return 1;
+  }
+
+  const_iterator find(const T &value) const {
+    return std::find(elements_.cbegin(), elements_.cend(), value);
+  }
+
+  bool contains(const T &value) const { return find(value) != end(); }
+
+  size_t count(const T &value) const { return contains(value) ? 1 : 0; }
+
+  void clear() { elements_.clear(); }
+
+  size_t size() const { return elements_.size(); }
+
+  bool empty() const { return elements_.empty(); }
+
+  const_iterator begin() const { return elements_.cbegin(); }
+
+  const_iterator end() const { return elements_.cend(); }
+
+ private:
+  Storage elements_;
+};
+
+}  // namespace ray
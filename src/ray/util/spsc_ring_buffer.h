@@ -0,0 +1,133 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SpscRingBuffer is a bounded, lock-free, single-producer single-consumer queue.
+// Exactly one thread may call `TryPush` and exactly one thread (which could be a
+// different one) may call `TryPop` at any given time. Callers that need more
+// consumers must serialize them externally.
+//
+// Example usage:
+// SpscRingBuffer<std::unique_ptr<Event>> ring{/*capacity=*/1024};
+// // Producer thread.
+// if (!ring.TryPush(std::move(event))) {
+//   // Ring is full, `event` is left untouched and can go through a slow path.
+// }
+//
+// // Consumer thread.
+// std::unique_ptr<Event> out;
+// while (ring.TryPop(&out)) {
+//   // Consume `out`.
+// }
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "ray/util/logging.h"
+
+namespace ray::utils::container {
+
+template <typename T>
+class SpscRingBuffer final {
+ public:
+  // `capacity` is rounded up to the next power of two, so the actual number of
+  // elements the ring can hold might be larger than requested.
+  explicit SpscRingBuffer(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1), slots_(new T[mask_ + 1]) {
+    RAY_CHECK_GT(capacity, 0UL);
+  }
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+  ~SpscRingBuffer() = default;
+
+  // Append `value` to the ring. Returns false if the ring is full, in which case
+  // `value` is not moved from.
+  //
+  // Must only be called from the producer thread.
+  bool TryPush(T &&value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pop the oldest element into `out`. Returns false if the ring is empty.
+  //
+  // Must only be called from the consumer thread.
+  bool TryPop(T *out) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    *out = std::move(slots_[head & mask_]);
+    // Reset the slot so resources held by a moved-from value are released now
+    // instead of when the slot gets overwritten.
+    slots_[head & mask_] = T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Number of elements in the ring. Only a snapshot when called concurrently with
+  // pushes or pops.
+  size_t Size() const {
+    // Load `head_` first, since `tail_` never falls behind it.
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  // Keep the producer and consumer indices on separate cache lines, so that the
+  // two sides do not false-share.
+  static constexpr size_t kCacheLineSize = 64;
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Consumer side: written by the consumer, `head_` is read by the producer.
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  // Consumer's last observed value of `tail_`.
+  size_t cached_tail_ = 0;
+  // Producer side: written by the producer, `tail_` is read by the consumer.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  // Producer's last observed value of `head_`.
+  size_t cached_head_ = 0;
+};
+
+}  // namespace ray::utils::container
@@ -0,0 +1,87 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/intern_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ray {
+
+TEST(InternPoolTest, SharesEqualValues) {
+  InternPool<std::string> pool;
+  auto a = pool.Intern("foo");
+  auto b = pool.Intern(std::string("foo"));
+  auto c = pool.Intern("bar");
+  ASSERT_EQ(a.get(), b.get());
+  ASSERT_NE(a.get(), c.get());
+  ASSERT_EQ(*a, "foo");
+  ASSERT_EQ(*c, "bar");
+  ASSERT_EQ(pool.Size(), 2);
+}
+
+TEST(InternPoolTest, ReinternFreedValue) {
+  InternPool<std::string> pool;
+  auto a = pool.Intern("foo");
+  a.reset();
+  auto b = pool.Intern("foo");
+  ASSERT_EQ(*b, "foo");
+  ASSERT_EQ(pool.Size(), 1);
+}
+
+TEST(InternPoolTest, PruneFreedValues) {
+  InternPool<std::string> pool;
+  std::vector<std::shared_ptr<const std::string>> alive;
+  for (int i = 0; i < 10000; i++) {
+    auto value = pool.Intern(std::to_string(i));
+    if (i % 100 == 0) {
+      alive.push_back(std::move(value));
+    }
+  }
+  // Entries of the freed values don't pile up.
+  ASSERT_LT(pool.Size(), 1000);
+  for (size_t i = 0; i < alive.size(); i++) {
+    ASSERT_EQ(pool.Intern(std::to_string(i * 100)).get(), alive[i].get());
+  }
+}
+
+TEST(InternPoolTest, ShardedPoolSharesEqualValues) {
+  InternPool<std::string> pool(/*num_shards=*/16);
+  const int num_values = 1000;
+  std::vector<std::vector<std::shared_ptr<const std::string>>> interned(4);
+  std::vector<std::thread> threads;
+  for (auto &values : interned) {
+    threads.emplace_back([&pool, &values]() {
+      for (int i = 0; i < num_values; i++) {
+        values.push_back(pool.Intern(std::to_string(i)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // Every thread got the same copy of each value.
+  for (const auto &values : interned) {
+    for (int i = 0; i < num_values; i++) {
+      ASSERT_EQ(values[i].get(), interned[0][i].get());
+      ASSERT_EQ(*values[i], std::to_string(i));
+    }
+  }
+  ASSERT_EQ(pool.Size(), num_values);
+}
+
+}  // namespace ray
@@ -0,0 +1,95 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ray::utils::container {
+
+TEST(MpscQueueTest, PushPopInOrder) {
+  MpscQueue<int> queue;
+  EXPECT_TRUE(queue.Empty());
+  int out = -1;
+  EXPECT_FALSE(queue.TryPop(&out));
+
+  for (int i = 0; i < 4; ++i) {
+    queue.Push(i);
+  }
+  EXPECT_FALSE(queue.Empty());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPop(&out));
+    EXPECT_EQ(out, i);
+  }
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_FALSE(queue.TryPop(&out));
+}
+
+TEST(MpscQueueTest, MoveOnlyType) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.Push(std::make_unique<int>(42));
+  std::unique_ptr<int> out;
+  ASSERT_TRUE(queue.TryPop(&out));
+  EXPECT_EQ(*out, 42);
+}
+
+TEST(MpscQueueTest, DestroysRemainingElements) {
+  auto value = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(value);
+    queue.Push(value);
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueueTest, ConcurrentProducers) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumPerProducer = 100000;
+  MpscQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kNumPerProducer; ++i) {
+        queue.Push({p, i});
+      }
+    });
+  }
+
+  // Elements of each producer are popped in the order they were pushed.
+  std::vector<int> next(kNumProducers, 0);
+  int num_popped = 0;
+  std::pair<int, int> out;
+  while (num_popped < kNumProducers * kNumPerProducer) {
+    if (!queue.TryPop(&out)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(out.second, next[out.first]);
+    next[out.first]++;
+    num_popped++;
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace ray::utils::container
@@ -0,0 +1,55 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/small_set.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+
+namespace ray {
+
+TEST(SmallSetTest, EmplaceAndErase) {
+  SmallSet<std::string> set;
+  ASSERT_TRUE(set.empty());
+  ASSERT_TRUE(set.emplace("a").second);
+  ASSERT_FALSE(set.emplace("a").second);
+  ASSERT_TRUE(set.emplace("b").second);
+  ASSERT_TRUE(set.insert("c").second);
+  ASSERT_EQ(set.size(), 3);
+  ASSERT_TRUE(set.contains("b"));
+  ASSERT_EQ(set.count("d"), 0);
+
+  ASSERT_EQ(set.erase("a"), 1);
+  ASSERT_EQ(set.erase("a"), 0);
+  ASSERT_EQ(set.size(), 2);
+  ASSERT_EQ(std::set<std::string>(set.begin(), set.end()),
+            std::set<std::string>({"b", "c"}));
+
+  set.clear();
+  ASSERT_TRUE(set.empty());
+  ASSERT_EQ(set.find("b"), set.end());
+}
+
+TEST(SmallSetTest, ConstructFromRange) {
+  std::set<int> values = {3, 1, 2};
+  SmallSet<int, 2> set(values.begin(), values.end());
+  ASSERT_EQ(set.size(), 3);
+  for (int value : values) {
+    ASSERT_TRUE(set.contains(value));
+  }
+}
+
+}  // namespace ray
@@ -0,0 +1,87 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/spsc_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+namespace ray::utils::container {
+
+TEST(SpscRingBufferTest, CapacityRoundedUp) {
+  SpscRingBuffer<int> ring{/*capacity=*/5};
+  EXPECT_EQ(ring.Capacity(), 8);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscRingBufferTest, PushPopInOrder) {
+  SpscRingBuffer<int> ring{/*capacity=*/4};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.TryPush(int{i}));
+  }
+  // Ring is full.
+  EXPECT_FALSE(ring.TryPush(4));
+  EXPECT_EQ(ring.Size(), 4);
+
+  int out = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring.TryPop(&out));
+    EXPECT_EQ(out, i);
+  }
+  EXPECT_FALSE(ring.TryPop(&out));
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscRingBufferTest, FailedPushDoesNotConsumeValue) {
+  SpscRingBuffer<std::unique_ptr<int>> ring{/*capacity=*/1};
+  EXPECT_TRUE(ring.TryPush(std::make_unique<int>(1)));
+
+  auto value = std::make_unique<int>(2);
+  EXPECT_FALSE(ring.TryPush(std::move(value)));
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 2);
+
+  std::unique_ptr<int> out;
+  ASSERT_TRUE(ring.TryPop(&out));
+  EXPECT_EQ(*out, 1);
+  EXPECT_TRUE(ring.TryPush(std::move(value)));
+}
+
+TEST(SpscRingBufferTest, ConcurrentProducerConsumer) {
+  constexpr int kNumElements = 100000;
+  SpscRingBuffer<int> ring{/*capacity=*/1024};
+
+  std::thread producer([&ring]() {
+    for (int i = 0; i < kNumElements; ++i) {
+      while (!ring.TryPush(int{i})) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  int out = -1;
+  while (expected < kNumElements) {
+    if (ring.TryPop(&out)) {
+      ASSERT_EQ(out, expected);
+      ++expected;
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(ring.Empty());
+}
+
+}  // namespace ray::utils::container
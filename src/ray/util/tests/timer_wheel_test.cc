@@ -0,0 +1,104 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ray/util/timer_wheel.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+namespace ray {
+
+TEST(TimerWheelTest, ExpireAtDeadline) {
+  TimerWheel<int> wheel;
+  wheel.Schedule(1, 0);
+  wheel.Schedule(2, 3);
+  ASSERT_EQ(wheel.Size(), 2);
+
+  std::vector<int> expired;
+  wheel.Advance(0, &expired);
+  ASSERT_EQ(expired, std::vector<int>({1}));
+
+  expired.clear();
+  wheel.Advance(2, &expired);
+  ASSERT_TRUE(expired.empty());
+
+  wheel.Advance(3, &expired);
+  ASSERT_EQ(expired, std::vector<int>({2}));
+  ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimerWheelTest, CascadeFromUpperLevels) {
+  TimerWheel<uint64_t> wheel;
+  // Delays that land on every level, including the boundaries between levels.
+  std::vector<uint64_t> delays = {
+      1, 63, 64, 65, 4095, 4096, 4097, 100000, 262143, 262144, 1000000};
+  for (auto delay : delays) {
+    wheel.Schedule(delay, delay);
+  }
+
+  std::vector<uint64_t> expired;
+  for (uint64_t tick = 1; tick <= 1000000; ++tick) {
+    wheel.Advance(tick, &expired);
+    for (auto delay : expired) {
+      ASSERT_EQ(delay, tick);
+    }
+    expired.clear();
+  }
+  ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimerWheelTest, RandomScheduleWhileAdvancing) {
+  TimerWheel<uint64_t> wheel;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<uint64_t> delay_dist(0, 20000);
+  std::uniform_int_distribution<uint64_t> step_dist(1, 500);
+
+  // Expected number of timers expiring at each tick.
+  std::map<uint64_t, size_t> expected;
+  for (int round = 0; round < 2000; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      auto delay = delay_dist(gen);
+      auto expiry = wheel.CurrentTick() + delay;
+      wheel.Schedule(expiry, delay);
+      expected[expiry]++;
+    }
+    std::vector<uint64_t> expired;
+    auto target = wheel.CurrentTick() + step_dist(gen);
+    // Advance one tick at a time to verify the exact expiry tick.
+    while (wheel.CurrentTick() < target) {
+      wheel.Advance(wheel.CurrentTick() + 1, &expired);
+      for (auto expiry : expired) {
+        ASSERT_EQ(expiry, wheel.CurrentTick());
+        ASSERT_GT(expected[expiry], 0);
+        expected[expiry]--;
+      }
+      expired.clear();
+    }
+  }
+}
+
+TEST(TimerWheelTest, ClampToMaxTicks) {
+  TimerWheel<int> wheel;
+  wheel.Schedule(1, TimerWheel<int>::MaxTicks() * 2);
+  std::vector<int> expired;
+  wheel.Advance(TimerWheel<int>::MaxTicks() - 1, &expired);
+  ASSERT_TRUE(expired.empty());
+  wheel.Advance(TimerWheel<int>::MaxTicks(), &expired);
+  ASSERT_EQ(expired, std::vector<int>({1}));
+}
+
+}  // namespace ray
@@ -0,0 +1,134 @@
+// Copyright 2024 The Ray Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ray {
+
+/// A hierarchical timing wheel, which tracks a large number of timers at the cost of
+/// O(1) per timer scheduling and amortized O(1) per expiration, no matter how many
+/// timers are pending.
+///
+/// Time is measured in ticks, and it only moves forward when the owner calls
+/// `Advance`. There are `kNumLevels` wheels of `kSlotsPerLevel` slots each: a slot of
+/// level `l` covers `kSlotsPerLevel ^ l` ticks. When a lower level wraps around, the
+/// entries of the next slot of the upper level are cascaded down to finer slots.
+/// Deadlines further than `MaxTicks()` away are clamped.
+///
+/// Timers can't be cancelled. Owners are expected to tag the values with enough
+/// information to tell whether an expired timer is still relevant.
+///
+/// This class is *not* thread-safe.
+template <typename T>
+class TimerWheel {
+ public:
+  TimerWheel() = default;
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  /// Schedule `value` to expire `delay_ticks` after the current tick. A delay of 0
+  /// expires at the next call to `Advance`.
+  void Schedule(T value, uint64_t delay_ticks) {
+    if (delay_ticks > MaxTicks()) {
+      delay_ticks = MaxTicks();
+    }
+    Insert(Entry{current_tick_ + delay_ticks, std::move(value)});
+    ++size_;
+  }
+
+  /// Move the current tick forward to `tick`, appending the values of all timers that
+  /// expire on the way to `expired`.
+  void Advance(uint64_t tick, std::vector<T> *expired) {
+    // Timers scheduled with a delay of 0 expire at the current tick.
+    PopExpired(expired);
+    while (current_tick_ < tick) {
+      ++current_tick_;
+      // Cascade the upper levels whose lower level just wrapped around.
+      for (size_t level = 1; level < kNumLevels; ++level) {
+        if ((current_tick_ & ((uint64_t{1} << (kBitsPerLevel * level)) - 1)) != 0) {
+          break;
+        }
+        auto &slot = levels_[level][SlotIndex(current_tick_, level)];
+        std::vector<Entry> entries;
+        entries.swap(slot);
+        for (auto &entry : entries) {
+          Insert(std::move(entry));
+        }
+      }
+      PopExpired(expired);
+    }
+  }
+
+  /// The current tick of the wheel.
+  uint64_t CurrentTick() const { return current_tick_; }
+
+  /// Number of pending timers.
+  size_t Size() const { return size_; }
+
+  /// The longest delay a timer could be scheduled with.
+  static constexpr uint64_t MaxTicks() {
+    return (uint64_t{1} << (kBitsPerLevel * kNumLevels)) - 1;
+  }
+
+ private:
+  struct Entry {
+    uint64_t expiry_tick;
+    T value;
+  };
+
+  static constexpr size_t kBitsPerLevel = 6;
+  static constexpr size_t kSlotsPerLevel = size_t{1} << kBitsPerLevel;
+  static constexpr size_t kNumLevels = 4;
+
+  static size_t SlotIndex(uint64_t tick, size_t level) {
+    return (tick >> (kBitsPerLevel * level)) & (kSlotsPerLevel - 1);
+  }
+
+  /// Put the entry to the finest level that covers its remaining delay.
+  void Insert(Entry entry) {
+    const uint64_t delay = entry.expiry_tick - current_tick_;
+    size_t level = 0;
+    while (level + 1 < kNumLevels &&
+           delay >= (uint64_t{1} << (kBitsPerLevel * (level + 1)))) {
+      ++level;
+    }
+    levels_[level][SlotIndex(entry.expiry_tick, level)].push_back(std::move(entry));
+  }
+
+  void PopExpired(std::vector<T> *expired) {
+    auto &slot = levels_[0][SlotIndex(current_tick_, 0)];
+    if (slot.empty()) {
+      return;
+    }
+    std::vector<Entry> entries;
+    entries.swap(slot);
+    for (auto &entry : entries) {
+      expired->push_back(std::move(entry.value));
+    }
+    size_ -= entries.size();
+  }
+
+  uint64_t current_tick_ = 0;
+  size_t size_ = 0;
+  std::array<std::array<std::vector<Entry>, kSlotsPerLevel>, kNumLevels> levels_;
+};
+
+}  // namespace ray